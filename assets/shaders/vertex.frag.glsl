@@ -1,14 +1,17 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout (location = 0) in vec3 frag_color;
 layout (location = 1) in vec2 frag_text_coord;
+layout (location = 2) flat in uint frag_texture;
 
-layout (binding = 1) uniform sampler2D text_sampler;
+// Texture table, every texture the renderer samples
+layout (set = 1, binding = 0) uniform sampler2D textures[];
 
 layout (location = 0) out vec4 out_color;
 
 void main()
 {
     // out_color = vec4(frag_color, 1.0);
-    out_color = texture(text_sampler, frag_text_coord);
+    out_color = texture(textures[frag_texture], frag_text_coord);
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #version 450
 
-layout(location = 0) in vec2 in_position;
-layout(location = 1) in vec3 in_color;
+// Scene mesh attributes, locations follow Aqua::VertexAttribute
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec2 in_text_coords;
 
 layout(location = 0) out vec3 frag_color;
 layout(location = 1) out vec2 frag_text_coord;
+layout(location = 2) flat out uint frag_texture;
 
 layout(binding = 0) uniform UniformBufferObject
 {
@@ -14,9 +16,17 @@ layout(binding = 0) uniform UniformBufferObject
     mat4 projection;
 } ubo;
 
+// Per draw data, the mesh's placement in its grid cell and its texture table index
+layout(push_constant) uniform DrawConstants
+{
+    mat4 transform;
+    uint texture_index;
+} draw;
+
 void main()
 {
-    gl_Position = ubo.projection * ubo.view * ubo.model * vec4(in_position, 0.0, 1.0);
-    frag_color = in_color;
+    gl_Position = ubo.projection * ubo.view * ubo.model * draw.transform * vec4(in_position, 1.0);
+    frag_color = in_normal * 0.5 + 0.5;
     frag_text_coord = in_text_coords;
+    frag_texture = draw.texture_index;
 }
\ No newline at end of file
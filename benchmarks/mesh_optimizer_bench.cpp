@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "Assets/MeshOptimizer.h"
+#include "Debug/Profile.h"
+
+// Measures post-transform cache efficiency (ACMR/ATVR) before and after the mesh optimizer
+// usage: mesh_optimizer_bench [mesh files ...]
+// Without arguments a shuffled grid and a sphere are generated
+
+static Aqua::MeshData create_grid(uint32_t size, bool shuffle)
+{
+	Aqua::MeshData mesh{};
+
+	for (uint32_t y = 0; y <= size; ++y)
+		for (uint32_t x = 0; x <= size; ++x)
+			mesh.positions.push_back({ static_cast<float>(x), static_cast<float>(y), 0.0f });
+
+	for (uint32_t y = 0; y < size; ++y)
+	{
+		for (uint32_t x = 0; x < size; ++x)
+		{
+			uint32_t v0 = y * (size + 1) + x;
+			uint32_t v1 = v0 + 1;
+			uint32_t v2 = v0 + size + 1;
+			uint32_t v3 = v2 + 1;
+			mesh.indices.insert(mesh.indices.end(), { v0, v2, v1, v1, v2, v3 });
+		}
+	}
+
+	if (shuffle)
+	{
+		std::vector<uint32_t> order(mesh.indices.size() / 3);
+		std::iota(order.begin(), order.end(), 0u);
+		std::shuffle(order.begin(), order.end(), std::mt19937{ 42 });
+
+		auto source = mesh.indices;
+		for (size_t i = 0; i < order.size(); ++i)
+			std::copy_n(source.begin() + order[i] * 3, 3, mesh.indices.begin() + i * 3);
+	}
+
+	return mesh;
+}
+
+static Aqua::MeshData create_sphere(uint32_t rings, uint32_t segments)
+{
+	Aqua::MeshData mesh{};
+	constexpr float pi = 3.14159265358979f;
+
+	for (uint32_t ring = 0; ring <= rings; ++ring)
+	{
+		float theta = pi * ring / rings;
+		for (uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			float phi = 2.0f * pi * segment / segments;
+			mesh.positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+		}
+	}
+
+	// Emitted ring strip by ring strip, which is the usual order from modelling tools
+	for (uint32_t ring = 0; ring < rings; ++ring)
+	{
+		for (uint32_t segment = 0; segment < segments; ++segment)
+		{
+			uint32_t v0 = ring * (segments + 1) + segment;
+			uint32_t v1 = v0 + 1;
+			uint32_t v2 = v0 + segments + 1;
+			uint32_t v3 = v2 + 1;
+			mesh.indices.insert(mesh.indices.end(), { v0, v2, v1, v1, v2, v3 });
+		}
+	}
+
+	return mesh;
+}
+
+static void run_benchmark(const std::string& name, Aqua::MeshData mesh)
+{
+	auto report = [&mesh](const char* label) {
+		std::cout << "  " << label;
+		for (uint32_t cache_size : { 16u, 32u })
+		{
+			auto statistics = Aqua::analyze_vertex_cache(mesh.indices, mesh.get_vertex_count(), cache_size);
+			std::cout << "  fifo" << cache_size << " acmr " << statistics.acmr << " atvr " << statistics.atvr;
+		}
+		std::cout << std::endl;
+	};
+
+	std::cout << name << ": " << mesh.get_vertex_count() << " vertices, " << mesh.get_index_count() / 3 << " triangles" << std::endl;
+	report("before");
+
+	auto start = std::chrono::high_resolution_clock::now();
+	Aqua::optimize_mesh(mesh);
+	auto end = std::chrono::high_resolution_clock::now();
+
+	report("after ");
+	std::cout << "  optimize time " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	Aqua::Profiler::BeginProfile("mesh_optimizer_bench.txt");
+
+	if (argc < 2)
+	{
+		run_benchmark("grid 256x256 (shuffled)", create_grid(256, true));
+		run_benchmark("grid 256x256 (scanline)", create_grid(256, false));
+		run_benchmark("sphere 256x512", create_sphere(256, 512));
+	}
+
+	for (int i = 1; i < argc; ++i)
+	{
+		auto mesh = Aqua::import_mesh(argv[i]);
+		if (mesh.has_value())
+			run_benchmark(argv[i], std::move(mesh.value()));
+	}
+
+	Aqua::Profiler::EndProfile();
+
+	return 0;
+}
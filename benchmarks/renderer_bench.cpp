@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Application/Application.h"
+#include "Renderer/Renderer.h"
+#include "Renderer/Vulkan/VulkanRenderer.h"
+#include "Window/Window.h"
+#include "EventSystem/Event.h"
+
+// Renders a scripted scene for a fixed number of frames and writes frame time statistics as JSON
+// usage: renderer_bench [--quads N] [--textures M] [--uniform-updates K] [--mesh file.gltf] [--frames F] [--warmup W]
+//                       [--width X] [--height Y] [--headless] [--out file.json]
+//                       [--frames-in-flight N] [--images I] [--present-mode fifo|fifo_relaxed|mailbox|immediate]
+//                       [--texture-layers L]
+// The animation advances a fixed step per frame, so every run draws the same frames. --texture-layers first uploads the
+// scene texture as an L layer array and exits with an error if that upload fails
+
+struct BenchOptions
+{
+	Aqua::SceneDescription scene{ 1024, 4, 16, 1.0f / 60.0f };
+	uint32_t frames = 1000;
+	uint32_t warmup = 100;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	bool headless = false;
+	uint32_t frames_in_flight = 2;
+	uint32_t swap_chain_images = 0;
+	Aqua::PresentMode present_mode = Aqua::PresentMode::Mailbox;
+	uint32_t texture_layers = 0;
+	std::string out{};
+};
+
+static const char* present_mode_names[] = { "fifo", "fifo_relaxed", "mailbox", "immediate" };
+
+static std::optional<Aqua::PresentMode> parse_present_mode(const char* name)
+{
+	for (size_t i = 0; i < std::size(present_mode_names); ++i)
+	{
+		if (std::strcmp(name, present_mode_names[i]) == 0)
+			return static_cast<Aqua::PresentMode>(i);
+	}
+	return std::nullopt;
+}
+
+struct Statistics
+{
+	double min = 0.0, max = 0.0, mean = 0.0, median = 0.0, p95 = 0.0, p99 = 0.0, stddev = 0.0;
+};
+
+static std::optional<BenchOptions> parse_options(int argc, char** argv)
+{
+	BenchOptions options{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		if (std::strcmp(arg, "--headless") == 0)
+		{
+			options.headless = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cerr << "renderer_bench: missing value or unknown option " << arg << std::endl;
+			return std::nullopt;
+		}
+
+		const char* value = argv[++i];
+		auto number = [value]() { return static_cast<uint32_t>(std::strtoul(value, nullptr, 10)); };
+
+		if (std::strcmp(arg, "--quads") == 0) options.scene.quad_count = number();
+		else if (std::strcmp(arg, "--textures") == 0) options.scene.texture_count = number();
+		else if (std::strcmp(arg, "--uniform-updates") == 0) options.scene.uniform_updates = number();
+		else if (std::strcmp(arg, "--mesh") == 0) options.scene.mesh = value;
+		else if (std::strcmp(arg, "--frames") == 0) options.frames = number();
+		else if (std::strcmp(arg, "--warmup") == 0) options.warmup = number();
+		else if (std::strcmp(arg, "--width") == 0) options.width = number();
+		else if (std::strcmp(arg, "--height") == 0) options.height = number();
+		else if (std::strcmp(arg, "--frames-in-flight") == 0) options.frames_in_flight = number();
+		else if (std::strcmp(arg, "--images") == 0) options.swap_chain_images = number();
+		else if (std::strcmp(arg, "--present-mode") == 0)
+		{
+			auto mode = parse_present_mode(value);
+			if (!mode.has_value())
+			{
+				std::cerr << "renderer_bench: unknown present mode " << value << std::endl;
+				return std::nullopt;
+			}
+			options.present_mode = *mode;
+		}
+		else if (std::strcmp(arg, "--texture-layers") == 0) options.texture_layers = number();
+		else if (std::strcmp(arg, "--out") == 0) options.out = value;
+		else
+		{
+			std::cerr << "renderer_bench: unknown option " << arg << std::endl;
+			return std::nullopt;
+		}
+	}
+
+	if (options.frames == 0 || options.width == 0 || options.height == 0)
+	{
+		std::cerr << "renderer_bench: frames, width and height must be positive" << std::endl;
+		return std::nullopt;
+	}
+
+	return options;
+}
+
+// Nearest rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+static Statistics compute_statistics(std::vector<double> samples)
+{
+	Statistics statistics{};
+	if (samples.empty())
+		return statistics;
+
+	std::sort(samples.begin(), samples.end());
+
+	const double count = static_cast<double>(samples.size());
+	statistics.min = samples.front();
+	statistics.max = samples.back();
+	statistics.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+	statistics.median = samples.size() % 2 == 0
+		? 0.5 * (samples[samples.size() / 2 - 1] + samples[samples.size() / 2])
+		: samples[samples.size() / 2];
+	statistics.p95 = percentile(samples, 0.95);
+	statistics.p99 = percentile(samples, 0.99);
+
+	double variance = 0.0;
+	for (double sample : samples)
+		variance += (sample - statistics.mean) * (sample - statistics.mean);
+	statistics.stddev = std::sqrt(variance / count);
+
+	return statistics;
+}
+
+static void write_statistics(std::ostream& out, const char* name, const Statistics& statistics, bool last)
+{
+	out << "\t\t\"" << name << "\": { "
+		<< "\"min\": " << statistics.min << ", "
+		<< "\"max\": " << statistics.max << ", "
+		<< "\"mean\": " << statistics.mean << ", "
+		<< "\"median\": " << statistics.median << ", "
+		<< "\"p95\": " << statistics.p95 << ", "
+		<< "\"p99\": " << statistics.p99 << ", "
+		<< "\"stddev\": " << statistics.stddev << " }" << (last ? "\n" : ",\n");
+}
+
+static void write_report(std::ostream& out, const BenchOptions& options, uint32_t frames,
+						 const std::vector<Aqua::FrameTiming>& timings, const std::vector<double>& frame_ms,
+						 const Aqua::Renderer& renderer)
+{
+	const bool gpu_timings = renderer.has_gpu_timings();
+	const bool present_timings = renderer.has_present_timings();
+
+	// Frames whose present could not be observed report 0 and are left out
+	std::vector<double> cpu_ms{}, gpu_ms{}, present_ms{};
+	for (const auto& timing : timings)
+	{
+		cpu_ms.push_back(timing.cpu_ms);
+		gpu_ms.push_back(timing.gpu_ms);
+		if (timing.present_ms > 0.0)
+			present_ms.push_back(timing.present_ms);
+	}
+
+	out << "{\n"
+		<< "\t\"scene\": {\n"
+		<< "\t\t\"quads\": " << options.scene.quad_count << ",\n"
+		<< "\t\t\"textures\": " << options.scene.texture_count << ",\n"
+		<< "\t\t\"uniform_updates\": " << options.scene.uniform_updates << ",\n"
+		<< "\t\t\"mesh\": \"" << (options.scene.mesh.empty() ? "quad" : options.scene.mesh.generic_string()) << "\",\n"
+		<< "\t\t\"width\": " << options.width << ",\n"
+		<< "\t\t\"height\": " << options.height << ",\n"
+		<< "\t\t\"headless\": " << (options.headless ? "true" : "false") << "\n"
+		<< "\t},\n"
+		<< "\t\"frames_in_flight\": " << renderer.get_frames_in_flight() << ",\n"
+		<< "\t\"present_mode\": \"" << present_mode_names[static_cast<size_t>(renderer.get_present_mode())] << "\",\n"
+		<< "\t\"warmup_frames\": " << options.warmup << ",\n"
+		<< "\t\"frames\": " << frames << ",\n"
+		<< "\t\"gpu_timings\": " << (gpu_timings ? "true" : "false") << ",\n"
+		<< "\t\"present_timings\": " << (present_timings ? "true" : "false") << ",\n"
+		<< "\t\"statistics_ms\": {\n";
+
+	write_statistics(out, "frame", compute_statistics(frame_ms), false);
+	write_statistics(out, "cpu", compute_statistics(cpu_ms), !gpu_timings && !present_timings);
+	if (gpu_timings)
+		write_statistics(out, "gpu", compute_statistics(gpu_ms), !present_timings);
+	if (present_timings)
+		write_statistics(out, "present", compute_statistics(present_ms), true);
+
+	out << "\t}\n"
+		<< "}" << std::endl;
+}
+
+// Every layer goes through one staging buffer, so anything but an exactly sized write exercises the offsets
+static bool check_texture_array(const Aqua::Vulkan::Renderer& renderer, uint32_t layers)
+{
+	const std::vector<std::filesystem::path> layer_paths(layers, Aqua::Application::get_assets_path() / "textures/final_kerr.png");
+	Aqua::Vulkan::Texture texture{ renderer.get_device(), layer_paths };
+
+	if (!texture.is_valid() || texture.get_image().get_array_layers() != layers)
+	{
+		std::cerr << "renderer_bench: failed to upload a " << layers << " layer texture array" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	auto options = parse_options(argc, argv);
+	if (!options.has_value())
+		return 1;
+
+	// Instance extensions are queried from GLFW even without a window
+	Aqua::Window::Startup();
+	Aqua::Renderer::Startup();
+
+	int result = 0;
+	{
+		Aqua::RendererSettings settings{ options->headless, options->width, options->height, true };
+		settings.frames_in_flight = options->frames_in_flight;
+		settings.swap_chain_images = options->swap_chain_images;
+		settings.present_mode = options->present_mode;
+
+		auto queue = std::make_shared<Aqua::EventQueue>();
+		std::unique_ptr<Aqua::Window> window{};
+		std::unique_ptr<Aqua::Renderer> renderer{};
+		if (options->headless)
+		{
+			renderer = std::make_unique<Aqua::Renderer>(settings);
+		}
+		else
+		{
+			window = std::make_unique<Aqua::Window>(options->width, options->height, "renderer_bench", queue);
+			renderer = std::make_unique<Aqua::Renderer>(*window, queue, settings);
+		}
+
+		if (!renderer->is_valid())
+		{
+			std::cerr << "renderer_bench: failed to create the renderer" << std::endl;
+			result = 1;
+		}
+		else if (options->texture_layers > 0 && !check_texture_array(*renderer->handle_, options->texture_layers))
+		{
+			result = 1;
+		}
+		else
+		{
+			renderer->set_scene(options->scene);
+
+			bool running = true;
+			auto run_frame = [&]() {
+				renderer->render();
+				if (window == nullptr)
+					return;
+
+				running = window->update();
+				while (!queue->is_empty() && running)
+				{
+					if (window->handle_events() || renderer->handle_events())
+						continue;
+
+					queue->handle([&running](const Aqua::Event& e) {
+						if (e.get_type() == Aqua::Event::Types::Window_Closed)
+							running = false;
+						return true;
+					});
+				}
+			};
+
+			for (uint32_t i = 0; i < options->warmup && running; ++i)
+				run_frame();
+			renderer->flush_frame_timings();
+
+			// Interval between consecutive frame starts, covers everything the frame loop does
+			std::vector<double> frame_ms{};
+			frame_ms.reserve(options->frames);
+
+			uint32_t frames = 0;
+			auto previous = std::chrono::high_resolution_clock::now();
+			for (; frames < options->frames && running; ++frames)
+			{
+				run_frame();
+				auto now = std::chrono::high_resolution_clock::now();
+				frame_ms.push_back(std::chrono::duration<double, std::milli>(now - previous).count());
+				previous = now;
+			}
+
+			auto timings = renderer->flush_frame_timings();
+
+			if (options->out.empty())
+			{
+				write_report(std::cout, *options, frames, timings, frame_ms, *renderer);
+			}
+			else
+			{
+				std::ofstream file(options->out);
+				if (!file.is_open())
+				{
+					std::cerr << "renderer_bench: could not open " << options->out << std::endl;
+					result = 1;
+				}
+				else
+				{
+					write_report(file, *options, frames, timings, frame_ms, *renderer);
+				}
+			}
+		}
+	}
+
+	Aqua::Renderer::Shutdown();
+	Aqua::Window::Shutdown();
+
+	return result;
+}
@@ -0,0 +1,947 @@
+#include "stm/math.h"
+#include "stm/matrix.h"
+#include "stm/vector2.h"
+#include "stm/vector3.h"
+#include "stm/vector4.h"
+#include "stm/complex.h"
+#include "stm/quaternion.h"
+#include "stm/spatial_transform.h"
+#include "stm/geometry.h"
+#include "stm/intersection.h"
+#include "stm/culling.h"
+#include "stm/bvh.h"
+#include "stm/dmatrix.h"
+#include "stm/transform_hierarchy.h"
+#include "stm/fft.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/*
+	Baseline for the stm math library. Every benchmark works through a batch of random
+	inputs so the compiler cannot fold the operations away, items/s counts single operations.
+
+	Machine readable results for regression tracking:
+		stm_bench --benchmark_out=stm.json --benchmark_out_format=json
+		stm_bench --benchmark_out=stm.csv --benchmark_out_format=csv
+	or build the stm_bench_report target.
+*/
+
+namespace
+{
+	constexpr std::size_t batch_size = 1024;
+
+	std::mt19937& generator()
+	{
+		static std::mt19937 engine{ 42 };
+		return engine;
+	}
+
+	float random_float(float low = -1.0f, float high = 1.0f)
+	{
+		return std::uniform_real_distribution<float>{ low, high }(generator());
+	}
+
+	// Distance from a double precision reference in units of the float spacing at the reference
+	double ulp_error(float approx, double exact)
+	{
+		const float rounded = std::fabs(static_cast<float>(exact));
+		const double ulp = static_cast<double>(std::nextafter(rounded, INFINITY)) - static_cast<double>(rounded);
+		return std::fabs(static_cast<double>(approx) - exact) / ulp;
+	}
+
+	template<std::size_t N>
+	std::vector<stm::vector<float, N>> random_vectors(std::size_t count = batch_size)
+	{
+		std::vector<stm::vector<float, N>> out(count);
+		for (auto& vec : out)
+			for (std::size_t i = 0; i < N; ++i)
+				vec[i] = random_float();
+		return out;
+	}
+
+	template<std::size_t N>
+	std::vector<stm::sqmatrix<float, N>> random_matrices(std::size_t count = batch_size)
+	{
+		std::vector<stm::sqmatrix<float, N>> out(count);
+		for (auto& mat : out)
+			for (std::size_t row = 0; row < N; ++row)
+				for (std::size_t col = 0; col < N; ++col)
+					mat[row][col] = random_float();
+		return out;
+	}
+
+	std::vector<stm::quatf> random_rotations(std::size_t count = batch_size + 1)
+	{
+		std::vector<stm::quatf> out(count);
+		for (auto& rotation : out)
+			rotation = stm::quatf{ random_float(), random_float(), random_float(), random_float() }.unit();
+		return out;
+	}
+
+	void set_items(benchmark::State& state, std::size_t items_per_iteration)
+	{
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items_per_iteration));
+	}
+}
+
+// Vector ops
+
+template<std::size_t N>
+static void BM_VectorAdd(benchmark::State& state)
+{
+	const auto lhs = random_vectors<N>();
+	const auto rhs = random_vectors<N>();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			stm::vector<float, N> result = lhs[i] + rhs[i];
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorAdd<2>);
+BENCHMARK(BM_VectorAdd<3>);
+BENCHMARK(BM_VectorAdd<4>);
+BENCHMARK(BM_VectorAdd<8>);
+
+template<std::size_t N>
+static void BM_VectorDot(benchmark::State& state)
+{
+	const auto lhs = random_vectors<N>();
+	const auto rhs = random_vectors<N>();
+	for (auto _ : state)
+	{
+		float sum = 0.0f;
+		for (std::size_t i = 0; i < batch_size; ++i)
+			sum += lhs[i] * rhs[i];
+		benchmark::DoNotOptimize(sum);
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorDot<2>);
+BENCHMARK(BM_VectorDot<3>);
+BENCHMARK(BM_VectorDot<4>);
+BENCHMARK(BM_VectorDot<8>);
+
+static void BM_Vector3Cross(benchmark::State& state)
+{
+	const auto lhs = random_vectors<3>();
+	const auto rhs = random_vectors<3>();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = stm::cross(lhs[i], rhs[i]);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_Vector3Cross);
+
+template<std::size_t N>
+static void BM_VectorUnit(benchmark::State& state)
+{
+	const auto vectors = random_vectors<N>();
+	for (auto _ : state)
+	{
+		for (const auto& vec : vectors)
+		{
+			auto result = vec.unit();
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorUnit<3>);
+BENCHMARK(BM_VectorUnit<4>);
+
+// Half of the pairs differ only in their last component
+template<std::size_t N>
+static void BM_VectorEquality(benchmark::State& state)
+{
+	const auto lhs = random_vectors<N>();
+	auto rhs = lhs;
+	for (std::size_t i = 0; i < batch_size; i += 2)
+		rhs[i][N - 1] += 1.0f;
+
+	for (auto _ : state)
+	{
+		std::size_t equal = 0;
+		for (std::size_t i = 0; i < batch_size; ++i)
+			equal += lhs[i] == rhs[i] ? 1 : 0;
+		benchmark::DoNotOptimize(equal);
+		if (equal != batch_size / 2)
+			state.SkipWithError("vector operator== ignores components");
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorEquality<2>);
+BENCHMARK(BM_VectorEquality<3>);
+BENCHMARK(BM_VectorEquality<4>);
+BENCHMARK(BM_VectorEquality<8>);
+
+// a + b * s - c on the state vector sizes of the physics code, lazily against one temporary per operation
+template<std::size_t N>
+static void BM_VectorExpression(benchmark::State& state)
+{
+	const auto a = random_vectors<N>(), b = random_vectors<N>(), c = random_vectors<N>();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			stm::vector<float, N> result = a[i] + b[i] * 0.5f - c[i];
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorExpression<16>);
+BENCHMARK(BM_VectorExpression<32>);
+BENCHMARK(BM_VectorExpression<64>);
+
+template<std::size_t N>
+static void BM_VectorExpressionEager(benchmark::State& state)
+{
+	const auto a = random_vectors<N>(), b = random_vectors<N>(), c = random_vectors<N>();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			stm::vector<float, N> scaled = b[i];
+			scaled *= 0.5f;
+			stm::vector<float, N> sum = a[i];
+			sum += scaled;
+			stm::vector<float, N> result = sum;
+			result -= c[i];
+			benchmark::DoNotOptimize(scaled);
+			benchmark::DoNotOptimize(sum);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_VectorExpressionEager<16>);
+BENCHMARK(BM_VectorExpressionEager<32>);
+BENCHMARK(BM_VectorExpressionEager<64>);
+
+// Matrices
+
+template<std::size_t N>
+static void BM_Matmul(benchmark::State& state)
+{
+	const auto lhs = random_matrices<N>(64);
+	const auto rhs = random_matrices<N>(64);
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < lhs.size(); ++i)
+		{
+			auto result = stm::matmul(lhs[i], rhs[i]);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, lhs.size());
+}
+BENCHMARK(BM_Matmul<2>);
+BENCHMARK(BM_Matmul<3>);
+BENCHMARK(BM_Matmul<4>);
+BENCHMARK(BM_Matmul<8>);
+BENCHMARK(BM_Matmul<16>);
+
+template<std::size_t N>
+static void BM_Inverse(benchmark::State& state)
+{
+	const auto matrices = random_matrices<N>();
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::inverse(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_Inverse<2>);
+BENCHMARK(BM_Inverse<3>);
+BENCHMARK(BM_Inverse<4>);
+BENCHMARK(BM_Inverse<8>);
+
+// Pivoting elimination on 4x4, the path inverse() avoids with the closed forms
+static void BM_InverseGaussJordan4(benchmark::State& state)
+{
+	const auto matrices = random_matrices<4>();
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::intern::gauss_jordan_inverse(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_InverseGaussJordan4);
+
+template<std::size_t N>
+static void BM_Determinant(benchmark::State& state)
+{
+	const auto matrices = random_matrices<N>();
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::determinant(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_Determinant<3>);
+BENCHMARK(BM_Determinant<4>);
+
+static void BM_InverseAffine(benchmark::State& state)
+{
+	auto matrices = random_matrices<4>();
+	for (auto& mat : matrices)
+		mat[3][0] = mat[3][1] = mat[3][2] = 0.0f, mat[3][3] = 1.0f;
+
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::inverse_affine(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_InverseAffine);
+
+static void BM_InverseRigid(benchmark::State& state)
+{
+	const auto axes = random_vectors<3>();
+	std::vector<stm::sqmatrix<float, 4>> matrices(batch_size);
+	for (std::size_t i = 0; i < batch_size; ++i)
+		matrices[i] = stm::matmul(stm::translate(axes[i]), stm::rotate(axes[i].unit(), axes[i].x * 3.0f));
+
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::inverse_rigid(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_InverseRigid);
+
+static void BM_NormalMatrix(benchmark::State& state)
+{
+	const auto matrices = random_matrices<4>();
+	for (auto _ : state)
+	{
+		for (const auto& mat : matrices)
+		{
+			auto result = stm::normal_matrix(mat);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_NormalMatrix);
+
+// Dynamic matrices, range(0) square size and range(1) threads, items/s counts multiply-adds
+
+static stm::dmatrixf random_dmatrix(std::size_t rows, std::size_t columns)
+{
+	stm::dmatrixf out(rows, columns);
+	for (std::size_t row = 0; row < rows; ++row)
+		for (std::size_t column = 0; column < columns; ++column)
+			out(row, column) = random_float();
+	return out;
+}
+
+static void BM_Gemm(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const auto threads = static_cast<std::size_t>(state.range(1));
+	const auto a = random_dmatrix(size, size), b = random_dmatrix(size, size);
+	stm::dmatrixf c(size, size);
+	for (auto _ : state)
+	{
+		stm::gemm(1.0f, a.view(), b.view(), 0.0f, c.view(), threads);
+		benchmark::DoNotOptimize(c.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, size * size * size);
+}
+BENCHMARK(BM_Gemm)->Args({ 64, 1 })->Args({ 256, 1 })->Args({ 512, 1 })->Args({ 512, 4 })->UseRealTime();
+
+// The unblocked i-k-j loop of matmul() for fixed size matrices, on the same storage
+static void BM_GemmNaive(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const auto a = random_dmatrix(size, size), b = random_dmatrix(size, size);
+	stm::dmatrixf c(size, size);
+	for (auto _ : state)
+	{
+		c.fill(0.0f);
+		for (std::size_t i = 0; i < size; ++i)
+			for (std::size_t k = 0; k < size; ++k)
+				for (std::size_t j = 0; j < size; ++j)
+					c(i, j) += a(i, k) * b(k, j);
+		benchmark::DoNotOptimize(c.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, size * size * size);
+}
+BENCHMARK(BM_GemmNaive)->Arg(64)->Arg(256)->Arg(512);
+
+// Normal equations of a least-squares fit, A^T A through a transposed view
+static void BM_GemmNormalEquations(benchmark::State& state)
+{
+	const auto a = random_dmatrix(static_cast<std::size_t>(state.range(0)), 32);
+	stm::dmatrixf normal(32, 32);
+	for (auto _ : state)
+	{
+		stm::gemm(1.0f, a.view().transposed(), a.view(), 0.0f, normal.view());
+		benchmark::DoNotOptimize(normal.data());
+	}
+	set_items(state, a.rows() * 32 * 32);
+}
+BENCHMARK(BM_GemmNormalEquations)->Arg(300);
+
+// Transforms
+
+static void BM_ModelMatrix(benchmark::State& state)
+{
+	const auto translations = random_vectors<3>();
+	const auto axes = random_vectors<3>();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto model = stm::matmul(stm::translate(translations[i]),
+									 stm::matmul(stm::rotate(axes[i].unit(), axes[i].x), stm::scale(2.0f, 2.0f, 2.0f)));
+			benchmark::DoNotOptimize(model);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_ModelMatrix);
+
+static void BM_ViewProjection(benchmark::State& state)
+{
+	const auto positions = random_vectors<3>();
+	for (auto _ : state)
+	{
+		for (const auto& position : positions)
+		{
+			auto view = stm::lookAt(position, stm::vec3f{ 0.0f, 0.0f, 0.0f }, stm::vec3f{ 0.0f, 1.0f, 0.0f });
+			auto view_projection = stm::matmul(stm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f), view);
+			benchmark::DoNotOptimize(view_projection);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_ViewProjection);
+
+// Transcendental functions, standard against the fast_math.h approximations
+
+template<stm::precision P>
+static void BM_SinCos(benchmark::State& state)
+{
+	std::vector<float> angles(batch_size);
+	for (auto& angle : angles)
+		angle = random_float(-10.0f, 10.0f);
+	for (auto _ : state)
+	{
+		for (float angle : angles)
+		{
+			auto result = stm::sincos<float, P>(angle);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_SinCos<stm::precision::standard>);
+BENCHMARK(BM_SinCos<stm::precision::fast>);
+
+static void BM_SinCosFloat8(benchmark::State& state)
+{
+	std::vector<float> angles(batch_size);
+	for (auto& angle : angles)
+		angle = random_float(-10.0f, 10.0f);
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; i += stm::simd::float8::width)
+		{
+			auto result = stm::fast::sincos(stm::simd::float8::load(angles.data() + i));
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_SinCosFloat8);
+
+template<stm::precision P>
+static void BM_Atan(benchmark::State& state)
+{
+	std::vector<float> values(batch_size);
+	for (auto& value : values)
+		value = random_float(-4.0f, 4.0f);
+	// Worst input of an exhaustive search over the positive floats
+	values[0] = 0.436321229f;
+
+	double max_ulp = 0.0;
+	for (float value : values)
+		max_ulp = std::max(max_ulp, ulp_error(stm::fast::atan(value), std::atan(static_cast<double>(value))));
+	if (max_ulp > stm::fast::atan_max_ulp)
+		state.SkipWithError("fast atan exceeds its documented error bound");
+
+	for (auto _ : state)
+	{
+		for (float value : values)
+		{
+			auto result = P == stm::precision::fast ? stm::fast::atan(value) : std::atan(value);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+	state.counters["fast_max_ulp"] = max_ulp;
+}
+BENCHMARK(BM_Atan<stm::precision::standard>);
+BENCHMARK(BM_Atan<stm::precision::fast>);
+
+template<stm::precision P>
+static void BM_Atan2(benchmark::State& state)
+{
+	const auto points = random_vectors<2>();
+
+	double max_ulp = 0.0;
+	for (const auto& point : points)
+		max_ulp = std::max(max_ulp, ulp_error(stm::fast::atan2(point.y, point.x),
+			std::atan2(static_cast<double>(point.y), static_cast<double>(point.x))));
+	if (max_ulp > stm::fast::atan2_max_ulp)
+		state.SkipWithError("fast atan2 exceeds its documented error bound");
+
+	for (auto _ : state)
+	{
+		for (const auto& point : points)
+		{
+			auto angle = stm::atan2<float, P>(point.y, point.x);
+			benchmark::DoNotOptimize(angle);
+		}
+	}
+	set_items(state, batch_size);
+	state.counters["fast_max_ulp"] = max_ulp;
+}
+BENCHMARK(BM_Atan2<stm::precision::standard>);
+BENCHMARK(BM_Atan2<stm::precision::fast>);
+
+template<stm::precision P>
+static void BM_Rsqrt(benchmark::State& state)
+{
+	std::vector<float> values(batch_size);
+	for (auto& value : values)
+		value = random_float(0.001f, 1000.0f);
+	for (auto _ : state)
+	{
+		for (float value : values)
+		{
+			auto result = stm::rsqrt<float, P>(value);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_Rsqrt<stm::precision::standard>);
+BENCHMARK(BM_Rsqrt<stm::precision::fast>);
+
+template<stm::precision P>
+static void BM_RotateMatrix(benchmark::State& state)
+{
+	const auto axes = random_vectors<3>();
+	for (auto _ : state)
+	{
+		for (const auto& axis : axes)
+		{
+			auto rotation = stm::rotate<float, P>(axis, axis.x * 10.0f);
+			benchmark::DoNotOptimize(rotation);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_RotateMatrix<stm::precision::standard>);
+BENCHMARK(BM_RotateMatrix<stm::precision::fast>);
+
+// Quaternions and complex numbers
+
+static void BM_QuaternionMultiply(benchmark::State& state)
+{
+	const auto values = random_rotations();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = values[i] * values[i + 1];
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_QuaternionMultiply);
+
+template<stm::precision P>
+static void BM_QuaternionSlerp(benchmark::State& state)
+{
+	const auto values = random_rotations();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = stm::slerp<float, P>(values[i], values[i + 1], 0.3f);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_QuaternionSlerp<stm::precision::standard>);
+BENCHMARK(BM_QuaternionSlerp<stm::precision::fast>);
+
+static void BM_QuaternionNlerp(benchmark::State& state)
+{
+	const auto values = random_rotations();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = stm::nlerp(values[i], values[i + 1], 0.3f);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_QuaternionNlerp);
+
+static void BM_QuaternionToMatrix(benchmark::State& state)
+{
+	const auto values = random_rotations();
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = values[i].to_matrix4();
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_QuaternionToMatrix);
+
+// Transform hierarchy, a random forest where range(0) nodes out of every 1024 move each frame
+
+static void BM_TransformHierarchyUpdate(benchmark::State& state)
+{
+	const std::size_t node_count = 16 * batch_size;
+	const auto moving_per_batch = static_cast<std::size_t>(state.range(0));
+	const auto rotations = random_rotations();
+
+	stm::transform_hierarchy<float> hierarchy;
+	hierarchy.reserve(node_count);
+	for (std::size_t i = 0; i < node_count; ++i)
+	{
+		const auto parent = i < 8 ? hierarchy.no_parent : static_cast<std::uint32_t>(generator()() % i);
+		hierarchy.add(parent, { random_float(), random_float(), random_float() }, rotations[i % batch_size]);
+	}
+	hierarchy.update();
+
+	std::vector<std::uint32_t> moving(node_count / batch_size * moving_per_batch);
+	for (auto& node : moving)
+		node = static_cast<std::uint32_t>(generator()() % node_count);
+
+	float offset = 0.0f;
+	for (auto _ : state)
+	{
+		offset += 0.01f;
+		for (auto node : moving)
+			hierarchy.set_translation(node, { offset, 0.0f, 0.0f });
+		benchmark::DoNotOptimize(hierarchy.update());
+	}
+	set_items(state, node_count);
+}
+BENCHMARK(BM_TransformHierarchyUpdate)->Arg(0)->Arg(1)->Arg(16)->Arg(1024);
+
+static void BM_ComplexMultiply(benchmark::State& state)
+{
+	std::vector<stm::complex<float>> values(batch_size + 1, stm::complex<float>{ 0.0f });
+	for (auto& value : values)
+		value = { random_float(), random_float() };
+
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = values[i] * values[i + 1];
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_ComplexMultiply);
+
+static void BM_ComplexDivide(benchmark::State& state)
+{
+	std::vector<stm::complex<float>> values(batch_size + 1, stm::complex<float>{ 0.0f });
+	for (auto& value : values)
+		value = { random_float(0.5f, 1.0f), random_float(0.5f, 1.0f) };
+
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = values[i] / values[i + 1];
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_ComplexDivide);
+
+// FFT, items/s counts transforms
+static std::vector<stm::complex<float>> random_signal(std::size_t count)
+{
+	std::vector<stm::complex<float>> out(count, stm::complex<float>{ 0.0f });
+	for (auto& value : out)
+		value = { random_float(), random_float() };
+	return out;
+}
+
+static void BM_Fft(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const stm::fft_plan<float> plan{ size };
+	const auto input = random_signal(size);
+	std::vector<stm::complex<float>> output(size, stm::complex<float>{ 0.0f });
+
+	for (auto _ : state)
+	{
+		plan.forward(input, output);
+		benchmark::DoNotOptimize(output.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, 1);
+}
+BENCHMARK(BM_Fft)->Arg(64)->Arg(256)->Arg(1000)->Arg(1024)->Arg(4096);
+
+// O(n^2) reference the plans are measured against
+static void BM_DftNaive(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const auto input = random_signal(size);
+	std::vector<stm::complex<float>> twiddles(size, stm::complex<float>{ 0.0f });
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		const double angle = -2.0 * stm::pi * static_cast<double>(i) / static_cast<double>(size);
+		twiddles[i] = { static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+	}
+	std::vector<stm::complex<float>> output(size, stm::complex<float>{ 0.0f });
+
+	for (auto _ : state)
+	{
+		for (std::size_t k = 0; k < size; ++k)
+		{
+			float re = 0.0f, im = 0.0f;
+			for (std::size_t j = 0; j < size; ++j)
+			{
+				const auto& w = twiddles[(j * k) % size];
+				re += input[j].real() * w.real() - input[j].imag() * w.imag();
+				im += input[j].real() * w.imag() + input[j].imag() * w.real();
+			}
+			output[k] = { re, im };
+		}
+		benchmark::DoNotOptimize(output.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, 1);
+}
+BENCHMARK(BM_DftNaive)->Arg(64)->Arg(256);
+
+static void BM_RealFft(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const stm::real_fft_plan<float> plan{ size };
+	std::vector<float> input(size);
+	for (auto& value : input)
+		value = random_float();
+	std::vector<stm::complex<float>> output(plan.bins(), stm::complex<float>{ 0.0f });
+
+	for (auto _ : state)
+	{
+		plan.forward(input, output);
+		benchmark::DoNotOptimize(output.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, 1);
+}
+BENCHMARK(BM_RealFft)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_Fft2D(benchmark::State& state)
+{
+	const auto size = static_cast<std::size_t>(state.range(0));
+	const stm::fft_plan_2d<float> plan{ size, size };
+	const auto input = random_signal(size * size);
+	std::vector<stm::complex<float>> output(size * size, stm::complex<float>{ 0.0f });
+
+	for (auto _ : state)
+	{
+		plan.forward(input, output);
+		benchmark::DoNotOptimize(output.data());
+		benchmark::ClobberMemory();
+	}
+	set_items(state, 1);
+}
+BENCHMARK(BM_Fft2D)->Arg(64)->Arg(256);
+
+// Intersection
+
+namespace
+{
+	struct intersection_scene
+	{
+		std::vector<stm::ray<float, 3>> rays;
+		std::vector<stm::sphere<float, 3>> spheres;
+		stm::ray_soa<float> ray_batch;
+		stm::sphere_soa<float> sphere_batch;
+
+		intersection_scene(std::size_t ray_count, std::size_t sphere_count)
+		{
+			for (std::size_t i = 0; i < ray_count; ++i)
+			{
+				rays.emplace_back(stm::vec3f{ random_float(-50.0f, 50.0f), random_float(-50.0f, 50.0f), -100.0f },
+								  stm::vec3f{ random_float(-0.2f, 0.2f), random_float(-0.2f, 0.2f), 1.0f });
+				ray_batch.push_back(rays.back());
+			}
+
+			for (std::size_t i = 0; i < sphere_count; ++i)
+			{
+				spheres.emplace_back(random_float(0.5f, 4.0f),
+									 stm::vec3f{ random_float(-50.0f, 50.0f), random_float(-50.0f, 50.0f), random_float(-50.0f, 50.0f) });
+				sphere_batch.push_back(spheres.back());
+			}
+		}
+	};
+}
+
+static void BM_IntersectionRaySphere(benchmark::State& state)
+{
+	const intersection_scene scene{ batch_size, batch_size };
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			auto result = stm::intersection(scene.rays[i], scene.spheres[i]);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	set_items(state, batch_size);
+}
+BENCHMARK(BM_IntersectionRaySphere);
+
+// One ray against range(0) spheres, scalar loop versus the SoA kernel
+static void BM_NearestSphereScalar(benchmark::State& state)
+{
+	const intersection_scene scene{ 64, static_cast<std::size_t>(state.range(0)) };
+	for (auto _ : state)
+	{
+		for (const auto& ray : scene.rays)
+		{
+			auto hit = stm::intersect_nearest<float>(ray, scene.sphere_batch);
+			benchmark::DoNotOptimize(hit);
+		}
+	}
+	set_items(state, scene.rays.size() * scene.spheres.size());
+}
+BENCHMARK(BM_NearestSphereScalar)->RangeMultiplier(8)->Range(8, 4096);
+
+static void BM_NearestSphereBatch(benchmark::State& state)
+{
+	const intersection_scene scene{ 64, static_cast<std::size_t>(state.range(0)) };
+	for (auto _ : state)
+	{
+		for (const auto& ray : scene.rays)
+		{
+			auto hit = stm::intersect_nearest(ray, scene.sphere_batch);
+			benchmark::DoNotOptimize(hit);
+		}
+	}
+	set_items(state, scene.rays.size() * scene.spheres.size());
+}
+BENCHMARK(BM_NearestSphereBatch)->RangeMultiplier(8)->Range(8, 4096);
+
+static void BM_NearestSphereManyToMany(benchmark::State& state)
+{
+	const intersection_scene scene{ static_cast<std::size_t>(state.range(0)), 64 };
+	std::vector<stm::sphere_hit<float>> hits(scene.rays.size());
+	for (auto _ : state)
+	{
+		auto count = stm::intersect_nearest(scene.ray_batch, scene.sphere_batch, std::span{ hits });
+		benchmark::DoNotOptimize(count);
+	}
+	set_items(state, scene.rays.size() * scene.spheres.size());
+}
+BENCHMARK(BM_NearestSphereManyToMany)->RangeMultiplier(16)->Range(256, 65536);
+
+static void BM_BvhNearestSphere(benchmark::State& state)
+{
+	const intersection_scene scene{ 1024, static_cast<std::size_t>(state.range(0)) };
+	const stm::bvh<float, stm::sphere<float, 3>> tree{ std::span<const stm::sphere<float, 3>>{ scene.spheres } };
+	for (auto _ : state)
+	{
+		for (const auto& ray : scene.rays)
+		{
+			auto hit = tree.intersect(ray);
+			benchmark::DoNotOptimize(hit);
+		}
+	}
+	set_items(state, scene.rays.size());
+}
+BENCHMARK(BM_BvhNearestSphere)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_FrustumCullSpheres(benchmark::State& state)
+{
+	const intersection_scene scene{ 0, static_cast<std::size_t>(state.range(0)) };
+
+	// Camera at z = -60 looking at the origin, lookAt takes the camera's up and right axes
+	const stm::vec3f eye{ 0.0f, 0.0f, -60.0f };
+	const auto direction = (stm::vec3f{ 0.0f, 0.0f, 0.0f } - eye).unit();
+	const auto right = stm::cross(direction, stm::vec3f{ 0.0f, 1.0f, 0.0f }).unit();
+	const auto up = stm::cross(right, direction).unit();
+	const stm::frustum<float> view{ stm::matmul(stm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f), stm::lookAt(eye, up, right)) };
+
+	// The spheres fill a cube the camera sees part of, a degenerate view culls all or none of them
+	std::vector<uint32_t> visible(scene.spheres.size());
+	const auto expected = stm::cull(view, scene.sphere_batch, std::span{ visible });
+	const double visible_fraction = static_cast<double>(expected) / static_cast<double>(scene.spheres.size());
+	if (visible_fraction < 0.1 || visible_fraction > 0.9)
+		state.SkipWithError("frustum culls an implausible share of the spheres");
+
+	for (auto _ : state)
+	{
+		auto count = stm::cull(view, scene.sphere_batch, std::span{ visible });
+		benchmark::DoNotOptimize(count);
+	}
+	set_items(state, scene.spheres.size());
+	state.counters["visible_fraction"] = visible_fraction;
+}
+BENCHMARK(BM_FrustumCullSpheres)->RangeMultiplier(8)->Range(64, 32768);
+
+BENCHMARK_MAIN();
@@ -5,6 +5,7 @@
 namespace Aqua
 {
     class ApplicationImpl;
+    class AssetArchive;
     class Renderer;
     class Window;
 
@@ -22,12 +23,16 @@ namespace Aqua
         AQUA_API Renderer& get_renderer();
         AQUA_API const Renderer& get_renderer() const;
 
+        AQUA_API const AssetArchive* get_asset_archive() const;
+
         static std::filesystem::path get_binary_path() { return std::filesystem::absolute("."); }
         static std::filesystem::path get_root_path() { return std::filesystem::absolute(".."); }
         static std::filesystem::path get_assets_path() { return get_root_path() / "assets"; }
+        static std::filesystem::path get_assets_archive_path() { return get_root_path() / "assets.aqpk"; }
         static std::filesystem::path get_runtime_path() { return runtime_path_; }
 
         AQUA_API static Application& get() { return *current_application_; }
+        AQUA_API static Application* get_current() noexcept { return current_application_; }
 
     private:
         std::unique_ptr<ApplicationImpl> impl_;
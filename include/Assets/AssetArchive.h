@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "Utils/MappedFile.h"
+
+#include <span>
+
+namespace Aqua
+{
+    /*
+        Packed asset archive (.aqpk)
+
+        [ArchiveHeader][entry data ...][ArchiveEntry x entry_count][name table]
+
+        Entry data is placed at offsets aligned to the entry's alignment so uncompressed
+        entries can be copied straight from the mapped file into a staging buffer.
+        The table of contents is sorted by name hash for binary search lookups.
+    */
+    enum class AssetCompression : uint32_t
+    {
+        None = 0,
+        LZ4  = 1,
+        Zstd = 2,
+    };
+
+    struct ArchiveHeader
+    {
+        static constexpr uint32_t magic_value = 0x4B505141; // "AQPK"
+        static constexpr uint32_t current_version = 1;
+
+        uint32_t magic = magic_value;
+        uint32_t version = current_version;
+        uint32_t entry_count = 0;
+        uint32_t flags = 0;
+        uint64_t toc_offset = 0;
+        uint64_t names_offset = 0;
+        uint64_t names_size = 0;
+    };
+
+    struct ArchiveEntry
+    {
+        uint64_t name_hash = 0;
+        uint64_t offset = 0;
+        uint64_t stored_size = 0;
+        uint64_t size = 0;
+        uint32_t name_offset = 0;
+        uint32_t name_length = 0;
+        uint32_t alignment = 0;
+        AssetCompression compression = AssetCompression::None;
+    };
+
+    static_assert(sizeof(ArchiveHeader) == 40);
+    static_assert(sizeof(ArchiveEntry) == 48);
+
+    class AssetArchive
+    {
+    public:
+        AssetArchive(const std::filesystem::path& archive_path);
+
+        AssetArchive(const AssetArchive&) = delete;
+        AssetArchive(AssetArchive&&) noexcept = default;
+
+        bool is_valid() const noexcept { return valid_; }
+
+        size_t get_entry_count() const noexcept { return entries_.size(); }
+        std::span<const ArchiveEntry> get_entries() const noexcept { return entries_; }
+
+        const ArchiveEntry* find(std::string_view name) const;
+        std::string_view get_name(const ArchiveEntry& entry) const;
+
+        // Zero-copy view over the mapped file, only available for uncompressed entries
+        std::span<const uint8_t> view(const ArchiveEntry& entry) const;
+
+        // Writes the entry (decompressing if needed) into dst, which must hold entry.size bytes
+        bool read(const ArchiveEntry& entry, std::span<uint8_t> dst) const;
+        std::vector<uint8_t> read(const ArchiveEntry& entry) const;
+
+        static uint64_t hash_name(std::string_view name) noexcept;
+        static std::string normalize_name(std::string_view name);
+
+    private:
+        MappedFile file_;
+        std::span<const ArchiveEntry> entries_;
+        std::span<const char> names_;
+        bool valid_ = false;
+    };
+
+    class AssetArchiveWriter
+    {
+    public:
+        static constexpr uint32_t default_alignment = 256;
+
+        bool add(std::string_view name,
+                 std::span<const uint8_t> data,
+                 AssetCompression compression = AssetCompression::None,
+                 uint32_t alignment = default_alignment);
+
+        bool add_file(const std::filesystem::path& file_path,
+                      std::string_view name,
+                      AssetCompression compression = AssetCompression::None,
+                      uint32_t alignment = default_alignment);
+
+        // Adds every regular file under root, named by its path relative to root
+        bool add_directory(const std::filesystem::path& root,
+                           AssetCompression compression = AssetCompression::None,
+                           uint32_t alignment = default_alignment);
+
+        bool write(const std::filesystem::path& archive_path) const;
+
+    private:
+        struct PendingEntry
+        {
+            std::string name;
+            std::vector<uint8_t> data;
+            uint64_t size;
+            uint32_t alignment;
+            AssetCompression compression;
+        };
+
+        std::vector<PendingEntry> entries_;
+    };
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "Utils/MappedFile.h"
+
+#include "Math/stm/vector2.h"
+#include "Math/stm/vector3.h"
+
+#include <span>
+#include <utility>
+
+namespace Aqua
+{
+    enum class VertexAttribute : uint32_t
+    {
+        Position = 0,
+        Normal   = 1,
+        TexCoord = 2,
+    };
+
+    enum class VertexFormat : uint32_t
+    {
+        Float2    = 0,
+        Float3    = 1,
+        Half2     = 2,  // texture coordinates, ~3 significant digits
+        Snorm16x4 = 3,  // unit normals in xyz, w is zero
+    };
+
+    enum class VertexStreamLayout : uint32_t
+    {
+        Interleaved   = 0,  // one stream holding every attribute
+        Deinterleaved = 1,  // one stream per attribute
+    };
+
+    struct VertexStreamAttribute
+    {
+        VertexAttribute attribute;
+        VertexFormat format;
+        uint32_t offset;
+    };
+
+    struct VertexStreamDescription
+    {
+        static constexpr uint32_t max_attributes = 4;
+
+        uint32_t stride = 0;
+        uint32_t attribute_count = 0;
+        std::array<VertexStreamAttribute, max_attributes> attributes{};
+
+        std::span<const VertexStreamAttribute> get_attributes() const noexcept { return { attributes.data(), attribute_count }; }
+    };
+
+    struct Submesh
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count = 0;
+    };
+
+    // Imported geometry, one array per attribute, indexed triangle lists
+    struct MeshData
+    {
+        std::vector<stm::vec3f> positions;
+        std::vector<stm::vec3f> normals;
+        std::vector<stm::vec2f> text_coords;
+        std::vector<uint32_t> indices;
+        std::vector<Submesh> submeshes;
+
+        uint32_t get_vertex_count() const noexcept { return static_cast<uint32_t>(positions.size()); }
+        uint32_t get_index_count() const noexcept { return static_cast<uint32_t>(indices.size()); }
+
+        void generate_normals();
+    };
+
+    // Non owning view over GPU ready vertex streams
+    struct MeshView
+    {
+        uint32_t vertex_count = 0;
+        std::vector<VertexStreamDescription> streams;
+        std::vector<std::span<const uint8_t>> stream_data;
+        std::span<const uint32_t> indices;
+        std::span<const Submesh> submeshes;
+        stm::vec3f bounds_min;
+        stm::vec3f bounds_max;
+    };
+
+    // GPU ready vertex streams built from MeshData
+    class PackedMesh
+    {
+    public:
+        PackedMesh(const MeshData& mesh, VertexStreamLayout layout);
+
+        MeshView get_view() const;
+
+        VertexStreamLayout get_layout() const noexcept { return layout_; }
+
+    private:
+        VertexStreamLayout layout_;
+        uint32_t vertex_count_ = 0;
+        std::vector<VertexStreamDescription> streams_;
+        std::vector<std::vector<uint8_t>> stream_data_;
+        std::vector<uint32_t> indices_;
+        std::vector<Submesh> submeshes_;
+        stm::vec3f bounds_min_;
+        stm::vec3f bounds_max_;
+
+        friend bool write_mesh_cache(const PackedMesh&, const std::filesystem::path&, const std::filesystem::path&);
+    };
+
+    /*
+        Binary mesh cache (.aqmesh)
+
+        [MeshCacheHeader][VertexStreamDescription x stream_count][MeshCacheStream x stream_count]
+        [Submesh x submesh_count][indices][stream data ...]
+
+        Blocks are 16 byte aligned so the file can be mapped and uploaded without parsing.
+        The source file size and write time are stored to detect stale caches.
+    */
+    struct MeshCacheHeader
+    {
+        static constexpr uint32_t magic_value = 0x534D5141; // "AQMS"
+        static constexpr uint32_t current_version = 4;
+
+        uint32_t magic = magic_value;
+        uint32_t version = current_version;
+        uint64_t source_size = 0;
+        int64_t source_time = 0;
+        uint32_t vertex_count = 0;
+        uint32_t index_count = 0;
+        uint32_t stream_count = 0;
+        uint32_t submesh_count = 0;
+        VertexStreamLayout layout = VertexStreamLayout::Interleaved;
+        float bounds_min[3]{};
+        float bounds_max[3]{};
+        uint64_t descriptions_offset = 0;
+        uint64_t streams_offset = 0;
+        uint64_t submeshes_offset = 0;
+        uint64_t indices_offset = 0;
+    };
+
+    struct MeshCacheStream
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    class MeshCache
+    {
+    public:
+        MeshCache(const std::filesystem::path& cache_path);
+
+        MeshCache(const MeshCache&) = delete;
+        MeshCache(MeshCache&&) noexcept = default;
+
+        bool is_valid() const noexcept { return valid_; }
+        bool is_up_to_date(const std::filesystem::path& source_path) const;
+
+        const MeshCacheHeader& get_header() const noexcept { return header_; }
+        MeshView get_view() const;
+
+    private:
+        MappedFile file_;
+        MeshCacheHeader header_{};
+        bool valid_ = false;
+    };
+
+    std::optional<MeshData> import_obj(const std::filesystem::path& file_path);
+    std::optional<MeshData> import_gltf(const std::filesystem::path& file_path);
+    std::optional<MeshData> import_mesh(const std::filesystem::path& file_path);
+
+    bool write_mesh_cache(const PackedMesh& mesh,
+                          const std::filesystem::path& source_path,
+                          const std::filesystem::path& cache_path);
+
+    std::filesystem::path get_mesh_cache_path(const std::filesystem::path& source_path);
+
+    // Maps the cache for source_path, re-importing, optimizing and rewriting it when missing or stale
+    std::optional<MeshCache> load_mesh(const std::filesystem::path& source_path,
+                                       VertexStreamLayout layout = VertexStreamLayout::Interleaved);
+
+    constexpr uint32_t get_format_size(VertexFormat format) noexcept
+    {
+        switch (format)
+        {
+        case VertexFormat::Float2:    return 2 * sizeof(float);
+        case VertexFormat::Float3:    return 3 * sizeof(float);
+        case VertexFormat::Half2:     return 2 * sizeof(uint16_t);
+        case VertexFormat::Snorm16x4: return 4 * sizeof(int16_t);
+        }
+
+        return 0;
+    }
+
+    // The attributes PackedMesh writes in stream order, the only description of the packed vertex. Positions stay
+    // full floats, normals and texture coordinates are quantized to 24 bytes per vertex, down from 32
+    inline constexpr std::array<std::pair<VertexAttribute, VertexFormat>, 3> packed_vertex_attributes = {{
+        { VertexAttribute::Position, VertexFormat::Float3 },
+        { VertexAttribute::Normal,   VertexFormat::Snorm16x4 },
+        { VertexAttribute::TexCoord, VertexFormat::Half2 },
+    }};
+
+    // The streams PackedMesh writes for layout, the same for every mesh. Renderers build their vertex input from these
+    std::vector<VertexStreamDescription> get_packed_streams(VertexStreamLayout layout);
+}
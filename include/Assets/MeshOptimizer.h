@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "Assets/Mesh.h"
+
+#include <span>
+
+namespace Aqua
+{
+    struct VertexCacheStatistics
+    {
+        uint32_t vertices_transformed = 0;
+        float acmr = 0.0f;  // average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+        float atvr = 0.0f;  // average transform to vertex ratio, transformed vertices per unique vertex (1.0 ideal)
+    };
+
+    // Simulates a FIFO post-transform cache of cache_size entries over a triangle list
+    VertexCacheStatistics analyze_vertex_cache(std::span<const uint32_t> indices,
+                                               uint32_t vertex_count,
+                                               uint32_t cache_size = 16);
+
+    // Reorders triangles for post-transform cache locality (Forsyth's linear speed optimizer)
+    void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count);
+
+    /*
+        Reorders clusters of an already cache optimized triangle list so outward facing
+        clusters are drawn first, reducing overdraw with early depth testing.
+        Clusters are split at hard cache boundaries (triangles missing on all three vertices)
+        and at soft boundaries while the ACMR stays within threshold times the original one,
+        e.g. 1.05 allows the reordered mesh to be up to 5% worse in cache efficiency.
+    */
+    void optimize_overdraw(std::span<uint32_t> indices,
+                           std::span<const stm::vec3f> positions,
+                           float threshold = 1.05f,
+                           uint32_t cache_size = 16);
+
+    // Renumbers vertices in first use order and drops unused ones, returns the new vertex count
+    uint32_t optimize_vertex_fetch(MeshData& mesh);
+
+    // Runs the vertex cache, overdraw and vertex fetch passes on every submesh
+    void optimize_mesh(MeshData& mesh);
+}
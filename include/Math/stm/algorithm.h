@@ -2,10 +2,6 @@
 #define STM_ALGORITHM_H
 
 #include "common.h"
-
-namespace stm
-{
-
-}
+#include "fft.h"
 
 #endif /* STM_ALGORITHM_H */
\ No newline at end of file
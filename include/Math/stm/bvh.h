@@ -0,0 +1,480 @@
+#ifndef STM_BVH_H
+#define STM_BVH_H
+
+#include "common.h"
+#include "geometry.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace stm
+{
+	// Any type with bounds() and hit_distance() overloads found by lookup can be stored in a bvh
+	template<typename P, typename T>
+	concept bvh_primitive = Float<T> && requires(const P& primitive, const ray<T, 3>& ray)
+	{
+		{ bounds(primitive) } -> std::convertible_to<aabb<T, 3>>;
+		{ hit_distance(ray, primitive) } -> std::convertible_to<T>;
+	};
+
+	namespace intern
+	{
+		// Unqualified call so bounds() of user primitives is found through their namespace
+		template<Float T, bvh_primitive<T> Primitive>
+		constexpr aabb<T, 3> primitive_bounds(const Primitive& primitive) noexcept
+		{
+			return bounds(primitive);
+		}
+	}
+
+	// Depth-first flattened node, 32 bytes for float. The first child of an interior node follows it
+	template<Float T>
+	struct bvh_node
+	{
+		T min[3];
+		std::uint32_t offset;	// first primitive for leaves, second child for interior nodes
+		T max[3];
+		std::uint16_t count;	// primitives in the leaf, 0 for interior nodes
+		std::uint16_t axis;		// split axis, the child on the ray's side is visited first
+
+		constexpr bool is_leaf() const noexcept { return count != 0; }
+
+		constexpr aabb<T, 3> bounds() const noexcept
+		{
+			return { { min[0], min[1], min[2] }, { max[0], max[1], max[2] } };
+		}
+
+		constexpr void set_bounds(const aabb<T, 3>& box) noexcept
+		{
+			for (std::size_t i = 0; i < 3; ++i)
+			{
+				min[i] = box.min()[i];
+				max[i] = box.max()[i];
+			}
+		}
+	};
+
+	/*
+		Bounding volume hierarchy built with the binned surface area heuristic.
+		Primitives are copied in traversal order, hits report the index they had in the
+		span passed at construction. refit() updates the bounds of moving primitives
+		without changing the topology, rebuild when they move too far from where they started.
+	*/
+	template<Float T, bvh_primitive<T> Primitive>
+	class bvh
+	{
+	public:
+		using node_type = bvh_node<T>;
+
+		static constexpr std::size_t max_depth = 64;
+		static constexpr std::size_t bin_count = 16;
+
+		bvh() noexcept = default;
+
+		explicit bvh(std::span<const Primitive> primitives, std::size_t max_leaf_size = 4)
+		{
+			assert(primitives.size() <= 0xFFFFFFFFu);
+			if (primitives.empty())
+				return;
+
+			max_leaf_size_ = std::clamp<std::size_t>(max_leaf_size, 1, 0xFFFF);
+
+			references_.resize(primitives.size());
+			indices_.resize(primitives.size());
+			for (std::size_t i = 0; i < primitives.size(); ++i)
+			{
+				references_[i].bounds = intern::primitive_bounds<T>(primitives[i]);
+				references_[i].centroid = references_[i].bounds.center();
+				indices_[i] = static_cast<std::uint32_t>(i);
+			}
+
+			nodes_.reserve(2 * primitives.size() / max_leaf_size_ + 1);
+			build(0, static_cast<std::uint32_t>(primitives.size()), 0);
+			nodes_.shrink_to_fit();
+
+			primitives_.reserve(primitives.size());
+			for (auto index : indices_)
+				primitives_.push_back(primitives[index]);
+
+			references_.clear();
+			references_.shrink_to_fit();
+		}
+
+		constexpr std::size_t size() const noexcept { return primitives_.size(); }
+		constexpr bool empty() const noexcept { return primitives_.empty(); }
+
+		constexpr std::span<const node_type> nodes() const noexcept { return nodes_; }
+		constexpr std::span<const Primitive> primitives() const noexcept { return primitives_; }
+		constexpr std::span<const std::uint32_t> indices() const noexcept { return indices_; }
+
+		constexpr aabb<T, 3> bounds() const noexcept { return nodes_.empty() ? aabb<T, 3>::empty() : nodes_.front().bounds(); }
+
+		// Closest hit with distance below max_distance, in units of the ray direction length
+		ray_hit<T> intersect(const ray<T, 3>& ray, T max_distance = std::numeric_limits<T>::infinity()) const noexcept
+		{
+			ray_hit<T> hit{ max_distance, ray_hit<T>::no_primitive };
+			traverse(ray, hit, [](std::uint32_t) { return false; });
+			return hit;
+		}
+
+		// Any hit below max_distance, stops at the first one found
+		bool occluded(const ray<T, 3>& ray, T max_distance = std::numeric_limits<T>::infinity()) const noexcept
+		{
+			ray_hit<T> hit{ max_distance, ray_hit<T>::no_primitive };
+			return traverse(ray, hit, [](std::uint32_t) { return true; });
+		}
+
+		// Packet traversal, a node is visited while any lane reaches it. Best with coherent rays
+		template<typename Wide>
+		void intersect(std::span<const ray<T, 3>, Wide::width> rays,
+					   std::span<ray_hit<T>, Wide::width> hits,
+					   T max_distance = std::numeric_limits<T>::infinity()) const noexcept
+			requires std::same_as<T, float>
+		{
+			constexpr std::size_t width = Wide::width;
+			constexpr int all_lanes = (1 << width) - 1;
+
+			float origin[3][width];
+			float inverse_direction[3][width];
+			float closest[width];
+			for (std::size_t lane = 0; lane < width; ++lane)
+			{
+				for (std::size_t i = 0; i < 3; ++i)
+				{
+					origin[i][lane] = rays[lane].origin()[i];
+					inverse_direction[i][lane] = 1.0f / rays[lane].direction()[i];
+				}
+				closest[lane] = max_distance;
+				hits[lane] = { max_distance, ray_hit<T>::no_primitive };
+			}
+
+			if (nodes_.empty())
+				return;
+
+			const Wide ox = Wide::load(origin[0]), oy = Wide::load(origin[1]), oz = Wide::load(origin[2]);
+			const Wide ix = Wide::load(inverse_direction[0]), iy = Wide::load(inverse_direction[1]), iz = Wide::load(inverse_direction[2]);
+			Wide wide_closest = Wide::load(closest);
+
+			auto lane_mask = [&](const node_type& node) {
+				const auto x0 = (Wide::broadcast(node.min[0]) - ox) * ix, x1 = (Wide::broadcast(node.max[0]) - ox) * ix;
+				const auto y0 = (Wide::broadcast(node.min[1]) - oy) * iy, y1 = (Wide::broadcast(node.max[1]) - oy) * iy;
+				const auto z0 = (Wide::broadcast(node.min[2]) - oz) * iz, z1 = (Wide::broadcast(node.max[2]) - oz) * iz;
+				const auto entry = max(max(min(x0, x1), min(y0, y1)), max(min(z0, z1), Wide::zero()));
+				const auto exit = min(min(max(x0, x1), max(y0, y1)), min(max(z0, z1), wide_closest));
+				return movemask(entry <= exit) & all_lanes;
+			};
+
+			const bool negative[3] = { inverse_direction[0][0] < 0.0f, inverse_direction[1][0] < 0.0f, inverse_direction[2][0] < 0.0f };
+
+			std::uint32_t stack[max_depth];
+			std::size_t stack_size = 0;
+			std::uint32_t index = 0;
+			while (true)
+			{
+				const auto& node = nodes_[index];
+				const int mask = lane_mask(node);
+				if (mask != 0)
+				{
+					if (!node.is_leaf())
+					{
+						const bool far_first = negative[node.axis];
+						stack[stack_size++] = far_first ? index + 1 : node.offset;
+						index = far_first ? node.offset : index + 1;
+						continue;
+					}
+
+					for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+					{
+						for (auto lanes = static_cast<unsigned int>(mask); lanes != 0; lanes &= lanes - 1)
+						{
+							const auto lane = static_cast<std::size_t>(std::countr_zero(lanes));
+							const T distance = hit_distance(rays[lane], primitives_[i]);
+							if (distance < closest[lane])
+							{
+								closest[lane] = distance;
+								hits[lane] = { distance, indices_[i] };
+							}
+						}
+					}
+					wide_closest = Wide::load(closest);
+				}
+
+				if (stack_size == 0)
+					break;
+				index = stack[--stack_size];
+			}
+		}
+
+		// Batched queries, packets of eight for float and single rays otherwise
+		void intersect(std::span<const ray<T, 3>> rays,
+					   std::span<ray_hit<T>> hits,
+					   T max_distance = std::numeric_limits<T>::infinity()) const noexcept
+		{
+			assert(hits.size() >= rays.size());
+
+			std::size_t i = 0;
+			if constexpr (std::same_as<T, float>)
+			{
+				constexpr std::size_t width = simd::float8::width;
+				for (; i + width <= rays.size(); i += width)
+					intersect<simd::float8>(rays.subspan(i).template first<width>(), hits.subspan(i).template first<width>(), max_distance);
+			}
+
+			for (; i < rays.size(); ++i)
+				hits[i] = intersect(rays[i], max_distance);
+		}
+
+		// Updates the bounds bottom-up, primitives must be in the order the bvh was built from
+		void refit(std::span<const Primitive> primitives) noexcept
+		{
+			assert(primitives.size() == primitives_.size());
+
+			for (std::size_t i = 0; i < primitives_.size(); ++i)
+				primitives_[i] = primitives[indices_[i]];
+
+			// Children always follow their parent, a reverse sweep visits them first
+			for (std::size_t i = nodes_.size(); i-- > 0;)
+			{
+				auto& node = nodes_[i];
+				auto box = aabb<T, 3>::empty();
+				if (node.is_leaf())
+				{
+					for (std::uint32_t j = node.offset; j < node.offset + node.count; ++j)
+						box.expand(intern::primitive_bounds<T>(primitives_[j]));
+				}
+				else
+				{
+					box = merge(nodes_[i + 1].bounds(), nodes_[node.offset].bounds());
+				}
+				node.set_bounds(box);
+			}
+		}
+
+	private:
+		struct reference
+		{
+			aabb<T, 3> bounds;
+			point<T, 3> centroid;
+		};
+
+		struct bin
+		{
+			aabb<T, 3> bounds = aabb<T, 3>::empty();
+			std::uint32_t count = 0;
+		};
+
+		std::uint32_t build(std::uint32_t begin, std::uint32_t end, std::size_t depth)
+		{
+			const auto node_index = static_cast<std::uint32_t>(nodes_.size());
+			nodes_.emplace_back();
+
+			auto box = aabb<T, 3>::empty();
+			auto centroid_box = aabb<T, 3>::empty();
+			for (auto i = begin; i < end; ++i)
+			{
+				box.expand(references_[indices_[i]].bounds);
+				centroid_box.expand(references_[indices_[i]].centroid);
+			}
+			nodes_[node_index].set_bounds(box);
+
+			const std::uint32_t count = end - begin;
+			if (count == 1)
+				return make_leaf(node_index, begin, count);
+
+			// Past half the stack depth only balanced splits are made so traversal cannot overflow
+			std::size_t axis = 0;
+			std::uint32_t middle = begin;
+			if (depth < max_depth / 2)
+			{
+				const auto [split_axis, split_bin, split_cost] = find_split(begin, end, box, centroid_box);
+				const T leaf_cost = static_cast<T>(count);
+				if (split_bin != 0 && (split_cost < leaf_cost || count > max_leaf_size_))
+				{
+					axis = split_axis;
+					const T low = centroid_box.min()[axis];
+					const T scale = T{ bin_count } / (centroid_box.max()[axis] - low);
+					auto* split = std::partition(indices_.data() + begin, indices_.data() + end, [&](std::uint32_t index) {
+						return bin_index(references_[index].centroid[axis], low, scale) < split_bin;
+					});
+					middle = static_cast<std::uint32_t>(split - indices_.data());
+				}
+				else if (count <= max_leaf_size_)
+				{
+					return make_leaf(node_index, begin, count);
+				}
+			}
+
+			// Degenerate centroids or depth limit, split at the object median of the widest axis
+			if (middle == begin || middle == end)
+			{
+				const auto extent = centroid_box.size();
+				axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+				middle = begin + count / 2;
+				std::nth_element(indices_.data() + begin, indices_.data() + middle, indices_.data() + end, [&](std::uint32_t lhs, std::uint32_t rhs) {
+					return references_[lhs].centroid[axis] < references_[rhs].centroid[axis];
+				});
+			}
+
+			nodes_[node_index].axis = static_cast<std::uint16_t>(axis);
+			build(begin, middle, depth + 1);
+			const auto second_child = build(middle, end, depth + 1);
+			nodes_[node_index].offset = second_child;
+			return node_index;
+		}
+
+		std::uint32_t make_leaf(std::uint32_t node_index, std::uint32_t begin, std::uint32_t count) noexcept
+		{
+			nodes_[node_index].offset = begin;
+			nodes_[node_index].count = static_cast<std::uint16_t>(count);
+			return node_index;
+		}
+
+		static std::size_t bin_index(T centroid, T low, T scale) noexcept
+		{
+			const auto index = static_cast<std::size_t>((centroid - low) * scale);
+			return index < bin_count ? index : bin_count - 1;
+		}
+
+		// Returns the axis, the first bin of the right side (0 if no split exists) and the SAH cost
+		std::tuple<std::size_t, std::size_t, T> find_split(std::uint32_t begin, std::uint32_t end,
+														   const aabb<T, 3>& box, const aabb<T, 3>& centroid_box) const noexcept
+		{
+			constexpr T traversal_cost = T{ 1 };
+			const T inverse_area = T{ 1 } / std::max(box.surface_area(), std::numeric_limits<T>::min());
+
+			std::size_t best_axis = 0;
+			std::size_t best_bin = 0;
+			T best_cost = std::numeric_limits<T>::infinity();
+
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				const T low = centroid_box.min()[axis];
+				const T extent = centroid_box.max()[axis] - low;
+				if (!(extent > T{ 0 }))
+					continue;
+
+				bin bins[bin_count];
+				const T scale = T{ bin_count } / extent;
+				for (auto i = begin; i < end; ++i)
+				{
+					const auto& ref = references_[indices_[i]];
+					auto& target = bins[bin_index(ref.centroid[axis], low, scale)];
+					target.bounds.expand(ref.bounds);
+					++target.count;
+				}
+
+				// Right to left sweep stores the right side cost of every split plane
+				T right_cost[bin_count]{};
+				auto right_box = aabb<T, 3>::empty();
+				std::uint32_t right_count = 0;
+				for (std::size_t i = bin_count - 1; i > 0; --i)
+				{
+					right_box.expand(bins[i].bounds);
+					right_count += bins[i].count;
+					right_cost[i] = right_count != 0 ? right_box.surface_area() * static_cast<T>(right_count) : T{ 0 };
+				}
+
+				auto left_box = aabb<T, 3>::empty();
+				std::uint32_t left_count = 0;
+				for (std::size_t i = 1; i < bin_count; ++i)
+				{
+					left_box.expand(bins[i - 1].bounds);
+					left_count += bins[i - 1].count;
+					if (left_count == 0 || left_count == end - begin)
+						continue;
+
+					const T cost = traversal_cost + (left_box.surface_area() * static_cast<T>(left_count) + right_cost[i]) * inverse_area;
+					if (cost < best_cost)
+					{
+						best_axis = axis;
+						best_bin = i;
+						best_cost = cost;
+					}
+				}
+			}
+
+			return { best_axis, best_bin, best_cost };
+		}
+
+		template<typename AnyHit>
+		bool traverse(const ray<T, 3>& ray, ray_hit<T>& hit, AnyHit any_hit) const noexcept
+		{
+			if (nodes_.empty())
+				return false;
+
+			T origin[3];
+			T inverse_direction[3];
+			for (std::size_t i = 0; i < 3; ++i)
+			{
+				origin[i] = ray.origin()[i];
+				inverse_direction[i] = T{ 1 } / ray.direction()[i];
+			}
+
+			auto reaches = [&](const node_type& node) {
+				T entry = T{ 0 };
+				T exit = hit.distance;
+				for (std::size_t i = 0; i < 3; ++i)
+				{
+					T t0 = (node.min[i] - origin[i]) * inverse_direction[i];
+					T t1 = (node.max[i] - origin[i]) * inverse_direction[i];
+					if (t0 > t1)
+						std::swap(t0, t1);
+					// Written so NaN from 0 * inf leaves the range unchanged
+					entry = t0 > entry ? t0 : entry;
+					exit = t1 < exit ? t1 : exit;
+				}
+				return entry <= exit;
+			};
+
+			std::uint32_t stack[max_depth];
+			std::size_t stack_size = 0;
+			std::uint32_t index = 0;
+			bool found = false;
+			while (true)
+			{
+				const auto& node = nodes_[index];
+				if (reaches(node))
+				{
+					if (!node.is_leaf())
+					{
+						const bool far_first = inverse_direction[node.axis] < T{ 0 };
+						stack[stack_size++] = far_first ? index + 1 : node.offset;
+						index = far_first ? node.offset : index + 1;
+						continue;
+					}
+
+					for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+					{
+						const T distance = hit_distance(ray, primitives_[i]);
+						if (distance < hit.distance)
+						{
+							hit = { distance, indices_[i] };
+							found = true;
+							if (any_hit(i))
+								return true;
+						}
+					}
+				}
+
+				if (stack_size == 0)
+					break;
+				index = stack[--stack_size];
+			}
+			return found;
+		}
+
+		std::vector<node_type> nodes_;
+		std::vector<Primitive> primitives_;
+		std::vector<std::uint32_t> indices_;
+		std::vector<reference> references_;
+		std::size_t max_leaf_size_ = 4;
+	};
+}
+
+#endif /* STM_BVH_H */
@@ -188,7 +188,7 @@ namespace stm
 
 		using value_type = T;
 
-		friend std::ostream& operator<<<T>(std::ostream& stream, const stm::complex<T>& value);
+		// friend std::ostream& operator<<<T>(std::ostream& stream, const stm::complex<T>& value);
 
 	private:
 		T r, i;
@@ -0,0 +1,160 @@
+#ifndef STM_CULLING_H
+#define STM_CULLING_H
+
+#include "common.h"
+#include "geometry.h"
+#include "geometry_soa.h"
+#include "simd.h"
+
+#include <bit>
+#include <span>
+
+namespace stm
+{
+	/*
+		Frustum culling of a batch of bounds, writes the indices of the visible ones to
+		visible in ascending order and returns their count. visible must hold size() entries.
+		Same conservative test as frustum::intersects.
+	*/
+	template<Float T>
+	constexpr std::size_t cull(const frustum<T>& view, const aabb_soa<T>& boxes, std::span<std::uint32_t> visible) noexcept
+	{
+		assert(visible.size() >= boxes.size());
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < boxes.size(); ++i)
+		{
+			visible[count] = static_cast<std::uint32_t>(i);
+			count += view.intersects(boxes[i]) ? 1 : 0;
+		}
+		return count;
+	}
+
+	template<Float T>
+	constexpr std::size_t cull(const frustum<T>& view, const sphere_soa<T>& spheres, std::span<std::uint32_t> visible) noexcept
+	{
+		assert(visible.size() >= spheres.size());
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < spheres.size(); ++i)
+		{
+			visible[count] = static_cast<std::uint32_t>(i);
+			count += view.intersects(spheres[i]) ? 1 : 0;
+		}
+		return count;
+	}
+
+	namespace intern
+	{
+		template<typename Wide>
+		struct wide_plane
+		{
+			Wide nx, ny, nz;
+			Wide abs_nx, abs_ny, abs_nz;
+			Wide distance;
+		};
+
+		template<typename Wide>
+		inline std::array<wide_plane<Wide>, frustum<float>::plane_count> broadcast_planes(const frustum<float>& view) noexcept
+		{
+			std::array<wide_plane<Wide>, frustum<float>::plane_count> out;
+			for (std::size_t i = 0; i < out.size(); ++i)
+			{
+				const auto& n = view[i].normal();
+				out[i] = { Wide::broadcast(n.x), Wide::broadcast(n.y), Wide::broadcast(n.z),
+						   Wide::broadcast(stm::abs(n.x)), Wide::broadcast(stm::abs(n.y)), Wide::broadcast(stm::abs(n.z)),
+						   Wide::broadcast(view[i].distance()) };
+			}
+			return out;
+		}
+
+		// Appends the set lanes of mask as indices starting at base
+		inline std::size_t compact(int mask, std::uint32_t base, std::uint32_t* out) noexcept
+		{
+			std::size_t count = 0;
+			for (auto bits = static_cast<unsigned int>(mask); bits != 0; bits &= bits - 1)
+				out[count++] = base + static_cast<std::uint32_t>(std::countr_zero(bits));
+			return count;
+		}
+	}
+
+	// SIMD paths, eight bounds per iteration with a scalar tail
+	inline std::size_t cull(const frustum<float>& view, const aabb_soa<float>& boxes, std::span<std::uint32_t> visible) noexcept
+	{
+		using wide = simd::float8;
+		assert(visible.size() >= boxes.size());
+
+		const auto planes = intern::broadcast_planes<wide>(view);
+		const float* cx = boxes.center_x().data();
+		const float* cy = boxes.center_y().data();
+		const float* cz = boxes.center_z().data();
+		const float* ex = boxes.extent_x().data();
+		const float* ey = boxes.extent_y().data();
+		const float* ez = boxes.extent_z().data();
+
+		std::size_t count = 0;
+		std::size_t i = 0;
+		for (; i + wide::width <= boxes.size(); i += wide::width)
+		{
+			const auto x = wide::load(cx + i), y = wide::load(cy + i), z = wide::load(cz + i);
+			const auto rx = wide::load(ex + i), ry = wide::load(ey + i), rz = wide::load(ez + i);
+
+			auto outside = wide::zero();
+			for (const auto& p : planes)
+			{
+				const auto distance = fmadd(p.nx, x, fmadd(p.ny, y, fmadd(p.nz, z, p.distance)));
+				const auto radius = fmadd(p.abs_nx, rx, fmadd(p.abs_ny, ry, p.abs_nz * rz));
+				outside = outside | (distance < -radius);
+			}
+
+			const int inside = ~movemask(outside) & ((1 << wide::width) - 1);
+			count += intern::compact(inside, static_cast<std::uint32_t>(i), visible.data() + count);
+		}
+
+		for (; i < boxes.size(); ++i)
+		{
+			visible[count] = static_cast<std::uint32_t>(i);
+			count += view.intersects(boxes[i]) ? 1 : 0;
+		}
+		return count;
+	}
+
+	inline std::size_t cull(const frustum<float>& view, const sphere_soa<float>& spheres, std::span<std::uint32_t> visible) noexcept
+	{
+		using wide = simd::float8;
+		assert(visible.size() >= spheres.size());
+
+		const auto planes = intern::broadcast_planes<wide>(view);
+		const float* ox = spheres.origin_x().data();
+		const float* oy = spheres.origin_y().data();
+		const float* oz = spheres.origin_z().data();
+		const float* radii = spheres.radius().data();
+
+		std::size_t count = 0;
+		std::size_t i = 0;
+		for (; i + wide::width <= spheres.size(); i += wide::width)
+		{
+			const auto x = wide::load(ox + i), y = wide::load(oy + i), z = wide::load(oz + i);
+			const auto negative_radius = -wide::load(radii + i);
+
+			auto outside = wide::zero();
+			for (const auto& p : planes)
+			{
+				const auto distance = fmadd(p.nx, x, fmadd(p.ny, y, fmadd(p.nz, z, p.distance)));
+				outside = outside | (distance < negative_radius);
+			}
+
+			const int inside = ~movemask(outside) & ((1 << wide::width) - 1);
+			count += intern::compact(inside, static_cast<std::uint32_t>(i), visible.data() + count);
+		}
+
+		for (; i < spheres.size(); ++i)
+		{
+			visible[count] = static_cast<std::uint32_t>(i);
+			count += view.intersects(spheres[i]) ? 1 : 0;
+		}
+		return count;
+	}
+}
+
+#endif /* STM_CULLING_H */
@@ -0,0 +1,472 @@
+#ifndef STM_DMATRIX_H
+#define STM_DMATRIX_H
+
+#include "common.h"
+#include "matrix.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+	Heap allocated matrices with sizes chosen at runtime, row-major with every row starting on a
+	64 byte boundary. dmatrix_view wraps existing memory with arbitrary row and column strides,
+	so blocks and transposes are views rather than copies.
+
+	gemm() computes C = alpha * A * B + beta * C by packing cache sized blocks of A and B into
+	contiguous panels and running a register blocked micro kernel over them (float8 for float,
+	plain loops the compiler can vectorize for other types). Rows of C can be split across threads.
+*/
+namespace stm
+{
+	namespace intern
+	{
+		inline constexpr std::size_t dmatrix_alignment = 64;
+
+		template<typename T, std::size_t Alignment>
+		struct aligned_allocator
+		{
+			using value_type = T;
+
+			template<typename U>
+			struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+			aligned_allocator() noexcept = default;
+
+			template<typename U>
+			aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+			T* allocate(std::size_t count)
+			{
+				return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+			}
+
+			void deallocate(T* pointer, std::size_t) noexcept
+			{
+				::operator delete(pointer, std::align_val_t{ Alignment });
+			}
+
+			template<typename U>
+			friend bool operator==(const aligned_allocator&, const aligned_allocator<U, Alignment>&) noexcept { return true; }
+		};
+
+		template<typename T>
+		using aligned_vector = std::vector<T, aligned_allocator<T, dmatrix_alignment>>;
+
+		inline void dimension_mismatch_except(std::size_t lhs, std::size_t rhs)
+		{
+			throw std::invalid_argument{ "Matrix dimensions [" + std::to_string(lhs) + "] and [" +
+				std::to_string(rhs) + "] do not match" };
+		}
+	}
+
+	// Non owning matrix over strided memory, T may be const
+	template<typename T>
+	class dmatrix_view
+	{
+	public:
+		using value_type = std::remove_const_t<T>;
+
+		constexpr dmatrix_view() noexcept = default;
+
+		constexpr dmatrix_view(T* data, std::size_t rows, std::size_t columns) noexcept
+			: data_{ data }, rows_{ rows }, columns_{ columns }, row_stride_{ static_cast<std::ptrdiff_t>(columns) } {}
+
+		constexpr dmatrix_view(T* data, std::size_t rows, std::size_t columns,
+							   std::ptrdiff_t row_stride, std::ptrdiff_t column_stride = 1) noexcept
+			: data_{ data }, rows_{ rows }, columns_{ columns }, row_stride_{ row_stride }, column_stride_{ column_stride } {}
+
+		constexpr operator dmatrix_view<const T>() const noexcept requires (!std::is_const_v<T>)
+		{
+			return { data_, rows_, columns_, row_stride_, column_stride_ };
+		}
+
+		constexpr T* data() const noexcept { return data_; }
+		constexpr std::size_t rows() const noexcept { return rows_; }
+		constexpr std::size_t columns() const noexcept { return columns_; }
+		constexpr std::ptrdiff_t row_stride() const noexcept { return row_stride_; }
+		constexpr std::ptrdiff_t column_stride() const noexcept { return column_stride_; }
+
+		constexpr T& operator()(std::size_t row, std::size_t column) const noexcept
+		{
+			assert(row < rows_ && column < columns_);
+			return data_[static_cast<std::ptrdiff_t>(row) * row_stride_ + static_cast<std::ptrdiff_t>(column) * column_stride_];
+		}
+
+		constexpr dmatrix_view block(std::size_t row, std::size_t column, std::size_t rows, std::size_t columns) const noexcept
+		{
+			assert(row + rows <= rows_ && column + columns <= columns_);
+			return { &(*this)(row, column), rows, columns, row_stride_, column_stride_ };
+		}
+
+		constexpr dmatrix_view transposed() const noexcept
+		{
+			return { data_, columns_, rows_, column_stride_, row_stride_ };
+		}
+
+	private:
+		T* data_ = nullptr;
+		std::size_t rows_ = 0;
+		std::size_t columns_ = 0;
+		std::ptrdiff_t row_stride_ = 0;
+		std::ptrdiff_t column_stride_ = 1;
+	};
+
+	template<Real T>
+	class dmatrix
+	{
+	public:
+		using value_type = T;
+		using underlying_num_type = underlying_num_t<T>;
+
+		dmatrix() = default;
+		dmatrix(const dmatrix&) = default;
+		dmatrix(dmatrix&&) noexcept = default;
+		dmatrix& operator=(const dmatrix&) = default;
+		dmatrix& operator=(dmatrix&&) noexcept = default;
+		~dmatrix() = default;
+
+		dmatrix(std::size_t rows, std::size_t columns, const T& value = T{})
+			: rows_{ rows }, columns_{ columns }, stride_{ padded_stride(columns) }, data_(rows * stride_, value) {}
+
+		explicit dmatrix(dmatrix_view<const T> view)
+			: dmatrix(view.rows(), view.columns())
+		{
+			for (std::size_t row = 0; row < rows_; ++row)
+				for (std::size_t column = 0; column < columns_; ++column)
+					(*this)(row, column) = view(row, column);
+		}
+
+		template<std::size_t Rows, std::size_t Columns>
+		explicit dmatrix(const matrix<T, Rows, Columns>& mat)
+			: dmatrix(Rows, Columns)
+		{
+			for (std::size_t row = 0; row < Rows; ++row)
+				std::copy(mat[row], mat[row] + Columns, (*this)[row]);
+		}
+
+		static dmatrix identity(std::size_t size)
+		{
+			dmatrix out(size, size);
+			for (std::size_t i = 0; i < size; ++i)
+				out(i, i) = T{1};
+			return out;
+		}
+
+		std::size_t rows() const noexcept { return rows_; }
+		std::size_t columns() const noexcept { return columns_; }
+		std::size_t size() const noexcept { return rows_ * columns_; }
+		// Distance in elements between the starts of two rows, the padding holds zeros
+		std::size_t stride() const noexcept { return stride_; }
+
+		T* data() noexcept { return data_.data(); }
+		const T* data() const noexcept { return data_.data(); }
+
+		T* operator[](std::size_t row) noexcept { assert(row < rows_); return data_.data() + row * stride_; }
+		const T* operator[](std::size_t row) const noexcept { assert(row < rows_); return data_.data() + row * stride_; }
+
+		T& operator()(std::size_t row, std::size_t column) noexcept { assert(column < columns_); return (*this)[row][column]; }
+		const T& operator()(std::size_t row, std::size_t column) const noexcept { assert(column < columns_); return (*this)[row][column]; }
+
+		T& at(std::size_t row, std::size_t column)
+		{
+			if (row >= rows_) intern::out_of_bounds_except(row, rows_);
+			if (column >= columns_) intern::out_of_bounds_except(column, columns_);
+			return (*this)(row, column);
+		}
+
+		const T& at(std::size_t row, std::size_t column) const
+		{
+			if (row >= rows_) intern::out_of_bounds_except(row, rows_);
+			if (column >= columns_) intern::out_of_bounds_except(column, columns_);
+			return (*this)(row, column);
+		}
+
+		dmatrix_view<T> view() noexcept { return { data(), rows_, columns_, static_cast<std::ptrdiff_t>(stride_) }; }
+		dmatrix_view<const T> view() const noexcept { return { data(), rows_, columns_, static_cast<std::ptrdiff_t>(stride_) }; }
+
+		dmatrix_view<T> block(std::size_t row, std::size_t column, std::size_t rows, std::size_t columns) noexcept
+		{
+			return view().block(row, column, rows, columns);
+		}
+
+		dmatrix_view<const T> block(std::size_t row, std::size_t column, std::size_t rows, std::size_t columns) const noexcept
+		{
+			return view().block(row, column, rows, columns);
+		}
+
+		dmatrix transpose() const
+		{
+			return dmatrix{ view().transposed() };
+		}
+
+		void fill(const T& value) noexcept
+		{
+			for (std::size_t row = 0; row < rows_; ++row)
+				std::fill((*this)[row], (*this)[row] + columns_, value);
+		}
+
+		dmatrix& operator+=(const dmatrix& rhs)
+		{
+			check_same_shape(rhs);
+			for (std::size_t i = 0; i < data_.size(); ++i)
+				data_[i] += rhs.data_[i];
+			return *this;
+		}
+
+		dmatrix& operator-=(const dmatrix& rhs)
+		{
+			check_same_shape(rhs);
+			for (std::size_t i = 0; i < data_.size(); ++i)
+				data_[i] -= rhs.data_[i];
+			return *this;
+		}
+
+		dmatrix& operator*=(const T& rhs) noexcept
+		{
+			for (auto& value : data_)
+				value *= rhs;
+			return *this;
+		}
+
+		dmatrix& operator/=(const T& rhs) noexcept(Float<underlying_num_type>)
+		{
+			if constexpr (Integer<T>)
+				if (rhs == static_cast<T>(0)) intern::int_zero_division_except();
+			for (auto& value : data_)
+				value /= rhs;
+			return *this;
+		}
+
+		friend dmatrix operator+(dmatrix lhs, const dmatrix& rhs) { return lhs += rhs; }
+		friend dmatrix operator-(dmatrix lhs, const dmatrix& rhs) { return lhs -= rhs; }
+		friend dmatrix operator*(dmatrix lhs, const T& rhs) { return lhs *= rhs; }
+		friend dmatrix operator*(const T& lhs, dmatrix rhs) { return rhs *= lhs; }
+		friend dmatrix operator/(dmatrix lhs, const T& rhs) { return lhs /= rhs; }
+
+		friend bool operator==(const dmatrix& lhs, const dmatrix& rhs) noexcept
+		{
+			return lhs.rows_ == rhs.rows_ && lhs.columns_ == rhs.columns_ && lhs.data_ == rhs.data_;
+		}
+
+	private:
+		static std::size_t padded_stride(std::size_t columns) noexcept
+		{
+			constexpr std::size_t lane = std::max<std::size_t>(1, intern::dmatrix_alignment / sizeof(T));
+			return (columns + lane - 1) / lane * lane;
+		}
+
+		void check_same_shape(const dmatrix& rhs) const
+		{
+			if (rows_ != rhs.rows_) intern::dimension_mismatch_except(rows_, rhs.rows_);
+			if (columns_ != rhs.columns_) intern::dimension_mismatch_except(columns_, rhs.columns_);
+		}
+
+		std::size_t rows_ = 0;
+		std::size_t columns_ = 0;
+		std::size_t stride_ = 0;
+		intern::aligned_vector<T> data_{};
+	};
+
+	namespace intern
+	{
+		// Micro tile of C held in registers and the cache blocks around it, sized for 32 KiB L1 and 256 KiB+ L2
+		template<typename T>
+		struct gemm_blocking
+		{
+			static constexpr std::size_t mr = 6;
+			static constexpr std::size_t nr = 16;
+			static constexpr std::size_t kc = 256;
+			static constexpr std::size_t mc = 96;
+			static constexpr std::size_t nc = 2048;
+		};
+
+		// rows x depth block of A as mr row panels, each stored column after column, zero padded
+		template<typename T>
+		void pack_a(dmatrix_view<const T> a, T* out) noexcept
+		{
+			constexpr std::size_t mr = gemm_blocking<T>::mr;
+			for (std::size_t panel = 0; panel < a.rows(); panel += mr)
+			{
+				const std::size_t height = std::min(mr, a.rows() - panel);
+				for (std::size_t k = 0; k < a.columns(); ++k)
+				{
+					for (std::size_t r = 0; r < height; ++r)
+						out[r] = a(panel + r, k);
+					for (std::size_t r = height; r < mr; ++r)
+						out[r] = T{};
+					out += mr;
+				}
+			}
+		}
+
+		// depth x columns block of B as nr column panels, each stored row after row, zero padded
+		template<typename T>
+		void pack_b(dmatrix_view<const T> b, T* out) noexcept
+		{
+			constexpr std::size_t nr = gemm_blocking<T>::nr;
+			for (std::size_t panel = 0; panel < b.columns(); panel += nr)
+			{
+				const std::size_t width = std::min(nr, b.columns() - panel);
+				for (std::size_t k = 0; k < b.rows(); ++k)
+				{
+					if (b.column_stride() == 1 && width == nr)
+					{
+						const T* row = &b(k, panel);
+						std::copy(row, row + nr, out);
+					}
+					else
+					{
+						for (std::size_t c = 0; c < width; ++c)
+							out[c] = b(k, panel + c);
+						for (std::size_t c = width; c < nr; ++c)
+							out[c] = T{};
+					}
+					out += nr;
+				}
+			}
+		}
+
+		// tile (mr x nr) = packed A panel * packed B panel over depth
+		template<typename T>
+		void gemm_micro_kernel(std::size_t depth, const T* a, const T* b, T* tile) noexcept
+		{
+			constexpr std::size_t mr = gemm_blocking<T>::mr;
+			constexpr std::size_t nr = gemm_blocking<T>::nr;
+
+			if constexpr (std::is_same_v<T, float>)
+			{
+				using simd::float8;
+				float8 accumulators[mr][2];
+				for (std::size_t r = 0; r < mr; ++r)
+					accumulators[r][0] = accumulators[r][1] = float8::zero();
+
+				for (std::size_t k = 0; k < depth; ++k, a += mr, b += nr)
+				{
+					const float8 b0 = float8::load(b);
+					const float8 b1 = float8::load(b + 8);
+					for (std::size_t r = 0; r < mr; ++r)
+					{
+						const float8 broadcast = float8::broadcast(a[r]);
+						accumulators[r][0] = fmadd(broadcast, b0, accumulators[r][0]);
+						accumulators[r][1] = fmadd(broadcast, b1, accumulators[r][1]);
+					}
+				}
+
+				for (std::size_t r = 0; r < mr; ++r)
+				{
+					accumulators[r][0].store(tile + r * nr);
+					accumulators[r][1].store(tile + r * nr + 8);
+				}
+			}
+			else
+			{
+				T accumulators[mr][nr]{};
+				for (std::size_t k = 0; k < depth; ++k, a += mr, b += nr)
+					for (std::size_t r = 0; r < mr; ++r)
+						for (std::size_t c = 0; c < nr; ++c)
+							accumulators[r][c] += a[r] * b[c];
+
+				for (std::size_t r = 0; r < mr; ++r)
+					for (std::size_t c = 0; c < nr; ++c)
+						tile[r * nr + c] = accumulators[r][c];
+			}
+		}
+
+		// C += alpha * A * B on one thread, C was already scaled by beta
+		template<typename T>
+		void gemm_blocked(const T& alpha, dmatrix_view<const T> a, dmatrix_view<const T> b, dmatrix_view<T> c)
+		{
+			using blocking = gemm_blocking<T>;
+			constexpr std::size_t mr = blocking::mr, nr = blocking::nr;
+
+			thread_local aligned_vector<T> packed_a, packed_b;
+			packed_a.resize(blocking::mc * blocking::kc);
+			packed_b.resize(blocking::kc * ((blocking::nc + nr - 1) / nr * nr));
+			alignas(dmatrix_alignment) T tile[mr * nr];
+
+			for (std::size_t jc = 0; jc < c.columns(); jc += blocking::nc)
+			{
+				const std::size_t nc = std::min(blocking::nc, c.columns() - jc);
+				for (std::size_t pc = 0; pc < a.columns(); pc += blocking::kc)
+				{
+					const std::size_t kc = std::min(blocking::kc, a.columns() - pc);
+					pack_b(b.block(pc, jc, kc, nc), packed_b.data());
+
+					for (std::size_t ic = 0; ic < c.rows(); ic += blocking::mc)
+					{
+						const std::size_t mc = std::min(blocking::mc, c.rows() - ic);
+						pack_a(a.block(ic, pc, mc, kc), packed_a.data());
+
+						for (std::size_t jr = 0; jr < nc; jr += nr)
+						{
+							const std::size_t width = std::min(nr, nc - jr);
+							for (std::size_t ir = 0; ir < mc; ir += mr)
+							{
+								const std::size_t height = std::min(mr, mc - ir);
+								gemm_micro_kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc, tile);
+
+								for (std::size_t r = 0; r < height; ++r)
+									for (std::size_t col = 0; col < width; ++col)
+										c(ic + ir + r, jc + jr + col) += alpha * tile[r * nr + col];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// C = alpha * A * B + beta * C, threads > 1 splits the rows of C between that many threads
+	template<Real T>
+	void gemm(const T& alpha, dmatrix_view<const std::type_identity_t<T>> a, dmatrix_view<const std::type_identity_t<T>> b,
+			  const T& beta, dmatrix_view<T> c, std::size_t threads = 1)
+	{
+		assert(a.columns() == b.rows() && a.rows() == c.rows() && b.columns() == c.columns());
+
+		for (std::size_t row = 0; row < c.rows(); ++row)
+			for (std::size_t column = 0; column < c.columns(); ++column)
+				c(row, column) = beta == T{} ? T{} : c(row, column) * beta;
+
+		if (a.columns() == 0 || alpha == T{})
+			return;
+
+		// Fewer than one register tile of rows per thread only adds overhead
+		threads = std::min(threads, std::max<std::size_t>(1, c.rows() / intern::gemm_blocking<T>::mr));
+		if (threads <= 1)
+		{
+			intern::gemm_blocked(alpha, a, b, c);
+			return;
+		}
+
+		const std::size_t chunk = (c.rows() + threads - 1) / threads;
+		std::vector<std::jthread> workers;
+		workers.reserve(threads - 1);
+		for (std::size_t begin = chunk; begin < c.rows(); begin += chunk)
+		{
+			const std::size_t rows = std::min(chunk, c.rows() - begin);
+			workers.emplace_back([=]() {
+				intern::gemm_blocked(alpha, a.block(begin, 0, rows, a.columns()), b, c.block(begin, 0, rows, c.columns()));
+			});
+		}
+		intern::gemm_blocked(alpha, a.block(0, 0, chunk, a.columns()), b, c.block(0, 0, chunk, c.columns()));
+	}
+
+	template<Real T>
+	dmatrix<T> matmul(const dmatrix<T>& lhs, const dmatrix<T>& rhs, std::size_t threads = 1)
+	{
+		if (lhs.columns() != rhs.rows()) intern::dimension_mismatch_except(lhs.columns(), rhs.rows());
+
+		dmatrix<T> out(lhs.rows(), rhs.columns());
+		gemm(T{1}, lhs.view(), rhs.view(), T{}, out.view(), threads);
+		return out;
+	}
+
+	using dmatrixf = dmatrix<float>;
+	using dmatrixd = dmatrix<double>;
+}
+
+#endif /* STM_DMATRIX_H */
@@ -0,0 +1,272 @@
+#ifndef STM_FAST_MATH_H
+#define STM_FAST_MATH_H
+
+#include "common.h"
+#include "constant.h"
+#include "math_internal.h"
+#include "simd.h"
+
+#include <bit>
+#include <cstdint>
+
+/*
+	Fast approximations of the float transcendental functions, scalar and float4/float8.
+
+	sin, cos, sincos	Cody-Waite reduction by pi/2 and minimax polynomials on [-pi/4, pi/4].
+						Max error 2 ulp for |x| <= pi and an absolute error of at most 1.2e-7 for
+						|x| <= fast::max_trig_argument. Larger scalar arguments fall back to the
+						standard functions, larger SIMD lanes are unspecified.
+	atan, atan2			Octant reduction and a minimax polynomial on [0, tan(pi/8)], max error
+						3 ulp for atan and 4 ulp for atan2 (fast::atan_max_ulp, atan2_max_ulp).
+						atan2(±0, -0) returns ±0 and infinite pairs return NaN.
+	rsqrt				Hardware estimate (or a bit level guess) refined with Newton-Raphson,
+						max error 4 ulp for positive normal inputs, rsqrt(0) is +inf.
+
+	The scalar versions are constexpr, where rsqrt is exact at compile time.
+*/
+namespace stm
+{
+	// Precision of sin/cos/tan/atan2/sincos/rsqrt in math.h and of the transforms built on them
+	enum class precision
+	{
+		standard,	// std:: at runtime, long double continued fractions at compile time
+		fast		// the approximations below for float, other types keep the standard path
+	};
+
+	// Define STM_FAST_MATH to make the fast approximations the default of every call site
+#ifdef STM_FAST_MATH
+	inline constexpr precision default_precision = precision::fast;
+#else
+	inline constexpr precision default_precision = precision::standard;
+#endif
+
+	template<typename T>
+	struct sincos_result
+	{
+		T sin;
+		T cos;
+	};
+
+	namespace fast
+	{
+		inline constexpr float max_trig_argument = 8192.0f;
+
+		// Worst case errors against a double precision reference, stm_bench checks them
+		inline constexpr float atan_max_ulp = 3.0f;
+		inline constexpr float atan2_max_ulp = 4.0f;
+
+		namespace intern
+		{
+			inline constexpr float two_over_pi = 0.636619772367581343f;
+
+			// pi/2 split so that k * pio2_hi and k * pio2_mid are exact for the supported k
+			inline constexpr float pio2_hi = 1.5703125f;
+			inline constexpr float pio2_mid = 4.837512969970703125e-4f;
+			inline constexpr float pio2_lo = 7.54978995489188216e-8f;
+
+			inline constexpr float tan_pi_8 = 0.414213562373095049f;
+
+			inline constexpr float madd(float a, float b, float c) noexcept { return a * b + c; }
+
+			template<simd::Wide_float W>
+			inline W madd(W a, W b, W c) noexcept { return fmadd(a, b, c); }
+
+			template<typename T>
+			inline constexpr T splat(float value) noexcept
+			{
+				if constexpr (std::same_as<T, float>)
+					return value;
+				else
+					return T::broadcast(value);
+			}
+
+			// sin(r) and cos(r) for |r| <= pi/4
+			template<typename T>
+			inline constexpr T sin_poly(T r, T r2) noexcept
+			{
+				const T p = madd(madd(splat<T>(-1.9515295891e-4f), r2, splat<T>(8.3321608736e-3f)), r2, splat<T>(-1.6666654611e-1f));
+				return madd(p * r2, r, r);
+			}
+
+			template<typename T>
+			inline constexpr T cos_poly(T r2) noexcept
+			{
+				const T p = madd(madd(splat<T>(2.443315711809948e-5f), r2, splat<T>(-1.388731625493765e-3f)), r2, splat<T>(4.166664568298827e-2f));
+				return madd(p * r2, r2, madd(splat<T>(-0.5f), r2, splat<T>(1.0f)));
+			}
+
+			// atan(t) for |t| <= tan(pi/8)
+			template<typename T>
+			inline constexpr T atan_poly(T t) noexcept
+			{
+				const T z = t * t;
+				const T p = madd(madd(madd(splat<T>(8.05374449538e-2f), z, splat<T>(-1.38776856032e-1f)), z,
+									  splat<T>(1.99777106478e-1f)), z, splat<T>(-3.33329491539e-1f));
+				return madd(p * z, t, t);
+			}
+
+			inline constexpr float copy_sign(float magnitude, float sign) noexcept
+			{
+				return std::bit_cast<float>((std::bit_cast<std::uint32_t>(magnitude) & 0x7FFFFFFFu) |
+											(std::bit_cast<std::uint32_t>(sign) & 0x80000000u));
+			}
+
+			template<simd::Wide_float W>
+			inline W copy_sign(W magnitude, W sign) noexcept
+			{
+				const W sign_bit = W::broadcast(-0.0f);
+				return andnot(sign_bit, magnitude) | (sign & sign_bit);
+			}
+		}
+
+		inline constexpr sincos_result<float> sincos(float x) noexcept
+		{
+			const float magnitude = x < 0.0f ? -x : x;
+			if (!(magnitude <= max_trig_argument))
+			{
+				if (std::is_constant_evaluated())
+					return { const_sin(x), const_cos(x) };
+				else
+					return { std::sin(x), std::cos(x) };
+			}
+
+			const int k = static_cast<int>(x * intern::two_over_pi + (x < 0.0f ? -0.5f : 0.5f));
+			const float kf = static_cast<float>(k);
+			const float r = ((x - kf * intern::pio2_hi) - kf * intern::pio2_mid) - kf * intern::pio2_lo;
+			const float r2 = r * r;
+
+			const float s = intern::sin_poly(r, r2);
+			const float c = intern::cos_poly(r2);
+			switch (k & 3)
+			{
+			case 0:  return { s, c };
+			case 1:  return { c, -s };
+			case 2:  return { -s, -c };
+			default: return { -c, s };
+			}
+		}
+
+		inline constexpr float sin(float x) noexcept { return fast::sincos(x).sin; }
+		inline constexpr float cos(float x) noexcept { return fast::sincos(x).cos; }
+
+		inline constexpr float tan(float x) noexcept
+		{
+			const auto [s, c] = fast::sincos(x);
+			return s / c;
+		}
+
+		inline constexpr float atan(float x) noexcept
+		{
+			const float t = x < 0.0f ? -x : x;
+			float base = 0.0f, reduced = t;
+			if (t > 1.0f / intern::tan_pi_8)
+			{
+				base = pi_f / 2.0f;
+				reduced = -1.0f / t;
+			}
+			else if (t > intern::tan_pi_8)
+			{
+				base = pi_f / 4.0f;
+				reduced = (t - 1.0f) / (t + 1.0f);
+			}
+			return intern::copy_sign(base + intern::atan_poly(reduced), x);
+		}
+
+		inline constexpr float atan2(float y, float x) noexcept
+		{
+			const float ax = x < 0.0f ? -x : x;
+			const float ay = y < 0.0f ? -y : y;
+			const float largest = ax > ay ? ax : ay;
+			const float smallest = ax > ay ? ay : ax;
+			if (largest == 0.0f)
+				return intern::copy_sign(0.0f, y);
+
+			const float a = smallest / largest;
+			float angle = a > intern::tan_pi_8
+				? pi_f / 4.0f + intern::atan_poly((a - 1.0f) / (a + 1.0f))
+				: intern::atan_poly(a);
+			if (ay > ax)
+				angle = pi_f / 2.0f - angle;
+			if (x < 0.0f)
+				angle = pi_f - angle;
+			return intern::copy_sign(angle, y);
+		}
+
+		inline constexpr float rsqrt(float x) noexcept
+		{
+			if (std::is_constant_evaluated())
+				return 1.0f / const_sqrt(x);
+
+		#ifdef STM_SIMD_SSE2
+			const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+			if (x == 0.0f)
+				return estimate;
+			return estimate * (1.5f - (0.5f * x * estimate) * estimate);
+		#else
+			if (x == 0.0f)
+				return 1.0f / x;
+			float y = std::bit_cast<float>(0x5F375A86u - (std::bit_cast<std::uint32_t>(x) >> 1));
+			for (int i = 0; i < 3; ++i)
+				y = y * (1.5f - (0.5f * x * y) * y);
+			return y;
+		#endif
+		}
+
+		// Lanes are independent, the same ranges and error bounds as the scalar versions apply
+		template<simd::Wide_float W>
+		inline sincos_result<W> sincos(W x) noexcept
+		{
+			const W k = round(x * W::broadcast(intern::two_over_pi));
+			W r = fmadd(k, W::broadcast(-intern::pio2_hi), x);
+			r = fmadd(k, W::broadcast(-intern::pio2_mid), r);
+			r = fmadd(k, W::broadcast(-intern::pio2_lo), r);
+			const W r2 = r * r;
+
+			const W s = intern::sin_poly(r, r2);
+			const W c = intern::cos_poly(r2);
+
+			// Quadrant as k - 4 round(k / 4), one of -2, -1, 0, 1, 2
+			const W quadrant = fmadd(round(k * W::broadcast(0.25f)), W::broadcast(-4.0f), k);
+			const W one = W::broadcast(1.0f), half = W::broadcast(0.5f), sign_bit = W::broadcast(-0.0f);
+			const W swap = abs(quadrant) == one;
+			const W sin_negative = (quadrant < -half) | (quadrant > one + half);
+			const W cos_negative = (quadrant > half) | (quadrant < -(one + half));
+
+			return { select(swap, c, s) ^ (sin_negative & sign_bit), select(swap, s, c) ^ (cos_negative & sign_bit) };
+		}
+
+		template<simd::Wide_float W>
+		inline W sin(W x) noexcept { return fast::sincos(x).sin; }
+
+		template<simd::Wide_float W>
+		inline W cos(W x) noexcept { return fast::sincos(x).cos; }
+
+		template<simd::Wide_float W>
+		inline W atan2(W y, W x) noexcept
+		{
+			const W ax = abs(x), ay = abs(y);
+			const W largest = max(ax, ay), smallest = min(ax, ay);
+			const W a = select(largest == W::zero(), W::zero(), smallest / largest);
+
+			const W reduce = a > W::broadcast(intern::tan_pi_8);
+			const W t = select(reduce, (a - W::broadcast(1.0f)) / (a + W::broadcast(1.0f)), a);
+			W angle = (reduce & W::broadcast(pi_f / 4.0f)) + intern::atan_poly(t);
+			angle = select(ay > ax, W::broadcast(pi_f / 2.0f) - angle, angle);
+			angle = select(x < W::zero(), W::broadcast(pi_f) - angle, angle);
+			return intern::copy_sign(angle, y);
+		}
+
+		template<simd::Wide_float W>
+		inline W atan(W x) noexcept { return fast::atan2(x, W::broadcast(1.0f)); }
+
+		template<simd::Wide_float W>
+		inline W rsqrt(W x) noexcept
+		{
+			const W estimate = rsqrt_estimate(x);
+			const W refined = estimate * (W::broadcast(1.5f) - (W::broadcast(0.5f) * x * estimate) * estimate);
+			return select(x == W::zero(), estimate, refined);
+		}
+	}
+}
+
+#endif /* STM_FAST_MATH_H */
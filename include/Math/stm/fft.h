@@ -0,0 +1,597 @@
+#ifndef STM_FFT_H
+#define STM_FFT_H
+
+#include "common.h"
+#include "complex.h"
+#include "constant.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+/*
+	Fast Fourier transforms of any length. A plan factors the length into radix 4, 2 and 3 stages
+	(other primes run as a direct DFT of that radix, so lengths with large prime factors are slow)
+	and precomputes every twiddle factor. The stages use the Stockham autosort ordering, which
+	needs no bit reversal and keeps each pass contiguous, and run on split real/imaginary arrays.
+	For float, stages with a stride of at least eight and the column pass of 2D transforms use
+	float8 lanes.
+
+	forward() computes X[k] = sum x[j] exp(-2 pi i jk / n) and inverse() includes the 1/n factor.
+	Plans are immutable after construction and can be shared between threads.
+*/
+namespace stm
+{
+	namespace intern
+	{
+		struct fft_stage
+		{
+			std::size_t radix;
+			std::size_t length;		// length of the sub-transforms this stage splits
+			std::size_t stride;		// product of the radices of the previous stages
+			std::size_t twiddles;	// offset of this stage's (length / radix) * (radix - 1) twiddles
+			std::size_t dft;		// offset of the radix x radix DFT matrix for generic radices
+		};
+
+		template<Float T>
+		struct fft_scalar_lanes
+		{
+			using type = T;
+			static constexpr std::size_t width = 1;
+			static T load(const T* data) noexcept { return *data; }
+			static void store(T* data, T value) noexcept { *data = value; }
+			static T broadcast(T value) noexcept { return value; }
+		};
+
+	#ifdef STM_SIMD_SSE2
+		struct fft_wide_lanes
+		{
+			using type = simd::float8;
+			static constexpr std::size_t width = 8;
+			static simd::float8 load(const float* data) noexcept { return simd::float8::load(data); }
+			static void store(float* data, simd::float8 value) noexcept { value.store(data); }
+			static simd::float8 broadcast(float value) noexcept { return simd::float8::broadcast(value); }
+		};
+	#endif
+
+		// Real and imaginary parts in separate arrays
+		template<typename T>
+		struct fft_split
+		{
+			T* re;
+			T* im;
+		};
+
+		/*
+			One radix R butterfly of a Stockham stage on lanes of type L:
+			y[j * out_step] = (sum_k x[k * in_step] w_R^jk) w^j
+			R == 0 runs the generic DFT with the radix from dft_size.
+		*/
+		template<std::size_t R, typename L, Float T>
+		inline void fft_butterfly(fft_split<const T> x, std::size_t in_step, fft_split<T> y, std::size_t out_step,
+								  const T* w_re, const T* w_im, const T* dft_re, const T* dft_im, std::size_t dft_size) noexcept
+		{
+			using V = typename L::type;
+
+			auto twiddle = [&](V& re, V& im, std::size_t j) {
+				const V wr = L::broadcast(w_re[j - 1]), wi = L::broadcast(w_im[j - 1]);
+				const V tmp = re * wr - im * wi;
+				im = re * wi + im * wr;
+				re = tmp;
+			};
+
+			if constexpr (R == 2)
+			{
+				const V a0r = L::load(x.re), a0i = L::load(x.im);
+				const V a1r = L::load(x.re + in_step), a1i = L::load(x.im + in_step);
+				V y1r = a0r - a1r, y1i = a0i - a1i;
+				twiddle(y1r, y1i, 1);
+				L::store(y.re, a0r + a1r);
+				L::store(y.im, a0i + a1i);
+				L::store(y.re + out_step, y1r);
+				L::store(y.im + out_step, y1i);
+			}
+			else if constexpr (R == 3)
+			{
+				const V half = L::broadcast(T{0.5});
+				const V sin60 = L::broadcast(static_cast<T>(0.86602540378443864676));
+				const V a0r = L::load(x.re), a0i = L::load(x.im);
+				const V a1r = L::load(x.re + in_step), a1i = L::load(x.im + in_step);
+				const V a2r = L::load(x.re + 2 * in_step), a2i = L::load(x.im + 2 * in_step);
+
+				const V t1r = a1r + a2r, t1i = a1i + a2i;
+				const V t2r = a0r - t1r * half, t2i = a0i - t1i * half;
+				const V t3r = (a1r - a2r) * sin60, t3i = (a1i - a2i) * sin60;
+
+				// y1 = t2 - i t3, y2 = t2 + i t3
+				V y1r = t2r + t3i, y1i = t2i - t3r;
+				V y2r = t2r - t3i, y2i = t2i + t3r;
+				twiddle(y1r, y1i, 1);
+				twiddle(y2r, y2i, 2);
+				L::store(y.re, a0r + t1r);
+				L::store(y.im, a0i + t1i);
+				L::store(y.re + out_step, y1r);
+				L::store(y.im + out_step, y1i);
+				L::store(y.re + 2 * out_step, y2r);
+				L::store(y.im + 2 * out_step, y2i);
+			}
+			else if constexpr (R == 4)
+			{
+				const V a0r = L::load(x.re), a0i = L::load(x.im);
+				const V a1r = L::load(x.re + in_step), a1i = L::load(x.im + in_step);
+				const V a2r = L::load(x.re + 2 * in_step), a2i = L::load(x.im + 2 * in_step);
+				const V a3r = L::load(x.re + 3 * in_step), a3i = L::load(x.im + 3 * in_step);
+
+				const V t0r = a0r + a2r, t0i = a0i + a2i;
+				const V t1r = a0r - a2r, t1i = a0i - a2i;
+				const V t2r = a1r + a3r, t2i = a1i + a3i;
+				// -i (a1 - a3)
+				const V t3r = a1i - a3i, t3i = a3r - a1r;
+
+				V y1r = t1r + t3r, y1i = t1i + t3i;
+				V y2r = t0r - t2r, y2i = t0i - t2i;
+				V y3r = t1r - t3r, y3i = t1i - t3i;
+				twiddle(y1r, y1i, 1);
+				twiddle(y2r, y2i, 2);
+				twiddle(y3r, y3i, 3);
+				L::store(y.re, t0r + t2r);
+				L::store(y.im, t0i + t2i);
+				L::store(y.re + out_step, y1r);
+				L::store(y.im + out_step, y1i);
+				L::store(y.re + 2 * out_step, y2r);
+				L::store(y.im + 2 * out_step, y2i);
+				L::store(y.re + 3 * out_step, y3r);
+				L::store(y.im + 3 * out_step, y3i);
+			}
+			else
+			{
+				for (std::size_t j = 0; j < dft_size; ++j)
+				{
+					V sum_r = L::broadcast(T{0}), sum_i = L::broadcast(T{0});
+					for (std::size_t k = 0; k < dft_size; ++k)
+					{
+						const V ar = L::load(x.re + k * in_step), ai = L::load(x.im + k * in_step);
+						const V dr = L::broadcast(dft_re[j * dft_size + k]), di = L::broadcast(dft_im[j * dft_size + k]);
+						sum_r = sum_r + ar * dr - ai * di;
+						sum_i = sum_i + ar * di + ai * dr;
+					}
+					if (j != 0)
+						twiddle(sum_r, sum_i, j);
+					L::store(y.re + j * out_step, sum_r);
+					L::store(y.im + j * out_step, sum_i);
+				}
+			}
+		}
+
+		/*
+			Runs one stage over element indices scaled by element_stride. batch == 1 is a single
+			transform, vectorized over the stride when it is wide enough. batch > 1 transforms that
+			many interleaved sequences at once (consecutive memory lanes), e.g. the columns of a 2D array.
+		*/
+		template<std::size_t R, Float T>
+		inline void fft_run_stage(const fft_stage& stage, const T* twiddle_re, const T* twiddle_im, const T* dft_re, const T* dft_im,
+								  fft_split<const T> x, fft_split<T> y, std::size_t element_stride, std::size_t batch) noexcept
+		{
+			const std::size_t radix = stage.radix, s = stage.stride, m = stage.length / radix;
+			const std::size_t in_step = s * m * element_stride, out_step = s * element_stride;
+
+			for (std::size_t p = 0; p < m; ++p)
+			{
+				const T* w_re = twiddle_re + stage.twiddles + p * (radix - 1);
+				const T* w_im = twiddle_im + stage.twiddles + p * (radix - 1);
+
+				for (std::size_t q = 0; q < s; )
+				{
+					const std::size_t in = (q + s * p) * element_stride, out = (q + s * radix * p) * element_stride;
+					if (batch == 1)
+					{
+					#ifdef STM_SIMD_SSE2
+						if constexpr (std::is_same_v<T, float>)
+						{
+							if (element_stride == 1 && q + fft_wide_lanes::width <= s)
+							{
+								fft_butterfly<R, fft_wide_lanes>(fft_split<const T>{ x.re + in, x.im + in }, in_step,
+																  fft_split<T>{ y.re + out, y.im + out }, out_step,
+																  w_re, w_im, dft_re, dft_im, radix);
+								q += fft_wide_lanes::width;
+								continue;
+							}
+						}
+					#endif
+						fft_butterfly<R, fft_scalar_lanes<T>>(fft_split<const T>{ x.re + in, x.im + in }, in_step,
+															   fft_split<T>{ y.re + out, y.im + out }, out_step,
+															   w_re, w_im, dft_re, dft_im, radix);
+					}
+					else
+					{
+						std::size_t lane = 0;
+					#ifdef STM_SIMD_SSE2
+						if constexpr (std::is_same_v<T, float>)
+						{
+							for (; lane + fft_wide_lanes::width <= batch; lane += fft_wide_lanes::width)
+								fft_butterfly<R, fft_wide_lanes>(fft_split<const T>{ x.re + in + lane, x.im + in + lane }, in_step,
+																  fft_split<T>{ y.re + out + lane, y.im + out + lane }, out_step,
+																  w_re, w_im, dft_re, dft_im, radix);
+						}
+					#endif
+						for (; lane < batch; ++lane)
+							fft_butterfly<R, fft_scalar_lanes<T>>(fft_split<const T>{ x.re + in + lane, x.im + in + lane }, in_step,
+																   fft_split<T>{ y.re + out + lane, y.im + out + lane }, out_step,
+																   w_re, w_im, dft_re, dft_im, radix);
+					}
+					++q;
+				}
+			}
+		}
+
+		template<Float T>
+		inline std::vector<T>& fft_scratch(std::size_t index, std::size_t size)
+		{
+			thread_local std::vector<T> buffers[6];
+			if (buffers[index].size() < size)
+				buffers[index].resize(size);
+			return buffers[index];
+		}
+	}
+
+	template<Float T>
+	class fft_plan
+	{
+	public:
+		fft_plan() = default;
+
+		explicit fft_plan(std::size_t size)
+			: size_{ size }
+		{
+			assert(size > 0);
+
+			std::size_t remaining = size;
+			std::vector<std::size_t> radices;
+			while (remaining % 4 == 0) { radices.push_back(4); remaining /= 4; }
+			while (remaining % 2 == 0) { radices.push_back(2); remaining /= 2; }
+			while (remaining % 3 == 0) { radices.push_back(3); remaining /= 3; }
+			for (std::size_t factor = 5; remaining > 1; factor += 2)
+			{
+				while (remaining % factor == 0) { radices.push_back(factor); remaining /= factor; }
+				if (factor * factor > remaining && remaining > 1)
+				{
+					radices.push_back(remaining);
+					remaining = 1;
+				}
+			}
+
+			std::size_t length = size, stride = 1;
+			for (std::size_t radix : radices)
+			{
+				intern::fft_stage stage{ radix, length, stride, twiddle_re_.size(), dft_re_.size() };
+				const std::size_t m = length / radix;
+				for (std::size_t p = 0; p < m; ++p)
+				{
+					for (std::size_t j = 1; j < radix; ++j)
+					{
+						const double angle = -2.0 * pi * static_cast<double>(p * j) / static_cast<double>(length);
+						twiddle_re_.push_back(static_cast<T>(std::cos(angle)));
+						twiddle_im_.push_back(static_cast<T>(std::sin(angle)));
+					}
+				}
+
+				if (radix > 4)
+				{
+					for (std::size_t j = 0; j < radix; ++j)
+					{
+						for (std::size_t k = 0; k < radix; ++k)
+						{
+							const double angle = -2.0 * pi * static_cast<double>((j * k) % radix) / static_cast<double>(radix);
+							dft_re_.push_back(static_cast<T>(std::cos(angle)));
+							dft_im_.push_back(static_cast<T>(std::sin(angle)));
+						}
+					}
+				}
+
+				stages_.push_back(stage);
+				length = m;
+				stride *= radix;
+			}
+		}
+
+		std::size_t size() const noexcept { return size_; }
+
+		void forward(std::span<const complex<T>> in, std::span<complex<T>> out) const
+		{
+			assert(in.size() == size_ && out.size() == size_);
+			auto& re = intern::fft_scratch<T>(0, size_);
+			auto& im = intern::fft_scratch<T>(1, size_);
+			deinterleave(in, re.data(), im.data());
+			forward(re, im, re, im);
+			interleave(re.data(), im.data(), out);
+		}
+
+		void inverse(std::span<const complex<T>> in, std::span<complex<T>> out) const
+		{
+			assert(in.size() == size_ && out.size() == size_);
+			auto& re = intern::fft_scratch<T>(0, size_);
+			auto& im = intern::fft_scratch<T>(1, size_);
+			deinterleave(in, re.data(), im.data());
+			inverse(re, im, re, im);
+			interleave(re.data(), im.data(), out);
+		}
+
+		void forward(std::span<complex<T>> data) const { forward(std::span<const complex<T>>{ data }, data); }
+		void inverse(std::span<complex<T>> data) const { inverse(std::span<const complex<T>>{ data }, data); }
+
+		// Split complex input and output, which may be the same arrays
+		void forward(std::span<const T> in_re, std::span<const T> in_im, std::span<T> out_re, std::span<T> out_im) const
+		{
+			assert(in_re.size() >= size_ && in_im.size() >= size_ && out_re.size() >= size_ && out_im.size() >= size_);
+			transform({ in_re.data(), in_im.data() }, { out_re.data(), out_im.data() }, 1, 1);
+		}
+
+		// Swapping real and imaginary parts conjugates, so the inverse is a forward transform on swapped arrays
+		void inverse(std::span<const T> in_re, std::span<const T> in_im, std::span<T> out_re, std::span<T> out_im) const
+		{
+			forward(in_im, in_re, out_im, out_re);
+			const T scale = T{1} / static_cast<T>(size_);
+			for (std::size_t i = 0; i < size_; ++i)
+			{
+				out_re[i] *= scale;
+				out_im[i] *= scale;
+			}
+		}
+
+		/*
+			batch interleaved sequences with element i of sequence b at [i * element_stride + b].
+			Used for the columns of 2D transforms, data may be both input and output.
+		*/
+		void forward_batch(intern::fft_split<const T> in, intern::fft_split<T> out, std::size_t element_stride, std::size_t batch) const
+		{
+			transform(in, out, element_stride, batch);
+		}
+
+		void inverse_batch(intern::fft_split<const T> in, intern::fft_split<T> out, std::size_t element_stride, std::size_t batch) const
+		{
+			transform({ in.im, in.re }, { out.im, out.re }, element_stride, batch);
+			const T scale = T{1} / static_cast<T>(size_);
+			for (std::size_t i = 0; i < size_; ++i)
+			{
+				for (std::size_t lane = 0; lane < batch; ++lane)
+				{
+					out.re[i * element_stride + lane] *= scale;
+					out.im[i * element_stride + lane] *= scale;
+				}
+			}
+		}
+
+	private:
+		void transform(intern::fft_split<const T> in, intern::fft_split<T> out, std::size_t element_stride, std::size_t batch) const
+		{
+			const std::size_t extent = (size_ - 1) * element_stride + batch;
+			if (stages_.empty())
+			{
+				std::copy(in.re, in.re + extent, out.re);
+				std::copy(in.im, in.im + extent, out.im);
+				return;
+			}
+
+			auto& work_re = intern::fft_scratch<T>(2, extent);
+			auto& work_im = intern::fft_scratch<T>(3, extent);
+			intern::fft_split<T> work{ work_re.data(), work_im.data() };
+
+			// Ping-pong so the last stage lands in out. With an odd stage count the first stage writes
+			// out, so aliased input is copied to work first
+			intern::fft_split<const T> source = in;
+			const bool aliased = in.re == out.re || in.im == out.im || in.re == out.im || in.im == out.re;
+			if (aliased && stages_.size() % 2 == 1)
+			{
+				std::copy(in.re, in.re + extent, work.re);
+				std::copy(in.im, in.im + extent, work.im);
+				source = { work.re, work.im };
+			}
+
+			for (std::size_t i = 0; i < stages_.size(); ++i)
+			{
+				const intern::fft_split<T> destination = (stages_.size() - 1 - i) % 2 == 0 ? out : work;
+				run_stage(stages_[i], source, destination, element_stride, batch);
+				source = { destination.re, destination.im };
+			}
+		}
+
+		void run_stage(const intern::fft_stage& stage, intern::fft_split<const T> x, intern::fft_split<T> y,
+					   std::size_t element_stride, std::size_t batch) const
+		{
+			const T* tw_re = twiddle_re_.data();
+			const T* tw_im = twiddle_im_.data();
+			const T* dft_re = dft_re_.data() + stage.dft;
+			const T* dft_im = dft_im_.data() + stage.dft;
+			switch (stage.radix)
+			{
+			case 2:  intern::fft_run_stage<2>(stage, tw_re, tw_im, dft_re, dft_im, x, y, element_stride, batch); break;
+			case 3:  intern::fft_run_stage<3>(stage, tw_re, tw_im, dft_re, dft_im, x, y, element_stride, batch); break;
+			case 4:  intern::fft_run_stage<4>(stage, tw_re, tw_im, dft_re, dft_im, x, y, element_stride, batch); break;
+			default: intern::fft_run_stage<0>(stage, tw_re, tw_im, dft_re, dft_im, x, y, element_stride, batch); break;
+			}
+		}
+
+		static void deinterleave(std::span<const complex<T>> in, T* re, T* im) noexcept
+		{
+			for (std::size_t i = 0; i < in.size(); ++i)
+			{
+				re[i] = in[i].real();
+				im[i] = in[i].imag();
+			}
+		}
+
+		static void interleave(const T* re, const T* im, std::span<complex<T>> out) noexcept
+		{
+			for (std::size_t i = 0; i < out.size(); ++i)
+				out[i] = complex<T>{ re[i], im[i] };
+		}
+
+		std::size_t size_ = 0;
+		std::vector<intern::fft_stage> stages_;
+		std::vector<T> twiddle_re_, twiddle_im_;
+		std::vector<T> dft_re_, dft_im_;
+	};
+
+	/*
+		Transform of n real samples (n even) through a complex transform of n / 2: even samples go
+		in the real part, odd samples in the imaginary part, and one pass untangles the halves.
+		forward() writes the n / 2 + 1 non-redundant bins, the rest are their conjugates.
+	*/
+	template<Float T>
+	class real_fft_plan
+	{
+	public:
+		real_fft_plan() = default;
+
+		explicit real_fft_plan(std::size_t size)
+			: size_{ size }, half_{ size / 2 }
+		{
+			assert(size >= 2 && size % 2 == 0);
+			for (std::size_t k = 0; k < half_; ++k)
+			{
+				const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+				twiddle_re_.push_back(static_cast<T>(std::cos(angle)));
+				twiddle_im_.push_back(static_cast<T>(std::sin(angle)));
+			}
+			plan_ = fft_plan<T>{ half_ };
+		}
+
+		std::size_t size() const noexcept { return size_; }
+		std::size_t bins() const noexcept { return half_ + 1; }
+
+		void forward(std::span<const T> in, std::span<complex<T>> out) const
+		{
+			assert(in.size() == size_ && out.size() == bins());
+			auto& re = intern::fft_scratch<T>(0, half_);
+			auto& im = intern::fft_scratch<T>(1, half_);
+			for (std::size_t k = 0; k < half_; ++k)
+			{
+				re[k] = in[2 * k];
+				im[k] = in[2 * k + 1];
+			}
+			plan_.forward(re, im, re, im);
+
+			// X[k] = (Z[k] + conj Z[h - k]) / 2 - i w^k (Z[k] - conj Z[h - k]) / 2
+			for (std::size_t k = 0; k <= half_; ++k)
+			{
+				const std::size_t a = k < half_ ? k : 0, b = k > 0 ? half_ - k : 0;
+				const T even_re = (re[a] + re[b]) * T{0.5}, even_im = (im[a] - im[b]) * T{0.5};
+				const T odd_re = (im[a] + im[b]) * T{0.5}, odd_im = (re[b] - re[a]) * T{0.5};
+				const T w_re = k < half_ ? twiddle_re_[k] : T{-1}, w_im = k < half_ ? twiddle_im_[k] : T{0};
+				out[k] = complex<T>{ even_re + odd_re * w_re - odd_im * w_im, even_im + odd_re * w_im + odd_im * w_re };
+			}
+		}
+
+		void inverse(std::span<const complex<T>> in, std::span<T> out) const
+		{
+			assert(in.size() == bins() && out.size() == size_);
+			auto& re = intern::fft_scratch<T>(0, half_);
+			auto& im = intern::fft_scratch<T>(1, half_);
+
+			// Z[k] = E[k] + i O[k] with E = (X[k] + conj X[h - k]) / 2 and O = conj(w^k) (X[k] - conj X[h - k]) / 2
+			for (std::size_t k = 0; k < half_; ++k)
+			{
+				const complex<T>& x = in[k];
+				const complex<T>& y = in[half_ - k];
+				const T even_re = (x.real() + y.real()) * T{0.5}, even_im = (x.imag() - y.imag()) * T{0.5};
+				const T diff_re = (x.real() - y.real()) * T{0.5}, diff_im = (x.imag() + y.imag()) * T{0.5};
+				const T odd_re = diff_re * twiddle_re_[k] + diff_im * twiddle_im_[k];
+				const T odd_im = diff_im * twiddle_re_[k] - diff_re * twiddle_im_[k];
+				re[k] = even_re - odd_im;
+				im[k] = even_im + odd_re;
+			}
+			plan_.inverse(re, im, re, im);
+
+			for (std::size_t k = 0; k < half_; ++k)
+			{
+				out[2 * k] = re[k];
+				out[2 * k + 1] = im[k];
+			}
+		}
+
+	private:
+		std::size_t size_ = 0;
+		std::size_t half_ = 0;
+		fft_plan<T> plan_;
+		std::vector<T> twiddle_re_, twiddle_im_;
+	};
+
+	// Row-major 2D transform, rows one at a time and all columns together as a batch
+	template<Float T>
+	class fft_plan_2d
+	{
+	public:
+		fft_plan_2d() = default;
+
+		fft_plan_2d(std::size_t rows, std::size_t columns)
+			: rows_{ rows }, columns_{ columns }, row_plan_{ columns }, column_plan_{ rows } {}
+
+		std::size_t rows() const noexcept { return rows_; }
+		std::size_t columns() const noexcept { return columns_; }
+
+		void forward(std::span<const complex<T>> in, std::span<complex<T>> out) const { transform(in, out, false); }
+		void inverse(std::span<const complex<T>> in, std::span<complex<T>> out) const { transform(in, out, true); }
+
+		void forward(std::span<complex<T>> data) const { transform(data, data, false); }
+		void inverse(std::span<complex<T>> data) const { transform(data, data, true); }
+
+	private:
+		void transform(std::span<const complex<T>> in, std::span<complex<T>> out, bool inverse) const
+		{
+			const std::size_t count = rows_ * columns_;
+			assert(in.size() == count && out.size() == count);
+
+			auto& re = intern::fft_scratch<T>(4, count);
+			auto& im = intern::fft_scratch<T>(5, count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				re[i] = in[i].real();
+				im[i] = in[i].imag();
+			}
+
+			for (std::size_t row = 0; row < rows_; ++row)
+			{
+				const std::span<T> row_re{ re.data() + row * columns_, columns_ };
+				const std::span<T> row_im{ im.data() + row * columns_, columns_ };
+				if (inverse)
+					row_plan_.inverse(row_re, row_im, row_re, row_im);
+				else
+					row_plan_.forward(row_re, row_im, row_re, row_im);
+			}
+
+			const intern::fft_split<T> planes{ re.data(), im.data() };
+			if (inverse)
+				column_plan_.inverse_batch({ planes.re, planes.im }, planes, columns_, columns_);
+			else
+				column_plan_.forward_batch({ planes.re, planes.im }, planes, columns_, columns_);
+
+			for (std::size_t i = 0; i < count; ++i)
+				out[i] = complex<T>{ re[i], im[i] };
+		}
+
+		std::size_t rows_ = 0;
+		std::size_t columns_ = 0;
+		fft_plan<T> row_plan_;
+		fft_plan<T> column_plan_;
+	};
+
+	template<Float T>
+	std::vector<complex<T>> fft(std::span<const complex<T>> in)
+	{
+		std::vector<complex<T>> out(in.size());
+		fft_plan<T>{ in.size() }.forward(in, out);
+		return out;
+	}
+
+	template<Float T>
+	std::vector<complex<T>> ifft(std::span<const complex<T>> in)
+	{
+		std::vector<complex<T>> out(in.size());
+		fft_plan<T>{ in.size() }.inverse(in, out);
+		return out;
+	}
+}
+
+#endif /* STM_FFT_H */
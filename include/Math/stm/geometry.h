@@ -2,6 +2,16 @@
 #define STM_GEOMETRY_H
 
 #include "common.h"
+#include "math.h"
+#include "matrix.h"
+#include "vector.h"
+#include "vector3.h"
+#include "vector4.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
 
 namespace stm
 {
@@ -29,7 +39,7 @@ namespace stm
 			:origin_{ origin }, direction_{ direction }
 		{
 			if (normalize)
-				direction_.unit();
+				direction_ = direction_.unit();
 		}
 
 		constexpr auto& origin() noexcept { return origin_; }
@@ -69,7 +79,7 @@ namespace stm
 			return !(lhs == rhs);
 		}
 
-		friend std::ostream& operator<<<T, Dims>(std::ostream&, const ray&);
+		// friend std::ostream& operator<<<T, Dims>(std::ostream&, const ray&);
 
 	private:
 		stm::point<T, Dims> origin_{};
@@ -105,7 +115,8 @@ namespace stm
 
 		constexpr sphere& scale(const T& scale) noexcept
 		{
-			origin *= scale;
+			origin_ *= scale;
+			radius_ *= scale;
 			return *this;
 		}
 
@@ -119,13 +130,14 @@ namespace stm
 			return !(lhs == rhs);
 		}
 
-		friend std::ostream& operator<<<T, Dims>(std::ostream&, const sphere&);
+		// friend std::ostream& operator<<<T, Dims>(std::ostream&, const sphere&);
 
 	private:
 		stm::point<T, Dims> origin_{};
 		T radius_{};
 	};
 
+	// Hyperplane dot(normal, p) + distance = 0, the normal points to the positive half-space
 	template<Real T, std::size_t Dims>
 	class plane
 	{
@@ -135,10 +147,319 @@ namespace stm
 		constexpr plane(plane&&) noexcept = default;
 		constexpr plane& operator=(const plane&) noexcept = default;
 		constexpr plane& operator=(plane&&) noexcept = default;
-		~sphere() noexcept = default;
+		~plane() noexcept = default;
+
+		constexpr plane(const stm::vector<T, Dims>& normal, const T& distance) noexcept
+			:normal_{ normal }, distance_{ distance }
+		{}
+
+		constexpr plane(const stm::vector<T, Dims>& normal, const stm::point<T, Dims>& origin) noexcept
+			:normal_{ normal }, distance_{ -(normal * origin) }
+		{}
+
+		constexpr auto& normal() noexcept { return normal_; }
+		constexpr const auto& normal() const noexcept { return normal_; }
+
+		constexpr T& distance() noexcept { return distance_; }
+		constexpr const T& distance() const noexcept { return distance_; }
+
+		static constexpr std::size_t dimensions() noexcept { return Dims; }
+
+		// Signed distance scaled by the normal length, exact for normalized planes
+		constexpr T signed_distance(const stm::point<T, Dims>& point) const noexcept
+		{
+			return normal_ * point + distance_;
+		}
+
+		constexpr plane& normalize() noexcept
+		{
+			const T length = normal_.abs();
+			normal_ /= length;
+			distance_ /= length;
+			return *this;
+		}
+
+		constexpr friend bool operator==(const plane& lhs, const plane& rhs) noexcept
+		{
+			return (lhs.normal_ == rhs.normal_) && (lhs.distance_ == rhs.distance_);
+		}
+
+		constexpr friend bool operator!=(const plane& lhs, const plane& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+	private:
+		stm::vector<T, Dims> normal_{};
+		T distance_{};
+	};
+
+	// Axis aligned bounding box, empty() returns an inverted box that any expand() overwrites
+	template<Real T, std::size_t Dims>
+	class aabb
+	{
+	public:
+		constexpr aabb() noexcept = default;
+		constexpr aabb(const aabb&) noexcept = default;
+		constexpr aabb(aabb&&) noexcept = default;
+		constexpr aabb& operator=(const aabb&) noexcept = default;
+		constexpr aabb& operator=(aabb&&) noexcept = default;
+		~aabb() noexcept = default;
+
+		constexpr aabb(const stm::point<T, Dims>& min, const stm::point<T, Dims>& max) noexcept
+			:min_{ min }, max_{ max }
+		{}
+
+		static constexpr aabb empty() noexcept
+		{
+			aabb out;
+			for (std::size_t i = 0; i < Dims; ++i)
+			{
+				out.min_[i] = std::numeric_limits<T>::max();
+				out.max_[i] = std::numeric_limits<T>::lowest();
+			}
+			return out;
+		}
+
+		static constexpr aabb from_center_extents(const stm::point<T, Dims>& center, const stm::vector<T, Dims>& extents) noexcept
+		{
+			return { center - extents, center + extents };
+		}
+
+		constexpr auto& min() noexcept { return min_; }
+		constexpr const auto& min() const noexcept { return min_; }
+
+		constexpr auto& max() noexcept { return max_; }
+		constexpr const auto& max() const noexcept { return max_; }
+
+		static constexpr std::size_t dimensions() noexcept { return Dims; }
+
+		constexpr bool is_empty() const noexcept
+		{
+			for (std::size_t i = 0; i < Dims; ++i)
+				if (min_[i] > max_[i])
+					return true;
+			return false;
+		}
+
+		constexpr stm::point<T, Dims> center() const noexcept { return (min_ + max_) / T{ 2 }; }
+		constexpr stm::vector<T, Dims> extents() const noexcept { return (max_ - min_) / T{ 2 }; }
+		constexpr stm::vector<T, Dims> size() const noexcept { return max_ - min_; }
+
+		constexpr T surface_area() const noexcept requires (Dims == 3)
+		{
+			const auto d = size();
+			return T{ 2 } * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		constexpr aabb& expand(const stm::point<T, Dims>& point) noexcept
+		{
+			for (std::size_t i = 0; i < Dims; ++i)
+			{
+				min_[i] = point[i] < min_[i] ? point[i] : min_[i];
+				max_[i] = point[i] > max_[i] ? point[i] : max_[i];
+			}
+			return *this;
+		}
+
+		constexpr aabb& expand(const aabb& box) noexcept
+		{
+			for (std::size_t i = 0; i < Dims; ++i)
+			{
+				min_[i] = box.min_[i] < min_[i] ? box.min_[i] : min_[i];
+				max_[i] = box.max_[i] > max_[i] ? box.max_[i] : max_[i];
+			}
+			return *this;
+		}
+
+		constexpr bool contains(const stm::point<T, Dims>& point) const noexcept
+		{
+			for (std::size_t i = 0; i < Dims; ++i)
+				if (point[i] < min_[i] || point[i] > max_[i])
+					return false;
+			return true;
+		}
+
+		constexpr bool intersects(const aabb& box) const noexcept
+		{
+			for (std::size_t i = 0; i < Dims; ++i)
+				if (box.max_[i] < min_[i] || box.min_[i] > max_[i])
+					return false;
+			return true;
+		}
+
+		constexpr friend bool operator==(const aabb& lhs, const aabb& rhs) noexcept
+		{
+			return (lhs.min_ == rhs.min_) && (lhs.max_ == rhs.max_);
+		}
+
+		constexpr friend bool operator!=(const aabb& lhs, const aabb& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+	private:
+		stm::point<T, Dims> min_{};
+		stm::point<T, Dims> max_{};
+	};
+
+	template<Real T, std::size_t Dims>
+	constexpr aabb<T, Dims> merge(const aabb<T, Dims>& lhs, const aabb<T, Dims>& rhs) noexcept
+	{
+		return aabb<T, Dims>{ lhs }.expand(rhs);
+	}
+
+	template<Real T, std::size_t Dims>
+	class triangle
+	{
+	public:
+		constexpr triangle() noexcept = default;
+		constexpr triangle(const triangle&) noexcept = default;
+		constexpr triangle(triangle&&) noexcept = default;
+		constexpr triangle& operator=(const triangle&) noexcept = default;
+		constexpr triangle& operator=(triangle&&) noexcept = default;
+		~triangle() noexcept = default;
+
+		constexpr triangle(const stm::point<T, Dims>& a, const stm::point<T, Dims>& b, const stm::point<T, Dims>& c) noexcept
+			:vertices_{ a, b, c }
+		{}
+
+		constexpr auto& operator[](std::size_t index) noexcept { return vertices_[index]; }
+		constexpr const auto& operator[](std::size_t index) const noexcept { return vertices_[index]; }
+
+		constexpr auto& vertices() noexcept { return vertices_; }
+		constexpr const auto& vertices() const noexcept { return vertices_; }
+
+		static constexpr std::size_t dimensions() noexcept { return Dims; }
+
+		constexpr stm::point<T, Dims> centroid() const noexcept
+		{
+			return (vertices_[0] + vertices_[1] + vertices_[2]) / T{ 3 };
+		}
+
+		// Unnormalized, counter-clockwise winding faces the viewer
+		constexpr stm::vector<T, 3> normal() const noexcept requires (Dims == 3)
+		{
+			return stm::cross(vertices_[1] - vertices_[0], vertices_[2] - vertices_[0]);
+		}
+
+		constexpr triangle& translate(const stm::vector<T, Dims>& translation) noexcept
+		{
+			for (auto& vertex : vertices_)
+				vertex += translation;
+			return *this;
+		}
+
+		constexpr friend bool operator==(const triangle& lhs, const triangle& rhs) noexcept
+		{
+			return lhs.vertices_ == rhs.vertices_;
+		}
+
+		constexpr friend bool operator!=(const triangle& lhs, const triangle& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
 	private:
-		stm::point<T, Dims> origin_;
-		stm::point<T, Dims> normal_;
+		std::array<stm::point<T, Dims>, 3> vertices_{};
+	};
+
+	template<Real T, std::size_t Dims>
+	constexpr aabb<T, Dims> bounds(const aabb<T, Dims>& box) noexcept
+	{
+		return box;
+	}
+
+	template<Real T, std::size_t Dims>
+	constexpr aabb<T, Dims> bounds(const sphere<T, Dims>& sphere) noexcept
+	{
+		stm::vector<T, Dims> extents;
+		for (std::size_t i = 0; i < Dims; ++i)
+			extents[i] = sphere.radius();
+		return aabb<T, Dims>::from_center_extents(sphere.origin(), extents);
+	}
+
+	template<Real T, std::size_t Dims>
+	constexpr aabb<T, Dims> bounds(const triangle<T, Dims>& triangle) noexcept
+	{
+		return aabb<T, Dims>{ triangle[0], triangle[0] }.expand(triangle[1]).expand(triangle[2]);
+	}
+
+	// Clip space depth range of the projection a frustum is extracted from
+	enum class clip_depth
+	{
+		zero_to_one,		// Vulkan/D3D, stm::perspective
+		negative_one_to_one	// OpenGL, stm::orthographic
+	};
+
+	// View frustum as six inward facing planes: left, right, bottom, top, near, far
+	template<Float T>
+	class frustum
+	{
+	public:
+		enum plane_index : std::size_t { left_plane, right_plane, bottom_plane, top_plane, near_plane, far_plane, plane_count };
+
+		constexpr frustum() noexcept = default;
+
+		// Gribb-Hartmann extraction for column vectors (clip = m * p), planes come out normalized
+		constexpr frustum(const stm::matrix<T, 4, 4>& view_projection, clip_depth depth = clip_depth::zero_to_one) noexcept
+		{
+			const auto& m = view_projection;
+			auto row_plane = [&m](std::size_t row, T sign) {
+				return stm::vector<T, 4>{ m[3][0] + sign * m[row][0], m[3][1] + sign * m[row][1],
+										  m[3][2] + sign * m[row][2], m[3][3] + sign * m[row][3] };
+			};
+
+			const stm::vector<T, 4> rows[plane_count] = {
+				row_plane(0, T{ 1 }), row_plane(0, T{ -1 }),
+				row_plane(1, T{ 1 }), row_plane(1, T{ -1 }),
+				depth == clip_depth::zero_to_one ? stm::vector<T, 4>{ m[2][0], m[2][1], m[2][2], m[2][3] } : row_plane(2, T{ 1 }),
+				row_plane(2, T{ -1 })
+			};
+
+			for (std::size_t i = 0; i < plane_count; ++i)
+			{
+				planes_[i] = plane<T, 3>{ stm::vector<T, 3>{ rows[i].x, rows[i].y, rows[i].z }, rows[i].w };
+				planes_[i].normalize();
+			}
+		}
+
+		constexpr const plane<T, 3>& operator[](std::size_t index) const noexcept { return planes_[index]; }
+		constexpr const auto& planes() const noexcept { return planes_; }
+
+		constexpr bool contains(const stm::point<T, 3>& point) const noexcept
+		{
+			for (const auto& p : planes_)
+				if (p.signed_distance(point) < T{ 0 })
+					return false;
+			return true;
+		}
+
+		// Conservative tests, bounds straddling a corner outside the frustum may report true
+		constexpr bool intersects(const sphere<T, 3>& bounds) const noexcept
+		{
+			for (const auto& p : planes_)
+				if (p.signed_distance(bounds.origin()) < -bounds.radius())
+					return false;
+			return true;
+		}
+
+		constexpr bool intersects(const aabb<T, 3>& bounds) const noexcept
+		{
+			const auto center = bounds.center();
+			const auto extents = bounds.extents();
+			for (const auto& p : planes_)
+			{
+				const auto& n = p.normal();
+				const T radius = extents.x * stm::abs(n.x) + extents.y * stm::abs(n.y) + extents.z * stm::abs(n.z);
+				if (p.signed_distance(center) < -radius)
+					return false;
+			}
+			return true;
+		}
+
+	private:
+		std::array<plane<T, 3>, plane_count> planes_{};
 	};
 
 	template<Real T, std::size_t Dims>
@@ -170,11 +491,114 @@ namespace stm
 		}
 	}
 
+	// Slab test, returns the entry and exit parameters of the line through the ray
+	template<Real T, std::size_t Dims>
+	constexpr std::pair<std::size_t, std::array<T, 2>> intersection(const ray<T, Dims>& ray, const aabb<T, Dims>& box) noexcept
+	{
+		T entry = std::numeric_limits<T>::lowest();
+		T exit = std::numeric_limits<T>::max();
+
+		for (std::size_t i = 0; i < Dims; ++i)
+		{
+			const T origin = ray.origin()[i];
+			const T direction = ray.direction()[i];
+			if (direction == T{ 0 })
+			{
+				if (origin < box.min()[i] || origin > box.max()[i])
+					return { 0, std::array<T, 2>{} };
+				continue;
+			}
+
+			T t0 = (box.min()[i] - origin) / direction;
+			T t1 = (box.max()[i] - origin) / direction;
+			if (t0 > t1)
+				std::swap(t0, t1);
+			entry = t0 > entry ? t0 : entry;
+			exit = t1 < exit ? t1 : exit;
+			if (entry > exit)
+				return { 0, std::array<T, 2>{} };
+		}
+
+		return { 2, std::array<T, 2>{ entry, exit } };
+	}
+
+	// Moller-Trumbore, returns the ray parameter and the barycentric coordinates of vertices 1 and 2
+	template<Real T>
+	constexpr std::pair<std::size_t, std::array<T, 3>> intersection(const ray<T, 3>& ray, const triangle<T, 3>& triangle) noexcept
+	{
+		const auto edge1 = triangle[1] - triangle[0];
+		const auto edge2 = triangle[2] - triangle[0];
+		const auto p = stm::cross(ray.direction(), edge2);
+		const T determinant = edge1 * p;
+
+		if (stm::abs(determinant) <= std::numeric_limits<T>::epsilon() * (edge1.norm() + edge2.norm()))
+			return { 0, std::array<T, 3>{} };
+
+		const T inverse = T{ 1 } / determinant;
+		const auto s = ray.origin() - triangle[0];
+		const T u = (s * p) * inverse;
+		if (u < T{ 0 } || u > T{ 1 })
+			return { 0, std::array<T, 3>{} };
+
+		const auto q = stm::cross(s, edge1);
+		const T v = (ray.direction() * q) * inverse;
+		if (v < T{ 0 } || u + v > T{ 1 })
+			return { 0, std::array<T, 3>{} };
+
+		return { 1, std::array<T, 3>{ (edge2 * q) * inverse, u, v } };
+	}
+
+	// Closest hit of a ray query, no_primitive when nothing was hit
+	template<Float T>
+	struct ray_hit
+	{
+		static constexpr std::uint32_t no_primitive = ~std::uint32_t{ 0 };
+
+		T distance = std::numeric_limits<T>::infinity();
+		std::uint32_t primitive = no_primitive;	// index of the primitive in the queried collection
+
+		constexpr explicit operator bool() const noexcept { return primitive != no_primitive; }
+	};
+
+	// Nearest surface point along the ray with t >= 0, infinity on a miss
+	template<Float T>
+	constexpr T hit_distance(const ray<T, 3>& ray, const sphere<T, 3>& sphere) noexcept
+	{
+		const auto [count, roots] = intersection(ray, sphere);
+		const T near_root = count == 2 ? roots[1] : roots[0];
+		if (count != 0 && near_root >= T{ 0 })
+			return near_root;
+		if (count == 2 && roots[0] >= T{ 0 })
+			return roots[0];
+		return std::numeric_limits<T>::infinity();
+	}
+
+	template<Float T>
+	constexpr T hit_distance(const ray<T, 3>& ray, const aabb<T, 3>& box) noexcept
+	{
+		const auto [count, range] = intersection(ray, box);
+		if (count != 0 && range[0] >= T{ 0 })
+			return range[0];
+		if (count != 0 && range[1] >= T{ 0 })
+			return range[1];
+		return std::numeric_limits<T>::infinity();
+	}
+
+	template<Float T>
+	constexpr T hit_distance(const ray<T, 3>& ray, const triangle<T, 3>& triangle) noexcept
+	{
+		const auto [count, hit] = intersection(ray, triangle);
+		return count != 0 && hit[0] >= T{ 0 } ? hit[0] : std::numeric_limits<T>::infinity();
+	}
+
 	template<Number T>
 	using circle = sphere<T, 2>;
 
 	template<Number T>
 	using sphere3 = sphere<T, 3>;
+
+	template<Number T>
+	using triangle3 = triangle<T, 3>;
 }
 
 #endif /* STM_GEOMETRY_H */
\ No newline at end of file
@@ -0,0 +1,168 @@
+#ifndef STM_GEOMETRY_SOA_H
+#define STM_GEOMETRY_SOA_H
+
+#include "common.h"
+#include "geometry.h"
+
+#include <span>
+#include <vector>
+
+/*
+	Structure of arrays containers for the batch kernels in culling.h and intersection.h,
+	every component lives in its own contiguous stream so eight elements load as one register
+*/
+namespace stm
+{
+	// Bounding boxes stored as separate center and extent streams for batch culling
+	template<Real T>
+	class aabb_soa
+	{
+	public:
+		constexpr std::size_t size() const noexcept { return center_x_.size(); }
+		constexpr bool empty() const noexcept { return center_x_.empty(); }
+
+		constexpr void reserve(std::size_t capacity)
+		{
+			for (auto* stream : { &center_x_, &center_y_, &center_z_, &extent_x_, &extent_y_, &extent_z_ })
+				stream->reserve(capacity);
+		}
+
+		constexpr void clear() noexcept
+		{
+			for (auto* stream : { &center_x_, &center_y_, &center_z_, &extent_x_, &extent_y_, &extent_z_ })
+				stream->clear();
+		}
+
+		constexpr void push_back(const aabb<T, 3>& box)
+		{
+			const auto center = box.center();
+			const auto extents = box.extents();
+			center_x_.push_back(center.x);
+			center_y_.push_back(center.y);
+			center_z_.push_back(center.z);
+			extent_x_.push_back(extents.x);
+			extent_y_.push_back(extents.y);
+			extent_z_.push_back(extents.z);
+		}
+
+		constexpr aabb<T, 3> operator[](std::size_t index) const noexcept
+		{
+			return aabb<T, 3>::from_center_extents({ center_x_[index], center_y_[index], center_z_[index] },
+												   { extent_x_[index], extent_y_[index], extent_z_[index] });
+		}
+
+		constexpr std::span<const T> center_x() const noexcept { return center_x_; }
+		constexpr std::span<const T> center_y() const noexcept { return center_y_; }
+		constexpr std::span<const T> center_z() const noexcept { return center_z_; }
+		constexpr std::span<const T> extent_x() const noexcept { return extent_x_; }
+		constexpr std::span<const T> extent_y() const noexcept { return extent_y_; }
+		constexpr std::span<const T> extent_z() const noexcept { return extent_z_; }
+
+	private:
+		std::vector<T> center_x_;
+		std::vector<T> center_y_;
+		std::vector<T> center_z_;
+		std::vector<T> extent_x_;
+		std::vector<T> extent_y_;
+		std::vector<T> extent_z_;
+	};
+
+	// Bounding spheres stored as separate origin and radius streams for batch culling
+	template<Real T>
+	class sphere_soa
+	{
+	public:
+		constexpr std::size_t size() const noexcept { return origin_x_.size(); }
+		constexpr bool empty() const noexcept { return origin_x_.empty(); }
+
+		constexpr void reserve(std::size_t capacity)
+		{
+			for (auto* stream : { &origin_x_, &origin_y_, &origin_z_, &radius_ })
+				stream->reserve(capacity);
+		}
+
+		constexpr void clear() noexcept
+		{
+			for (auto* stream : { &origin_x_, &origin_y_, &origin_z_, &radius_ })
+				stream->clear();
+		}
+
+		constexpr void push_back(const sphere<T, 3>& bounds)
+		{
+			origin_x_.push_back(bounds.origin().x);
+			origin_y_.push_back(bounds.origin().y);
+			origin_z_.push_back(bounds.origin().z);
+			radius_.push_back(bounds.radius());
+		}
+
+		constexpr sphere<T, 3> operator[](std::size_t index) const noexcept
+		{
+			return sphere<T, 3>{ radius_[index], { origin_x_[index], origin_y_[index], origin_z_[index] } };
+		}
+
+		constexpr std::span<const T> origin_x() const noexcept { return origin_x_; }
+		constexpr std::span<const T> origin_y() const noexcept { return origin_y_; }
+		constexpr std::span<const T> origin_z() const noexcept { return origin_z_; }
+		constexpr std::span<const T> radius() const noexcept { return radius_; }
+
+	private:
+		std::vector<T> origin_x_;
+		std::vector<T> origin_y_;
+		std::vector<T> origin_z_;
+		std::vector<T> radius_;
+	};
+
+	// Rays stored as separate origin and direction streams for batch intersection
+	template<Real T>
+	class ray_soa
+	{
+	public:
+		constexpr std::size_t size() const noexcept { return origin_x_.size(); }
+		constexpr bool empty() const noexcept { return origin_x_.empty(); }
+
+		constexpr void reserve(std::size_t capacity)
+		{
+			for (auto* stream : { &origin_x_, &origin_y_, &origin_z_, &direction_x_, &direction_y_, &direction_z_ })
+				stream->reserve(capacity);
+		}
+
+		constexpr void clear() noexcept
+		{
+			for (auto* stream : { &origin_x_, &origin_y_, &origin_z_, &direction_x_, &direction_y_, &direction_z_ })
+				stream->clear();
+		}
+
+		constexpr void push_back(const ray<T, 3>& ray)
+		{
+			origin_x_.push_back(ray.origin().x);
+			origin_y_.push_back(ray.origin().y);
+			origin_z_.push_back(ray.origin().z);
+			direction_x_.push_back(ray.direction().x);
+			direction_y_.push_back(ray.direction().y);
+			direction_z_.push_back(ray.direction().z);
+		}
+
+		constexpr ray<T, 3> operator[](std::size_t index) const noexcept
+		{
+			return ray<T, 3>{ { origin_x_[index], origin_y_[index], origin_z_[index] },
+							  { direction_x_[index], direction_y_[index], direction_z_[index] } };
+		}
+
+		constexpr std::span<const T> origin_x() const noexcept { return origin_x_; }
+		constexpr std::span<const T> origin_y() const noexcept { return origin_y_; }
+		constexpr std::span<const T> origin_z() const noexcept { return origin_z_; }
+		constexpr std::span<const T> direction_x() const noexcept { return direction_x_; }
+		constexpr std::span<const T> direction_y() const noexcept { return direction_y_; }
+		constexpr std::span<const T> direction_z() const noexcept { return direction_z_; }
+
+	private:
+		std::vector<T> origin_x_;
+		std::vector<T> origin_y_;
+		std::vector<T> origin_z_;
+		std::vector<T> direction_x_;
+		std::vector<T> direction_y_;
+		std::vector<T> direction_z_;
+	};
+}
+
+#endif /* STM_GEOMETRY_SOA_H */
@@ -0,0 +1,202 @@
+#ifndef STM_INTERSECTION_H
+#define STM_INTERSECTION_H
+
+#include "common.h"
+#include "geometry.h"
+#include "geometry_soa.h"
+#include "simd.h"
+
+#include <bit>
+#include <span>
+
+namespace stm
+{
+	// Compact record of a ray that hit something, indices refer to the queried batches
+	template<Float T>
+	struct sphere_hit
+	{
+		T distance;
+		std::uint32_t ray;
+		std::uint32_t sphere;
+	};
+
+	/*
+		Batch ray-sphere queries. Distances follow hit_distance(ray, sphere): nearest surface
+		point with t >= 0 in units of the ray direction length, only hits below max_distance count.
+	*/
+	template<Float T>
+	constexpr ray_hit<T> intersect_nearest(const ray<T, 3>& ray, const sphere_soa<T>& spheres,
+										   T max_distance = std::numeric_limits<T>::infinity()) noexcept
+	{
+		ray_hit<T> hit{ max_distance, ray_hit<T>::no_primitive };
+		for (std::size_t i = 0; i < spheres.size(); ++i)
+		{
+			const T distance = hit_distance(ray, spheres[i]);
+			if (distance < hit.distance)
+				hit = { distance, static_cast<std::uint32_t>(i) };
+		}
+		return hit;
+	}
+
+	// Nearest sphere of every ray, writes one record per ray that hit and returns their count
+	template<Float T>
+	constexpr std::size_t intersect_nearest(const ray_soa<T>& rays, const sphere_soa<T>& spheres, std::span<sphere_hit<T>> hits,
+											T max_distance = std::numeric_limits<T>::infinity()) noexcept
+	{
+		assert(hits.size() >= rays.size());
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			const auto hit = intersect_nearest(rays[i], spheres, max_distance);
+			if (hit)
+				hits[count++] = { hit.distance, static_cast<std::uint32_t>(i), hit.primitive };
+		}
+		return count;
+	}
+
+	namespace intern
+	{
+		// Loads count values and pads the remaining lanes with NaN, which fails every hit test
+		template<typename Wide>
+		inline Wide load_padded(const float* data, std::size_t count) noexcept
+		{
+			if (count >= Wide::width)
+				return Wide::load(data);
+
+			float values[Wide::width];
+			for (std::size_t i = 0; i < Wide::width; ++i)
+				values[i] = i < count ? data[i] : std::numeric_limits<float>::quiet_NaN();
+			return Wide::load(values);
+		}
+
+		/*
+			Branchless nearest root of |o + t d - c| = r for t >= 0. oc is o - c, a is dot(d, d).
+			Lanes without a valid root come out as NaN or negative and fail the caller's range test.
+		*/
+		template<typename Wide>
+		inline Wide sphere_distance(Wide ocx, Wide ocy, Wide ocz, Wide dx, Wide dy, Wide dz,
+									Wide radius, Wide inverse_a, Wide a) noexcept
+		{
+			const auto b = fmadd(dx, ocx, fmadd(dy, ocy, dz * ocz));
+			const auto c = fmadd(ocx, ocx, fmadd(ocy, ocy, ocz * ocz)) - radius * radius;
+			const auto discriminant = b * b - a * c;
+			const auto root = sqrt(max(discriminant, Wide::zero()));
+			const auto near_root = (-b - root) * inverse_a;
+			const auto far_root = (root - b) * inverse_a;
+			const auto distance = select(near_root >= Wide::zero(), near_root, far_root);
+			return select(discriminant >= Wide::zero(), distance, Wide::broadcast(-1.0f));
+		}
+	}
+
+	// One ray against eight spheres per iteration
+	inline ray_hit<float> intersect_nearest(const ray<float, 3>& ray, const sphere_soa<float>& spheres,
+											float max_distance = std::numeric_limits<float>::infinity()) noexcept
+	{
+		using wide = simd::float8;
+
+		const auto& o = ray.origin();
+		const auto& d = ray.direction();
+		const float a = d * d;
+		const auto wide_a = wide::broadcast(a), inverse_a = wide::broadcast(1.0f / a);
+		const auto ox = wide::broadcast(o.x), oy = wide::broadcast(o.y), oz = wide::broadcast(o.z);
+		const auto dx = wide::broadcast(d.x), dy = wide::broadcast(d.y), dz = wide::broadcast(d.z);
+
+		const float* cx = spheres.origin_x().data();
+		const float* cy = spheres.origin_y().data();
+		const float* cz = spheres.origin_z().data();
+		const float* radii = spheres.radius().data();
+
+		// Tracks the block of the best hit per lane as a float, exact below 2^24 blocks
+		auto best_distance = wide::broadcast(max_distance);
+		auto best_block = wide::broadcast(-1.0f);
+		for (std::size_t i = 0; i < spheres.size(); i += wide::width)
+		{
+			const std::size_t remaining = spheres.size() - i;
+			const auto ocx = ox - intern::load_padded<wide>(cx + i, remaining);
+			const auto ocy = oy - intern::load_padded<wide>(cy + i, remaining);
+			const auto ocz = oz - intern::load_padded<wide>(cz + i, remaining);
+			const auto radius = intern::load_padded<wide>(radii + i, remaining);
+
+			const auto distance = intern::sphere_distance(ocx, ocy, ocz, dx, dy, dz, radius, inverse_a, wide_a);
+			const auto closer = (distance >= wide::zero()) & (distance < best_distance);
+			best_distance = select(closer, distance, best_distance);
+			best_block = select(closer, wide::broadcast(static_cast<float>(i / wide::width)), best_block);
+		}
+
+		float distances[wide::width];
+		float blocks[wide::width];
+		best_distance.store(distances);
+		best_block.store(blocks);
+
+		ray_hit<float> hit{ max_distance, ray_hit<float>::no_primitive };
+		for (std::size_t lane = 0; lane < wide::width; ++lane)
+		{
+			if (blocks[lane] < 0.0f)
+				continue;
+
+			const auto index = static_cast<std::uint32_t>(static_cast<std::size_t>(blocks[lane]) * wide::width + lane);
+			if (distances[lane] < hit.distance || (distances[lane] == hit.distance && index < hit.primitive))
+				hit = { distances[lane], index };
+		}
+		return hit;
+	}
+
+	// Eight rays per iteration against every sphere, suited to many rays over few spheres
+	inline std::size_t intersect_nearest(const ray_soa<float>& rays, const sphere_soa<float>& spheres, std::span<sphere_hit<float>> hits,
+										 float max_distance = std::numeric_limits<float>::infinity()) noexcept
+	{
+		using wide = simd::float8;
+		assert(hits.size() >= rays.size());
+
+		const float* rox = rays.origin_x().data();
+		const float* roy = rays.origin_y().data();
+		const float* roz = rays.origin_z().data();
+		const float* rdx = rays.direction_x().data();
+		const float* rdy = rays.direction_y().data();
+		const float* rdz = rays.direction_z().data();
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < rays.size(); i += wide::width)
+		{
+			const std::size_t remaining = rays.size() - i;
+			const auto ox = intern::load_padded<wide>(rox + i, remaining);
+			const auto oy = intern::load_padded<wide>(roy + i, remaining);
+			const auto oz = intern::load_padded<wide>(roz + i, remaining);
+			const auto dx = intern::load_padded<wide>(rdx + i, remaining);
+			const auto dy = intern::load_padded<wide>(rdy + i, remaining);
+			const auto dz = intern::load_padded<wide>(rdz + i, remaining);
+			const auto a = fmadd(dx, dx, fmadd(dy, dy, dz * dz));
+			const auto inverse_a = wide::broadcast(1.0f) / a;
+
+			// Sphere indices are selected as raw bit patterns, the float value is never used
+			auto best_distance = wide::broadcast(max_distance);
+			auto best_sphere = wide::broadcast(std::bit_cast<float>(ray_hit<float>::no_primitive));
+			for (std::size_t j = 0; j < spheres.size(); ++j)
+			{
+				const auto center = spheres[j].origin();
+				const auto radius = wide::broadcast(spheres[j].radius());
+				const auto distance = intern::sphere_distance(ox - wide::broadcast(center.x), oy - wide::broadcast(center.y), oz - wide::broadcast(center.z),
+															  dx, dy, dz, radius, inverse_a, a);
+				const auto closer = (distance >= wide::zero()) & (distance < best_distance);
+				best_distance = select(closer, distance, best_distance);
+				best_sphere = select(closer, wide::broadcast(std::bit_cast<float>(static_cast<std::uint32_t>(j))), best_sphere);
+			}
+
+			float distances[wide::width];
+			float indices[wide::width];
+			best_distance.store(distances);
+			best_sphere.store(indices);
+
+			const int mask = movemask(best_distance < wide::broadcast(max_distance));
+			for (auto lanes = static_cast<unsigned int>(mask); lanes != 0; lanes &= lanes - 1)
+			{
+				const auto lane = static_cast<std::size_t>(std::countr_zero(lanes));
+				hits[count++] = { distances[lane], static_cast<std::uint32_t>(i + lane), std::bit_cast<std::uint32_t>(indices[lane]) };
+			}
+		}
+		return count;
+	}
+}
+
+#endif /* STM_INTERSECTION_H */
@@ -1,6 +1,7 @@
 #ifndef STM_MATH_H
 #define STM_MATH_H
 
+#include "fast_math.h"
 #include "math_internal.h"
 #include "units.h"
 
@@ -80,60 +81,98 @@ namespace stm
 			return stm::sqrt(norm(value));
 	}
 
-	template<Real T>
+	// The precision parameter selects the fast_math.h approximations for float, see fast_math.h for their error bounds
+	template<Real T, precision P = default_precision>
 	inline constexpr T tan(const T& x) noexcept
 	{
-		if (std::is_constant_evaluated())
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::tan(x);
+		else if (std::is_constant_evaluated())
 			return const_tan(x);
 		else
 			return static_cast<T>(std::tan(x));
 	}
 
-	template<Real T, Angle_unit_type Unit>
+	template<Real T, Angle_unit_type Unit, precision P = default_precision>
 	inline constexpr T tan(const angle_unit<T, Unit>& x) noexcept
 	{
-		return stm::tan(radian<T>(x).value);
+		return stm::tan<T, P>(radian<T>(x).value);
 	}
 
-	template<Real T>
+	template<Real T, precision P = default_precision>
 	inline constexpr T sin(const T& x) noexcept
 	{
-		if (std::is_constant_evaluated())
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::sin(x);
+		else if (std::is_constant_evaluated())
 			return const_sin(x);
 		else
 			return static_cast<T>(std::sin(x));
 	}
 
-	template<Real T, Angle_unit_type Unit>
+	template<Real T, Angle_unit_type Unit, precision P = default_precision>
 	inline constexpr T sin(const angle_unit<T, Unit>& x) noexcept
 	{
-		return stm::sin(radian<T>(x).value);
+		return stm::sin<T, P>(radian<T>(x).value);
 	}
 
-	template<Real T>
+	template<Real T, precision P = default_precision>
 	inline constexpr T cos(const T& x) noexcept
 	{
-		if (std::is_constant_evaluated())
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::cos(x);
+		else if (std::is_constant_evaluated())
 			return const_cos(x);
 		else
 			return static_cast<T>(std::cos(x));
 	}
 
-	template<Real T, Angle_unit_type Unit>
+	template<Real T, Angle_unit_type Unit, precision P = default_precision>
 	inline constexpr T cos(const angle_unit<T, Unit>& x) noexcept
 	{
-		return stm::cos(radian<T>(x).value);
+		return stm::cos<T, P>(radian<T>(x).value);
 	}
 
-	template<Real T>
+	// Both values of one angle, sharing the argument reduction on the fast path
+	template<Real T, precision P = default_precision>
+	inline constexpr sincos_result<T> sincos(const T& x) noexcept
+	{
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::sincos(x);
+		else if (std::is_constant_evaluated())
+			return { const_sin(x), const_cos(x) };
+		else
+			return { static_cast<T>(std::sin(x)), static_cast<T>(std::cos(x)) };
+	}
+
+	template<Real T, Angle_unit_type Unit, precision P = default_precision>
+	inline constexpr sincos_result<T> sincos(const angle_unit<T, Unit>& x) noexcept
+	{
+		return stm::sincos<T, P>(radian<T>(x).value);
+	}
+
+	template<Real T, precision P = default_precision>
 	inline constexpr T atan2(const T& y, const T& x) noexcept
 	{
-		if (std::is_constant_evaluated())
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::atan2(y, x);
+		else if (std::is_constant_evaluated())
 			return const_atan2(y, x);
 		else
 			return static_cast<T>(std::atan2(y, x));
 	}
 
+	template<Float T, precision P = default_precision>
+	inline constexpr T rsqrt(const T& x) noexcept
+	{
+		if constexpr (P == precision::fast && std::same_as<T, float>)
+			return fast::rsqrt(x);
+		else if (std::is_constant_evaluated())
+			return T{ 1 } / const_sqrt(x);
+		else
+			return T{ 1 } / std::sqrt(x);
+	}
+
 	template<Real T>
 	inline constexpr T asin(const T& x) noexcept
 	{
@@ -4,6 +4,9 @@
 #include "common.h"
 #include "comparison.h"
 #include "ranges.h"
+#include "simd.h"
+
+#include <type_traits>
 
 namespace stm
 {
@@ -109,6 +112,492 @@ namespace stm
 		return res;
 	}
 
+	/*
+		Determinants and inverses. 2x2, 3x3 and 4x4 use closed forms, larger matrices Gaussian
+		elimination with partial pivoting. 3x3 and 4x4 float run on SSE outside of constant
+		evaluation. Singular matrices are not detected, their inverse has non-finite entries,
+		check the determinant first when that can happen.
+	*/
+	namespace intern
+	{
+		template<Number T>
+		constexpr T abs_value(const T& value) noexcept { return value < T{0} ? -value : value; }
+
+		// Rows of the cofactor matrix of a 3x3 block, each one the cross product of the other two rows
+		template<Number T, std::size_t N>
+		constexpr sqmatrix<T, 3> cofactors3(const sqmatrix<T, N>& m) noexcept
+		{
+			sqmatrix<T, 3> out;
+			out[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+			out[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+			out[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+			out[1][0] = m[2][1] * m[0][2] - m[2][2] * m[0][1];
+			out[1][1] = m[2][2] * m[0][0] - m[2][0] * m[0][2];
+			out[1][2] = m[2][0] * m[0][1] - m[2][1] * m[0][0];
+			out[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+			out[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+			out[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+			return out;
+		}
+
+		template<Float T, std::size_t N>
+		constexpr sqmatrix<T, N> gauss_jordan_inverse(sqmatrix<T, N> m) noexcept
+		{
+			sqmatrix<T, N> out = identity<T, N>();
+			for (std::size_t column = 0; column < N; ++column)
+			{
+				std::size_t pivot = column;
+				for (std::size_t row = column + 1; row < N; ++row)
+					if (abs_value(m[row][column]) > abs_value(m[pivot][column]))
+						pivot = row;
+
+				if (pivot != column)
+				{
+					for (std::size_t k = 0; k < N; ++k)
+					{
+						std::swap(m[pivot][k], m[column][k]);
+						std::swap(out[pivot][k], out[column][k]);
+					}
+				}
+
+				const T scale = T{1} / m[column][column];
+				for (std::size_t k = 0; k < N; ++k)
+				{
+					m[column][k] *= scale;
+					out[column][k] *= scale;
+				}
+
+				for (std::size_t row = 0; row < N; ++row)
+				{
+					if (row == column)
+						continue;
+
+					const T factor = m[row][column];
+					for (std::size_t k = 0; k < N; ++k)
+					{
+						m[row][k] -= factor * m[column][k];
+						out[row][k] -= factor * out[column][k];
+					}
+				}
+			}
+			return out;
+		}
+
+		template<Float T, std::size_t N>
+		constexpr T elimination_determinant(sqmatrix<T, N> m) noexcept
+		{
+			T det{1};
+			for (std::size_t column = 0; column < N; ++column)
+			{
+				std::size_t pivot = column;
+				for (std::size_t row = column + 1; row < N; ++row)
+					if (abs_value(m[row][column]) > abs_value(m[pivot][column]))
+						pivot = row;
+
+				if (m[pivot][column] == T{0})
+					return T{0};
+
+				if (pivot != column)
+				{
+					for (std::size_t k = column; k < N; ++k)
+						std::swap(m[pivot][k], m[column][k]);
+					det = -det;
+				}
+
+				det *= m[column][column];
+				for (std::size_t row = column + 1; row < N; ++row)
+				{
+					const T factor = m[row][column] / m[column][column];
+					for (std::size_t k = column; k < N; ++k)
+						m[row][k] -= factor * m[column][k];
+				}
+			}
+			return det;
+		}
+
+	#ifdef STM_SIMD_SSE2
+		#define STM_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+		// 2x2 blocks stored row-major in one register: A * B, adj(A) * B and A * adj(B)
+		inline __m128 mat2_mul(__m128 lhs, __m128 rhs) noexcept
+		{
+			return _mm_add_ps(_mm_mul_ps(lhs, STM_SHUFFLE(rhs, rhs, 0, 3, 0, 3)),
+							  _mm_mul_ps(STM_SHUFFLE(lhs, lhs, 1, 0, 3, 2), STM_SHUFFLE(rhs, rhs, 2, 1, 2, 1)));
+		}
+
+		inline __m128 mat2_adj_mul(__m128 lhs, __m128 rhs) noexcept
+		{
+			return _mm_sub_ps(_mm_mul_ps(STM_SHUFFLE(lhs, lhs, 3, 3, 0, 0), rhs),
+							  _mm_mul_ps(STM_SHUFFLE(lhs, lhs, 1, 1, 2, 2), STM_SHUFFLE(rhs, rhs, 2, 3, 0, 1)));
+		}
+
+		inline __m128 mat2_mul_adj(__m128 lhs, __m128 rhs) noexcept
+		{
+			return _mm_sub_ps(_mm_mul_ps(lhs, STM_SHUFFLE(rhs, rhs, 3, 0, 3, 0)),
+							  _mm_mul_ps(STM_SHUFFLE(lhs, lhs, 1, 0, 3, 2), STM_SHUFFLE(rhs, rhs, 2, 1, 2, 1)));
+		}
+
+		// Block inverse with 2x2 sub-matrices, needs no horizontal adds beyond the trace
+		inline sqmatrix<float, 4> inverse4_sse(const sqmatrix<float, 4>& m) noexcept
+		{
+			const __m128 row0 = _mm_loadu_ps(m[0]);
+			const __m128 row1 = _mm_loadu_ps(m[1]);
+			const __m128 row2 = _mm_loadu_ps(m[2]);
+			const __m128 row3 = _mm_loadu_ps(m[3]);
+
+			const __m128 a = _mm_movelh_ps(row0, row1);
+			const __m128 b = _mm_movehl_ps(row1, row0);
+			const __m128 c = _mm_movelh_ps(row2, row3);
+			const __m128 d = _mm_movehl_ps(row3, row2);
+
+			// |A| |B| |C| |D|
+			const __m128 det_sub = _mm_sub_ps(
+				_mm_mul_ps(STM_SHUFFLE(row0, row2, 0, 2, 0, 2), STM_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+				_mm_mul_ps(STM_SHUFFLE(row0, row2, 1, 3, 1, 3), STM_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+			const __m128 det_a = STM_SHUFFLE(det_sub, det_sub, 0, 0, 0, 0);
+			const __m128 det_b = STM_SHUFFLE(det_sub, det_sub, 1, 1, 1, 1);
+			const __m128 det_c = STM_SHUFFLE(det_sub, det_sub, 2, 2, 2, 2);
+			const __m128 det_d = STM_SHUFFLE(det_sub, det_sub, 3, 3, 3, 3);
+
+			const __m128 d_c = mat2_adj_mul(d, c);
+			const __m128 a_b = mat2_adj_mul(a, b);
+
+			// Adjugates of the blocks of the inverse
+			__m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul(b, d_c));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_mul(c, a_b));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj(d, a_b));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj(a, d_c));
+
+			// |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+			__m128 trace = _mm_mul_ps(a_b, STM_SHUFFLE(d_c, d_c, 0, 2, 1, 3));
+			trace = _mm_add_ps(trace, STM_SHUFFLE(trace, trace, 1, 0, 3, 2));
+			trace = _mm_add_ps(trace, STM_SHUFFLE(trace, trace, 2, 3, 0, 1));
+			const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+
+			const __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+			x = _mm_mul_ps(x, inv_det);
+			y = _mm_mul_ps(y, inv_det);
+			z = _mm_mul_ps(z, inv_det);
+			w = _mm_mul_ps(w, inv_det);
+
+			sqmatrix<float, 4> out;
+			_mm_storeu_ps(out[0], STM_SHUFFLE(x, y, 3, 1, 3, 1));
+			_mm_storeu_ps(out[1], STM_SHUFFLE(x, y, 2, 0, 2, 0));
+			_mm_storeu_ps(out[2], STM_SHUFFLE(z, w, 3, 1, 3, 1));
+			_mm_storeu_ps(out[3], STM_SHUFFLE(z, w, 2, 0, 2, 0));
+			return out;
+		}
+
+		inline __m128 cross3(__m128 lhs, __m128 rhs) noexcept
+		{
+			const __m128 product = _mm_sub_ps(_mm_mul_ps(lhs, STM_SHUFFLE(rhs, rhs, 1, 2, 0, 3)),
+											  _mm_mul_ps(STM_SHUFFLE(lhs, lhs, 1, 2, 0, 3), rhs));
+			return STM_SHUFFLE(product, product, 1, 2, 0, 3);
+		}
+
+		// Cofactor rows as cross products of the 3x3 block, inverse_transpose skips the final transpose
+		template<bool Transpose, std::size_t N>
+		inline sqmatrix<float, 3> inverse3_sse(const sqmatrix<float, N>& m) noexcept
+		{
+			const __m128 row0 = _mm_setr_ps(m[0][0], m[0][1], m[0][2], 0.0f);
+			const __m128 row1 = _mm_setr_ps(m[1][0], m[1][1], m[1][2], 0.0f);
+			const __m128 row2 = _mm_setr_ps(m[2][0], m[2][1], m[2][2], 0.0f);
+
+			__m128 cofactor0 = cross3(row1, row2);
+			__m128 cofactor1 = cross3(row2, row0);
+			__m128 cofactor2 = cross3(row0, row1);
+
+			__m128 det = _mm_mul_ps(row0, cofactor0);
+			det = _mm_add_ps(det, STM_SHUFFLE(det, det, 1, 0, 3, 2));
+			det = _mm_add_ps(det, STM_SHUFFLE(det, det, 2, 3, 0, 1));
+			const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+			if constexpr (Transpose)
+			{
+				__m128 unused = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(cofactor0, cofactor1, cofactor2, unused);
+			}
+
+			alignas(16) float rows[12];
+			_mm_store_ps(rows, _mm_mul_ps(cofactor0, inv_det));
+			_mm_store_ps(rows + 4, _mm_mul_ps(cofactor1, inv_det));
+			_mm_store_ps(rows + 8, _mm_mul_ps(cofactor2, inv_det));
+
+			sqmatrix<float, 3> out;
+			for (std::size_t row = 0; row < 3; ++row)
+				for (std::size_t column = 0; column < 3; ++column)
+					out[row][column] = rows[row * 4 + column];
+			return out;
+		}
+
+		// Transposes the 3x3 block (already divided by the determinant) and appends -block * translation
+		inline sqmatrix<float, 4> affine_inverse_rows_sse(__m128 col0, __m128 col1, __m128 col2,
+														  __m128 row0, __m128 row1, __m128 row2) noexcept
+		{
+			__m128 translation = _mm_add_ps(_mm_mul_ps(col0, STM_SHUFFLE(row0, row0, 3, 3, 3, 3)),
+											_mm_mul_ps(col1, STM_SHUFFLE(row1, row1, 3, 3, 3, 3)));
+			translation = _mm_add_ps(translation, _mm_mul_ps(col2, STM_SHUFFLE(row2, row2, 3, 3, 3, 3)));
+			translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+
+			_MM_TRANSPOSE4_PS(col0, col1, col2, translation);
+
+			sqmatrix<float, 4> out;
+			_mm_storeu_ps(out[0], col0);
+			_mm_storeu_ps(out[1], col1);
+			_mm_storeu_ps(out[2], col2);
+			_mm_storeu_ps(out[3], translation);
+			return out;
+		}
+
+		inline sqmatrix<float, 4> inverse_affine_sse(const sqmatrix<float, 4>& m) noexcept
+		{
+			const __m128 mask_xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+			const __m128 row0 = _mm_loadu_ps(m[0]);
+			const __m128 row1 = _mm_loadu_ps(m[1]);
+			const __m128 row2 = _mm_loadu_ps(m[2]);
+			const __m128 block0 = _mm_and_ps(row0, mask_xyz);
+			const __m128 block1 = _mm_and_ps(row1, mask_xyz);
+			const __m128 block2 = _mm_and_ps(row2, mask_xyz);
+
+			const __m128 cofactor0 = cross3(block1, block2);
+			const __m128 cofactor1 = cross3(block2, block0);
+			const __m128 cofactor2 = cross3(block0, block1);
+
+			__m128 det = _mm_mul_ps(block0, cofactor0);
+			det = _mm_add_ps(det, STM_SHUFFLE(det, det, 1, 0, 3, 2));
+			det = _mm_add_ps(det, STM_SHUFFLE(det, det, 2, 3, 0, 1));
+			const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+			return affine_inverse_rows_sse(_mm_mul_ps(cofactor0, inv_det), _mm_mul_ps(cofactor1, inv_det),
+										   _mm_mul_ps(cofactor2, inv_det), row0, row1, row2);
+		}
+
+		inline sqmatrix<float, 4> inverse_rigid_sse(const sqmatrix<float, 4>& m) noexcept
+		{
+			const __m128 mask_xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+			const __m128 row0 = _mm_loadu_ps(m[0]);
+			const __m128 row1 = _mm_loadu_ps(m[1]);
+			const __m128 row2 = _mm_loadu_ps(m[2]);
+
+			return affine_inverse_rows_sse(_mm_and_ps(row0, mask_xyz), _mm_and_ps(row1, mask_xyz),
+										   _mm_and_ps(row2, mask_xyz), row0, row1, row2);
+		}
+
+		#undef STM_SHUFFLE
+	#endif
+	}
+
+	template<Number T, std::size_t N>
+	constexpr T determinant(const sqmatrix<T, N>& m) noexcept
+	{
+		if constexpr (N == 1)
+		{
+			return m[0][0];
+		}
+		else if constexpr (N == 2)
+		{
+			return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+		}
+		else if constexpr (N == 3)
+		{
+			const auto cofactors = intern::cofactors3(m);
+			return m[0][0] * cofactors[0][0] + m[0][1] * cofactors[0][1] + m[0][2] * cofactors[0][2];
+		}
+		else if constexpr (N == 4)
+		{
+			const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+			const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+			const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+			const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+			const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+			const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+			const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+			const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+			const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+			const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+			const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+			const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+		else
+		{
+			static_assert(Float<T>, "determinants above 4x4 need a floating point type");
+			return intern::elimination_determinant(m);
+		}
+	}
+
+	template<Float T, std::size_t N>
+	constexpr sqmatrix<T, N> inverse(const sqmatrix<T, N>& m) noexcept
+	{
+		if constexpr (N == 1)
+		{
+			sqmatrix<T, 1> out;
+			out[0][0] = T{1} / m[0][0];
+			return out;
+		}
+		else if constexpr (N == 2)
+		{
+			const T inv_det = T{1} / determinant(m);
+			sqmatrix<T, 2> out;
+			out[0][0] =  m[1][1] * inv_det;
+			out[0][1] = -m[0][1] * inv_det;
+			out[1][0] = -m[1][0] * inv_det;
+			out[1][1] =  m[0][0] * inv_det;
+			return out;
+		}
+		else if constexpr (N == 3)
+		{
+		#ifdef STM_SIMD_SSE2
+			if constexpr (std::is_same_v<T, float>)
+				if (!std::is_constant_evaluated())
+					return intern::inverse3_sse<true>(m);
+		#endif
+
+			// The inverse is the transposed cofactor matrix over the determinant
+			const auto cofactors = intern::cofactors3(m);
+			const T inv_det = T{1} / (m[0][0] * cofactors[0][0] + m[0][1] * cofactors[0][1] + m[0][2] * cofactors[0][2]);
+			sqmatrix<T, 3> out;
+			for (std::size_t row = 0; row < 3; ++row)
+				for (std::size_t column = 0; column < 3; ++column)
+					out[row][column] = cofactors[column][row] * inv_det;
+			return out;
+		}
+		else if constexpr (N == 4)
+		{
+		#ifdef STM_SIMD_SSE2
+			if constexpr (std::is_same_v<T, float>)
+				if (!std::is_constant_evaluated())
+					return intern::inverse4_sse(m);
+		#endif
+
+			const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+			const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+			const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+			const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+			const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+			const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+			const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+			const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+			const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+			const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+			const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+			const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+			const T inv_det = T{1} / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+			sqmatrix<T, 4> out;
+			out[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_det;
+			out[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv_det;
+			out[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_det;
+			out[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv_det;
+			out[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv_det;
+			out[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_det;
+			out[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv_det;
+			out[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_det;
+			out[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_det;
+			out[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv_det;
+			out[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_det;
+			out[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv_det;
+			out[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv_det;
+			out[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_det;
+			out[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv_det;
+			out[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_det;
+			return out;
+		}
+		else
+		{
+			return intern::gauss_jordan_inverse(m);
+		}
+	}
+
+	// Inverse of a 4x4 with a bottom row of 0 0 0 1 (any rotation, scale and shear plus translation)
+	template<Float T>
+	constexpr sqmatrix<T, 4> inverse_affine(const sqmatrix<T, 4>& m) noexcept
+	{
+	#ifdef STM_SIMD_SSE2
+		if constexpr (std::is_same_v<T, float>)
+			if (!std::is_constant_evaluated())
+				return intern::inverse_affine_sse(m);
+	#endif
+
+		const auto cofactors = intern::cofactors3(m);
+		const T inv_det = T{1} / (m[0][0] * cofactors[0][0] + m[0][1] * cofactors[0][1] + m[0][2] * cofactors[0][2]);
+
+		sqmatrix<T, 4> out;
+		for (std::size_t row = 0; row < 3; ++row)
+		{
+			out[row][0] = cofactors[0][row] * inv_det;
+			out[row][1] = cofactors[1][row] * inv_det;
+			out[row][2] = cofactors[2][row] * inv_det;
+			out[row][3] = -(out[row][0] * m[0][3] + out[row][1] * m[1][3] + out[row][2] * m[2][3]);
+		}
+		out[3][3] = T{1};
+		return out;
+	}
+
+	// Inverse of a rotation plus translation, the rotation block has to be orthonormal
+	template<Float T>
+	constexpr sqmatrix<T, 4> inverse_rigid(const sqmatrix<T, 4>& m) noexcept
+	{
+	#ifdef STM_SIMD_SSE2
+		if constexpr (std::is_same_v<T, float>)
+			if (!std::is_constant_evaluated())
+				return intern::inverse_rigid_sse(m);
+	#endif
+
+		sqmatrix<T, 4> out;
+		for (std::size_t row = 0; row < 3; ++row)
+		{
+			out[row][0] = m[0][row];
+			out[row][1] = m[1][row];
+			out[row][2] = m[2][row];
+			out[row][3] = -(m[0][row] * m[0][3] + m[1][row] * m[1][3] + m[2][row] * m[2][3]);
+		}
+		out[3][3] = T{1};
+		return out;
+	}
+
+	template<Float T, std::size_t N>
+	constexpr sqmatrix<T, N> inverse_transpose(const sqmatrix<T, N>& m) noexcept
+	{
+		if constexpr (N == 3)
+		{
+		#ifdef STM_SIMD_SSE2
+			if constexpr (std::is_same_v<T, float>)
+				if (!std::is_constant_evaluated())
+					return intern::inverse3_sse<false>(m);
+		#endif
+
+			auto cofactors = intern::cofactors3(m);
+			const T inv_det = T{1} / (m[0][0] * cofactors[0][0] + m[0][1] * cofactors[0][1] + m[0][2] * cofactors[0][2]);
+			for (std::size_t row = 0; row < 3; ++row)
+				for (std::size_t column = 0; column < 3; ++column)
+					cofactors[row][column] *= inv_det;
+			return cofactors;
+		}
+		else
+		{
+			return inverse(m).transpose();
+		}
+	}
+
+	// Transforms normals by the model matrix m, the inverse transpose of its upper 3x3 block
+	template<Float T>
+	constexpr sqmatrix<T, 3> normal_matrix(const sqmatrix<T, 4>& m) noexcept
+	{
+	#ifdef STM_SIMD_SSE2
+		if constexpr (std::is_same_v<T, float>)
+			if (!std::is_constant_evaluated())
+				return intern::inverse3_sse<false>(m);
+	#endif
+
+		auto cofactors = intern::cofactors3(m);
+		const T inv_det = T{1} / (m[0][0] * cofactors[0][0] + m[0][1] * cofactors[0][1] + m[0][2] * cofactors[0][2]);
+		for (std::size_t row = 0; row < 3; ++row)
+			for (std::size_t column = 0; column < 3; ++column)
+				cofactors[row][column] *= inv_det;
+		return cofactors;
+	}
+
 	using mat4f = matrix<float, 4, 4>;
 	using mat3f = matrix<float, 3, 3>;
 	using mat2f = matrix<float, 2, 2>;
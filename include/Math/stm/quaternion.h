@@ -2,9 +2,19 @@
 #define STM_QUATERNION_H
 
 #include "common.h"
+#include "math.h"
+#include "matrix.h"
+#include "vector3.h"
+
+#include <span>
 
 namespace stm
 {
+	/*
+		r + i*i + j*j + k*k stored as four plain values, trivially copyable and 4 * sizeof(T) bytes.
+		Rotations are unit quaternions and follow the column vector convention of the matrices in
+		spatial_transform.h, so a * b applies b first.
+	*/
 	template<Real T>
 	class quaternion
 	{
@@ -15,14 +25,55 @@ namespace stm
 		constexpr quaternion() noexcept = default;
 		constexpr quaternion(const quaternion&) noexcept = default;
 		constexpr quaternion(quaternion&&) noexcept = default;
+		constexpr quaternion& operator=(const quaternion&) noexcept = default;
+		constexpr quaternion& operator=(quaternion&&) noexcept = default;
 		~quaternion() noexcept = default;
 
-		constexpr quaternion(std::span<T, 4> data) noexcept
+		constexpr quaternion(std::span<const T, 4> data) noexcept
 			: r{data[0]}, i{data[1]}, j{data[2]}, k{data[3]} {}
 		constexpr quaternion(T r, T i, T j, T k) noexcept
 			: r{r}, i{i}, j{j}, k{k} {}
+		constexpr quaternion(T real, const vector<T, 3>& imaginary) noexcept
+			: r{real}, i{imaginary.x}, j{imaginary.y}, k{imaginary.z} {}
+
+		static constexpr quaternion identity() noexcept { return { T{1}, T{0}, T{0}, T{0} }; }
+
+		// Rotation of angle radians around a unit axis
+		template<precision P = default_precision>
+		static constexpr quaternion from_axis_angle(const vector<T, 3>& axis, T angle) noexcept
+		{
+			const auto [sinHalf, cosHalf] = stm::sincos<T, P>(angle / T{2});
+			return { cosHalf, axis * sinHalf };
+		}
+
+		// Rotation part of a matrix without scale or shear
+		static constexpr quaternion from_matrix(const sqmatrix<T, 3>& m) noexcept { return from_rotation(m); }
+		static constexpr quaternion from_matrix(const sqmatrix<T, 4>& m) noexcept { return from_rotation(m); }
+
+		constexpr T* data() noexcept { return &r; }
+		constexpr const T* data() const noexcept { return &r; }
+		static constexpr std::size_t size() noexcept { return 4; }
+
+		constexpr T& operator[](std::size_t index) noexcept { assert(index < size()); return data()[index]; }
+		constexpr const T& operator[](std::size_t index) const noexcept { assert(index < size()); return data()[index]; }
 
-		friend constexpr quaternion operator*(const quaternion& lhs, const quaternion& rhs) noexcept
+		constexpr T real() const noexcept { return r; }
+		constexpr vector<T, 3> imaginary() const noexcept { return { i, j, k }; }
+
+		constexpr quaternion operator+() const noexcept { return *this; }
+		constexpr quaternion operator-() const noexcept { return { -r, -i, -j, -k }; }
+
+		constexpr friend quaternion operator+(const quaternion& lhs, const quaternion& rhs) noexcept
+		{
+			return { lhs.r + rhs.r, lhs.i + rhs.i, lhs.j + rhs.j, lhs.k + rhs.k };
+		}
+
+		constexpr friend quaternion operator-(const quaternion& lhs, const quaternion& rhs) noexcept
+		{
+			return { lhs.r - rhs.r, lhs.i - rhs.i, lhs.j - rhs.j, lhs.k - rhs.k };
+		}
+
+		constexpr friend quaternion operator*(const quaternion& lhs, const quaternion& rhs) noexcept
 		{
 			return quaternion{
 				lhs.r * rhs.r - lhs.i * rhs.i - lhs.j * rhs.j - lhs.k * rhs.k,
@@ -32,37 +83,173 @@ namespace stm
 			};
 		}
 
-		constexpr T real() const noexcept { return r; }
-		constexpr std::span<T, 3> imaginary() const noexcept { return { &data_[1] }; }
+		constexpr friend quaternion operator/(const quaternion& lhs, const quaternion& rhs) noexcept
+		{
+			return lhs * rhs.inverse();
+		}
+
+		constexpr friend quaternion operator*(const quaternion& lhs, const T& rhs) noexcept
+		{
+			return { lhs.r * rhs, lhs.i * rhs, lhs.j * rhs, lhs.k * rhs };
+		}
+
+		constexpr friend quaternion operator*(const T& lhs, const quaternion& rhs) noexcept
+		{
+			return rhs * lhs;
+		}
+
+		constexpr friend quaternion operator/(const quaternion& lhs, const T& rhs) noexcept
+		{
+			return { lhs.r / rhs, lhs.i / rhs, lhs.j / rhs, lhs.k / rhs };
+		}
+
+		constexpr quaternion& operator+=(const quaternion& rhs) noexcept { return *this = *this + rhs; }
+		constexpr quaternion& operator-=(const quaternion& rhs) noexcept { return *this = *this - rhs; }
+		constexpr quaternion& operator*=(const quaternion& rhs) noexcept { return *this = *this * rhs; }
+		constexpr quaternion& operator/=(const quaternion& rhs) noexcept { return *this = *this / rhs; }
+		constexpr quaternion& operator*=(const T& rhs) noexcept { return *this = *this * rhs; }
+		constexpr quaternion& operator/=(const T& rhs) noexcept { return *this = *this / rhs; }
+
+		constexpr friend bool operator==(const quaternion& lhs, const quaternion& rhs) noexcept
+		{
+			return lhs.r == rhs.r && lhs.i == rhs.i && lhs.j == rhs.j && lhs.k == rhs.k;
+		}
 
 		constexpr quaternion conjugate() const noexcept
 		{
 			return { r, -i , -j , -k };
 		}
 
+		constexpr T norm() const noexcept
+		{
+			return r * r + i * i + j * j + k * k;
+		}
+
 		constexpr T magnitude() const noexcept
 		{
-			return std::sqrt(r * r + i * i + j * j + k * k);
+			return stm::sqrt(norm());
+		}
+
+		constexpr quaternion unit() const noexcept
+		{
+			return *this / magnitude();
 		}
 
+		// Equal to the conjugate for unit quaternions
 		constexpr quaternion inverse() const noexcept
 		{
-			return conjugate() / magnitude();
+			return conjugate() / norm();
 		}
 
-		T& r = data_[0];
-		T& i = data_[1];
-		T& j = data_[2];
-		T& k = data_[3];
+		// Rotates vec by this unit quaternion, cheaper than q * vec * q^-1
+		constexpr vector<T, 3> rotate(const vector<T, 3>& vec) const noexcept
+		{
+			const vector<T, 3> axis{ i, j, k };
+			const auto t = cross(axis, vec) * T{2};
+			return vec + t * r + cross(axis, t);
+		}
+
+		constexpr sqmatrix<T, 3> to_matrix3() const noexcept
+		{
+			sqmatrix<T, 3> out;
+			write_rotation(out);
+			return out;
+		}
+
+		constexpr sqmatrix<T, 4> to_matrix4() const noexcept
+		{
+			sqmatrix<T, 4> out;
+			write_rotation(out);
+			out[3][3] = T{1};
+			return out;
+		}
 
-		constexpr T& operator[](std::size_t i) noexcept { return data_[i]; }
-		constexpr const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+		T r;
+		T i;
+		T j;
+		T k;
 
 	private:
-		std::array<T, 4> data_;
+		template<typename Matrix>
+		constexpr void write_rotation(Matrix& out) const noexcept
+		{
+			const T ii = i * i, jj = j * j, kk = k * k;
+			const T ij = i * j, ik = i * k, jk = j * k;
+			const T ri = r * i, rj = r * j, rk = r * k;
+
+			out[0][0] = T{1} - T{2} * (jj + kk);
+			out[0][1] = T{2} * (ij - rk);
+			out[0][2] = T{2} * (ik + rj);
+			out[1][0] = T{2} * (ij + rk);
+			out[1][1] = T{1} - T{2} * (ii + kk);
+			out[1][2] = T{2} * (jk - ri);
+			out[2][0] = T{2} * (ik - rj);
+			out[2][1] = T{2} * (jk + ri);
+			out[2][2] = T{1} - T{2} * (ii + jj);
+		}
+
+		// Shepperd's method, branches on the largest diagonal term to stay well conditioned
+		template<typename Matrix>
+		static constexpr quaternion from_rotation(const Matrix& m) noexcept
+		{
+			const T trace = m[0][0] + m[1][1] + m[2][2];
+			if (trace > T{0})
+			{
+				const T s = stm::sqrt(trace + T{1}) * T{2};
+				return { s / T{4}, (m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s };
+			}
+			else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+			{
+				const T s = stm::sqrt(T{1} + m[0][0] - m[1][1] - m[2][2]) * T{2};
+				return { (m[2][1] - m[1][2]) / s, s / T{4}, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s };
+			}
+			else if (m[1][1] > m[2][2])
+			{
+				const T s = stm::sqrt(T{1} + m[1][1] - m[0][0] - m[2][2]) * T{2};
+				return { (m[0][2] - m[2][0]) / s, (m[0][1] + m[1][0]) / s, s / T{4}, (m[1][2] + m[2][1]) / s };
+			}
+			else
+			{
+				const T s = stm::sqrt(T{1} + m[2][2] - m[0][0] - m[1][1]) * T{2};
+				return { (m[1][0] - m[0][1]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, s / T{4} };
+			}
+		}
 	};
 
+	template<Real T>
+	inline constexpr T dot(const quaternion<T>& lhs, const quaternion<T>& rhs) noexcept
+	{
+		return lhs.r * rhs.r + lhs.i * rhs.i + lhs.j * rhs.j + lhs.k * rhs.k;
+	}
+
+	// Normalized linear interpolation along the shorter arc, constant cost but uneven angular speed
+	template<Float T>
+	inline constexpr quaternion<T> nlerp(const quaternion<T>& from, const quaternion<T>& to, T t) noexcept
+	{
+		const quaternion<T> target = dot(from, to) < T{0} ? -to : to;
+		return (from * (T{1} - t) + target * t).unit();
+	}
+
+	// Spherical linear interpolation along the shorter arc, falls back to nlerp for nearly equal rotations
+	template<Float T, precision P = default_precision>
+	inline constexpr quaternion<T> slerp(const quaternion<T>& from, const quaternion<T>& to, T t) noexcept
+	{
+		T cosTheta = dot(from, to);
+		const quaternion<T> target = cosTheta < T{0} ? -to : to;
+		cosTheta = cosTheta < T{0} ? -cosTheta : cosTheta;
+
+		if (cosTheta > T{0.9995})
+			return nlerp(from, target, t);
+
+		const T sinTheta = stm::sqrt(T{1} - cosTheta * cosTheta);
+		const T theta = stm::atan2<T, P>(sinTheta, cosTheta);
+		const T from_weight = stm::sin<T, P>((T{1} - t) * theta) / sinTheta;
+		const T to_weight = stm::sin<T, P>(t * theta) / sinTheta;
+		return from * from_weight + target * to_weight;
+	}
+
 	using quatf = quaternion<float>;
+	using quatd = quaternion<double>;
 }
 
-#endif /* STM_QUATERNION_H */
\ No newline at end of file
+#endif /* STM_QUATERNION_H */
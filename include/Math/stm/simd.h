@@ -0,0 +1,310 @@
+#ifndef STM_SIMD_H
+#define STM_SIMD_H
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+/*
+	Thin SIMD wrappers used by the batch kernels (culling, intersection, ...)
+
+	float4 maps to SSE, float8 to AVX when compiled with AVX (/arch:AVX, -mavx) and to
+	two float4 otherwise. Define STM_DISABLE_SIMD to force the scalar fallback.
+	Comparisons return lane masks (all bits set or clear) usable with select/movemask.
+	Loads and stores are unaligned. rsqrt_estimate has about 12 bits of precision on SSE/AVX
+	and is exact in the scalar fallback, refine it with a Newton step where it matters.
+*/
+#ifndef STM_DISABLE_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define STM_SIMD_SSE2
+	#endif
+
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		#define STM_SIMD_SSE41
+	#endif
+
+	#if defined(__AVX__)
+		#define STM_SIMD_AVX
+	#endif
+
+	// GCC and Clang only enable FMA with -mfma, MSVC has no FMA macro but /arch:AVX2 implies it
+	#if defined(__FMA__) || (defined(_MSC_VER) && !defined(__clang__) && defined(__AVX2__))
+		#define STM_SIMD_FMA
+	#endif
+#endif
+
+#if defined(STM_SIMD_SSE2) || defined(STM_SIMD_AVX)
+	#include <immintrin.h>
+#endif
+
+namespace stm
+{
+	namespace simd
+	{
+		class float4
+		{
+		public:
+			static constexpr std::size_t width = 4;
+
+			float4() noexcept = default;
+
+		#ifdef STM_SIMD_SSE2
+			explicit float4(__m128 value) noexcept : value_{ value } {}
+
+			static float4 zero() noexcept { return float4{ _mm_setzero_ps() }; }
+			static float4 broadcast(float value) noexcept { return float4{ _mm_set1_ps(value) }; }
+			static float4 set(float x, float y, float z, float w) noexcept { return float4{ _mm_setr_ps(x, y, z, w) }; }
+			static float4 load(const float* data) noexcept { return float4{ _mm_loadu_ps(data) }; }
+			void store(float* data) const noexcept { _mm_storeu_ps(data, value_); }
+
+			__m128 native() const noexcept { return value_; }
+
+			friend float4 operator+(float4 lhs, float4 rhs) noexcept { return float4{ _mm_add_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator-(float4 lhs, float4 rhs) noexcept { return float4{ _mm_sub_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator*(float4 lhs, float4 rhs) noexcept { return float4{ _mm_mul_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator/(float4 lhs, float4 rhs) noexcept { return float4{ _mm_div_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator-(float4 value) noexcept { return float4{ _mm_xor_ps(value.value_, _mm_set1_ps(-0.0f)) }; }
+
+			friend float4 operator&(float4 lhs, float4 rhs) noexcept { return float4{ _mm_and_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator|(float4 lhs, float4 rhs) noexcept { return float4{ _mm_or_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator^(float4 lhs, float4 rhs) noexcept { return float4{ _mm_xor_ps(lhs.value_, rhs.value_) }; }
+			friend float4 andnot(float4 mask, float4 value) noexcept { return float4{ _mm_andnot_ps(mask.value_, value.value_) }; }
+
+			friend float4 operator<(float4 lhs, float4 rhs) noexcept { return float4{ _mm_cmplt_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator<=(float4 lhs, float4 rhs) noexcept { return float4{ _mm_cmple_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator>(float4 lhs, float4 rhs) noexcept { return float4{ _mm_cmpgt_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator>=(float4 lhs, float4 rhs) noexcept { return float4{ _mm_cmpge_ps(lhs.value_, rhs.value_) }; }
+			friend float4 operator==(float4 lhs, float4 rhs) noexcept { return float4{ _mm_cmpeq_ps(lhs.value_, rhs.value_) }; }
+
+			friend float4 min(float4 lhs, float4 rhs) noexcept { return float4{ _mm_min_ps(lhs.value_, rhs.value_) }; }
+			friend float4 max(float4 lhs, float4 rhs) noexcept { return float4{ _mm_max_ps(lhs.value_, rhs.value_) }; }
+			friend float4 sqrt(float4 value) noexcept { return float4{ _mm_sqrt_ps(value.value_) }; }
+			friend float4 abs(float4 value) noexcept { return float4{ _mm_andnot_ps(_mm_set1_ps(-0.0f), value.value_) }; }
+			friend float4 rsqrt_estimate(float4 value) noexcept { return float4{ _mm_rsqrt_ps(value.value_) }; }
+
+			// Nearest integer, ties to even
+			friend float4 round(float4 value) noexcept
+			{
+			#ifdef STM_SIMD_SSE41
+				return float4{ _mm_round_ps(value.value_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) };
+			#else
+				// Magnitudes from 2^23 up are already integers and may not fit the 32 bit conversion
+				const __m128 rounded = _mm_cvtepi32_ps(_mm_cvtps_epi32(value.value_));
+				const __m128 small = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), value.value_), _mm_set1_ps(8388608.0f));
+				return float4{ _mm_or_ps(_mm_and_ps(small, rounded), _mm_andnot_ps(small, value.value_)) };
+			#endif
+			}
+
+			// mask ? lhs : rhs
+			friend float4 select(float4 mask, float4 lhs, float4 rhs) noexcept
+			{
+				return float4{ _mm_or_ps(_mm_and_ps(mask.value_, lhs.value_), _mm_andnot_ps(mask.value_, rhs.value_)) };
+			}
+
+			friend int movemask(float4 mask) noexcept { return _mm_movemask_ps(mask.value_); }
+
+			friend float4 fmadd(float4 a, float4 b, float4 c) noexcept
+			{
+			#ifdef STM_SIMD_FMA
+				return float4{ _mm_fmadd_ps(a.value_, b.value_, c.value_) };
+			#else
+				return float4{ _mm_add_ps(_mm_mul_ps(a.value_, b.value_), c.value_) };
+			#endif
+			}
+
+		private:
+			__m128 value_;
+		#else
+			static float4 zero() noexcept { return broadcast(0.0f); }
+			static float4 broadcast(float value) noexcept { return set(value, value, value, value); }
+			static float4 set(float x, float y, float z, float w) noexcept { float4 out; out.value_[0] = x; out.value_[1] = y; out.value_[2] = z; out.value_[3] = w; return out; }
+			static float4 load(const float* data) noexcept { return set(data[0], data[1], data[2], data[3]); }
+			void store(float* data) const noexcept { for (std::size_t i = 0; i < width; ++i) data[i] = value_[i]; }
+
+			template<typename F>
+			friend float4 apply(float4 lhs, float4 rhs, F function) noexcept
+			{
+				float4 out;
+				for (std::size_t i = 0; i < width; ++i)
+					out.value_[i] = function(lhs.value_[i], rhs.value_[i]);
+				return out;
+			}
+
+			static float from_mask(bool value) noexcept { return std::bit_cast<float>(value ? 0xFFFFFFFFu : 0u); }
+			static std::uint32_t bits(float value) noexcept { return std::bit_cast<std::uint32_t>(value); }
+
+			friend float4 operator+(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a + b; }); }
+			friend float4 operator-(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a - b; }); }
+			friend float4 operator*(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a * b; }); }
+			friend float4 operator/(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a / b; }); }
+			friend float4 operator-(float4 value) noexcept { return zero() - value; }
+
+			friend float4 operator&(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return std::bit_cast<float>(bits(a) & bits(b)); }); }
+			friend float4 operator|(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return std::bit_cast<float>(bits(a) | bits(b)); }); }
+			friend float4 operator^(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return std::bit_cast<float>(bits(a) ^ bits(b)); }); }
+			friend float4 andnot(float4 mask, float4 value) noexcept { return apply(mask, value, [](float a, float b) { return std::bit_cast<float>(~bits(a) & bits(b)); }); }
+
+			friend float4 operator<(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return from_mask(a < b); }); }
+			friend float4 operator<=(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return from_mask(a <= b); }); }
+			friend float4 operator>(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return from_mask(a > b); }); }
+			friend float4 operator>=(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return from_mask(a >= b); }); }
+			friend float4 operator==(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return from_mask(a == b); }); }
+
+			// Same NaN behaviour as minps/maxps, the second operand is returned when unordered
+			friend float4 min(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a < b ? a : b; }); }
+			friend float4 max(float4 lhs, float4 rhs) noexcept { return apply(lhs, rhs, [](float a, float b) { return a > b ? a : b; }); }
+			friend float4 sqrt(float4 value) noexcept { return apply(value, value, [](float a, float) { return std::sqrt(a); }); }
+			friend float4 abs(float4 value) noexcept { return apply(value, value, [](float a, float) { return std::fabs(a); }); }
+			friend float4 rsqrt_estimate(float4 value) noexcept { return apply(value, value, [](float a, float) { return 1.0f / std::sqrt(a); }); }
+			friend float4 round(float4 value) noexcept { return apply(value, value, [](float a, float) { return std::nearbyint(a); }); }
+
+			friend float4 select(float4 mask, float4 lhs, float4 rhs) noexcept { return (mask & lhs) | andnot(mask, rhs); }
+
+			friend int movemask(float4 mask) noexcept
+			{
+				int out = 0;
+				for (std::size_t i = 0; i < width; ++i)
+					out |= static_cast<int>(bits(mask.value_[i]) >> 31) << i;
+				return out;
+			}
+
+			friend float4 fmadd(float4 a, float4 b, float4 c) noexcept { return a * b + c; }
+
+		private:
+			float value_[4];
+		#endif
+
+		public:
+			float operator[](std::size_t index) const noexcept
+			{
+				float values[width];
+				store(values);
+				return values[index];
+			}
+		};
+
+		class float8
+		{
+		public:
+			static constexpr std::size_t width = 8;
+
+			float8() noexcept = default;
+
+		#ifdef STM_SIMD_AVX
+			explicit float8(__m256 value) noexcept : value_{ value } {}
+
+			static float8 zero() noexcept { return float8{ _mm256_setzero_ps() }; }
+			static float8 broadcast(float value) noexcept { return float8{ _mm256_set1_ps(value) }; }
+			static float8 load(const float* data) noexcept { return float8{ _mm256_loadu_ps(data) }; }
+			void store(float* data) const noexcept { _mm256_storeu_ps(data, value_); }
+
+			__m256 native() const noexcept { return value_; }
+
+			friend float8 operator+(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_add_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator-(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_sub_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator*(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_mul_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator/(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_div_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator-(float8 value) noexcept { return float8{ _mm256_xor_ps(value.value_, _mm256_set1_ps(-0.0f)) }; }
+
+			friend float8 operator&(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_and_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator|(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_or_ps(lhs.value_, rhs.value_) }; }
+			friend float8 operator^(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_xor_ps(lhs.value_, rhs.value_) }; }
+			friend float8 andnot(float8 mask, float8 value) noexcept { return float8{ _mm256_andnot_ps(mask.value_, value.value_) }; }
+
+			friend float8 operator<(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_LT_OQ) }; }
+			friend float8 operator<=(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_LE_OQ) }; }
+			friend float8 operator>(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_GT_OQ) }; }
+			friend float8 operator>=(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_GE_OQ) }; }
+			friend float8 operator==(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_EQ_OQ) }; }
+
+			friend float8 min(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_min_ps(lhs.value_, rhs.value_) }; }
+			friend float8 max(float8 lhs, float8 rhs) noexcept { return float8{ _mm256_max_ps(lhs.value_, rhs.value_) }; }
+			friend float8 sqrt(float8 value) noexcept { return float8{ _mm256_sqrt_ps(value.value_) }; }
+			friend float8 abs(float8 value) noexcept { return float8{ _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value.value_) }; }
+			friend float8 rsqrt_estimate(float8 value) noexcept { return float8{ _mm256_rsqrt_ps(value.value_) }; }
+			friend float8 round(float8 value) noexcept { return float8{ _mm256_round_ps(value.value_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+			friend float8 select(float8 mask, float8 lhs, float8 rhs) noexcept { return float8{ _mm256_blendv_ps(rhs.value_, lhs.value_, mask.value_) }; }
+
+			friend int movemask(float8 mask) noexcept { return _mm256_movemask_ps(mask.value_); }
+
+			friend float8 fmadd(float8 a, float8 b, float8 c) noexcept
+			{
+			#ifdef STM_SIMD_FMA
+				return float8{ _mm256_fmadd_ps(a.value_, b.value_, c.value_) };
+			#else
+				return float8{ _mm256_add_ps(_mm256_mul_ps(a.value_, b.value_), c.value_) };
+			#endif
+			}
+
+		private:
+			__m256 value_;
+		#else
+			float8(float4 low, float4 high) noexcept : low_{ low }, high_{ high } {}
+
+			static float8 zero() noexcept { return { float4::zero(), float4::zero() }; }
+			static float8 broadcast(float value) noexcept { return { float4::broadcast(value), float4::broadcast(value) }; }
+			static float8 load(const float* data) noexcept { return { float4::load(data), float4::load(data + 4) }; }
+			void store(float* data) const noexcept { low_.store(data); high_.store(data + 4); }
+
+			friend float8 operator+(float8 lhs, float8 rhs) noexcept { return { lhs.low_ + rhs.low_, lhs.high_ + rhs.high_ }; }
+			friend float8 operator-(float8 lhs, float8 rhs) noexcept { return { lhs.low_ - rhs.low_, lhs.high_ - rhs.high_ }; }
+			friend float8 operator*(float8 lhs, float8 rhs) noexcept { return { lhs.low_ * rhs.low_, lhs.high_ * rhs.high_ }; }
+			friend float8 operator/(float8 lhs, float8 rhs) noexcept { return { lhs.low_ / rhs.low_, lhs.high_ / rhs.high_ }; }
+			friend float8 operator-(float8 value) noexcept { return { -value.low_, -value.high_ }; }
+
+			friend float8 operator&(float8 lhs, float8 rhs) noexcept { return { lhs.low_ & rhs.low_, lhs.high_ & rhs.high_ }; }
+			friend float8 operator|(float8 lhs, float8 rhs) noexcept { return { lhs.low_ | rhs.low_, lhs.high_ | rhs.high_ }; }
+			friend float8 operator^(float8 lhs, float8 rhs) noexcept { return { lhs.low_ ^ rhs.low_, lhs.high_ ^ rhs.high_ }; }
+			friend float8 andnot(float8 mask, float8 value) noexcept { return { andnot(mask.low_, value.low_), andnot(mask.high_, value.high_) }; }
+
+			friend float8 operator<(float8 lhs, float8 rhs) noexcept { return { lhs.low_ < rhs.low_, lhs.high_ < rhs.high_ }; }
+			friend float8 operator<=(float8 lhs, float8 rhs) noexcept { return { lhs.low_ <= rhs.low_, lhs.high_ <= rhs.high_ }; }
+			friend float8 operator>(float8 lhs, float8 rhs) noexcept { return { lhs.low_ > rhs.low_, lhs.high_ > rhs.high_ }; }
+			friend float8 operator>=(float8 lhs, float8 rhs) noexcept { return { lhs.low_ >= rhs.low_, lhs.high_ >= rhs.high_ }; }
+			friend float8 operator==(float8 lhs, float8 rhs) noexcept { return { lhs.low_ == rhs.low_, lhs.high_ == rhs.high_ }; }
+
+			friend float8 min(float8 lhs, float8 rhs) noexcept { return { min(lhs.low_, rhs.low_), min(lhs.high_, rhs.high_) }; }
+			friend float8 max(float8 lhs, float8 rhs) noexcept { return { max(lhs.low_, rhs.low_), max(lhs.high_, rhs.high_) }; }
+			friend float8 sqrt(float8 value) noexcept { return { sqrt(value.low_), sqrt(value.high_) }; }
+			friend float8 abs(float8 value) noexcept { return { abs(value.low_), abs(value.high_) }; }
+			friend float8 rsqrt_estimate(float8 value) noexcept { return { rsqrt_estimate(value.low_), rsqrt_estimate(value.high_) }; }
+			friend float8 round(float8 value) noexcept { return { round(value.low_), round(value.high_) }; }
+
+			friend float8 select(float8 mask, float8 lhs, float8 rhs) noexcept
+			{
+				return { select(mask.low_, lhs.low_, rhs.low_), select(mask.high_, lhs.high_, rhs.high_) };
+			}
+
+			friend int movemask(float8 mask) noexcept { return movemask(mask.low_) | (movemask(mask.high_) << 4); }
+
+			friend float8 fmadd(float8 a, float8 b, float8 c) noexcept { return { fmadd(a.low_, b.low_, c.low_), fmadd(a.high_, b.high_, c.high_) }; }
+
+		private:
+			float4 low_;
+			float4 high_;
+		#endif
+
+		public:
+			float operator[](std::size_t index) const noexcept
+			{
+				float values[width];
+				store(values);
+				return values[index];
+			}
+		};
+
+		template<typename T>
+		concept Wide_float = std::same_as<T, float4> || std::same_as<T, float8>;
+
+		template<typename T>
+		inline bool any(T mask) noexcept { return movemask(mask) != 0; }
+
+		template<typename T>
+		inline bool all(T mask) noexcept { return movemask(mask) == (1 << T::width) - 1; }
+	}
+}
+
+#endif /* STM_SIMD_H */
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "math.h"
 #include "matrix.h"
 #include "quaternion.h"
 #include "vector3.h"
@@ -54,72 +55,73 @@ namespace stm
         return temp;
 	}
 
-    template<Float T>
+    template<Float T, precision P = default_precision>
 	constexpr sqmatrix<T, 4> rotateX(T angleInRads) noexcept
 	{
 		sqmatrix<T, 4> temp = identity<float, 4>();
-		temp[1][1] =  stm::cos(angleInRads);
-		temp[1][2] = -stm::sin(angleInRads);
-		temp[2][1] =  stm::sin(angleInRads);
-		temp[2][2] =  stm::cos(angleInRads);
+		const auto [sinA, cosA] = stm::sincos<T, P>(angleInRads);
+		temp[1][1] =  cosA;
+		temp[1][2] = -sinA;
+		temp[2][1] =  sinA;
+		temp[2][2] =  cosA;
         temp[3][3] = 1.0f;
 		
         return temp;
 	}
 
-    template<Float T>
+    template<Float T, precision P = default_precision>
 	constexpr sqmatrix<T, 4> rotateY(T angleInRads) noexcept
 	{
 		sqmatrix<T, 4> temp = identity<float, 4>();
-		temp[0][0] =  stm::cos(angleInRads);
-		temp[0][2] =  stm::sin(angleInRads);
-		temp[2][0] = -stm::sin(angleInRads);
-		temp[2][2] =  stm::cos(angleInRads);
+		const auto [sinA, cosA] = stm::sincos<T, P>(angleInRads);
+		temp[0][0] =  cosA;
+		temp[0][2] =  sinA;
+		temp[2][0] = -sinA;
+		temp[2][2] =  cosA;
         temp[3][3] = 1;
 		
         return temp;
 	}
 
-    template<Float T>
+    template<Float T, precision P = default_precision>
 	constexpr sqmatrix<T, 4> rotateZ(T angleInRads) noexcept
 	{
 		sqmatrix<T, 4> temp = identity<float, 4>();
-		temp[0][0] =  stm::cos(angleInRads);
-		temp[0][1] = -stm::sin(angleInRads);
-		temp[1][0] =  stm::sin(angleInRads);
-		temp[1][1] =  stm::cos(angleInRads);
+		const auto [sinA, cosA] = stm::sincos<T, P>(angleInRads);
+		temp[0][0] =  cosA;
+		temp[0][1] = -sinA;
+		temp[1][0] =  sinA;
+		temp[1][1] =  cosA;
         temp[3][3] = 1.0f;
 		
         return temp;
 	}
 
-    template<Float T>
+    template<Float T, precision P = default_precision>
 	constexpr sqmatrix<T, 4> rotate(const vector<T, 3>& axis, T angleInRads) noexcept
 	{
 		sqmatrix<T, 4> temp;
-		const auto sinA = stm::sin(angleInRads);
-		const auto cosA = stm::cos(angleInRads);
-		temp[0][0] = cosA + ((1.f - cosA) * (axis.x * axis.x));
-		temp[0][1] = (axis.x * axis.y * (1 - cosA)) - (axis.z * sinA);
-		temp[0][2] = (axis.x * axis.z * (1 - cosA)) + (axis.y * sinA);
-		temp[1][0] = (axis.x * axis.y * (1 - cosA)) + (axis.z * sinA);
-		temp[1][1] = cosA + ((1.f - cosA) * (axis.y * axis.y));
-		temp[1][2] = (axis.y * axis.z * (1 - cosA)) - (axis.x * sinA);
-		temp[2][0] = (axis.x * axis.z * (1 - cosA)) - (axis.y * sinA);
-		temp[2][1] = (axis.y * axis.z * (1 - cosA)) + (axis.x * sinA);
-		temp[2][2] = cosA + ((1.f - cosA) * (axis.z * axis.z));
+		const auto [sinA, cosA] = stm::sincos<T, P>(angleInRads);
+		const T oneMinusCos = T{1} - cosA;
+		const T xy = axis.x * axis.y * oneMinusCos, xz = axis.x * axis.z * oneMinusCos, yz = axis.y * axis.z * oneMinusCos;
+		temp[0][0] = cosA + (oneMinusCos * (axis.x * axis.x));
+		temp[0][1] = xy - (axis.z * sinA);
+		temp[0][2] = xz + (axis.y * sinA);
+		temp[1][0] = xy + (axis.z * sinA);
+		temp[1][1] = cosA + (oneMinusCos * (axis.y * axis.y));
+		temp[1][2] = yz - (axis.x * sinA);
+		temp[2][0] = xz - (axis.y * sinA);
+		temp[2][1] = yz + (axis.x * sinA);
+		temp[2][2] = cosA + (oneMinusCos * (axis.z * axis.z));
 		temp[3][3] = 1.0f;
 
 		return temp;
 	}
 
-    template<Float T>
+    template<Float T, precision P = default_precision>
     constexpr vector<T, 3> rotate(const vector<T, 3>& vec, const vector<T, 3>& axis, T angle) noexcept
     {
-        quaternion<T> func{ std::cos(angle / 2.0f), axis * std::sin(angle / 2.0f) };
-        quaternion<T> out{ 0 , vec };
-        out = (func * out) * func.inverse();
-        return out.imaginary();
+        return quaternion<T>::template from_axis_angle<P>(axis, angle).rotate(vec);
     }
 	
     template<Float T>
@@ -138,12 +140,13 @@ namespace stm
 		return temp;
 	}
 
-	template<Float T>
+	template<Float T, precision P = default_precision>
     constexpr sqmatrix<T, 4> perspective(T FOVRads, T aspectRatio, T zNear, T zFar) noexcept
 	{
 		sqmatrix<T, 4> temp;
-		temp[0][0] = T{1} / (aspectRatio * stm::tan(FOVRads / T{2}));
-		temp[1][1] = T{1} / stm::tan(FOVRads / T{2});
+		const T cotHalfFOV = T{1} / stm::tan<T, P>(FOVRads / T{2});
+		temp[0][0] = cotHalfFOV / aspectRatio;
+		temp[1][1] = cotHalfFOV;
 		temp[2][2] = zFar / (zFar - zNear);
         temp[3][2] = T{1};
         temp[2][3] = -zFar * zNear / (zFar - zNear);
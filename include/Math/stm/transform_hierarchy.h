@@ -0,0 +1,198 @@
+#ifndef STM_TRANSFORM_HIERARCHY_H
+#define STM_TRANSFORM_HIERARCHY_H
+
+#include "common.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "vector3.h"
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace stm
+{
+	/*
+		Scene graph transforms stored as parallel arrays indexed by node, with parents always
+		before their children. update() is a single forward pass that recomputes the local and
+		world matrices of changed nodes and of everything below them, static subtrees cost one
+		flag test per node. Local matrices are translation * rotation * scale.
+	*/
+	template<Float T>
+	class transform_hierarchy
+	{
+	public:
+		using index_type = std::uint32_t;
+
+		static constexpr index_type no_parent = std::numeric_limits<index_type>::max();
+
+		transform_hierarchy() = default;
+
+		void reserve(std::size_t count)
+		{
+			parent_.reserve(count);
+			translation_.reserve(count);
+			rotation_.reserve(count);
+			scale_.reserve(count);
+			local_.reserve(count);
+			world_.reserve(count);
+			dirty_.reserve(count);
+			changed_.reserve(count);
+		}
+
+		// The parent has to exist already, which keeps the arrays in update order
+		index_type add(index_type parent = no_parent,
+					   const vector<T, 3>& translation = { T{0}, T{0}, T{0} },
+					   const quaternion<T>& rotation = quaternion<T>::identity(),
+					   const vector<T, 3>& scale = { T{1}, T{1}, T{1} })
+		{
+			assert(parent == no_parent || parent < size());
+			const auto index = static_cast<index_type>(size());
+
+			parent_.push_back(parent);
+			translation_.push_back(translation);
+			rotation_.push_back(rotation);
+			scale_.push_back(scale);
+			local_.push_back(identity<T, 4>());
+			world_.push_back(identity<T, 4>());
+			dirty_.push_back(1);
+			changed_.push_back(0);
+
+			return index;
+		}
+
+		void clear() noexcept
+		{
+			parent_.clear();
+			translation_.clear();
+			rotation_.clear();
+			scale_.clear();
+			local_.clear();
+			world_.clear();
+			dirty_.clear();
+			changed_.clear();
+			updated_.clear();
+		}
+
+		std::size_t size() const noexcept { return parent_.size(); }
+
+		index_type parent(index_type node) const noexcept { assert(node < size()); return parent_[node]; }
+
+		const vector<T, 3>& translation(index_type node) const noexcept { assert(node < size()); return translation_[node]; }
+		const quaternion<T>& rotation(index_type node) const noexcept { assert(node < size()); return rotation_[node]; }
+		const vector<T, 3>& scale(index_type node) const noexcept { assert(node < size()); return scale_[node]; }
+
+		void set_translation(index_type node, const vector<T, 3>& translation) noexcept
+		{
+			assert(node < size());
+			translation_[node] = translation;
+			dirty_[node] = 1;
+		}
+
+		void set_rotation(index_type node, const quaternion<T>& rotation) noexcept
+		{
+			assert(node < size());
+			rotation_[node] = rotation;
+			dirty_[node] = 1;
+		}
+
+		void set_scale(index_type node, const vector<T, 3>& scale) noexcept
+		{
+			assert(node < size());
+			scale_[node] = scale;
+			dirty_[node] = 1;
+		}
+
+		// Valid after update(), the cached matrices are not refreshed by the setters
+		const sqmatrix<T, 4>& local(index_type node) const noexcept { assert(node < size()); return local_[node]; }
+		const sqmatrix<T, 4>& world(index_type node) const noexcept { assert(node < size()); return world_[node]; }
+		std::span<const sqmatrix<T, 4>> worlds() const noexcept { return world_; }
+
+		// Nodes whose world matrix changed in the last update(), in increasing order
+		std::span<const index_type> updated() const noexcept { return updated_; }
+
+		// Returns how many world matrices were recomputed
+		std::size_t update()
+		{
+			updated_.clear();
+
+			const std::size_t count = size();
+			for (std::size_t node = 0; node < count; ++node)
+			{
+				const index_type parent = parent_[node];
+				const bool parent_changed = parent != no_parent && changed_[parent];
+				changed_[node] = dirty_[node] | static_cast<std::uint8_t>(parent_changed);
+				if (!changed_[node])
+					continue;
+
+				if (dirty_[node])
+				{
+					compose_local(node);
+					dirty_[node] = 0;
+				}
+
+				if (parent == no_parent)
+					world_[node] = local_[node];
+				else
+					multiply_affine(world_[parent], local_[node], world_[node]);
+
+				updated_.push_back(static_cast<index_type>(node));
+			}
+
+			return updated_.size();
+		}
+
+	private:
+		void compose_local(std::size_t node) noexcept
+		{
+			sqmatrix<T, 4>& out = local_[node];
+			const sqmatrix<T, 3> rotation = rotation_[node].to_matrix3();
+			const vector<T, 3>& scale = scale_[node];
+			const vector<T, 3>& translation = translation_[node];
+
+			for (std::size_t row = 0; row < 3; ++row)
+			{
+				out[row][0] = rotation[row][0] * scale.x;
+				out[row][1] = rotation[row][1] * scale.y;
+				out[row][2] = rotation[row][2] * scale.z;
+			}
+			out[0][3] = translation.x;
+			out[1][3] = translation.y;
+			out[2][3] = translation.z;
+			out[3][0] = T{0};
+			out[3][1] = T{0};
+			out[3][2] = T{0};
+			out[3][3] = T{1};
+		}
+
+		// Both operands have a bottom row of 0 0 0 1, so only the top 3x4 block is computed
+		static void multiply_affine(const sqmatrix<T, 4>& lhs, const sqmatrix<T, 4>& rhs, sqmatrix<T, 4>& out) noexcept
+		{
+			for (std::size_t row = 0; row < 3; ++row)
+			{
+				const T a0 = lhs[row][0], a1 = lhs[row][1], a2 = lhs[row][2];
+				out[row][0] = a0 * rhs[0][0] + a1 * rhs[1][0] + a2 * rhs[2][0];
+				out[row][1] = a0 * rhs[0][1] + a1 * rhs[1][1] + a2 * rhs[2][1];
+				out[row][2] = a0 * rhs[0][2] + a1 * rhs[1][2] + a2 * rhs[2][2];
+				out[row][3] = a0 * rhs[0][3] + a1 * rhs[1][3] + a2 * rhs[2][3] + lhs[row][3];
+			}
+			out[3][0] = T{0};
+			out[3][1] = T{0};
+			out[3][2] = T{0};
+			out[3][3] = T{1};
+		}
+
+		std::vector<index_type> parent_;
+		std::vector<vector<T, 3>> translation_;
+		std::vector<quaternion<T>> rotation_;
+		std::vector<vector<T, 3>> scale_;
+		std::vector<sqmatrix<T, 4>> local_;
+		std::vector<sqmatrix<T, 4>> world_;
+		std::vector<std::uint8_t> dirty_;
+		std::vector<std::uint8_t> changed_;
+		std::vector<index_type> updated_;
+	};
+}
+
+#endif /* STM_TRANSFORM_HIERARCHY_H */
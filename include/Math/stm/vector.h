@@ -2,6 +2,7 @@
 #define STM_VECTOR_H
 
 #include "common.h"
+#include "vector_expression.h"
 
 namespace stm
 {
@@ -11,13 +12,31 @@ namespace stm
 	public:
 		using value_type = T;
 		using underlying_num_type = underlying_num_t<T>;
-
+		using expression_tag = intern::vector_expression_tag;
 
 		constexpr vector() noexcept = default;
 		constexpr vector(const vector&) noexcept = default;
 		constexpr vector(vector&&) noexcept = default;
+		constexpr vector& operator=(const vector&) noexcept = default;
+		constexpr vector& operator=(vector&&) noexcept = default;
 		~vector() = default;
 
+		// Evaluates an expression of vector_expression.h in one pass
+		template<typename E> requires compatible_vector_expressions<vector, E>
+		constexpr vector(const E& expression) noexcept
+		{
+			for (std::size_t i = 0; i < size(); ++i)
+				data_[i] = expression[i];
+		}
+
+		template<typename E> requires compatible_vector_expressions<vector, E>
+		constexpr vector& operator=(const E& expression) noexcept
+		{
+			for (std::size_t i = 0; i < size(); ++i)
+				data_[i] = expression[i];
+			return *this;
+		}
+
 		explicit constexpr vector(const std::array<T, Dims>& values) noexcept
 		{
 			std::copy(values.begin(), values.end(), data_);
@@ -52,30 +71,6 @@ namespace stm
 		constexpr T& at(std::size_t index) { if (index >= size()) intern::out_of_bounds_except(index, size()); return data_[index]; }
 		constexpr const T& at(std::size_t index) const { if (index >= size()) intern::out_of_bounds_except(index, size()); return data_[index]; }
 
-		constexpr friend vector operator+(const vector& lhs, const vector& rhs) noexcept
-		{
-			vector out { lhs };
-			return out += rhs;
-		}
-
-		constexpr friend vector operator-(const vector& lhs, const vector& rhs) noexcept
-		{
-			vector out{ lhs };
-			return out -= rhs;
-		}
-
-		constexpr friend vector operator*(const vector& lhs, const T& rhs) noexcept
-		{
-			vector out{ lhs };
-			return out *= rhs;
-		}
-
-		constexpr friend vector operator/(const vector& lhs, const T& rhs) noexcept(noexcept(lhs /= rhs))
-		{
-			vector out{ lhs };
-			return out /= rhs;
-		}
-
 		constexpr friend T operator*(const vector& lhs, const vector& rhs) noexcept
 		{
 			T out{};
@@ -84,14 +79,16 @@ namespace stm
 			return out;
 		}
 
-		constexpr vector& operator+=(const vector& rhs) noexcept
+		template<typename E> requires compatible_vector_expressions<vector, E>
+		constexpr vector& operator+=(const E& rhs) noexcept
 		{
 			for (std::size_t i = 0; i < size(); ++i)
 				data_[i] += rhs[i];
 			return *this;
 		}
 
-		constexpr vector& operator-=(const vector& rhs) noexcept
+		template<typename E> requires compatible_vector_expressions<vector, E>
+		constexpr vector& operator-=(const E& rhs) noexcept
 		{
 			for (std::size_t i = 0; i < size(); ++i)
 				data_[i] -= rhs[i];
@@ -185,7 +182,7 @@ namespace stm
 	template<Number T, std::size_t Dims>
 	inline constexpr T dot(const vector<T, Dims>& lhs, const vector<T, Dims>& rhs) noexcept
 	{
-		return lhs.dot(rhs);
+		return lhs * rhs;
 	}
 
 	template<Number T, std::size_t Dims>
@@ -120,7 +120,7 @@ namespace stm
 
 		constexpr friend bool operator==(const vector& lhs, const vector& rhs) noexcept
 		{
-			return (lhs.x == rhs.x) && (lhs.y == rhs.y);
+			return (lhs.x == rhs.x) && (lhs.y == rhs.y) && (lhs.z == rhs.z);
 		}
 
 		constexpr friend bool operator!=(const vector& lhs, const vector& rhs) noexcept
@@ -124,7 +124,7 @@ namespace stm
 
 		constexpr friend bool operator==(const vector& lhs, const vector& rhs) noexcept
 		{
-			return (lhs.x == rhs.x) && (lhs.y == rhs.y);
+			return (lhs.x == rhs.x) && (lhs.y == rhs.y) && (lhs.z == rhs.z) && (lhs.w == rhs.w);
 		}
 
 		constexpr friend bool operator!=(const vector& lhs, const vector& rhs) noexcept
@@ -161,7 +161,7 @@ namespace stm
 			}
 		}
 
-		operator std::span<T, N>() const noexcept { return { data() }; }
+		operator std::span<T, 4>() const noexcept { return { data() }; }
 		// friend std::ostream& operator<<<T>(std::ostream&, const vector&);
 
 	public:
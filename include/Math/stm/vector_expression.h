@@ -0,0 +1,206 @@
+#ifndef STM_VECTOR_EXPRESSION_H
+#define STM_VECTOR_EXPRESSION_H
+
+#include "common.h"
+
+#include <type_traits>
+#include <utility>
+
+/*
+	Lazy arithmetic for the generic vector (the 2, 3 and 4 dimensional specializations stay eager).
+	a + b * s - c builds a tree of small nodes and runs a single loop when it is assigned or
+	converted to a vector, with no temporary vectors in between. Lvalue vectors are held by
+	reference and rvalues by value, so an expression kept in an auto variable must not outlive
+	the named vectors it was built from. Use eval() to force a vector.
+*/
+namespace stm
+{
+	namespace intern
+	{
+		struct vector_expression_tag {};
+
+		struct add_op
+		{
+			template<typename T>
+			static constexpr T apply(const T& lhs, const T& rhs) noexcept { return lhs + rhs; }
+		};
+
+		struct subtract_op
+		{
+			template<typename T>
+			static constexpr T apply(const T& lhs, const T& rhs) noexcept { return lhs - rhs; }
+		};
+
+		struct multiply_op
+		{
+			template<typename T>
+			static constexpr T apply(const T& lhs, const T& rhs) noexcept { return lhs * rhs; }
+		};
+
+		struct divide_op
+		{
+			template<typename T>
+			static constexpr T apply(const T& lhs, const T& rhs) noexcept { return lhs / rhs; }
+		};
+	}
+
+	// The generic vector and every expression node, the only operands of the lazy operators
+	template<typename E>
+	concept vector_expression = std::same_as<typename std::remove_cvref_t<E>::expression_tag, intern::vector_expression_tag>;
+
+	template<typename Lhs, typename Rhs>
+	concept compatible_vector_expressions = vector_expression<Lhs> && vector_expression<Rhs> &&
+		std::same_as<typename std::remove_cvref_t<Lhs>::value_type, typename std::remove_cvref_t<Rhs>::value_type> &&
+		std::remove_cvref_t<Lhs>::size() == std::remove_cvref_t<Rhs>::size();
+
+	namespace intern
+	{
+		template<typename E>
+		struct is_expression_node : std::false_type {};
+
+		// Named vectors by reference, temporary vectors and all nodes by value
+		template<typename E>
+		using expression_operand = std::conditional_t<
+			std::is_lvalue_reference_v<E> && !is_expression_node<std::remove_cvref_t<E>>::value,
+			const std::remove_cvref_t<E>&,
+			std::remove_cvref_t<E>>;
+	}
+
+	template<typename Lhs, typename Rhs, typename Op>
+	class vector_binary_expression
+	{
+	public:
+		using expression_tag = intern::vector_expression_tag;
+		using value_type = typename std::remove_cvref_t<Lhs>::value_type;
+
+		template<typename L, typename R>
+		constexpr vector_binary_expression(L&& lhs, R&& rhs) noexcept
+			: lhs_{ std::forward<L>(lhs) }, rhs_{ std::forward<R>(rhs) } {}
+
+		static constexpr std::size_t size() noexcept { return std::remove_cvref_t<Lhs>::size(); }
+
+		constexpr value_type operator[](std::size_t index) const noexcept { return Op::apply(lhs_[index], rhs_[index]); }
+
+		constexpr vector<value_type, size()> eval() const noexcept { return *this; }
+
+	private:
+		Lhs lhs_;
+		Rhs rhs_;
+	};
+
+	template<typename Operand, typename Op>
+	class vector_scalar_expression
+	{
+	public:
+		using expression_tag = intern::vector_expression_tag;
+		using value_type = typename std::remove_cvref_t<Operand>::value_type;
+
+		template<typename O>
+		constexpr vector_scalar_expression(O&& operand, const value_type& scalar) noexcept
+			: operand_{ std::forward<O>(operand) }, scalar_{ scalar } {}
+
+		static constexpr std::size_t size() noexcept { return std::remove_cvref_t<Operand>::size(); }
+
+		constexpr value_type operator[](std::size_t index) const noexcept { return Op::apply(operand_[index], scalar_); }
+
+		constexpr vector<value_type, size()> eval() const noexcept { return *this; }
+
+	private:
+		Operand operand_;
+		value_type scalar_;
+	};
+
+	template<typename Operand>
+	class vector_negate_expression
+	{
+	public:
+		using expression_tag = intern::vector_expression_tag;
+		using value_type = typename std::remove_cvref_t<Operand>::value_type;
+
+		template<typename O>
+		explicit constexpr vector_negate_expression(O&& operand) noexcept
+			: operand_{ std::forward<O>(operand) } {}
+
+		static constexpr std::size_t size() noexcept { return std::remove_cvref_t<Operand>::size(); }
+
+		constexpr value_type operator[](std::size_t index) const noexcept { return -operand_[index]; }
+
+		constexpr vector<value_type, size()> eval() const noexcept { return *this; }
+
+	private:
+		Operand operand_;
+	};
+
+	namespace intern
+	{
+		template<typename Lhs, typename Rhs, typename Op>
+		struct is_expression_node<vector_binary_expression<Lhs, Rhs, Op>> : std::true_type {};
+
+		template<typename Operand, typename Op>
+		struct is_expression_node<vector_scalar_expression<Operand, Op>> : std::true_type {};
+
+		template<typename Operand>
+		struct is_expression_node<vector_negate_expression<Operand>> : std::true_type {};
+
+		template<typename E>
+		using expression_value_t = typename std::remove_cvref_t<E>::value_type;
+	}
+
+	template<typename Lhs, typename Rhs> requires compatible_vector_expressions<Lhs, Rhs>
+	constexpr auto operator+(Lhs&& lhs, Rhs&& rhs) noexcept
+	{
+		return vector_binary_expression<intern::expression_operand<Lhs>, intern::expression_operand<Rhs>, intern::add_op>{
+			std::forward<Lhs>(lhs), std::forward<Rhs>(rhs) };
+	}
+
+	template<typename Lhs, typename Rhs> requires compatible_vector_expressions<Lhs, Rhs>
+	constexpr auto operator-(Lhs&& lhs, Rhs&& rhs) noexcept
+	{
+		return vector_binary_expression<intern::expression_operand<Lhs>, intern::expression_operand<Rhs>, intern::subtract_op>{
+			std::forward<Lhs>(lhs), std::forward<Rhs>(rhs) };
+	}
+
+	template<vector_expression E>
+	constexpr auto operator-(E&& operand) noexcept
+	{
+		return vector_negate_expression<intern::expression_operand<E>>{ std::forward<E>(operand) };
+	}
+
+	template<vector_expression E>
+	constexpr auto operator*(E&& lhs, const intern::expression_value_t<E>& rhs) noexcept
+	{
+		return vector_scalar_expression<intern::expression_operand<E>, intern::multiply_op>{ std::forward<E>(lhs), rhs };
+	}
+
+	template<vector_expression E>
+	constexpr auto operator*(const intern::expression_value_t<E>& lhs, E&& rhs) noexcept
+	{
+		return vector_scalar_expression<intern::expression_operand<E>, intern::multiply_op>{ std::forward<E>(rhs), lhs };
+	}
+
+	template<vector_expression E>
+	constexpr auto operator/(E&& lhs, const intern::expression_value_t<E>& rhs) noexcept(Float<underlying_num_t<intern::expression_value_t<E>>>)
+	{
+		if constexpr (Integer<intern::expression_value_t<E>>)
+			if (rhs == static_cast<intern::expression_value_t<E>>(0)) intern::int_zero_division_except();
+		return vector_scalar_expression<intern::expression_operand<E>, intern::divide_op>{ std::forward<E>(lhs), rhs };
+	}
+
+	// Dot product, reduces the expressions in the same single loop
+	template<typename Lhs, typename Rhs> requires compatible_vector_expressions<Lhs, Rhs>
+	constexpr auto operator*(const Lhs& lhs, const Rhs& rhs) noexcept
+	{
+		intern::expression_value_t<Lhs> out{};
+		for (std::size_t i = 0; i < std::remove_cvref_t<Lhs>::size(); ++i)
+			out += lhs[i] * rhs[i];
+		return out;
+	}
+
+	template<vector_expression E>
+	constexpr auto eval(const E& expression) noexcept
+	{
+		return vector<intern::expression_value_t<E>, std::remove_cvref_t<E>::size()>{ expression };
+	}
+}
+
+#endif /* STM_VECTOR_EXPRESSION_H */
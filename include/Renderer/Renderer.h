@@ -2,6 +2,7 @@
 
 #include "Core/Core.h"
 #include "Window/Window.h"
+#include "Renderer/RendererSettings.h"
 
 namespace Aqua
 {
@@ -13,7 +14,9 @@ namespace Aqua
     class AQUA_API Renderer
     {
     public:
-        Renderer(Window& window, std::shared_ptr<EventQueue> queue);
+        Renderer(Window& window, std::shared_ptr<EventQueue> queue, const RendererSettings& settings = {});
+        // Headless renderer, draws into offscreen images and never presents
+        explicit Renderer(const RendererSettings& settings);
         ~Renderer();
 
         Renderer(const Renderer&) = delete;
@@ -21,6 +24,14 @@ namespace Aqua
         bool is_valid() const noexcept;
         void render() const;
 
+        void set_scene(const SceneDescription& scene) const;
+        std::vector<FrameTiming> flush_frame_timings() const;
+        bool has_gpu_timings() const noexcept;
+        bool has_present_timings() const noexcept;
+
+        uint32_t get_frames_in_flight() const noexcept;
+        PresentMode get_present_mode() const noexcept;
+
         static bool Startup();
         static bool Shutdown();
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Core/Core.h"
+
+namespace Aqua
+{
+    enum class PresentMode
+    {
+        Fifo,           // vsync, always supported
+        FifoRelaxed,    // vsync that tears instead of waiting when a frame is late
+        Mailbox,        // vsync, newer frames replace queued ones
+        Immediate       // no vsync, tears
+    };
+
+    struct RendererSettings
+    {
+        // Renders into offscreen images of width x height instead of a window swap chain
+        bool headless = false;
+        uint32_t width = 1280;
+        uint32_t height = 720;
+
+        // Records CPU and GPU times of every frame, retrieved with flush_frame_timings
+        bool collect_timings = false;
+
+        /*
+            Latency policy. More frames in flight and swap chain images keep the GPU busy, fewer
+            shorten the time from input to the screen. frames_in_flight is clamped to [1, 4] and
+            zero swap_chain_images asks for one more than the surface minimum. An unsupported
+            present_mode falls back to Fifo.
+        */
+        uint32_t frames_in_flight = 2;
+        uint32_t swap_chain_images = 0;
+        PresentMode present_mode = PresentMode::Mailbox;
+    };
+
+    /*
+        Content drawn every frame. quad_count quads are laid out on a grid, each one its own
+        draw call, and cycle through texture_count textures and uniform_updates uniform buffers.
+        Every uniform buffer is rewritten each frame. A zero time_step animates with the wall
+        clock, otherwise each frame advances the animation by time_step seconds so runs repeat.
+        Each quad draws mesh, an .obj, .gltf or .glb file loaded through its mesh cache and scaled
+        to fit the quad's grid cell. Without one, or when it fails to load, a flat quad is drawn.
+    */
+    struct SceneDescription
+    {
+        uint32_t quad_count = 1;
+        uint32_t texture_count = 1;
+        uint32_t uniform_updates = 1;
+        float time_step = 0.0f;
+        std::filesystem::path mesh{};
+    };
+
+    struct FrameTiming
+    {
+        uint64_t frame = 0;
+        double cpu_ms = 0.0;    // spent inside draw_frame, including waits on the frame timeline value
+        double gpu_ms = 0.0;    // between timestamps at the start and end of the frame commands
+        // From the start of draw_frame, where input has been handled, until the image reached the
+        // screen. Needs VK_KHR_present_wait, otherwise 0. Presents are polled at the start of a
+        // frame and after each acquire, so the value can run late by up to that interval
+        double present_ms = 0.0;
+    };
+}
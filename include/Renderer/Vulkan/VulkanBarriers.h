@@ -0,0 +1,49 @@
+#pragma once
+
+#include "VulkanCore.h"
+#include "VulkanImage.h"
+
+#include <vector>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        class Device;
+
+        // The stages and accesses an image is usually used with in layout, for callers that only know the layout
+        ImageState get_layout_state(VkImageLayout layout);
+
+        /*
+            Collects image transitions and records them as a single vkCmdPipelineBarrier2. Each
+            transition reads the tracked state of every mip level and layer it covers, so the source
+            scope of a barrier is the last use of that subresource and not a guess from its layout.
+            Neighbouring subresources in the same state share one VkImageMemoryBarrier2, a whole
+            array moved at once is one barrier however many layers it has. Reads in the layout and
+            stages of the previous read need no barrier at all.
+        */
+        class BarrierBatcher
+        {
+        public:
+            explicit BarrierBatcher(const Device& device) : device_{ &device } {}
+            BarrierBatcher(const BarrierBatcher&) = delete;
+            ~BarrierBatcher();
+
+            // discard drops the current contents, the transition then starts from VK_IMAGE_LAYOUT_UNDEFINED
+            void transition(Image& image, const ImageState& state, bool discard = false);
+            void transition(Image& image, const VkImageSubresourceRange& range, const ImageState& state, bool discard = false);
+
+            // Barriers of one batch are unordered, a subresource can only be transitioned once per flush
+            void flush(VkCommandBuffer command_buffer);
+
+            size_t size() const noexcept { return barriers_.size(); }
+            bool empty() const noexcept { return barriers_.empty(); }
+
+        private:
+            const Device* device_;
+            std::vector<VkImageMemoryBarrier2> barriers_;
+
+            bool is_pending(VkImage image, const VkImageSubresourceRange& range) const;
+        };
+    }
+}
@@ -9,69 +9,14 @@
 #include "VulkanCore.h"
 #include "VulkanDevice.h"
 #include "VulkanBufferBase.h"
+#include "VulkanVertex.h"
+
+#include <span>
 
 namespace Aqua
 {
     namespace Vulkan
     {
-        struct Vertex
-        {
-            using vec3f = stm::vector<float, 3>;
-            using vec2f = stm::vector<float, 2>;
-
-            vec2f position;
-            vec3f color;
-            vec2f text_coord;
-
-            static VkVertexInputBindingDescription get_binding_description()
-            {
-                VkVertexInputBindingDescription description{};
-                description.binding = 0;
-                description.stride = sizeof(Vertex);
-                description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-                return description;
-            }
-
-            static std::array<VkVertexInputAttributeDescription, 3> get_attribute_descriptions()
-            {
-                std::array<VkVertexInputAttributeDescription, 3> attribute_descriptions{};
-                
-                attribute_descriptions[0].binding = 0;
-                attribute_descriptions[0].location = 0;
-                attribute_descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-                attribute_descriptions[0].offset = offsetof(Vertex, position);
-
-                attribute_descriptions[1].binding = 0;
-                attribute_descriptions[1].location = 1;
-                attribute_descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-                attribute_descriptions[1].offset = offsetof(Vertex, color);
-
-                attribute_descriptions[2].binding = 0;
-                attribute_descriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-                attribute_descriptions[2].location = 2;
-                attribute_descriptions[2].offset = offsetof(Vertex, text_coord);
-
-                return attribute_descriptions;
-            }
-
-            static VkPipelineVertexInputStateCreateInfo create_vertex_input_info()
-            {
-                static VkPipelineVertexInputStateCreateInfo info{};
-                
-                static auto binding_description = get_binding_description();
-                static auto attribute_description = get_attribute_descriptions();
-
-                info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-                info.vertexBindingDescriptionCount = 1;
-                info.pVertexBindingDescriptions = &binding_description;
-                info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_description.size());
-                info.pVertexAttributeDescriptions = attribute_description.data();
-
-                return info;
-            }
-        };
-
         class VertexBuffer : public Buffer
         {
         public:
@@ -85,11 +30,21 @@ namespace Aqua
                 create_vertex_buffer(device, vertices.data(), vertices.size() * sizeof(T));
             }
 
+            // Raw vertex stream, e.g. straight from a mapped mesh cache
+            VertexBuffer(const Device& device, std::span<const uint8_t> vertex_data, uint32_t vertex_count)
+                : Buffer{ device.create_buffer(vertex_data.size(),
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) },
+                  vertex_count_{ vertex_count }
+            {
+                create_vertex_buffer(device, vertex_data.data(), vertex_data.size());
+            }
+
             VertexBuffer(const VertexBuffer&) = delete;
 
             uint32_t get_vertex_count() const noexcept { return vertex_count_; }
 
-            void bind_buffer(VkCommandBuffer command_buffer) const;
+            void bind_buffer(VkCommandBuffer command_buffer, uint32_t binding = 0) const;
 
         private:
             uint32_t vertex_count_ = 0;
@@ -100,7 +55,7 @@ namespace Aqua
         class IndexBuffer : public Buffer
         {
         public:
-            IndexBuffer(const Device& device, const std::vector<uint32_t>& indices);
+            IndexBuffer(const Device& device, std::span<const uint32_t> indices);
 
             IndexBuffer(const VertexBuffer&) = delete;
 
@@ -9,11 +9,8 @@ namespace Aqua
         class Buffer
         {
         public:
-            ~Buffer()
-            {
-                vkFreeMemory(device_, memory_, nullptr);
-                vkDestroyBuffer(device_, buffer_, nullptr);
-            }
+            // Destroyed once the frames that may still read it have completed
+            ~Buffer();
 
             bool write_data(const uint8_t* src_data, VkDeviceSize size, VkDeviceSize dst_offset = 0) const;
 
@@ -28,12 +25,12 @@ namespace Aqua
             Buffer() = default;
             Buffer(const Buffer&) = delete;
             // Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
-            Buffer(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size)
-                : buffer_{ buffer }, memory_{ memory }, device_{ device }, buffer_size_{ size } {}
+            Buffer(const Device* owner, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size);
 
             VkBuffer buffer_ = VK_NULL_HANDLE;
             VkDeviceMemory memory_ = VK_NULL_HANDLE;
             VkDevice device_ = VK_NULL_HANDLE;
+            const Device* owner_ = nullptr;
             VkDeviceSize buffer_size_ = 0;
 
             friend class Device;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "VulkanCore.h"
+
+#include <deque>
+#include <functional>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        /*
+            Objects the GPU may still be reading, each tagged with the timeline value of the last
+            submission that can use it. Values complete in order, so flush(completed) destroys a
+            prefix of the queue and objects released mid-frame never need a device wait.
+        */
+        class DeletionQueue
+        {
+        public:
+            DeletionQueue() = default;
+            DeletionQueue(const DeletionQueue&) = delete;
+            ~DeletionQueue() { flush_all(); }
+
+            // value has to be at least the value of every earlier push
+            void push(uint64_t value, std::function<void()> deleter);
+
+            // Runs the deleters of every value up to and including completed_value
+            void flush(uint64_t completed_value);
+            // Only safe once the device is idle
+            void flush_all();
+
+            bool empty() const noexcept { return entries_.empty(); }
+            size_t size() const noexcept { return entries_.size(); }
+
+        private:
+            struct Entry
+            {
+                uint64_t value;
+                std::function<void()> deleter;
+            };
+
+            std::deque<Entry> entries_;
+        };
+    }
+}
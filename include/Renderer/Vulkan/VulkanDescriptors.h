@@ -0,0 +1,152 @@
+#pragma once
+
+#include "VulkanCore.h"
+
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        class Device;
+
+        /*
+            Deduplicates descriptor set layouts. Bindings are sorted before hashing, so the same
+            bindings declared in any order map to one VkDescriptorSetLayout, which also makes
+            pipeline layouts built from them compatible. Layouts live until clear().
+        */
+        class DescriptorLayoutCache
+        {
+        public:
+            explicit DescriptorLayoutCache(VkDevice device) : device_{ device } {}
+            DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+            ~DescriptorLayoutCache() { clear(); }
+
+            // binding_flags is either empty or has one entry per binding, in the order of bindings
+            VkDescriptorSetLayout get(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                      VkDescriptorSetLayoutCreateFlags flags = 0,
+                                      std::span<const VkDescriptorBindingFlags> binding_flags = {});
+
+            // Only safe once no pipeline layout or pool allocation uses the layouts
+            void clear();
+
+            size_t size() const noexcept { return layouts_.size(); }
+
+        private:
+            struct Binding
+            {
+                VkDescriptorSetLayoutBinding binding;
+                VkDescriptorBindingFlags flags;
+
+                bool operator==(const Binding& other) const noexcept;
+            };
+
+            struct Key
+            {
+                VkDescriptorSetLayoutCreateFlags flags = 0;
+                std::vector<Binding> bindings;
+
+                bool operator==(const Key& other) const noexcept = default;
+            };
+
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const noexcept;
+            };
+
+            VkDevice device_;
+            std::mutex mutex_;
+            std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> layouts_;
+        };
+
+        // Deduplicates pipeline layouts by their set layouts and push constant ranges
+        class PipelineLayoutCache
+        {
+        public:
+            explicit PipelineLayoutCache(VkDevice device) : device_{ device } {}
+            PipelineLayoutCache(const PipelineLayoutCache&) = delete;
+            ~PipelineLayoutCache() { clear(); }
+
+            VkPipelineLayout get(std::span<const VkDescriptorSetLayout> set_layouts,
+                                 std::span<const VkPushConstantRange> push_constants = {});
+
+            // Only safe once no pipeline uses the layouts
+            void clear();
+
+            size_t size() const noexcept { return layouts_.size(); }
+
+        private:
+            struct Key
+            {
+                std::vector<VkDescriptorSetLayout> set_layouts;
+                std::vector<VkPushConstantRange> push_constants;
+
+                bool operator==(const Key& other) const noexcept;
+            };
+
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const noexcept;
+            };
+
+            VkDevice device_;
+            std::mutex mutex_;
+            std::unordered_map<Key, VkPipelineLayout, KeyHash> layouts_;
+        };
+
+        /*
+            Allocates descriptor sets from a list of pools and creates a larger pool whenever the
+            current one runs out, so allocation never fails for lack of space and costs amortized
+            O(1). Sets are not freed one by one, reset() returns every set to the pools at once.
+            Pools are sized from per set ratios of each descriptor type.
+        */
+        class DescriptorAllocator
+        {
+        public:
+            struct PoolRatio
+            {
+                VkDescriptorType type;
+                float per_set;
+            };
+
+            static constexpr PoolRatio default_ratios[] = {
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.f },
+                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.f },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.f },
+                { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.f },
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f }
+            };
+
+            DescriptorAllocator(const Device& device,
+                                std::span<const PoolRatio> ratios = default_ratios,
+                                uint32_t initial_sets = 64);
+            DescriptorAllocator(const DescriptorAllocator&) = delete;
+            // The pools are destroyed once the submissions that may use their sets complete
+            ~DescriptorAllocator();
+
+            VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+            // Allocates one set per layout, all from the same pool
+            bool allocate(std::span<const VkDescriptorSetLayout> layouts, std::span<VkDescriptorSet> sets);
+
+            // Returns every set to the pools, only safe once no pending submission uses them
+            void reset();
+
+            size_t pool_count() const noexcept { return ready_pools_.size() + full_pools_.size(); }
+
+        private:
+            static constexpr uint32_t max_sets_per_pool = 4096;
+
+            const Device* device_;
+            std::vector<PoolRatio> ratios_;
+            // The back of ready_pools_ is the one allocated from, full pools wait for reset()
+            std::vector<VkDescriptorPool> ready_pools_;
+            std::vector<VkDescriptorPool> full_pools_;
+            uint32_t sets_per_pool_;
+
+            VkDescriptorPool get_pool(uint32_t set_count);
+            VkDescriptorPool create_pool(uint32_t set_count) const;
+        };
+    }
+}
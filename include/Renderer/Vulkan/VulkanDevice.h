@@ -3,7 +3,13 @@
 #include "VulkanCore.h"
 #include "VulkanBufferBase.h"
 #include "VulkanImage.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanDescriptors.h"
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <span>
 #include <unordered_set>
 
 namespace Aqua
@@ -38,6 +44,16 @@ namespace Aqua
                 }
             };
 
+            // Binary semaphores of a submission, swap chain acquire and present cannot use the timeline
+            struct SubmitSemaphores
+            {
+                std::span<const VkSemaphore> wait;
+                std::span<const VkPipelineStageFlags> wait_stages;
+                std::span<const VkSemaphore> signal;
+            };
+
+            static constexpr size_t max_submit_semaphores = 4;
+
             Device(VkPhysicalDevice physical_device, VkSurfaceKHR surface);
             ~Device();
 
@@ -88,16 +104,67 @@ namespace Aqua
             Image create_image(const VkImageCreateInfo& info,
                                VkMemoryPropertyFlags properties) const;
 
+            // Memory the caller binds and frees itself, VK_NULL_HANDLE on failure
+            VkDeviceMemory allocate_memory(const VkMemoryRequirements& requirements,
+                                           VkMemoryPropertyFlags properties) const;
+
+            /*
+                A single timeline semaphore orders all work submitted through submit(), each submission
+                signals the next value. CPU waits, upload completion and deferred destruction all
+                compare against that one counter instead of per submission fences.
+            */
+            uint64_t submit(VkQueue queue, VkCommandBuffer command_buffer, const SubmitSemaphores& semaphores = {}) const;
+            void wait(uint64_t value) const;
+            uint64_t get_completed_value() const;
+            uint64_t get_submitted_value() const noexcept { return timeline_value_; }
+            // The value the next submit() signals, work recorded now completes no earlier than that
+            uint64_t get_next_submission_value() const;
+            VkSemaphore get_timeline() const noexcept { return timeline_; }
+
+            // VK_KHR_present_id and VK_KHR_present_wait, enabled when the device has both
+            bool has_present_wait() const noexcept { return wait_for_present_ != nullptr; }
+            VkResult wait_for_present(VkSwapchainKHR swap_chain, uint64_t present_id, uint64_t timeout) const;
+
+            // vkCmdPipelineBarrier2 of VK_KHR_synchronization2, which the device requires
+            void cmd_pipeline_barrier(VkCommandBuffer command_buffer, const VkDependencyInfo& dependency) const
+            {
+                pipeline_barrier2_(command_buffer, &dependency);
+            }
+
+            // Objects released now are destroyed once the next submission has completed, Buffer and
+            // Image release themselves through here so they can be dropped mid-frame
+            void defer_destruction(std::function<void()> deleter) const;
+            // Destroys everything whose submissions have completed
+            void collect_garbage() const;
+
+            // Shared by every pipeline on the device, layouts live as long as the device
+            DescriptorLayoutCache& get_layout_cache() const noexcept { return *layout_cache_; }
+            PipelineLayoutCache& get_pipeline_layout_cache() const noexcept { return *pipeline_layout_cache_; }
+
             static QueueFamilyIndices find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface);
 
         private:
             VkDevice device_ = VK_NULL_HANDLE;
             VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
             QueueFamilyIndices queue_families_;
+
+            VkSemaphore timeline_ = VK_NULL_HANDLE;
+            // Last value handed to a submission, guarded by submit_mutex_ together with the queue
+            mutable std::atomic<uint64_t> timeline_value_ = 0;
+            mutable std::mutex submit_mutex_;
+            mutable DeletionQueue deletion_queue_;
+            std::unique_ptr<DescriptorLayoutCache> layout_cache_;
+            std::unique_ptr<PipelineLayoutCache> pipeline_layout_cache_;
+
+            PFN_vkWaitForPresentKHR wait_for_present_ = nullptr;
+            PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2_ = nullptr;
             // VkSurface surface_ associated_surface_ = VK_NULL_HANDLE;
             
             static std::vector<const char*> device_extensions_;
-            static VkDevice create_logical_device(VkPhysicalDevice physical_device, VkSurfaceKHR surface);
+            static std::vector<const char*> present_wait_extensions_;
+            static bool check_present_wait_support(VkPhysicalDevice physical_device);
+            static VkDevice create_logical_device(VkPhysicalDevice physical_device, VkSurfaceKHR surface, bool present_wait);
+            static VkSemaphore create_timeline_semaphore(VkDevice device);
 
             static VkCommandPool create_graphics_command_pool(VkDevice device,
                                                             const QueueFamilyIndices& queue_family_indices,
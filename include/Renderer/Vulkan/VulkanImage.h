@@ -2,26 +2,54 @@
 
 #include "VulkanCore.h"
 
+#include <vector>
+
 namespace Aqua
 {
     namespace Vulkan
     {
+        // What a subresource was last used for, the next barrier waits on these stages and accesses
+        struct ImageState
+        {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2 access = VK_ACCESS_2_NONE;
+
+            bool operator==(const ImageState& other) const noexcept = default;
+        };
+
         class Image
         {
         public:
             ~Image();
 
+            Image(Image&&) noexcept;
+            Image& operator=(Image&&) noexcept;
+
             uint32_t get_width() const noexcept { return size_.width; }
             uint32_t get_height() const noexcept { return size_.height; }
             uint32_t get_depth() const noexcept { return size_.depth; }
+            uint32_t get_mip_levels() const noexcept { return mip_levels_; }
+            uint32_t get_array_layers() const noexcept { return array_layers_; }
 
             VkImage get_image() const noexcept { return image_; }
             VkDeviceMemory get_memory() const noexcept { return memory_; }
             VkDevice get_device() const noexcept { return device_; }
             VkFormat get_format() const noexcept { return format_; }
-            VkImageLayout get_layout() const noexcept { return layout_; }
             VkImageView get_view() const noexcept { return view_; }
+            VkImageAspectFlags get_aspect() const noexcept { return aspect_; }
+
+            // Tracked per mip level and array layer, get_layout() is the one of the first subresource
+            const ImageState& get_state(uint32_t mip = 0, uint32_t layer = 0) const { return states_[mip * array_layers_ + layer]; }
+            VkImageLayout get_layout() const noexcept { return states_.empty() ? VK_IMAGE_LAYOUT_UNDEFINED : states_.front().layout; }
+            VkImageSubresourceRange get_full_range() const noexcept { return { aspect_, 0, mip_levels_, 0, array_layers_ }; }
 
+            // Every layer of mip 0 from the buffer, layers tightly packed one after the other. The image has to be in
+            // TRANSFER_DST_OPTIMAL
+            static void record_copy_from_buffer(VkCommandBuffer command_buffer, const Buffer& src, const Image& dst);
+
+            // Both wait for a one time submission, uploads that record several steps into one command buffer with a
+            // BarrierBatcher avoid the round trips
             static void copy_from_buffer(const Device& device, const Buffer& src, const Image& dst);
             static void transition_image_layout(const Device& device, Image& image, VkImageLayout new_layout);
             
@@ -30,21 +58,27 @@ namespace Aqua
             Image(const Image&) = delete;
             Image& operator=(const Image&) = delete;
 
-            Image(Image&&) noexcept;
-            Image& operator=(Image&&) noexcept;
+            Image(const Device* owner, VkImage image, VkDeviceMemory memory, const VkImageCreateInfo& info);
 
-            Image(VkDevice device, VkImage image, VkDeviceMemory memory, VkFormat format, VkExtent3D size);
+            // Hands the handles to the owner's deletion queue, the GPU may still be using them
+            void release() noexcept;
             
             VkImage image_ = VK_NULL_HANDLE;
             VkImageView view_ = VK_NULL_HANDLE;
             VkDeviceMemory memory_ = VK_NULL_HANDLE;
             VkDevice device_ = VK_NULL_HANDLE;
+            const Device* owner_ = nullptr;
             VkFormat format_;
             VkExtent3D size_;
-            VkImageLayout layout_ = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageAspectFlags aspect_ = VK_IMAGE_ASPECT_COLOR_BIT;
+            uint32_t mip_levels_ = 1;
+            uint32_t array_layers_ = 1;
+            // Mip major, array_layers_ entries per level
+            std::vector<ImageState> states_;
 
             friend class Device;
             friend class Texture;
+            friend class BarrierBatcher;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VulkanCore.h"
+#include "VulkanDevice.h"
+#include "VulkanBuffer.h"
+
+#include "Assets/Mesh.h"
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        // Device local vertex streams and indices uploaded from a MeshView,
+        // attribute locations follow the VertexAttribute values
+        class Mesh
+        {
+        public:
+            Mesh(const Device& device, const MeshView& mesh);
+            Mesh(const Mesh&) = delete;
+
+            bool is_valid() const noexcept { return index_buffer_ != nullptr && !vertex_buffers_.empty(); }
+
+            uint32_t get_vertex_count() const noexcept { return vertex_count_; }
+            uint32_t get_index_count() const noexcept { return index_buffer_ ? index_buffer_->get_index_count() : 0; }
+            const std::vector<Submesh>& get_submeshes() const noexcept { return submeshes_; }
+
+            const stm::vec3f& get_bounds_min() const noexcept { return bounds_min_; }
+            const stm::vec3f& get_bounds_max() const noexcept { return bounds_max_; }
+
+            std::vector<VkVertexInputBindingDescription> get_binding_descriptions() const { return get_binding_descriptions(streams_); }
+            std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions() const { return get_attribute_descriptions(streams_); }
+
+            // Stream i is bound to binding i, pipelines can be created before any mesh of those streams exists
+            static std::vector<VkVertexInputBindingDescription> get_binding_descriptions(std::span<const VertexStreamDescription> streams);
+            static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions(std::span<const VertexStreamDescription> streams);
+
+            void bind_buffers(VkCommandBuffer command_buffer) const;
+            void draw(VkCommandBuffer command_buffer) const;
+            void draw_submesh(VkCommandBuffer command_buffer, size_t submesh) const;
+
+            static VkFormat get_format(VertexFormat format) noexcept;
+
+        private:
+            uint32_t vertex_count_ = 0;
+            std::vector<VertexStreamDescription> streams_;
+            std::vector<Submesh> submeshes_;
+            stm::vec3f bounds_min_;
+            stm::vec3f bounds_max_;
+            std::vector<std::unique_ptr<VertexBuffer>> vertex_buffers_;
+            std::unique_ptr<IndexBuffer> index_buffer_;
+        };
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "VulkanCore.h"
+
+#include <span>
+#include <type_traits>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        // The push constant space every implementation guarantees, maxPushConstantsSize is at least this
+        inline constexpr uint32_t max_push_constants_size = 128;
+
+        template<typename T, uint32_t Offset>
+        concept PushConstantBlock =
+            std::is_trivially_copyable_v<T> &&
+            std::is_standard_layout_v<T> &&
+            Offset % 4 == 0 &&
+            sizeof(T) % 4 == 0 &&
+            Offset + sizeof(T) <= max_push_constants_size;
+
+        /*
+            Stages to pass to vkCmdPushConstants when updating [offset, offset + size) of a layout
+            with the reflected ranges: every stage whose range overlaps the update. 0 when no range
+            overlaps it or an overlapping range does not contain all of it, as such an update is
+            invalid for at least one stage.
+        */
+        VkShaderStageFlags get_push_constant_stages(std::span<const VkPushConstantRange> ranges,
+                                                    uint32_t offset,
+                                                    uint32_t size);
+
+        /*
+            Typed updates of a push constant block. The type is checked at compile time against the
+            guaranteed 128 bytes and at creation against the ranges reflected from the shaders, so
+            pushing is a single vkCmdPushConstants with no further checks. Per draw data pushed
+            this way is recorded into the command buffer, no memory write or descriptor update.
+        */
+        template<typename T, uint32_t Offset = 0>
+        requires PushConstantBlock<T, Offset>
+        class PushConstants
+        {
+        public:
+            static constexpr uint32_t offset = Offset;
+            static constexpr uint32_t size = sizeof(T);
+
+            PushConstants() = default;
+
+            PushConstants(VkPipelineLayout layout, std::span<const VkPushConstantRange> reflected_ranges)
+                : layout_{ layout },
+                stages_{ get_push_constant_stages(reflected_ranges, offset, size) }
+            {
+            }
+
+            // False when the shaders declare no block matching T
+            bool is_valid() const noexcept { return layout_ != VK_NULL_HANDLE && stages_ != 0; }
+
+            void push(VkCommandBuffer command_buffer, const T& data) const
+            {
+                vkCmdPushConstants(command_buffer, layout_, stages_, offset, size, &data);
+            }
+
+            VkShaderStageFlags get_stages() const noexcept { return stages_; }
+
+        private:
+            VkPipelineLayout layout_ = VK_NULL_HANDLE;
+            VkShaderStageFlags stages_ = 0;
+        };
+    }
+}
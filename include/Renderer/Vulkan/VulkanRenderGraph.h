@@ -0,0 +1,191 @@
+#pragma once
+
+#include "VulkanCore.h"
+
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        class Device;
+
+        /*
+            A frame described as passes that declare the images they read and write. compile() culls
+            the passes nothing consumes, places transient images whose lifetimes do not overlap in
+            the same memory, and derives every layout transition and dependency from the declared
+            uses. Each pass is preceded by at most one vkCmdPipelineBarrier2 holding all of its image
+            barriers, each with stage and access masks limited to the uses of that image on either
+            side. Passes run in the order they are added, so each one has to be added after the
+            passes it reads from.
+        */
+        class RenderGraph
+        {
+        public:
+            using Resource = uint32_t;
+            using Pass = uint32_t;
+
+            static constexpr uint32_t invalid_handle = std::numeric_limits<uint32_t>::max();
+
+            enum class Access
+            {
+                ColorAttachment,
+                SampledFragment,
+                SampledCompute,
+                StorageCompute,
+                TransferSrc,
+                TransferDst
+            };
+
+            // Owned by the graph, only valid during the frame
+            struct ImageDesc
+            {
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                VkExtent2D extent{};
+            };
+
+            // Owned by the caller, in the initial state when the frame starts and left in final_layout
+            struct ImportDesc
+            {
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                VkExtent2D extent{};
+                VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                VkPipelineStageFlags2 initial_stages = VK_PIPELINE_STAGE_2_NONE;
+                VkAccessFlags2 initial_access = VK_ACCESS_2_NONE;
+                VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            };
+
+            class PassBuilder
+            {
+            public:
+                void read(Resource resource, Access access);
+                // Replaces the whole image, a pass that only updates part of it also reads it
+                void write(Resource resource, Access access);
+                // Without a clear value the attachment is loaded, which also reads it
+                void color_attachment(Resource resource, std::optional<VkClearColorValue> clear = std::nullopt);
+                // Keeps the pass even when nothing reads what it writes
+                void side_effect();
+
+            private:
+                PassBuilder(RenderGraph& graph, Pass pass) : graph_{ graph }, pass_{ pass } {}
+
+                RenderGraph& graph_;
+                Pass pass_;
+
+                friend class RenderGraph;
+            };
+
+            explicit RenderGraph(const Device& device);
+            RenderGraph(const RenderGraph&) = delete;
+            // The images, memory and render passes are destroyed once the frames using them complete
+            ~RenderGraph();
+
+            Resource import_image(std::string name, const ImportDesc& desc);
+            Resource create_image(std::string name, const ImageDesc& desc);
+            Pass add_pass(std::string name,
+                          const std::function<void(PassBuilder&)>& setup,
+                          std::function<void(VkCommandBuffer)> execute);
+
+            bool compile();
+
+            // Imported images can change every frame as long as their format and extent do not
+            void bind_image(Resource resource, VkImage image, VkImageView view);
+            void execute(VkCommandBuffer command_buffer);
+
+            // Only for passes with color attachments, pipelines drawn in the pass are created against it
+            VkRenderPass get_render_pass(Pass pass) const;
+            bool is_culled(Pass pass) const;
+
+            // Memory backing the transient images, with aliasing applied
+            VkDeviceSize get_transient_memory_size() const noexcept;
+
+        private:
+            struct Use
+            {
+                Resource resource;
+                Access access;
+                bool read;
+                bool write;
+            };
+
+            struct Attachment
+            {
+                Resource resource;
+                std::optional<VkClearColorValue> clear;
+            };
+
+            struct Barrier
+            {
+                Resource resource;
+                VkImageLayout old_layout;
+                VkImageLayout new_layout;
+                VkPipelineStageFlags2 src_stages;
+                VkPipelineStageFlags2 dst_stages;
+                VkAccessFlags2 src_access;
+                VkAccessFlags2 dst_access;
+            };
+
+            struct PassData
+            {
+                std::string name;
+                std::vector<Use> uses;
+                std::vector<Attachment> attachments;
+                std::function<void(VkCommandBuffer)> execute;
+                bool side_effect = false;
+                bool culled = false;
+
+                std::vector<Barrier> barriers;
+                VkRenderPass render_pass = VK_NULL_HANDLE;
+                // Keyed by the attachment views, imported ones change between frames
+                std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+            };
+
+            struct ResourceData
+            {
+                std::string name;
+                VkFormat format;
+                VkExtent2D extent;
+                bool imported;
+                ImportDesc import;
+
+                VkImage image = VK_NULL_HANDLE;
+                VkImageView view = VK_NULL_HANDLE;
+                VkImageUsageFlags usage = 0;
+                // Indices into the kept passes, invalid_handle when no kept pass uses the image
+                uint32_t first_use = invalid_handle;
+                uint32_t last_use = invalid_handle;
+                uint32_t memory_block = invalid_handle;
+            };
+
+            // Transient images sharing memory, in the order of their lifetimes
+            struct MemoryBlock
+            {
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                VkDeviceSize size = 0;
+                uint32_t memory_type_bits = ~0u;
+                std::vector<Resource> occupants;
+            };
+
+            const Device* device_;
+            std::vector<ResourceData> resources_;
+            std::vector<PassData> passes_;
+            std::vector<Pass> kept_passes_;
+            std::vector<MemoryBlock> memory_blocks_;
+            std::vector<Barrier> final_barriers_;
+            bool compiled_ = false;
+
+            void cull_passes();
+            void compute_lifetimes();
+            bool allocate_transient_images();
+            void build_barriers();
+            bool create_render_passes();
+
+            void add_use(Pass pass, const Use& use);
+            VkFramebuffer get_framebuffer(PassData& pass);
+            void record_barriers(VkCommandBuffer command_buffer, const std::vector<Barrier>& batch) const;
+        };
+    }
+}
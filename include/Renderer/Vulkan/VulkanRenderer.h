@@ -2,12 +2,19 @@
 
 #include "Core/Core.h"
 #include "Window/Window.h"
+#include "Renderer/RendererSettings.h"
 
 #include "VulkanCore.h"
 #include "VulkanBuffer.h"
+#include "VulkanMesh.h"
+#include "VulkanPushConstants.h"
+#include "VulkanRenderGraph.h"
 #include "VulkanTexture.h"
+#include "VulkanTextureTable.h"
 #include "VulkanDevice.h"
 
+#include <deque>
+
 namespace Aqua
 {
     namespace Vulkan
@@ -15,15 +22,32 @@ namespace Aqua
         class Renderer
         {
         public:
-            Renderer(Window& window);
+            Renderer(Window& window, const RendererSettings& settings = {});
+            Renderer(const RendererSettings& settings);
             Renderer(const Renderer&) = delete;
             ~Renderer();
 
             bool is_valid() const noexcept { return successful_init_; }
+            bool is_headless() const noexcept { return headless_; }
+            bool has_gpu_timings() const noexcept { return timestamp_pool_ != VK_NULL_HANDLE; }
+            // Present times need VK_KHR_present_wait, headless renderers never present
+            bool has_present_timings() const noexcept { return collect_timings_ && !headless_ && device_->has_present_wait(); }
+
+            uint32_t get_frames_in_flight() const noexcept { return frames_in_flight_; }
+            const Device& get_device() const noexcept { return *device_; }
+            // The mode the swap chain was created with after falling back, Fifo when headless
+            PresentMode get_present_mode() const noexcept;
 
             void draw_frame();
             void set_resize(bool resize) { framebuffer_resize_ = resize; }
 
+            // Rebuilds the scene resources, the old ones are destroyed once the frames in flight complete
+            void set_scene(const SceneDescription& scene);
+            const SceneDescription& get_scene() const noexcept { return scene_; }
+
+            // Waits for the device and returns the timings of every frame since the last call in frame order
+            std::vector<FrameTiming> flush_frame_timings();
+
             static bool Startup();
             static bool Shutdown();
 
@@ -38,18 +62,27 @@ namespace Aqua
             {
                 VkSurfaceFormatKHR format;
                 VkExtent2D extent;
+                VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
             };
 
         private:
+            Renderer(GLFWwindow* window, const RendererSettings& settings);
+
             std::chrono::high_resolution_clock::time_point prev_time;
             std::chrono::high_resolution_clock::time_point curr_time;
-            inline static std::vector<std::unique_ptr<UniformBuffer>> main_uniform_buffers;
 
             GLFWwindow* glfw_window_;
+            bool headless_ = false;
+
+            uint32_t frames_in_flight_ = 2;
+            VkPresentModeKHR requested_present_mode_ = VK_PRESENT_MODE_MAILBOX_KHR;
+            uint32_t requested_images_ = 0;
+
+            // Headless render targets, one per frame in flight
+            std::vector<std::unique_ptr<Image>> offscreen_images_;
 
             std::vector<VkImage> swap_chain_images_;
             std::vector<VkImageView> swap_chain_image_views_;
-            std::vector<VkFramebuffer> swap_chain_framebuffers_;
             VkSwapchainKHR swap_chain_;
 
             VkSurfaceKHR surface_;
@@ -59,37 +92,118 @@ namespace Aqua
             */
             std::unique_ptr<Device> device_;
 
+            // Reflected from the shaders, owned by the device layout cache
             static inline VkDescriptorSetLayout descriptor_set_layout_;
-            VkDescriptorPool descriptor_pool_;
-            inline static std::vector<VkDescriptorSet> descriptor_sets_;
+            // Every texture the renderer samples, bound once per frame as set 1
+            std::unique_ptr<TextureTable> texture_table_;
+
+            // Loaded once, the pipeline is rebuilt from them whenever the swap chain changes
+            struct GraphicsShaders
+            {
+                std::vector<uint32_t> vertex;
+                std::vector<uint32_t> fragment;
+                // The scene mesh streams and the vertex attributes the vertex shader reads from them
+                std::vector<VkVertexInputBindingDescription> vertex_bindings;
+                std::vector<VkVertexInputAttributeDescription> vertex_attributes;
+            };
+
+            GraphicsShaders shaders_;
+
+            // Per draw data of the vertex shader push constant block
+            struct DrawConstants
+            {
+                stm::mat4f transform;
+                uint32_t texture_index;
+            };
+
+            PushConstants<DrawConstants> draw_constants_;
 
             VkQueue graphics_queue_;
             VkQueue presents_queue_;
             
             ImageProperties image_properties_;
+            // Owned by the device pipeline layout cache
             inline static VkPipelineLayout pipeline_layout_ = VK_NULL_HANDLE;
             VkPipeline graphics_pipeline_;
-            VkRenderPass render_pass_;
+
+            // Rebuilt with the swap chain, the backbuffer is bound to the acquired image every frame
+            std::unique_ptr<RenderGraph> frame_graph_;
+            RenderGraph::Resource backbuffer_ = RenderGraph::invalid_handle;
+            RenderGraph::Pass scene_pass_ = RenderGraph::invalid_handle;
             bool successful_init_;
 
             VkCommandPool command_pool_;
             std::vector<VkCommandBuffer> command_buffers_;
 
             std::vector<VkSemaphore> image_available_semaphores_;
+            // One per swap chain image, presentation can still wait on it after the frame completes
             std::vector<VkSemaphore> render_finished_semaphores_;
-            std::vector<VkFence> in_flight_fences_;
-
-            inline static std::unique_ptr<VertexBuffer> main_vertex_buffer = nullptr;
-            inline static std::unique_ptr<IndexBuffer> main_index_buffer = nullptr;
-            std::unique_ptr<Texture> main_texture = nullptr;
+            // Device timeline value of the last submission of each frame in flight
+            std::vector<uint64_t> frame_values_;
+
+            SceneDescription scene_;
+            float scene_time_ = 0.f;
+            std::unique_ptr<Mesh> scene_mesh_;
+            // Placement of each quad on the grid, all quads share the scene mesh
+            std::vector<stm::mat4f> scene_transforms_;
+            std::vector<std::unique_ptr<Texture>> scene_textures_;
+            // Texture table index of each scene texture, quad i samples texture i % texture_count
+            std::vector<uint32_t> scene_texture_indices_;
+            // uniform_updates buffers per frame in flight, frame major
+            std::vector<std::unique_ptr<UniformBuffer>> scene_uniform_buffers_;
+            // Quad i binds set i % sets_per_frame, which holds uniform i % uniform_updates
+            std::vector<VkDescriptorSet> descriptor_sets_;
+            uint32_t sets_per_frame_ = 0;
+            // One allocator per frame in flight, reset in bulk when its slot's sets are rewritten
+            std::vector<std::unique_ptr<DescriptorAllocator>> frame_descriptor_allocators_;
+            // Scene version the sets of each frame slot were written for
+            std::vector<uint64_t> frame_scene_versions_;
+            uint64_t scene_version_ = 0;
+
+            struct PendingTiming
+            {
+                FrameTiming timing;
+                std::chrono::high_resolution_clock::time_point start;
+                uint32_t slot = 0;
+                // Zero when the present is not measured
+                uint64_t present_id = 0;
+                VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
+                bool gpu_resolved = false;
+            };
 
-            inline static uint32_t current_frame_ = 0;
+            // Two timestamps per frame in flight, pending_timings_ holds frames in order until both their
+            // GPU time and their present time resolve
+            VkQueryPool timestamp_pool_ = VK_NULL_HANDLE;
+            double timestamp_period_ = 0.0;
+            uint64_t timestamp_mask_ = 0;
+            bool collect_timings_ = false;
+            uint64_t frame_index_ = 0;
+            std::deque<PendingTiming> pending_timings_;
+            std::vector<FrameTiming> frame_timings_;
+
+            uint32_t current_frame_ = 0;
             bool framebuffer_resize_ = false;
+            // Set while the surface cannot take a new swap chain, such as a minimized window
+            bool swap_chain_out_of_date_ = false;
 
-            void recreate_swap_chain();
+            bool recreate_swap_chain();
+            void retire_swap_chain(VkSwapchainKHR swap_chain);
             void cleanup_swap_chain();
 
-            static constexpr uint32_t max_frames_in_flight = 2;
+            void create_scene_resources();
+            void destroy_scene_resources();
+            void update_scene_uniforms();
+            bool write_frame_descriptor_sets(uint32_t frame);
+
+            void create_timestamp_pool();
+            void resolve_gpu_timing(PendingTiming& pending);
+            void resolve_present_timings(uint64_t timeout);
+            void collect_resolved_timings();
+
+            static constexpr uint32_t max_frames_in_flight = 4;
+            static constexpr uint32_t texture_table_capacity = 4096;
+            static constexpr uint32_t scene_set = 0;
+            static constexpr uint32_t texture_table_set = 1;
             static VkInstance instance_;
             static std::vector<const char*> device_extensions_;
             static VkDebugUtilsMessengerEXT debug_messenger_;
@@ -103,7 +217,9 @@ namespace Aqua
 
             static VkSurfaceKHR create_window_surface(GLFWwindow* window);
             static VkSurfaceFormatKHR select_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats);
-            static VkPresentModeKHR select_present_mode(const std::vector<VkPresentModeKHR>& available_modes);
+            static VkPresentModeKHR select_present_mode(
+                const std::vector<VkPresentModeKHR>& available_modes,
+                VkPresentModeKHR requested_mode);
             static VkExtent2D select_surface_extent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window);
 
             static VkPhysicalDevice select_physical_device(VkSurfaceKHR surface);
@@ -114,7 +230,10 @@ namespace Aqua
             static std::pair<VkSwapchainKHR, ImageProperties> create_swap_chain(
                 const Device& device,
                 VkSurfaceKHR surface,
-                GLFWwindow* window);
+                GLFWwindow* window,
+                VkPresentModeKHR requested_mode,
+                uint32_t requested_images,
+                VkSwapchainKHR old_swap_chain = VK_NULL_HANDLE);
 
             static std::vector<VkImage> create_swap_chain_images(const Device& device, VkSwapchainKHR swap_chain);
             static std::vector<VkImageView> create_image_views(
@@ -126,30 +245,21 @@ namespace Aqua
                 VkDevice device,
                 VkRenderPass render_pass,
                 VkPipelineLayout pipeline_layout,
-                const ImageProperties& image);
+                const ImageProperties& image,
+                const GraphicsShaders& shaders);
 
-            static VkPipelineLayout create_graphics_pipeline_layout(VkDevice device);
             static VkShaderModule create_shader_module(VkDevice device, const std::vector<uint32_t>& code);
-            static VkRenderPass create_render_pass(VkDevice device, const ImageProperties& image);
-
-            static std::vector<VkFramebuffer> create_framebuffers(
+            static std::vector<std::unique_ptr<Image>> create_offscreen_images(
                 const Device& device,
-                VkRenderPass render_pass,
-                const std::vector<VkImageView>& image_views,
-                const ImageProperties& properties);
+                const ImageProperties& properties,
+                uint32_t count);
 
-            static void record_command_buffer(
-                VkCommandBuffer buffer, 
-                VkPipeline graphics_pipeline,
-                VkRenderPass render_pass,
-                const std::vector<VkFramebuffer>& framebuffers,
-                uint32_t image_index,
-                ImageProperties properties);
+            bool build_frame_graph();
+            void record_command_buffer(VkCommandBuffer buffer, uint32_t image_index) const;
+            void record_scene(VkCommandBuffer buffer) const;
 
             static VkSemaphore create_semaphore(VkDevice device);
-            static VkFence create_fence(VkDevice device);
-            static VkDescriptorSetLayout create_descriptor_set_layout(VkDevice device);
-            static VkDescriptorPool create_descriptor_pool(VkDevice device);
+            static std::vector<VkSemaphore> create_semaphores(VkDevice device, size_t count);
 
             static void bind_vertex_buffer(const VertexBuffer& vertex_buffer, VkCommandBuffer command_buffer);
         };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "VulkanCore.h"
+
+#include <span>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        class Device;
+
+        struct ShaderBinding
+        {
+            uint32_t set = 0;
+            uint32_t binding = 0;
+            VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+            // Product of the array sizes, 0 for a runtime sized array
+            uint32_t count = 1;
+            VkShaderStageFlags stages = 0;
+        };
+
+        struct ShaderVertexInput
+        {
+            uint32_t location = 0;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+        };
+
+        /*
+            Interface of one compiled shader module, read straight from the SPIR-V: descriptor
+            bindings from the DescriptorSet/Binding decorations, the push constant block size from
+            its member offsets, and the vertex inputs from the Location decorations of the entry
+            point's Input variables. Built-ins are skipped.
+        */
+        struct ShaderReflection
+        {
+            VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+            // Sorted by set, then binding
+            std::vector<ShaderBinding> bindings;
+            std::optional<VkPushConstantRange> push_constants;
+            // Vertex shaders only, sorted by location
+            std::vector<ShaderVertexInput> vertex_inputs;
+        };
+
+        // Every stage of a pipeline, bindings declared in several stages are merged
+        struct ProgramReflection
+        {
+            std::vector<ShaderBinding> bindings;
+            // Stages declaring the same block share one range
+            std::vector<VkPushConstantRange> push_constants;
+            std::vector<ShaderVertexInput> vertex_inputs;
+            uint32_t set_count = 0;
+        };
+
+        // A set whose layout is provided instead of reflected, such as one with update after bind bindings
+        struct FixedSetLayout
+        {
+            uint32_t set;
+            VkDescriptorSetLayout layout;
+        };
+
+        struct ReflectedLayout
+        {
+            // One per set up to the highest one used, unused sets get an empty layout
+            std::vector<VkDescriptorSetLayout> set_layouts;
+            VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+        };
+
+        // Empty for modules that are not valid SPIR-V
+        std::optional<ShaderReflection> reflect_shader(std::span<const uint32_t> spirv);
+
+        // Empty when two stages declare the same binding with different types
+        std::optional<ProgramReflection> reflect_program(std::span<const ShaderReflection> stages);
+
+        // Layouts come from the device caches, identical interfaces share the same handles
+        ReflectedLayout create_reflected_layout(const Device& device,
+                                                const ProgramReflection& program,
+                                                std::span<const FixedSetLayout> fixed_sets = {});
+
+        // The attributes of available at the locations the shader reads, warns about inputs without one
+        std::vector<VkVertexInputAttributeDescription> match_vertex_inputs(
+            std::span<const ShaderVertexInput> inputs,
+            std::span<const VkVertexInputAttributeDescription> available);
+    }
+}
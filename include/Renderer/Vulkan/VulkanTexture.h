@@ -3,6 +3,8 @@
 #include "VulkanCore.h"
 #include "VulkanDevice.h"
 
+#include <span>
+
 namespace Aqua
 {
     namespace Vulkan
@@ -11,15 +13,24 @@ namespace Aqua
         {
         public:
             Texture(const Device& device, const std::filesystem::path& filepath);
+            Texture(const Device& device, std::span<const uint8_t> encoded_image);
+            // One layer per file, all of the same size, sampled as a 2D array
+            Texture(const Device& device, std::span<const std::filesystem::path> layer_filepaths);
             Texture(const Texture&) = delete;
             ~Texture();
 
+            // False when loading or uploading failed, the sampler is only created once the upload succeeded
+            bool is_valid() const noexcept { return sampler_ != VK_NULL_HANDLE; }
             const Image& get_image() const noexcept { return image_; }
             VkSampler get_sampler() const noexcept { return sampler_; }
 
         private:
+            static constexpr uint32_t image_channels = 4;
+
             Image image_;
-            VkSampler sampler_;
+            VkSampler sampler_ = VK_NULL_HANDLE;
+
+            void create_texture(const Device& device, std::span<const uint8_t* const> layers, int width, int height);
         };
     }
 }
\ No newline at end of file
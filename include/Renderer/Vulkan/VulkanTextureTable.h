@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VulkanCore.h"
+#include "VulkanDevice.h"
+#include "VulkanTexture.h"
+
+#include <deque>
+#include <limits>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        /*
+            A single descriptor set with one large array of combined image samplers that every draw
+            indexes into, so changing textures between draws binds nothing. The binding is update
+            after bind and partially bound: slots can be written while frames using the set are in
+            flight, and only the slots a draw actually samples have to be valid. Removed slots are
+            handed out again once every submission that could read them has completed.
+        */
+        class TextureTable
+        {
+        public:
+            static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+            // capacity is clamped to the update after bind limits of the device
+            TextureTable(const Device& device, uint32_t capacity);
+            TextureTable(const TextureTable&) = delete;
+            ~TextureTable();
+
+            // Returns the index shaders sample the texture with, invalid_index when the table is full
+            uint32_t add(const Texture& texture);
+            // The texture has to stay alive until the submissions that read the slot complete
+            void remove(uint32_t index);
+
+            VkDescriptorSetLayout get_layout() const noexcept { return layout_; }
+            VkDescriptorSet get_set() const noexcept { return set_; }
+
+            uint32_t capacity() const noexcept { return capacity_; }
+            uint32_t size() const noexcept { return size_; }
+
+            static bool is_supported(const VkPhysicalDeviceVulkan12Features& features);
+
+        private:
+            struct RetiredSlot
+            {
+                uint32_t index;
+                uint64_t value;
+            };
+
+            const Device* device_;
+            VkDescriptorSetLayout layout_ = VK_NULL_HANDLE;
+            VkDescriptorPool pool_ = VK_NULL_HANDLE;
+            VkDescriptorSet set_ = VK_NULL_HANDLE;
+
+            uint32_t capacity_ = 0;
+            uint32_t size_ = 0;
+            // Slots past next_unused_ have never been written
+            uint32_t next_unused_ = 0;
+            std::vector<uint32_t> free_slots_;
+            // Removed slots with the timeline value that has to complete before they are reused
+            std::deque<RetiredSlot> retired_slots_;
+
+            void reclaim_retired_slots();
+
+            static uint32_t get_max_capacity(VkPhysicalDevice physical_device);
+        };
+    }
+}
@@ -1,9 +1,175 @@
 #pragma once
 
+#include "VulkanCore.h"
+
+#include "Utils/Quantization.h"
+
+#include "Math/stm/vector2.h"
+#include "Math/stm/vector3.h"
+#include "Math/stm/vector4.h"
+
 namespace Aqua
 {
     namespace Vulkan
     {
-        
+        /*
+            Vertex attribute storage types
+
+            Each type stores its components in the GPU format named by `format` and converts
+            from/to `value_type`. Quantized types trade precision for fetch bandwidth:
+                Half2/Half4    ~3 significant digits, UVs and small ranged positions
+                Snorm16x4      normals and tangents, ~1.5e-5 step
+                Snorm8x4       low precision normals, ~7.9e-3 step
+                Unorm16x2      UVs inside [0, 1], ~1.5e-5 step
+                Unorm8x4       colors
+            All types are 4 byte aligned so attribute offsets stay aligned for fetch.
+
+            Vertex layouts are described at runtime by the VertexStreamDescription of the packed
+            mesh, Mesh::get_format maps its VertexFormat values to these types.
+        */
+        struct alignas(4) Float2
+        {
+            static constexpr VkFormat format = VK_FORMAT_R32G32_SFLOAT;
+            using value_type = stm::vec2f;
+
+            float data[2]{};
+
+            constexpr Float2() noexcept = default;
+            constexpr Float2(float x, float y) noexcept : data{ x, y } {}
+            constexpr Float2(const value_type& value) noexcept : Float2(value.x, value.y) {}
+
+            constexpr value_type unpack() const noexcept { return { data[0], data[1] }; }
+        };
+
+        struct alignas(4) Float3
+        {
+            static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT;
+            using value_type = stm::vec3f;
+
+            float data[3]{};
+
+            constexpr Float3() noexcept = default;
+            constexpr Float3(float x, float y, float z) noexcept : data{ x, y, z } {}
+            constexpr Float3(const value_type& value) noexcept : Float3(value.x, value.y, value.z) {}
+
+            constexpr value_type unpack() const noexcept { return { data[0], data[1], data[2] }; }
+        };
+
+        struct alignas(4) Float4
+        {
+            static constexpr VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            using value_type = stm::vec4f;
+
+            float data[4]{};
+
+            constexpr Float4() noexcept = default;
+            constexpr Float4(float x, float y, float z, float w) noexcept : data{ x, y, z, w } {}
+            constexpr Float4(const value_type& value) noexcept : Float4(value.x, value.y, value.z, value.w) {}
+
+            constexpr value_type unpack() const noexcept { return { data[0], data[1], data[2], data[3] }; }
+        };
+
+        struct alignas(4) Half2
+        {
+            static constexpr VkFormat format = VK_FORMAT_R16G16_SFLOAT;
+            using value_type = stm::vec2f;
+
+            uint16_t data[2]{};
+
+            constexpr Half2() noexcept = default;
+            constexpr Half2(float x, float y) noexcept : data{ float_to_half(x), float_to_half(y) } {}
+            constexpr Half2(const value_type& value) noexcept : Half2(value.x, value.y) {}
+
+            constexpr value_type unpack() const noexcept { return { half_to_float(data[0]), half_to_float(data[1]) }; }
+        };
+
+        struct alignas(4) Half4
+        {
+            static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
+            using value_type = stm::vec4f;
+
+            uint16_t data[4]{};
+
+            constexpr Half4() noexcept = default;
+            constexpr Half4(float x, float y, float z, float w = 1.0f) noexcept
+                : data{ float_to_half(x), float_to_half(y), float_to_half(z), float_to_half(w) } {}
+            constexpr Half4(const value_type& value) noexcept : Half4(value.x, value.y, value.z, value.w) {}
+
+            constexpr value_type unpack() const noexcept
+            {
+                return { half_to_float(data[0]), half_to_float(data[1]), half_to_float(data[2]), half_to_float(data[3]) };
+            }
+        };
+
+        struct alignas(4) Snorm16x4
+        {
+            static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SNORM;
+            using value_type = stm::vec4f;
+
+            int16_t data[4]{};
+
+            constexpr Snorm16x4() noexcept = default;
+            constexpr Snorm16x4(float x, float y, float z, float w = 0.0f) noexcept
+                : data{ float_to_snorm<int16_t>(x), float_to_snorm<int16_t>(y), float_to_snorm<int16_t>(z), float_to_snorm<int16_t>(w) } {}
+            constexpr Snorm16x4(const value_type& value) noexcept : Snorm16x4(value.x, value.y, value.z, value.w) {}
+            constexpr Snorm16x4(const stm::vec3f& normal) noexcept : Snorm16x4(normal.x, normal.y, normal.z) {}
+
+            constexpr value_type unpack() const noexcept
+            {
+                return { snorm_to_float(data[0]), snorm_to_float(data[1]), snorm_to_float(data[2]), snorm_to_float(data[3]) };
+            }
+        };
+
+        struct alignas(4) Snorm8x4
+        {
+            static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_SNORM;
+            using value_type = stm::vec4f;
+
+            int8_t data[4]{};
+
+            constexpr Snorm8x4() noexcept = default;
+            constexpr Snorm8x4(float x, float y, float z, float w = 0.0f) noexcept
+                : data{ float_to_snorm<int8_t>(x), float_to_snorm<int8_t>(y), float_to_snorm<int8_t>(z), float_to_snorm<int8_t>(w) } {}
+            constexpr Snorm8x4(const value_type& value) noexcept : Snorm8x4(value.x, value.y, value.z, value.w) {}
+            constexpr Snorm8x4(const stm::vec3f& normal) noexcept : Snorm8x4(normal.x, normal.y, normal.z) {}
+
+            constexpr value_type unpack() const noexcept
+            {
+                return { snorm_to_float(data[0]), snorm_to_float(data[1]), snorm_to_float(data[2]), snorm_to_float(data[3]) };
+            }
+        };
+
+        struct alignas(4) Unorm16x2
+        {
+            static constexpr VkFormat format = VK_FORMAT_R16G16_UNORM;
+            using value_type = stm::vec2f;
+
+            uint16_t data[2]{};
+
+            constexpr Unorm16x2() noexcept = default;
+            constexpr Unorm16x2(float x, float y) noexcept : data{ float_to_unorm<uint16_t>(x), float_to_unorm<uint16_t>(y) } {}
+            constexpr Unorm16x2(const value_type& value) noexcept : Unorm16x2(value.x, value.y) {}
+
+            constexpr value_type unpack() const noexcept { return { unorm_to_float(data[0]), unorm_to_float(data[1]) }; }
+        };
+
+        struct alignas(4) Unorm8x4
+        {
+            static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+            using value_type = stm::vec4f;
+
+            uint8_t data[4]{};
+
+            constexpr Unorm8x4() noexcept = default;
+            constexpr Unorm8x4(float r, float g, float b, float a = 1.0f) noexcept
+                : data{ float_to_unorm<uint8_t>(r), float_to_unorm<uint8_t>(g), float_to_unorm<uint8_t>(b), float_to_unorm<uint8_t>(a) } {}
+            constexpr Unorm8x4(const value_type& value) noexcept : Unorm8x4(value.x, value.y, value.z, value.w) {}
+            constexpr Unorm8x4(const stm::vec3f& color) noexcept : Unorm8x4(color.x, color.y, color.z) {}
+
+            constexpr value_type unpack() const noexcept
+            {
+                return { unorm_to_float(data[0]), unorm_to_float(data[1]), unorm_to_float(data[2]), unorm_to_float(data[3]) };
+            }
+        };
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core/Core.h"
+
+#include <span>
+
+namespace Aqua
+{
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const std::filesystem::path& file_path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool is_valid() const noexcept { return data_ != nullptr; }
+
+        const uint8_t* data() const noexcept { return data_; }
+        size_t size() const noexcept { return size_; }
+
+        std::span<const uint8_t> get_bytes() const noexcept { return { data_, size_ }; }
+        std::span<const uint8_t> get_bytes(size_t offset, size_t size) const noexcept;
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+
+        #ifdef AQUA_PLATFORM_WINDOWS
+            void* file_handle_ = nullptr;
+            void* mapping_handle_ = nullptr;
+        #else
+            int file_descriptor_ = -1;
+        #endif
+
+        void unmap() noexcept;
+    };
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Core/Core.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace Aqua
+{
+    /*
+        Conversions between floats and the quantized formats vertex attributes are stored in.
+        Halfs round to nearest even and keep infinities and NaNs, snorm and unorm values are
+        clamped to their range and rounded to nearest.
+    */
+    constexpr uint16_t float_to_half(float value) noexcept
+    {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+        if (magnitude >= 0x7F800000)    // infinity or NaN, NaNs stay quiet NaNs
+            return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x0200 : 0);
+
+        if (magnitude >= 0x477FF000)    // rounds above 65504
+            return sign | 0x7C00;
+
+        if (magnitude < 0x38800000)     // below the smallest normal half, 2^-14
+        {
+            if (magnitude < 0x33000000) // at most half of the smallest denormal, 2^-25
+                return sign;
+
+            const uint32_t exponent = magnitude >> 23;
+            const uint32_t mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+            const uint32_t shift = 126 - exponent;
+
+            uint32_t result = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (result & 1)))
+                ++result;
+
+            return sign | static_cast<uint16_t>(result);
+        }
+
+        // Rebias the exponent from 127 to 15 and round to nearest even, carries propagate into the exponent
+        uint32_t result = (magnitude - 0x38000000) >> 13;
+        const uint32_t remainder = magnitude & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1)))
+            ++result;
+
+        return sign | static_cast<uint16_t>(result);
+    }
+
+    constexpr float half_to_float(uint16_t value) noexcept
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x03FF;
+
+        if (exponent == 0)
+        {
+            const float denormal = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+            return sign ? -denormal : denormal;
+        }
+
+        if (exponent == 31)
+            return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+
+    template<typename T>
+    constexpr T float_to_snorm(float value) noexcept
+    {
+        constexpr float scale = static_cast<float>(std::numeric_limits<T>::max());
+        const float scaled = std::clamp(value, -1.0f, 1.0f) * scale;
+        return static_cast<T>(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+    }
+
+    template<typename T>
+    constexpr float snorm_to_float(T value) noexcept
+    {
+        constexpr float scale = static_cast<float>(std::numeric_limits<T>::max());
+        return std::max(static_cast<float>(value) / scale, -1.0f);
+    }
+
+    template<typename T>
+    constexpr T float_to_unorm(float value) noexcept
+    {
+        constexpr float scale = static_cast<float>(std::numeric_limits<T>::max());
+        return static_cast<T>(std::clamp(value, 0.0f, 1.0f) * scale + 0.5f);
+    }
+
+    template<typename T>
+    constexpr float unorm_to_float(T value) noexcept
+    {
+        constexpr float scale = static_cast<float>(std::numeric_limits<T>::max());
+        return static_cast<float>(value) / scale;
+    }
+}
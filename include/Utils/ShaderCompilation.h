@@ -5,4 +5,5 @@
 namespace Aqua
 {
     std::vector<uint32_t> compile_shader_from_file(const std::filesystem::path& file_path);
-}
\ No newline at end of file
+    std::vector<uint32_t> compile_shader_from_source(std::string_view source, std::string_view name);
+}
@@ -1,4 +1,5 @@
 #include "Application/Application.h"
+#include "Assets/AssetArchive.h"
 #include "Renderer/Renderer.h"
 #include "Window/Window.h"
 #include "Debug/Debug.h"
@@ -16,6 +17,18 @@ namespace Aqua
             AQUA_INFO("Current root path: " + Application::get_root_path().string());
             AQUA_INFO("Current application path: " + Application::get_binary_path().string());
 
+            if (std::filesystem::exists(Application::get_assets_archive_path()))
+            {
+                asset_archive_ = std::make_unique<AssetArchive>(Application::get_assets_archive_path());
+                if (!asset_archive_->is_valid())
+                    asset_archive_ = nullptr;
+            }
+        }
+
+        // The renderer loads its assets while it is constructed, through Application::get_asset_archive,
+        // so this runs once the application owns this object
+        void startup()
+        {
             event_queue_ = std::make_unique<EventQueue>();
 
             if (!Window::Startup()) AQUA_CRITICAL("Window library initialization failure");
@@ -32,6 +45,7 @@ namespace Aqua
         {
             renderer_ = nullptr;
             window_ = nullptr;
+            asset_archive_ = nullptr;
 
             Window::Shutdown();
             Renderer::Shutdown();
@@ -60,6 +74,7 @@ namespace Aqua
         std::unique_ptr<Window> window_;
         std::unique_ptr<Renderer> renderer_;
         std::shared_ptr<EventQueue> event_queue_;
+        std::unique_ptr<AssetArchive> asset_archive_;
     
         bool running_ = false;
     };
@@ -74,6 +89,7 @@ namespace Aqua
         current_application_ = this;
 
         impl_ = std::make_unique<ApplicationImpl>();
+        impl_->startup();
     }
 
     Application::~Application()
@@ -98,4 +114,6 @@ namespace Aqua
 
     Renderer& Application::get_renderer() { return *(impl_->renderer_); }
     const Renderer& Application::get_renderer() const { return *(impl_->renderer_); }
+
+    const AssetArchive* Application::get_asset_archive() const { return impl_ ? impl_->asset_archive_.get() : nullptr; }
 }
\ No newline at end of file
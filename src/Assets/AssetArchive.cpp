@@ -0,0 +1,393 @@
+#include "Assets/AssetArchive.h"
+
+#include "Debug/Debug.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef AQUA_ENABLE_LZ4
+    #include <lz4.h>
+#endif
+
+#ifdef AQUA_ENABLE_ZSTD
+    #include <zstd.h>
+#endif
+
+namespace Aqua
+{
+    static uint64_t align_offset(uint64_t offset, uint64_t alignment) noexcept
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static bool is_power_of_two(uint32_t value) noexcept
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    static bool decompress(AssetCompression compression, std::span<const uint8_t> src, std::span<uint8_t> dst)
+    {
+        switch (compression)
+        {
+        case AssetCompression::None:
+            if (src.size() != dst.size())
+                return false;
+            std::copy(src.begin(), src.end(), dst.begin());
+            return true;
+
+        case AssetCompression::LZ4:
+            #ifdef AQUA_ENABLE_LZ4
+                return LZ4_decompress_safe(reinterpret_cast<const char*>(src.data()),
+                                           reinterpret_cast<char*>(dst.data()),
+                                           static_cast<int>(src.size()),
+                                           static_cast<int>(dst.size())) == static_cast<int>(dst.size());
+            #else
+                AQUA_ERROR("Asset Archive Error: LZ4 support is not enabled in this build");
+                return false;
+            #endif
+
+        case AssetCompression::Zstd:
+            #ifdef AQUA_ENABLE_ZSTD
+            {
+                auto result = ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size());
+                return !ZSTD_isError(result) && result == dst.size();
+            }
+            #else
+                AQUA_ERROR("Asset Archive Error: zstd support is not enabled in this build");
+                return false;
+            #endif
+        }
+
+        return false;
+    }
+
+    static std::optional<std::vector<uint8_t>> compress(AssetCompression compression, std::span<const uint8_t> src)
+    {
+        switch (compression)
+        {
+        case AssetCompression::None:
+            return std::vector<uint8_t>(src.begin(), src.end());
+
+        case AssetCompression::LZ4:
+            #ifdef AQUA_ENABLE_LZ4
+            {
+                std::vector<uint8_t> out(LZ4_compressBound(static_cast<int>(src.size())));
+                int size = LZ4_compress_default(reinterpret_cast<const char*>(src.data()),
+                                                reinterpret_cast<char*>(out.data()),
+                                                static_cast<int>(src.size()),
+                                                static_cast<int>(out.size()));
+                if (size <= 0)
+                    return std::nullopt;
+
+                out.resize(size);
+                return out;
+            }
+            #else
+                AQUA_ERROR("Asset Archive Error: LZ4 support is not enabled in this build");
+                return std::nullopt;
+            #endif
+
+        case AssetCompression::Zstd:
+            #ifdef AQUA_ENABLE_ZSTD
+            {
+                std::vector<uint8_t> out(ZSTD_compressBound(src.size()));
+                auto size = ZSTD_compress(out.data(), out.size(), src.data(), src.size(), ZSTD_CLEVEL_DEFAULT);
+                if (ZSTD_isError(size))
+                    return std::nullopt;
+
+                out.resize(size);
+                return out;
+            }
+            #else
+                AQUA_ERROR("Asset Archive Error: zstd support is not enabled in this build");
+                return std::nullopt;
+            #endif
+        }
+
+        return std::nullopt;
+    }
+
+    AssetArchive::AssetArchive(const std::filesystem::path& archive_path)
+        : file_{ archive_path }
+    {
+        if (!file_.is_valid())
+            return;
+
+        if (file_.size() < sizeof(ArchiveHeader))
+        {
+            AQUA_ERROR("Asset Archive Error: file is too small to be an archive " + archive_path.string());
+            return;
+        }
+
+        ArchiveHeader header{};
+        std::memcpy(&header, file_.data(), sizeof(ArchiveHeader));
+
+        if (header.magic != ArchiveHeader::magic_value || header.version != ArchiveHeader::current_version)
+        {
+            AQUA_ERROR("Asset Archive Error: unsupported archive format " + archive_path.string());
+            return;
+        }
+
+        auto toc = file_.get_bytes(header.toc_offset, header.entry_count * sizeof(ArchiveEntry));
+        auto names = file_.get_bytes(header.names_offset, header.names_size);
+
+        if ((toc.empty() && header.entry_count != 0) || (header.toc_offset % alignof(ArchiveEntry)) != 0)
+        {
+            AQUA_ERROR("Asset Archive Error: corrupted table of contents in " + archive_path.string());
+            return;
+        }
+
+        entries_ = { reinterpret_cast<const ArchiveEntry*>(toc.data()), header.entry_count };
+        names_ = { reinterpret_cast<const char*>(names.data()), names.size() };
+
+        for (const auto& entry : entries_)
+        {
+            if (file_.get_bytes(entry.offset, entry.stored_size).size() != entry.stored_size ||
+                static_cast<uint64_t>(entry.name_offset) + entry.name_length > names_.size())
+            {
+                AQUA_ERROR("Asset Archive Error: entry is outside of archive bounds in " + archive_path.string());
+                entries_ = {};
+                return;
+            }
+        }
+
+        valid_ = true;
+        AQUA_INFO("Opened asset archive " + archive_path.string() + " with " + std::to_string(entries_.size()) + " entries");
+    }
+
+    const ArchiveEntry* AssetArchive::find(std::string_view name) const
+    {
+        auto normalized = normalize_name(name);
+        auto hash = hash_name(normalized);
+
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), hash,
+            [](const ArchiveEntry& entry, uint64_t value) { return entry.name_hash < value; });
+
+        for (; it != entries_.end() && it->name_hash == hash; ++it)
+        {
+            if (get_name(*it) == normalized)
+                return &(*it);
+        }
+
+        return nullptr;
+    }
+
+    std::string_view AssetArchive::get_name(const ArchiveEntry& entry) const
+    {
+        return { names_.data() + entry.name_offset, entry.name_length };
+    }
+
+    std::span<const uint8_t> AssetArchive::view(const ArchiveEntry& entry) const
+    {
+        if (entry.compression != AssetCompression::None)
+        {
+            AQUA_ERROR("Asset Archive Error: cannot view compressed entry " + std::string(get_name(entry)));
+            return {};
+        }
+
+        return file_.get_bytes(entry.offset, entry.stored_size);
+    }
+
+    bool AssetArchive::read(const ArchiveEntry& entry, std::span<uint8_t> dst) const
+    {
+        if (dst.size() < entry.size)
+        {
+            AQUA_ERROR("Asset Archive Error: destination is too small for entry " + std::string(get_name(entry)));
+            return false;
+        }
+
+        auto src = file_.get_bytes(entry.offset, entry.stored_size);
+        if (!decompress(entry.compression, src, dst.first(entry.size)))
+        {
+            AQUA_ERROR("Asset Archive Error: failed to decompress entry " + std::string(get_name(entry)));
+            return false;
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> AssetArchive::read(const ArchiveEntry& entry) const
+    {
+        std::vector<uint8_t> data(entry.size);
+
+        if (!read(entry, data))
+            return {};
+
+        return data;
+    }
+
+    uint64_t AssetArchive::hash_name(std::string_view name) noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    std::string AssetArchive::normalize_name(std::string_view name)
+    {
+        std::string normalized{ name };
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+        auto first = normalized.find_first_not_of('/');
+        return first == std::string::npos ? std::string{} : normalized.substr(first);
+    }
+
+    bool AssetArchiveWriter::add(std::string_view name,
+                                 std::span<const uint8_t> data,
+                                 AssetCompression compression,
+                                 uint32_t alignment)
+    {
+        if (!is_power_of_two(alignment))
+        {
+            AQUA_ERROR("Asset Archive Error: entry alignment must be a power of two");
+            return false;
+        }
+
+        auto stored = compress(compression, data);
+        if (!stored.has_value())
+        {
+            AQUA_ERROR("Asset Archive Error: failed to compress entry " + std::string(name));
+            return false;
+        }
+
+        // Keep incompressible data uncompressed so it can still be viewed without copies
+        if (compression != AssetCompression::None && stored->size() >= data.size())
+        {
+            compression = AssetCompression::None;
+            stored = std::vector<uint8_t>(data.begin(), data.end());
+        }
+
+        entries_.push_back({
+            .name = AssetArchive::normalize_name(name),
+            .data = std::move(stored.value()),
+            .size = data.size(),
+            .alignment = alignment,
+            .compression = compression
+        });
+
+        return true;
+    }
+
+    bool AssetArchiveWriter::add_file(const std::filesystem::path& file_path,
+                                      std::string_view name,
+                                      AssetCompression compression,
+                                      uint32_t alignment)
+    {
+        std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            AQUA_ERROR("Asset Archive Error: cannot open file " + file_path.string());
+            return false;
+        }
+
+        std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+        return add(name, data, compression, alignment);
+    }
+
+    bool AssetArchiveWriter::add_directory(const std::filesystem::path& root,
+                                           AssetCompression compression,
+                                           uint32_t alignment)
+    {
+        bool result = true;
+
+        for (const auto& item : std::filesystem::recursive_directory_iterator(root))
+        {
+            if (!item.is_regular_file())
+                continue;
+
+            auto name = std::filesystem::relative(item.path(), root).generic_string();
+            result &= add_file(item.path(), name, compression, alignment);
+        }
+
+        return result;
+    }
+
+    bool AssetArchiveWriter::write(const std::filesystem::path& archive_path) const
+    {
+        std::vector<ArchiveEntry> toc(entries_.size());
+        std::string names;
+
+        uint64_t offset = sizeof(ArchiveHeader);
+        for (size_t i = 0; i < entries_.size(); ++i)
+        {
+            const auto& pending = entries_[i];
+
+            offset = align_offset(offset, pending.alignment);
+
+            toc[i].name_hash = AssetArchive::hash_name(pending.name);
+            toc[i].offset = offset;
+            toc[i].stored_size = pending.data.size();
+            toc[i].size = pending.size;
+            toc[i].name_offset = static_cast<uint32_t>(names.size());
+            toc[i].name_length = static_cast<uint32_t>(pending.name.size());
+            toc[i].alignment = pending.alignment;
+            toc[i].compression = pending.compression;
+
+            names += pending.name;
+            offset += pending.data.size();
+        }
+
+        ArchiveHeader header{};
+        header.entry_count = static_cast<uint32_t>(toc.size());
+        header.toc_offset = align_offset(offset, alignof(ArchiveEntry));
+        header.names_offset = header.toc_offset + toc.size() * sizeof(ArchiveEntry);
+        header.names_size = names.size();
+
+        // Data stays in insertion order, only the table of contents is sorted for lookups
+        std::vector<size_t> order(toc.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return toc[a].name_hash < toc[b].name_hash; });
+
+        std::ofstream file(archive_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            AQUA_ERROR("Asset Archive Error: cannot create archive " + archive_path.string());
+            return false;
+        }
+
+        auto pad_to = [&file](uint64_t position) {
+            static constexpr char zeros[256]{};
+            for (auto current = static_cast<uint64_t>(file.tellp()); current < position;)
+            {
+                auto count = std::min<uint64_t>(position - current, sizeof(zeros));
+                file.write(zeros, count);
+                current += count;
+            }
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (size_t i = 0; i < entries_.size(); ++i)
+        {
+            pad_to(toc[i].offset);
+            file.write(reinterpret_cast<const char*>(entries_[i].data.data()), entries_[i].data.size());
+        }
+
+        pad_to(header.toc_offset);
+        for (auto index : order)
+            file.write(reinterpret_cast<const char*>(&toc[index]), sizeof(ArchiveEntry));
+
+        file.write(names.data(), names.size());
+
+        if (!file.good())
+        {
+            AQUA_ERROR("Asset Archive Error: failed to write archive " + archive_path.string());
+            return false;
+        }
+
+        AQUA_INFO("Wrote asset archive " + archive_path.string() + " with " + std::to_string(toc.size()) + " entries");
+
+        return true;
+    }
+}
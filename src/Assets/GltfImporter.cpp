@@ -0,0 +1,806 @@
+#include "Assets/Mesh.h"
+
+#include "Debug/Debug.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace Aqua
+{
+    namespace
+    {
+        struct JsonValue
+        {
+            enum class Type { Null, Bool, Number, String, Array, Object };
+
+            Type type = Type::Null;
+            bool boolean = false;
+            double number = 0.0;
+            std::string string;
+            std::vector<JsonValue> array;
+            std::vector<std::string> keys;
+            std::vector<JsonValue> values;
+
+            const JsonValue* find(std::string_view key) const noexcept
+            {
+                for (size_t i = 0; i < keys.size(); ++i)
+                {
+                    if (keys[i] == key)
+                        return &values[i];
+                }
+                return nullptr;
+            }
+
+            size_t size() const noexcept { return type == Type::Array ? array.size() : 0; }
+
+            const JsonValue* at(size_t index) const noexcept
+            {
+                return index < size() ? &array[index] : nullptr;
+            }
+
+            double get_number(std::string_view key, double fallback) const noexcept
+            {
+                auto value = find(key);
+                return value != nullptr && value->type == Type::Number ? value->number : fallback;
+            }
+
+            int64_t get_integer(std::string_view key, int64_t fallback) const noexcept
+            {
+                return static_cast<int64_t>(get_number(key, static_cast<double>(fallback)));
+            }
+
+            std::string_view get_string(std::string_view key) const noexcept
+            {
+                auto value = find(key);
+                return value != nullptr && value->type == Type::String ? std::string_view{ value->string } : std::string_view{};
+            }
+        };
+
+        // Minimal recursive descent JSON parser, enough for glTF documents
+        class JsonParser
+        {
+        public:
+            JsonParser(std::string_view text) : text_{ text } {}
+
+            std::optional<JsonValue> parse()
+            {
+                JsonValue value{};
+                if (!parse_value(value, 0))
+                    return std::nullopt;
+
+                skip_whitespace();
+                if (position_ != text_.size())
+                    return std::nullopt;
+
+                return value;
+            }
+
+        private:
+            static constexpr size_t max_depth = 128;
+
+            std::string_view text_;
+            size_t position_ = 0;
+
+            void skip_whitespace() noexcept
+            {
+                while (position_ < text_.size() &&
+                       (text_[position_] == ' ' || text_[position_] == '\t' || text_[position_] == '\n' || text_[position_] == '\r'))
+                    ++position_;
+            }
+
+            bool consume(char c) noexcept
+            {
+                skip_whitespace();
+                if (position_ < text_.size() && text_[position_] == c)
+                {
+                    ++position_;
+                    return true;
+                }
+                return false;
+            }
+
+            bool consume_literal(std::string_view literal) noexcept
+            {
+                if (text_.substr(position_, literal.size()) != literal)
+                    return false;
+                position_ += literal.size();
+                return true;
+            }
+
+            bool parse_value(JsonValue& value, size_t depth)
+            {
+                if (depth > max_depth)
+                    return false;
+
+                skip_whitespace();
+                if (position_ >= text_.size())
+                    return false;
+
+                switch (text_[position_])
+                {
+                case '{': return parse_object(value, depth);
+                case '[': return parse_array(value, depth);
+                case '"': value.type = JsonValue::Type::String; return parse_string(value.string);
+                case 't': value.type = JsonValue::Type::Bool; value.boolean = true; return consume_literal("true");
+                case 'f': value.type = JsonValue::Type::Bool; value.boolean = false; return consume_literal("false");
+                case 'n': value.type = JsonValue::Type::Null; return consume_literal("null");
+                default:  return parse_number(value);
+                }
+            }
+
+            bool parse_object(JsonValue& value, size_t depth)
+            {
+                value.type = JsonValue::Type::Object;
+                ++position_;
+
+                if (consume('}'))
+                    return true;
+
+                do
+                {
+                    skip_whitespace();
+                    auto& key = value.keys.emplace_back();
+                    if (!parse_string(key) || !consume(':'))
+                        return false;
+                    if (!parse_value(value.values.emplace_back(), depth + 1))
+                        return false;
+                } while (consume(','));
+
+                return consume('}');
+            }
+
+            bool parse_array(JsonValue& value, size_t depth)
+            {
+                value.type = JsonValue::Type::Array;
+                ++position_;
+
+                if (consume(']'))
+                    return true;
+
+                do
+                {
+                    if (!parse_value(value.array.emplace_back(), depth + 1))
+                        return false;
+                } while (consume(','));
+
+                return consume(']');
+            }
+
+            bool parse_number(JsonValue& value)
+            {
+                value.type = JsonValue::Type::Number;
+
+                auto begin = text_.data() + position_;
+                auto end = text_.data() + text_.size();
+                auto result = std::from_chars(begin, end, value.number);
+                if (result.ec != std::errc{})
+                    return false;
+
+                position_ += static_cast<size_t>(result.ptr - begin);
+                return true;
+            }
+
+            static void append_utf8(std::string& out, uint32_t code_point)
+            {
+                if (code_point < 0x80)
+                    out += static_cast<char>(code_point);
+                else if (code_point < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (code_point >> 6));
+                    out += static_cast<char>(0x80 | (code_point & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xE0 | (code_point >> 12));
+                    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code_point & 0x3F));
+                }
+            }
+
+            bool parse_string(std::string& out)
+            {
+                if (position_ >= text_.size() || text_[position_] != '"')
+                    return false;
+                ++position_;
+
+                while (position_ < text_.size())
+                {
+                    char c = text_[position_++];
+                    if (c == '"')
+                        return true;
+                    if (c != '\\')
+                    {
+                        out += c;
+                        continue;
+                    }
+
+                    if (position_ >= text_.size())
+                        return false;
+
+                    switch (text_[position_++])
+                    {
+                    case '"':  out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/':  out += '/'; break;
+                    case 'b':  out += '\b'; break;
+                    case 'f':  out += '\f'; break;
+                    case 'n':  out += '\n'; break;
+                    case 'r':  out += '\r'; break;
+                    case 't':  out += '\t'; break;
+                    case 'u':
+                    {
+                        uint32_t code_point = 0;
+                        auto digits = text_.substr(position_, 4);
+                        auto result = std::from_chars(digits.data(), digits.data() + digits.size(), code_point, 16);
+                        if (digits.size() != 4 || result.ptr != digits.data() + 4)
+                            return false;
+                        position_ += 4;
+                        append_utf8(out, code_point);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+
+                return false;
+            }
+        };
+
+        // Column-major 4x4 matrix, as stored by glTF
+        using NodeTransform = std::array<float, 16>;
+
+        constexpr NodeTransform identity_transform = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+
+        NodeTransform multiply(const NodeTransform& lhs, const NodeTransform& rhs) noexcept
+        {
+            NodeTransform result{};
+            for (size_t column = 0; column < 4; ++column)
+                for (size_t row = 0; row < 4; ++row)
+                    for (size_t k = 0; k < 4; ++k)
+                        result[column * 4 + row] += lhs[k * 4 + row] * rhs[column * 4 + k];
+            return result;
+        }
+
+        // Of the linear part, negative when the transform mirrors
+        float get_determinant(const NodeTransform& m) noexcept
+        {
+            return m[0] * (m[5] * m[10] - m[9] * m[6]) -
+                   m[4] * (m[1] * m[10] - m[9] * m[2]) +
+                   m[8] * (m[1] * m[6]  - m[5] * m[2]);
+        }
+
+        bool read_float_array(const JsonValue* value, float* out, size_t count) noexcept
+        {
+            if (value == nullptr || value->size() != count)
+                return false;
+
+            for (size_t i = 0; i < count; ++i)
+                out[i] = static_cast<float>(value->array[i].number);
+            return true;
+        }
+
+        NodeTransform get_local_transform(const JsonValue& node) noexcept
+        {
+            NodeTransform matrix = identity_transform;
+            if (read_float_array(node.find("matrix"), matrix.data(), 16))
+                return matrix;
+
+            float t[3]{ 0, 0, 0 }, r[4]{ 0, 0, 0, 1 }, s[3]{ 1, 1, 1 };
+            read_float_array(node.find("translation"), t, 3);
+            read_float_array(node.find("rotation"), r, 4);
+            read_float_array(node.find("scale"), s, 3);
+
+            const float x = r[0], y = r[1], z = r[2], w = r[3];
+            return {
+                (1 - 2 * (y * y + z * z)) * s[0], (2 * (x * y + z * w)) * s[0],     (2 * (x * z - y * w)) * s[0],     0,
+                (2 * (x * y - z * w)) * s[1],     (1 - 2 * (x * x + z * z)) * s[1], (2 * (y * z + x * w)) * s[1],     0,
+                (2 * (x * z + y * w)) * s[2],     (2 * (y * z - x * w)) * s[2],     (1 - 2 * (x * x + y * y)) * s[2], 0,
+                t[0], t[1], t[2], 1
+            };
+        }
+
+        std::optional<std::vector<uint8_t>> decode_base64(std::string_view text)
+        {
+            auto decode = [](char c) -> int {
+                if (c >= 'A' && c <= 'Z') return c - 'A';
+                if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+                if (c >= '0' && c <= '9') return c - '0' + 52;
+                if (c == '+') return 62;
+                if (c == '/') return 63;
+                return -1;
+            };
+
+            std::vector<uint8_t> out;
+            out.reserve(text.size() / 4 * 3);
+
+            uint32_t bits = 0;
+            int bit_count = 0;
+            for (char c : text)
+            {
+                if (c == '=')
+                    break;
+
+                int value = decode(c);
+                if (value < 0)
+                    return std::nullopt;
+
+                bits = (bits << 6) | static_cast<uint32_t>(value);
+                bit_count += 6;
+                if (bit_count >= 8)
+                {
+                    bit_count -= 8;
+                    out.push_back(static_cast<uint8_t>(bits >> bit_count));
+                }
+            }
+
+            return out;
+        }
+
+        class GltfDocument
+        {
+        public:
+            GltfDocument(const std::filesystem::path& file_path) : file_path_{ file_path } {}
+
+            bool load();
+            bool append_primitives(const JsonValue& mesh, const NodeTransform& transform, MeshData& out) const;
+            bool append_node(size_t node_index, const NodeTransform& parent, MeshData& out, size_t depth) const;
+
+            const JsonValue& get_root() const noexcept { return root_; }
+
+        private:
+            struct AccessorData
+            {
+                const uint8_t* data = nullptr;
+                size_t count = 0;
+                size_t stride = 0;
+                size_t components = 0;
+                int64_t component_type = 0;
+                bool normalized = false;
+            };
+
+            static constexpr int64_t component_byte = 5120;
+            static constexpr int64_t component_unsigned_byte = 5121;
+            static constexpr int64_t component_short = 5122;
+            static constexpr int64_t component_unsigned_short = 5123;
+            static constexpr int64_t component_unsigned_int = 5125;
+            static constexpr int64_t component_float = 5126;
+
+            static constexpr int64_t mode_triangles = 4;
+            static constexpr size_t max_node_depth = 64;
+
+            std::filesystem::path file_path_;
+            JsonValue root_;
+            std::vector<uint8_t> binary_chunk_;
+            std::vector<std::vector<uint8_t>> buffers_;
+
+            std::optional<AccessorData> get_accessor(int64_t index) const;
+            bool read_floats(int64_t accessor_index, size_t components, std::vector<float>& out) const;
+            bool read_indices(int64_t accessor_index, std::vector<uint32_t>& out) const;
+        };
+
+        bool GltfDocument::load()
+        {
+            std::ifstream file(file_path_, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+            {
+                AQUA_ERROR("Mesh Error: cannot open file " + file_path_.string());
+                return false;
+            }
+
+            std::vector<uint8_t> contents(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(contents.data()), contents.size());
+
+            std::string_view json{ reinterpret_cast<const char*>(contents.data()), contents.size() };
+
+            // Binary container: 12 byte header followed by a JSON chunk and an optional BIN chunk
+            constexpr uint32_t glb_magic = 0x46546C67;      // "glTF"
+            constexpr uint32_t chunk_json = 0x4E4F534A;     // "JSON"
+            constexpr uint32_t chunk_binary = 0x004E4942;   // "BIN\0"
+
+            uint32_t magic = 0;
+            if (contents.size() >= 12)
+                std::memcpy(&magic, contents.data(), sizeof(magic));
+
+            if (magic == glb_magic)
+            {
+                json = {};
+                for (size_t offset = 12; offset + 8 <= contents.size();)
+                {
+                    uint32_t chunk_length = 0, chunk_type = 0;
+                    std::memcpy(&chunk_length, contents.data() + offset, sizeof(uint32_t));
+                    std::memcpy(&chunk_type, contents.data() + offset + 4, sizeof(uint32_t));
+                    offset += 8;
+
+                    if (chunk_length > contents.size() - offset)
+                        break;
+
+                    if (chunk_type == chunk_json)
+                        json = { reinterpret_cast<const char*>(contents.data() + offset), chunk_length };
+                    else if (chunk_type == chunk_binary && binary_chunk_.empty())
+                        binary_chunk_.assign(contents.begin() + offset, contents.begin() + offset + chunk_length);
+
+                    offset += (chunk_length + 3) & ~3u;
+                }
+            }
+
+            auto root = JsonParser{ json }.parse();
+            if (!root.has_value() || root->type != JsonValue::Type::Object)
+            {
+                AQUA_ERROR("Mesh Error: invalid glTF document " + file_path_.string());
+                return false;
+            }
+            root_ = std::move(root.value());
+
+            if (auto buffers = root_.find("buffers"))
+            {
+                for (const auto& buffer : buffers->array)
+                {
+                    auto uri = buffer.get_string("uri");
+                    auto& data = buffers_.emplace_back();
+
+                    if (uri.empty())
+                    {
+                        data = binary_chunk_;
+                    }
+                    else if (uri.starts_with("data:"))
+                    {
+                        auto comma = uri.find(";base64,");
+                        auto decoded = comma == std::string_view::npos ? std::nullopt : decode_base64(uri.substr(comma + 8));
+                        if (!decoded.has_value())
+                        {
+                            AQUA_ERROR("Mesh Error: unsupported data uri in " + file_path_.string());
+                            return false;
+                        }
+                        data = std::move(decoded.value());
+                    }
+                    else
+                    {
+                        auto buffer_path = file_path_.parent_path() / std::filesystem::path{ std::string{ uri } };
+                        std::ifstream buffer_file(buffer_path, std::ios::binary | std::ios::ate);
+                        if (!buffer_file.is_open())
+                        {
+                            AQUA_ERROR("Mesh Error: cannot open glTF buffer " + buffer_path.string());
+                            return false;
+                        }
+
+                        data.resize(static_cast<size_t>(buffer_file.tellg()));
+                        buffer_file.seekg(0);
+                        buffer_file.read(reinterpret_cast<char*>(data.data()), data.size());
+                    }
+
+                    if (data.size() < static_cast<size_t>(buffer.get_integer("byteLength", 0)))
+                    {
+                        AQUA_ERROR("Mesh Error: glTF buffer is smaller than its byteLength in " + file_path_.string());
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        std::optional<GltfDocument::AccessorData> GltfDocument::get_accessor(int64_t index) const
+        {
+            auto accessors = root_.find("accessors");
+            auto accessor = accessors != nullptr && index >= 0 ? accessors->at(static_cast<size_t>(index)) : nullptr;
+            if (accessor == nullptr)
+                return std::nullopt;
+
+            AccessorData result{};
+            result.count = static_cast<size_t>(accessor->get_integer("count", 0));
+            result.component_type = accessor->get_integer("componentType", 0);
+            if (auto normalized = accessor->find("normalized"))
+                result.normalized = normalized->boolean;
+
+            auto type = accessor->get_string("type");
+            if (type == "SCALAR")     result.components = 1;
+            else if (type == "VEC2")  result.components = 2;
+            else if (type == "VEC3")  result.components = 3;
+            else if (type == "VEC4")  result.components = 4;
+            else                      return std::nullopt;
+
+            size_t component_size = 0;
+            switch (result.component_type)
+            {
+            case component_byte:
+            case component_unsigned_byte:  component_size = 1; break;
+            case component_short:
+            case component_unsigned_short: component_size = 2; break;
+            case component_unsigned_int:
+            case component_float:          component_size = 4; break;
+            default:                       return std::nullopt;
+            }
+
+            // Sparse accessors and accessors without a buffer view are not supported
+            auto buffer_views = root_.find("bufferViews");
+            auto view = buffer_views != nullptr ? buffer_views->at(static_cast<size_t>(accessor->get_integer("bufferView", -1))) : nullptr;
+            if (view == nullptr)
+                return std::nullopt;
+
+            auto buffer_index = static_cast<size_t>(view->get_integer("buffer", -1));
+            if (buffer_index >= buffers_.size())
+                return std::nullopt;
+
+            const auto& buffer = buffers_[buffer_index];
+            auto element_size = component_size * result.components;
+            auto offset = static_cast<size_t>(view->get_integer("byteOffset", 0) + accessor->get_integer("byteOffset", 0));
+            result.stride = static_cast<size_t>(view->get_integer("byteStride", static_cast<int64_t>(element_size)));
+
+            if (result.count == 0 || offset + (result.count - 1) * result.stride + element_size > buffer.size())
+                return std::nullopt;
+
+            result.data = buffer.data() + offset;
+            return result;
+        }
+
+        bool GltfDocument::read_floats(int64_t accessor_index, size_t components, std::vector<float>& out) const
+        {
+            auto accessor = get_accessor(accessor_index);
+            if (!accessor.has_value() || accessor->components != components)
+                return false;
+
+            // Integer components map to [0, 1] or [-1, 1] only when the accessor is normalized, otherwise
+            // they are plain integer values, as quantized positions are
+            const bool normalized = accessor->normalized;
+
+            out.resize(accessor->count * components);
+            for (size_t i = 0; i < accessor->count; ++i)
+            {
+                const auto* element = accessor->data + i * accessor->stride;
+                for (size_t c = 0; c < components; ++c)
+                {
+                    float value = 0.0f;
+                    switch (accessor->component_type)
+                    {
+                    case component_float:
+                        std::memcpy(&value, element + c * 4, sizeof(float));
+                        break;
+                    case component_unsigned_byte:
+                        value = normalized ? element[c] / 255.0f : static_cast<float>(element[c]);
+                        break;
+                    case component_byte:
+                    {
+                        const auto raw = static_cast<int8_t>(element[c]);
+                        value = normalized ? std::max(raw / 127.0f, -1.0f) : static_cast<float>(raw);
+                        break;
+                    }
+                    case component_unsigned_short:
+                    {
+                        uint16_t raw = 0;
+                        std::memcpy(&raw, element + c * 2, sizeof(raw));
+                        value = normalized ? raw / 65535.0f : static_cast<float>(raw);
+                        break;
+                    }
+                    case component_short:
+                    {
+                        int16_t raw = 0;
+                        std::memcpy(&raw, element + c * 2, sizeof(raw));
+                        value = normalized ? std::max(raw / 32767.0f, -1.0f) : static_cast<float>(raw);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+
+                    out[i * components + c] = value;
+                }
+            }
+
+            return true;
+        }
+
+        bool GltfDocument::read_indices(int64_t accessor_index, std::vector<uint32_t>& out) const
+        {
+            auto accessor = get_accessor(accessor_index);
+            if (!accessor.has_value() || accessor->components != 1)
+                return false;
+
+            out.resize(accessor->count);
+            for (size_t i = 0; i < accessor->count; ++i)
+            {
+                const auto* element = accessor->data + i * accessor->stride;
+                switch (accessor->component_type)
+                {
+                case component_unsigned_byte:
+                    out[i] = element[0];
+                    break;
+                case component_unsigned_short:
+                {
+                    uint16_t raw = 0;
+                    std::memcpy(&raw, element, sizeof(raw));
+                    out[i] = raw;
+                    break;
+                }
+                case component_unsigned_int:
+                    std::memcpy(&out[i], element, sizeof(uint32_t));
+                    break;
+                default:
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool GltfDocument::append_primitives(const JsonValue& mesh, const NodeTransform& transform, MeshData& out) const
+        {
+            auto primitives = mesh.find("primitives");
+            if (primitives == nullptr)
+                return true;
+
+            std::vector<float> positions, normals, text_coords;
+            std::vector<uint32_t> indices;
+
+            // A mirroring transform turns front faces into back faces, swapping two corners restores the winding
+            const bool mirrored = get_determinant(transform) < 0.0f;
+
+            for (const auto& primitive : primitives->array)
+            {
+                if (primitive.get_integer("mode", mode_triangles) != mode_triangles)
+                {
+                    AQUA_WARN("Mesh Warning: skipping non triangle primitive in " + file_path_.string());
+                    continue;
+                }
+
+                auto attributes = primitive.find("attributes");
+                if (attributes == nullptr || !read_floats(attributes->get_integer("POSITION", -1), 3, positions))
+                {
+                    AQUA_ERROR("Mesh Error: primitive without a valid POSITION attribute in " + file_path_.string());
+                    return false;
+                }
+
+                auto vertex_count = positions.size() / 3;
+                bool has_normals = read_floats(attributes->get_integer("NORMAL", -1), 3, normals) && normals.size() == positions.size();
+                bool has_text_coords = read_floats(attributes->get_integer("TEXCOORD_0", -1), 2, text_coords) && text_coords.size() / 2 == vertex_count;
+
+                if (primitive.find("indices") != nullptr)
+                {
+                    if (!read_indices(primitive.get_integer("indices", -1), indices))
+                    {
+                        AQUA_ERROR("Mesh Error: invalid index accessor in " + file_path_.string());
+                        return false;
+                    }
+                }
+                else
+                {
+                    indices.resize(vertex_count);
+                    for (size_t i = 0; i < vertex_count; ++i)
+                        indices[i] = static_cast<uint32_t>(i);
+                }
+
+                auto base_vertex = out.get_vertex_count();
+                for (size_t i = 0; i < vertex_count; ++i)
+                {
+                    const float* p = &positions[i * 3];
+                    out.positions.push_back({
+                        transform[0] * p[0] + transform[4] * p[1] + transform[8]  * p[2] + transform[12],
+                        transform[1] * p[0] + transform[5] * p[1] + transform[9]  * p[2] + transform[13],
+                        transform[2] * p[0] + transform[6] * p[1] + transform[10] * p[2] + transform[14]
+                    });
+
+                    // Normals use the linear part only and are renormalized, non-uniform scale is approximated
+                    stm::vec3f normal{};
+                    if (has_normals)
+                    {
+                        const float* n = &normals[i * 3];
+                        normal = {
+                            transform[0] * n[0] + transform[4] * n[1] + transform[8]  * n[2],
+                            transform[1] * n[0] + transform[5] * n[1] + transform[9]  * n[2],
+                            transform[2] * n[0] + transform[6] * n[1] + transform[10] * n[2]
+                        };
+                        auto length = normal.abs();
+                        if (length > 0.0f)
+                            normal = normal / length;
+                    }
+                    out.normals.push_back(normal);
+
+                    out.text_coords.push_back(has_text_coords ? stm::vec2f{ text_coords[i * 2], text_coords[i * 2 + 1] } : stm::vec2f{});
+                }
+
+                auto index_offset = out.get_index_count();
+                for (auto index : indices)
+                {
+                    if (index >= vertex_count)
+                    {
+                        AQUA_ERROR("Mesh Error: index out of range in " + file_path_.string());
+                        return false;
+                    }
+                    out.indices.push_back(base_vertex + index);
+                }
+
+                if (mirrored)
+                {
+                    for (size_t i = index_offset; i + 2 < out.indices.size(); i += 3)
+                        std::swap(out.indices[i + 1], out.indices[i + 2]);
+                }
+
+                out.submeshes.push_back({ index_offset, static_cast<uint32_t>(indices.size()) });
+            }
+
+            return true;
+        }
+
+        bool GltfDocument::append_node(size_t node_index, const NodeTransform& parent, MeshData& out, size_t depth) const
+        {
+            auto nodes = root_.find("nodes");
+            auto node = nodes != nullptr ? nodes->at(node_index) : nullptr;
+            if (node == nullptr || depth > max_node_depth)
+            {
+                AQUA_ERROR("Mesh Error: invalid node hierarchy in " + file_path_.string());
+                return false;
+            }
+
+            auto transform = multiply(parent, get_local_transform(*node));
+
+            if (node->find("mesh") != nullptr)
+            {
+                auto meshes = root_.find("meshes");
+                auto mesh = meshes != nullptr ? meshes->at(static_cast<size_t>(node->get_integer("mesh", -1))) : nullptr;
+                if (mesh == nullptr || !append_primitives(*mesh, transform, out))
+                    return false;
+            }
+
+            if (auto children = node->find("children"))
+            {
+                for (const auto& child : children->array)
+                {
+                    if (!append_node(static_cast<size_t>(child.number), transform, out, depth + 1))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    std::optional<MeshData> import_gltf(const std::filesystem::path& file_path)
+    {
+        GltfDocument document{ file_path };
+        if (!document.load())
+            return std::nullopt;
+
+        const auto& root = document.get_root();
+        MeshData mesh{};
+
+        // Flatten the default scene with node transforms applied, or every mesh as is without a scene
+        auto scenes = root.find("scenes");
+        auto scene = scenes != nullptr ? scenes->at(static_cast<size_t>(root.get_integer("scene", 0))) : nullptr;
+        if (scene != nullptr)
+        {
+            if (auto nodes = scene->find("nodes"))
+            {
+                for (const auto& node : nodes->array)
+                {
+                    if (!document.append_node(static_cast<size_t>(node.number), identity_transform, mesh, 0))
+                        return std::nullopt;
+                }
+            }
+        }
+        else if (auto meshes = root.find("meshes"))
+        {
+            for (const auto& item : meshes->array)
+            {
+                if (!document.append_primitives(item, identity_transform, mesh))
+                    return std::nullopt;
+            }
+        }
+
+        if (mesh.indices.empty())
+        {
+            AQUA_ERROR("Mesh Error: no triangles found in " + file_path.string());
+            return std::nullopt;
+        }
+
+        bool has_normals = std::any_of(mesh.normals.begin(), mesh.normals.end(),
+            [](const stm::vec3f& normal) { return normal.norm() > 0.0f; });
+        if (!has_normals)
+            mesh.generate_normals();
+
+        return mesh;
+    }
+}
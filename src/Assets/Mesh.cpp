@@ -0,0 +1,403 @@
+#include "Assets/Mesh.h"
+#include "Assets/MeshOptimizer.h"
+
+#include "Debug/Debug.h"
+#include "Utils/Quantization.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace Aqua
+{
+    static constexpr uint64_t cache_block_alignment = 16;
+
+    static uint64_t align_offset(uint64_t offset, uint64_t alignment) noexcept
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static int64_t get_source_time(const std::filesystem::path& source_path)
+    {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(source_path, error);
+        return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    static uint64_t get_source_size(const std::filesystem::path& source_path)
+    {
+        std::error_code error;
+        auto size = std::filesystem::file_size(source_path, error);
+        return error ? 0 : static_cast<uint64_t>(size);
+    }
+
+    // source holds the attribute's float components, missing ones are stored as zero
+    static void write_attribute(uint8_t* destination, VertexFormat format, const float* source, size_t source_components)
+    {
+        auto component = [source, source_components](size_t i) { return i < source_components ? source[i] : 0.0f; };
+
+        switch (format)
+        {
+        case VertexFormat::Float2:
+        case VertexFormat::Float3:
+        {
+            const size_t count = get_format_size(format) / sizeof(float);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float value = component(i);
+                std::memcpy(destination + i * sizeof(float), &value, sizeof(float));
+            }
+            break;
+        }
+        case VertexFormat::Half2:
+        {
+            const uint16_t half[2] = { float_to_half(component(0)), float_to_half(component(1)) };
+            std::memcpy(destination, half, sizeof(half));
+            break;
+        }
+        case VertexFormat::Snorm16x4:
+        {
+            const int16_t snorm[4] = { float_to_snorm<int16_t>(component(0)), float_to_snorm<int16_t>(component(1)),
+                                       float_to_snorm<int16_t>(component(2)), float_to_snorm<int16_t>(component(3)) };
+            std::memcpy(destination, snorm, sizeof(snorm));
+            break;
+        }
+        }
+    }
+
+    std::vector<VertexStreamDescription> get_packed_streams(VertexStreamLayout layout)
+    {
+        std::vector<VertexStreamDescription> streams;
+        if (layout == VertexStreamLayout::Interleaved)
+        {
+            VertexStreamDescription description{};
+            for (const auto& [attribute, format] : packed_vertex_attributes)
+            {
+                description.attributes[description.attribute_count++] = { attribute, format, description.stride };
+                description.stride += get_format_size(format);
+            }
+            streams.push_back(description);
+        }
+        else
+        {
+            for (const auto& [attribute, format] : packed_vertex_attributes)
+            {
+                VertexStreamDescription description{};
+                description.attributes[description.attribute_count++] = { attribute, format, 0 };
+                description.stride = get_format_size(format);
+                streams.push_back(description);
+            }
+        }
+
+        return streams;
+    }
+
+    void MeshData::generate_normals()
+    {
+        normals.assign(positions.size(), stm::vec3f{ 0.0f, 0.0f, 0.0f });
+
+        // Unnormalized face normals weight each contribution by triangle area
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            auto a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+            auto face_normal = stm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+
+            normals[a] += face_normal;
+            normals[b] += face_normal;
+            normals[c] += face_normal;
+        }
+
+        for (auto& normal : normals)
+        {
+            auto length = normal.abs();
+            normal = length > 0.0f ? normal / length : stm::vec3f{ 0.0f, 0.0f, 1.0f };
+        }
+    }
+
+    PackedMesh::PackedMesh(const MeshData& mesh, VertexStreamLayout layout)
+        : layout_{ layout },
+          vertex_count_{ mesh.get_vertex_count() },
+          streams_{ get_packed_streams(layout) },
+          indices_{ mesh.indices },
+          submeshes_{ mesh.submeshes }
+    {
+        auto get_source = [&mesh](VertexAttribute attribute, uint32_t vertex) -> std::pair<const float*, size_t> {
+            static constexpr float zero[3]{};
+            switch (attribute)
+            {
+            case VertexAttribute::Position: return { mesh.positions[vertex].data(), 3 };
+            case VertexAttribute::Normal:   return { vertex < mesh.normals.size() ? mesh.normals[vertex].data() : zero, 3 };
+            case VertexAttribute::TexCoord: return { vertex < mesh.text_coords.size() ? mesh.text_coords[vertex].data() : zero, 2 };
+            }
+            return { zero, 3 };
+        };
+
+        stream_data_.resize(streams_.size());
+        for (size_t stream = 0; stream < streams_.size(); ++stream)
+        {
+            const auto& description = streams_[stream];
+            auto& data = stream_data_[stream];
+            data.resize(static_cast<size_t>(description.stride) * vertex_count_);
+
+            for (uint32_t vertex = 0; vertex < vertex_count_; ++vertex)
+            {
+                auto* dst = data.data() + static_cast<size_t>(vertex) * description.stride;
+                for (const auto& attribute : description.get_attributes())
+                {
+                    const auto [source, components] = get_source(attribute.attribute, vertex);
+                    write_attribute(dst + attribute.offset, attribute.format, source, components);
+                }
+            }
+        }
+
+        if (submeshes_.empty() && !indices_.empty())
+            submeshes_.push_back({ 0, static_cast<uint32_t>(indices_.size()) });
+
+        constexpr auto max = std::numeric_limits<float>::max();
+        bounds_min_ = { max, max, max };
+        bounds_max_ = { -max, -max, -max };
+        for (const auto& position : mesh.positions)
+        {
+            for (size_t i = 0; i < 3; ++i)
+            {
+                bounds_min_[i] = std::min(bounds_min_[i], position[i]);
+                bounds_max_[i] = std::max(bounds_max_[i], position[i]);
+            }
+        }
+
+        if (mesh.positions.empty())
+            bounds_min_ = bounds_max_ = { 0.0f, 0.0f, 0.0f };
+    }
+
+    MeshView PackedMesh::get_view() const
+    {
+        MeshView view{};
+        view.vertex_count = vertex_count_;
+        view.streams = streams_;
+        for (const auto& data : stream_data_)
+            view.stream_data.emplace_back(data);
+        view.indices = indices_;
+        view.submeshes = submeshes_;
+        view.bounds_min = bounds_min_;
+        view.bounds_max = bounds_max_;
+
+        return view;
+    }
+
+    MeshCache::MeshCache(const std::filesystem::path& cache_path)
+        : file_{ cache_path }
+    {
+        if (!file_.is_valid())
+            return;
+
+        if (file_.size() < sizeof(MeshCacheHeader))
+        {
+            AQUA_ERROR("Mesh Error: file is too small to be a mesh cache " + cache_path.string());
+            return;
+        }
+
+        std::memcpy(&header_, file_.data(), sizeof(MeshCacheHeader));
+
+        if (header_.magic != MeshCacheHeader::magic_value || header_.version != MeshCacheHeader::current_version)
+        {
+            AQUA_WARN("Mesh Warning: unsupported mesh cache format " + cache_path.string());
+            return;
+        }
+
+        auto descriptions = file_.get_bytes(header_.descriptions_offset, header_.stream_count * sizeof(VertexStreamDescription));
+        auto streams = file_.get_bytes(header_.streams_offset, header_.stream_count * sizeof(MeshCacheStream));
+        auto submeshes = file_.get_bytes(header_.submeshes_offset, header_.submesh_count * sizeof(Submesh));
+        auto indices = file_.get_bytes(header_.indices_offset, header_.index_count * sizeof(uint32_t));
+
+        if (descriptions.size() != header_.stream_count * sizeof(VertexStreamDescription) ||
+            streams.size() != header_.stream_count * sizeof(MeshCacheStream) ||
+            submeshes.size() != header_.submesh_count * sizeof(Submesh) ||
+            indices.size() != header_.index_count * sizeof(uint32_t))
+        {
+            AQUA_ERROR("Mesh Error: corrupted mesh cache " + cache_path.string());
+            return;
+        }
+
+        for (const auto& description : std::span{ reinterpret_cast<const VertexStreamDescription*>(descriptions.data()), header_.stream_count })
+        {
+            const bool known_formats = description.attribute_count <= VertexStreamDescription::max_attributes &&
+                std::all_of(description.attributes.begin(), description.attributes.begin() + description.attribute_count,
+                    [](const VertexStreamAttribute& attribute) { return get_format_size(attribute.format) != 0; });
+            if (!known_formats)
+            {
+                AQUA_ERROR("Mesh Error: unknown vertex format in mesh cache " + cache_path.string());
+                return;
+            }
+        }
+
+        for (const auto& stream : std::span{ reinterpret_cast<const MeshCacheStream*>(streams.data()), header_.stream_count })
+        {
+            if (file_.get_bytes(stream.offset, stream.size).size() != stream.size)
+            {
+                AQUA_ERROR("Mesh Error: vertex stream is outside of mesh cache bounds " + cache_path.string());
+                return;
+            }
+        }
+
+        // A stale or corrupted cache would otherwise fetch vertices past the streams, it is rebuilt instead
+        const std::span<const uint32_t> index_values{ reinterpret_cast<const uint32_t*>(indices.data()), header_.index_count };
+        if (std::any_of(index_values.begin(), index_values.end(), [this](uint32_t index) { return index >= header_.vertex_count; }))
+        {
+            AQUA_ERROR("Mesh Error: index out of range in mesh cache " + cache_path.string());
+            return;
+        }
+
+        valid_ = true;
+    }
+
+    bool MeshCache::is_up_to_date(const std::filesystem::path& source_path) const
+    {
+        return valid_ &&
+               header_.source_size == get_source_size(source_path) &&
+               header_.source_time == get_source_time(source_path);
+    }
+
+    MeshView MeshCache::get_view() const
+    {
+        if (!valid_)
+            return {};
+
+        const auto* descriptions = reinterpret_cast<const VertexStreamDescription*>(file_.data() + header_.descriptions_offset);
+        const auto* streams = reinterpret_cast<const MeshCacheStream*>(file_.data() + header_.streams_offset);
+
+        MeshView view{};
+        view.vertex_count = header_.vertex_count;
+        view.streams.assign(descriptions, descriptions + header_.stream_count);
+        for (uint32_t i = 0; i < header_.stream_count; ++i)
+            view.stream_data.push_back(file_.get_bytes(streams[i].offset, streams[i].size));
+        view.indices = { reinterpret_cast<const uint32_t*>(file_.data() + header_.indices_offset), header_.index_count };
+        view.submeshes = { reinterpret_cast<const Submesh*>(file_.data() + header_.submeshes_offset), header_.submesh_count };
+        view.bounds_min = { header_.bounds_min[0], header_.bounds_min[1], header_.bounds_min[2] };
+        view.bounds_max = { header_.bounds_max[0], header_.bounds_max[1], header_.bounds_max[2] };
+
+        return view;
+    }
+
+    bool write_mesh_cache(const PackedMesh& mesh,
+                          const std::filesystem::path& source_path,
+                          const std::filesystem::path& cache_path)
+    {
+        MeshCacheHeader header{};
+        header.source_size = get_source_size(source_path);
+        header.source_time = get_source_time(source_path);
+        header.vertex_count = mesh.vertex_count_;
+        header.index_count = static_cast<uint32_t>(mesh.indices_.size());
+        header.stream_count = static_cast<uint32_t>(mesh.streams_.size());
+        header.submesh_count = static_cast<uint32_t>(mesh.submeshes_.size());
+        header.layout = mesh.layout_;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            header.bounds_min[i] = mesh.bounds_min_[i];
+            header.bounds_max[i] = mesh.bounds_max_[i];
+        }
+
+        uint64_t offset = align_offset(sizeof(MeshCacheHeader), cache_block_alignment);
+        header.descriptions_offset = offset;
+        offset = align_offset(offset + mesh.streams_.size() * sizeof(VertexStreamDescription), cache_block_alignment);
+        header.streams_offset = offset;
+        offset = align_offset(offset + mesh.streams_.size() * sizeof(MeshCacheStream), cache_block_alignment);
+        header.submeshes_offset = offset;
+        offset = align_offset(offset + mesh.submeshes_.size() * sizeof(Submesh), cache_block_alignment);
+        header.indices_offset = offset;
+        offset = align_offset(offset + mesh.indices_.size() * sizeof(uint32_t), cache_block_alignment);
+
+        std::vector<MeshCacheStream> streams(mesh.stream_data_.size());
+        for (size_t i = 0; i < streams.size(); ++i)
+        {
+            streams[i].offset = offset;
+            streams[i].size = mesh.stream_data_[i].size();
+            offset = align_offset(offset + streams[i].size, cache_block_alignment);
+        }
+
+        std::ofstream file(cache_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            AQUA_ERROR("Mesh Error: cannot create mesh cache " + cache_path.string());
+            return false;
+        }
+
+        auto write_block = [&file](uint64_t position, const void* data, size_t size) {
+            static constexpr char zeros[cache_block_alignment]{};
+            for (auto current = static_cast<uint64_t>(file.tellp()); current < position; ++current)
+                file.write(zeros, 1);
+            file.write(static_cast<const char*>(data), size);
+        };
+
+        write_block(0, &header, sizeof(header));
+        write_block(header.descriptions_offset, mesh.streams_.data(), mesh.streams_.size() * sizeof(VertexStreamDescription));
+        write_block(header.streams_offset, streams.data(), streams.size() * sizeof(MeshCacheStream));
+        write_block(header.submeshes_offset, mesh.submeshes_.data(), mesh.submeshes_.size() * sizeof(Submesh));
+        write_block(header.indices_offset, mesh.indices_.data(), mesh.indices_.size() * sizeof(uint32_t));
+        for (size_t i = 0; i < streams.size(); ++i)
+            write_block(streams[i].offset, mesh.stream_data_[i].data(), mesh.stream_data_[i].size());
+
+        if (!file.good())
+        {
+            AQUA_ERROR("Mesh Error: failed to write mesh cache " + cache_path.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    std::optional<MeshData> import_mesh(const std::filesystem::path& file_path)
+    {
+        auto extension = file_path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == ".obj")
+            return import_obj(file_path);
+        if (extension == ".gltf" || extension == ".glb")
+            return import_gltf(file_path);
+
+        AQUA_ERROR("Mesh Error: unsupported mesh format " + file_path.string());
+        return std::nullopt;
+    }
+
+    std::filesystem::path get_mesh_cache_path(const std::filesystem::path& source_path)
+    {
+        auto cache_path = source_path;
+        cache_path += ".aqmesh";
+        return cache_path;
+    }
+
+    std::optional<MeshCache> load_mesh(const std::filesystem::path& source_path, VertexStreamLayout layout)
+    {
+        auto cache_path = get_mesh_cache_path(source_path);
+
+        if (std::filesystem::exists(cache_path))
+        {
+            MeshCache cache{ cache_path };
+            if (cache.is_up_to_date(source_path) && cache.get_header().layout == layout)
+                return cache;
+        }
+
+        auto mesh = import_mesh(source_path);
+        if (!mesh.has_value())
+            return std::nullopt;
+
+        if (mesh->normals.empty())
+            mesh->generate_normals();
+
+        optimize_mesh(mesh.value());
+
+        if (!write_mesh_cache(PackedMesh{ mesh.value(), layout }, source_path, cache_path))
+            return std::nullopt;
+
+        AQUA_INFO("Built mesh cache " + cache_path.string());
+
+        MeshCache cache{ cache_path };
+        if (!cache.is_valid())
+            return std::nullopt;
+
+        return cache;
+    }
+}
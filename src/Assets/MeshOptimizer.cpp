@@ -0,0 +1,408 @@
+#include "Assets/MeshOptimizer.h"
+
+#include "Debug/Debug.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Aqua
+{
+    namespace
+    {
+        // Forsyth scoring, simulated as an LRU cache larger than the hardware FIFO
+        constexpr uint32_t forsyth_cache_size = 32;
+        constexpr uint32_t forsyth_max_valence = 32;
+        constexpr float forsyth_last_triangle_score = 0.75f;
+        constexpr float forsyth_cache_decay_power = 1.5f;
+        constexpr float forsyth_valence_boost_scale = 2.0f;
+        constexpr float forsyth_valence_boost_power = 0.5f;
+
+        struct ForsythTables
+        {
+            std::array<float, forsyth_cache_size + 1> cache{};
+            std::array<float, forsyth_max_valence + 1> valence{};
+
+            ForsythTables()
+            {
+                for (uint32_t position = 0; position < forsyth_cache_size; ++position)
+                {
+                    if (position < 3)
+                        cache[position] = forsyth_last_triangle_score;
+                    else
+                    {
+                        float scaler = 1.0f - static_cast<float>(position - 3) / (forsyth_cache_size - 3);
+                        cache[position] = std::pow(scaler, forsyth_cache_decay_power);
+                    }
+                }
+                cache[forsyth_cache_size] = 0.0f;  // not in cache
+
+                valence[0] = 0.0f;
+                for (uint32_t count = 1; count <= forsyth_max_valence; ++count)
+                    valence[count] = forsyth_valence_boost_scale * std::pow(static_cast<float>(count), -forsyth_valence_boost_power);
+            }
+
+            float score(uint32_t cache_position, uint32_t remaining_triangles) const noexcept
+            {
+                // Vertices without remaining triangles never contribute
+                if (remaining_triangles == 0)
+                    return -1.0f;
+
+                return cache[cache_position] + valence[std::min(remaining_triangles, forsyth_max_valence)];
+            }
+        };
+
+        const ForsythTables& get_forsyth_tables()
+        {
+            static const ForsythTables tables{};
+            return tables;
+        }
+
+        // Vertex to triangle adjacency in compressed row form
+        struct TriangleAdjacency
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> counts;
+            std::vector<uint32_t> triangles;
+
+            TriangleAdjacency(std::span<const uint32_t> indices, uint32_t vertex_count)
+                : offsets(vertex_count + 1, 0), counts(vertex_count, 0), triangles(indices.size())
+            {
+                for (auto index : indices)
+                    ++counts[index];
+
+                for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+                    offsets[vertex + 1] = offsets[vertex] + counts[vertex];
+
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t i = 0; i < indices.size(); ++i)
+                    triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        };
+    }
+
+    VertexCacheStatistics analyze_vertex_cache(std::span<const uint32_t> indices,
+                                               uint32_t vertex_count,
+                                               uint32_t cache_size)
+    {
+        VertexCacheStatistics statistics{};
+        if (indices.size() < 3 || vertex_count == 0 || cache_size == 0)
+            return statistics;
+
+        // Timestamps emulate a FIFO: a vertex hits while fewer than cache_size misses happened since it was loaded
+        std::vector<uint32_t> loaded_at(vertex_count, 0);
+        std::vector<bool> used(vertex_count, false);
+        uint32_t unique_vertices = 0;
+        uint32_t time = cache_size + 1;
+
+        for (auto index : indices)
+        {
+            if (time - loaded_at[index] > cache_size)
+            {
+                loaded_at[index] = time++;
+                ++statistics.vertices_transformed;
+            }
+
+            if (!used[index])
+            {
+                used[index] = true;
+                ++unique_vertices;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(indices.size() / 3);
+        statistics.atvr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(unique_vertices);
+
+        return statistics;
+    }
+
+    void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count)
+    {
+        if (indices.size() % 3 != 0)
+        {
+            AQUA_ERROR("Mesh Error: vertex cache optimization requires a triangle list");
+            return;
+        }
+
+        const auto& tables = get_forsyth_tables();
+        const auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+        if (triangle_count == 0)
+            return;
+
+        std::vector<uint32_t> source(indices.begin(), indices.end());
+        TriangleAdjacency adjacency{ source, vertex_count };
+
+        std::vector<uint32_t> live_triangles = adjacency.counts;
+        std::vector<uint32_t> cache_position(vertex_count, forsyth_cache_size);
+        std::vector<float> vertex_score(vertex_count);
+        std::vector<float> triangle_score(triangle_count, 0.0f);
+        std::vector<bool> emitted(triangle_count, false);
+
+        for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+            vertex_score[vertex] = tables.score(forsyth_cache_size, live_triangles[vertex]);
+
+        for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+            for (uint32_t corner = 0; corner < 3; ++corner)
+                triangle_score[triangle] += vertex_score[source[triangle * 3 + corner]];
+
+        // LRU cache with room for the three vertices pushed by the emitted triangle
+        std::array<uint32_t, forsyth_cache_size + 3> cache{};
+        std::array<uint32_t, forsyth_cache_size + 3> next_cache{};
+        uint32_t cache_count = 0;
+
+        uint32_t best_triangle = static_cast<uint32_t>(
+            std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+        uint32_t scan_cursor = 0;
+
+        for (uint32_t output = 0; output < triangle_count; ++output)
+        {
+            // No candidate from the cache, fall back to the next triangle that was not emitted yet
+            if (best_triangle == UINT32_MAX)
+            {
+                while (emitted[scan_cursor])
+                    ++scan_cursor;
+                best_triangle = scan_cursor;
+            }
+
+            const uint32_t* triangle = &source[best_triangle * 3];
+            indices[output * 3 + 0] = triangle[0];
+            indices[output * 3 + 1] = triangle[1];
+            indices[output * 3 + 2] = triangle[2];
+            emitted[best_triangle] = true;
+
+            uint32_t next_count = 0;
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                auto vertex = triangle[corner];
+                next_cache[next_count++] = vertex;
+
+                // Detach the emitted triangle from the vertex's live triangle list
+                auto* begin = adjacency.triangles.data() + adjacency.offsets[vertex];
+                auto* end = begin + live_triangles[vertex];
+                auto* it = std::find(begin, end, best_triangle);
+                std::swap(*it, *(end - 1));
+                --live_triangles[vertex];
+            }
+
+            for (uint32_t i = 0; i < cache_count; ++i)
+            {
+                auto vertex = cache[i];
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                    next_cache[next_count++] = vertex;
+            }
+
+            // Vertices pushed out of the cache lose their cache score
+            for (uint32_t i = forsyth_cache_size; i < next_count; ++i)
+                cache_position[next_cache[i]] = forsyth_cache_size;
+
+            cache_count = std::min(next_count, forsyth_cache_size);
+            std::swap(cache, next_cache);
+
+            auto update_vertex = [&](uint32_t vertex, uint32_t position) {
+                cache_position[vertex] = position;
+
+                float score = tables.score(position, live_triangles[vertex]);
+                float delta = score - vertex_score[vertex];
+                vertex_score[vertex] = score;
+
+                auto* begin = adjacency.triangles.data() + adjacency.offsets[vertex];
+                for (auto* it = begin; it != begin + live_triangles[vertex]; ++it)
+                    triangle_score[*it] += delta;
+            };
+
+            for (uint32_t i = cache_count; i < next_count; ++i)
+                update_vertex(cache[i], forsyth_cache_size);
+
+            best_triangle = UINT32_MAX;
+            float best_score = 0.0f;
+
+            for (uint32_t i = 0; i < cache_count; ++i)
+            {
+                auto vertex = cache[i];
+                update_vertex(vertex, i);
+
+                auto* begin = adjacency.triangles.data() + adjacency.offsets[vertex];
+                for (auto* it = begin; it != begin + live_triangles[vertex]; ++it)
+                {
+                    if (triangle_score[*it] > best_score)
+                    {
+                        best_score = triangle_score[*it];
+                        best_triangle = *it;
+                    }
+                }
+            }
+        }
+    }
+
+    void optimize_overdraw(std::span<uint32_t> indices,
+                           std::span<const stm::vec3f> positions,
+                           float threshold,
+                           uint32_t cache_size)
+    {
+        const auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+        if (triangle_count == 0 || cache_size == 0)
+            return;
+
+        std::vector<uint32_t> loaded_at(positions.size(), 0);
+        uint32_t time = cache_size + 1;
+
+        auto reset_cache = [&time, cache_size]() { time += cache_size + 1; };
+        auto count_misses = [&](uint32_t triangle) {
+            uint32_t misses = 0;
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                auto index = indices[triangle * 3 + corner];
+                if (time - loaded_at[index] > cache_size)
+                {
+                    loaded_at[index] = time++;
+                    ++misses;
+                }
+            }
+            return misses;
+        };
+
+        // Hard boundaries, where the cache optimized order misses on all three vertices
+        std::vector<uint32_t> hard_starts;
+        for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            if (count_misses(triangle) == 3 || triangle == 0)
+                hard_starts.push_back(triangle);
+        }
+        hard_starts.push_back(triangle_count);
+
+        // Soft boundaries split hard clusters once the local ACMR from a cold cache drops
+        // below threshold times the cluster's ACMR, bounding the cache cost of reordering
+        std::vector<uint32_t> cluster_starts;
+        for (size_t i = 0; i + 1 < hard_starts.size(); ++i)
+        {
+            auto first = hard_starts[i];
+            auto last = hard_starts[i + 1];
+
+            reset_cache();
+            uint32_t cluster_misses = 0;
+            for (auto triangle = first; triangle < last; ++triangle)
+                cluster_misses += count_misses(triangle);
+            float cluster_acmr = static_cast<float>(cluster_misses) / static_cast<float>(last - first);
+
+            reset_cache();
+            cluster_starts.push_back(first);
+            uint32_t start = first;
+            uint32_t misses = 0;
+            for (auto triangle = first; triangle < last; ++triangle)
+            {
+                misses += count_misses(triangle);
+
+                float local_acmr = static_cast<float>(misses) / static_cast<float>(triangle - start + 1);
+                if (triangle + 1 < last && local_acmr <= threshold * cluster_acmr)
+                {
+                    start = triangle + 1;
+                    misses = 0;
+                    cluster_starts.push_back(start);
+                    reset_cache();
+                }
+            }
+        }
+
+        stm::vec3f mesh_centroid{ 0.0f, 0.0f, 0.0f };
+        for (auto index : indices)
+            mesh_centroid += positions[index];
+        mesh_centroid = mesh_centroid / static_cast<float>(indices.size());
+
+        // Clusters facing away from the mesh center (likely occluders) are drawn first
+        struct Cluster
+        {
+            uint32_t first_triangle;
+            uint32_t triangle_count;
+            float sort_key;
+        };
+
+        std::vector<Cluster> clusters(cluster_starts.size());
+        for (size_t i = 0; i < cluster_starts.size(); ++i)
+        {
+            auto& cluster = clusters[i];
+            cluster.first_triangle = cluster_starts[i];
+            cluster.triangle_count = (i + 1 < cluster_starts.size() ? cluster_starts[i + 1] : triangle_count) - cluster.first_triangle;
+
+            stm::vec3f centroid{ 0.0f, 0.0f, 0.0f };
+            stm::vec3f normal{ 0.0f, 0.0f, 0.0f };
+            for (uint32_t triangle = cluster.first_triangle; triangle < cluster.first_triangle + cluster.triangle_count; ++triangle)
+            {
+                const auto& a = positions[indices[triangle * 3 + 0]];
+                const auto& b = positions[indices[triangle * 3 + 1]];
+                const auto& c = positions[indices[triangle * 3 + 2]];
+
+                centroid += a + b + c;
+                normal += stm::cross(b - a, c - a);
+            }
+
+            centroid = centroid / static_cast<float>(cluster.triangle_count * 3);
+            auto length = normal.abs();
+            cluster.sort_key = length > 0.0f ? ((centroid - mesh_centroid) * normal) / length : 0.0f;
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(),
+            [](const Cluster& lhs, const Cluster& rhs) { return lhs.sort_key > rhs.sort_key; });
+
+        std::vector<uint32_t> source(indices.begin(), indices.end());
+        size_t output = 0;
+        for (const auto& cluster : clusters)
+        {
+            auto begin = source.begin() + static_cast<size_t>(cluster.first_triangle) * 3;
+            std::copy(begin, begin + static_cast<size_t>(cluster.triangle_count) * 3, indices.begin() + output);
+            output += static_cast<size_t>(cluster.triangle_count) * 3;
+        }
+    }
+
+    uint32_t optimize_vertex_fetch(MeshData& mesh)
+    {
+        constexpr uint32_t unused = UINT32_MAX;
+
+        std::vector<uint32_t> remap(mesh.get_vertex_count(), unused);
+        uint32_t next_vertex = 0;
+
+        for (auto& index : mesh.indices)
+        {
+            if (remap[index] == unused)
+                remap[index] = next_vertex++;
+            index = remap[index];
+        }
+
+        auto reorder = [&remap, next_vertex](auto& attribute) {
+            if (attribute.size() != remap.size())
+                return;
+
+            std::remove_reference_t<decltype(attribute)> reordered(next_vertex);
+            for (size_t vertex = 0; vertex < remap.size(); ++vertex)
+            {
+                if (remap[vertex] != unused)
+                    reordered[remap[vertex]] = attribute[vertex];
+            }
+            attribute = std::move(reordered);
+        };
+
+        reorder(mesh.positions);
+        reorder(mesh.normals);
+        reorder(mesh.text_coords);
+
+        return next_vertex;
+    }
+
+    void optimize_mesh(MeshData& mesh)
+    {
+        const auto vertex_count = mesh.get_vertex_count();
+
+        std::vector<Submesh> submeshes = mesh.submeshes;
+        if (submeshes.empty())
+            submeshes.push_back({ 0, mesh.get_index_count() });
+
+        // Submeshes are optimized independently so their index ranges stay intact
+        for (const auto& submesh : submeshes)
+        {
+            std::span<uint32_t> indices{ mesh.indices.data() + submesh.index_offset, submesh.index_count };
+            optimize_vertex_cache(indices, vertex_count);
+            optimize_overdraw(indices, mesh.positions);
+        }
+
+        optimize_vertex_fetch(mesh);
+    }
+}
@@ -0,0 +1,226 @@
+#include "Assets/Mesh.h"
+
+#include "Debug/Debug.h"
+
+#include <charconv>
+#include <fstream>
+#include <unordered_map>
+
+namespace Aqua
+{
+    namespace
+    {
+        struct ObjVertexKey
+        {
+            int32_t position;
+            int32_t text_coord;
+            int32_t normal;
+
+            bool operator==(const ObjVertexKey&) const noexcept = default;
+        };
+
+        struct ObjVertexKeyHash
+        {
+            size_t operator()(const ObjVertexKey& key) const noexcept
+            {
+                uint64_t hash = static_cast<uint32_t>(key.position);
+                hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.text_coord);
+                hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.normal);
+                return static_cast<size_t>(hash ^ (hash >> 32));
+            }
+        };
+
+        std::string_view trim_start(std::string_view text) noexcept
+        {
+            auto first = text.find_first_not_of(" \t");
+            return first == std::string_view::npos ? std::string_view{} : text.substr(first);
+        }
+
+        std::string_view next_token(std::string_view& text) noexcept
+        {
+            text = trim_start(text);
+            auto end = text.find_first_of(" \t");
+            auto token = text.substr(0, end);
+            text = end == std::string_view::npos ? std::string_view{} : text.substr(end);
+            return token;
+        }
+
+        bool parse_float(std::string_view token, float& value) noexcept
+        {
+            auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+            return result.ec == std::errc{};
+        }
+
+        bool parse_index(std::string_view token, int32_t& value) noexcept
+        {
+            if (token.empty())
+            {
+                value = 0;
+                return true;
+            }
+
+            auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+            return result.ec == std::errc{};
+        }
+
+        // Resolves a 1-based (or negative, relative) OBJ index to a 0-based one, -1 if absent
+        int32_t resolve_index(int32_t index, size_t count) noexcept
+        {
+            if (index > 0)
+                return index - 1;
+            if (index < 0)
+                return static_cast<int32_t>(count) + index;
+            return -1;
+        }
+    }
+
+    std::optional<MeshData> import_obj(const std::filesystem::path& file_path)
+    {
+        std::ifstream file(file_path);
+        if (!file.is_open())
+        {
+            AQUA_ERROR("Mesh Error: cannot open file " + file_path.string());
+            return std::nullopt;
+        }
+
+        std::vector<stm::vec3f> positions;
+        std::vector<stm::vec3f> normals;
+        std::vector<stm::vec2f> text_coords;
+
+        MeshData mesh{};
+        std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertex_lookup;
+        std::vector<uint32_t> face;
+        bool has_normals = false;
+        bool has_text_coords = false;
+
+        auto begin_submesh = [&mesh]() {
+            auto index_count = mesh.get_index_count();
+            if (!mesh.submeshes.empty())
+            {
+                // Reuse the open submesh until it receives faces
+                if (mesh.submeshes.back().index_offset == index_count)
+                    return;
+                mesh.submeshes.back().index_count = index_count - mesh.submeshes.back().index_offset;
+            }
+            mesh.submeshes.push_back({ index_count, 0 });
+        };
+
+        begin_submesh();
+
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(file, line))
+        {
+            ++line_number;
+
+            std::string_view rest = line;
+            if (!rest.empty() && rest.back() == '\r')
+                rest.remove_suffix(1);
+
+            auto keyword = next_token(rest);
+            if (keyword.empty() || keyword[0] == '#')
+                continue;
+
+            if (keyword == "v" || keyword == "vn")
+            {
+                stm::vec3f value{};
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    if (!parse_float(next_token(rest), value[i]))
+                    {
+                        AQUA_ERROR("Mesh Error: invalid vector at line " + std::to_string(line_number) + " in " + file_path.string());
+                        return std::nullopt;
+                    }
+                }
+                (keyword == "v" ? positions : normals).push_back(value);
+            }
+            else if (keyword == "vt")
+            {
+                stm::vec2f value{};
+                if (!parse_float(next_token(rest), value.x) || !parse_float(next_token(rest), value.y))
+                {
+                    AQUA_ERROR("Mesh Error: invalid texture coordinate at line " + std::to_string(line_number) + " in " + file_path.string());
+                    return std::nullopt;
+                }
+                // OBJ uses a bottom-left origin, Vulkan samples from the top-left
+                value.y = 1.0f - value.y;
+                text_coords.push_back(value);
+            }
+            else if (keyword == "f")
+            {
+                face.clear();
+                for (auto token = next_token(rest); !token.empty(); token = next_token(rest))
+                {
+                    int32_t raw[3]{};
+                    size_t component = 0;
+                    for (size_t start = 0; component < 3; ++component)
+                    {
+                        auto slash = token.find('/', start);
+                        if (!parse_index(token.substr(start, slash - start), raw[component]))
+                        {
+                            AQUA_ERROR("Mesh Error: invalid face index at line " + std::to_string(line_number) + " in " + file_path.string());
+                            return std::nullopt;
+                        }
+                        if (slash == std::string_view::npos)
+                            break;
+                        start = slash + 1;
+                    }
+
+                    ObjVertexKey key{
+                        resolve_index(raw[0], positions.size()),
+                        resolve_index(raw[1], text_coords.size()),
+                        resolve_index(raw[2], normals.size())
+                    };
+
+                    if (key.position < 0 || key.position >= static_cast<int32_t>(positions.size()) ||
+                        key.text_coord >= static_cast<int32_t>(text_coords.size()) ||
+                        key.normal >= static_cast<int32_t>(normals.size()))
+                    {
+                        AQUA_ERROR("Mesh Error: face index out of range at line " + std::to_string(line_number) + " in " + file_path.string());
+                        return std::nullopt;
+                    }
+
+                    auto [it, inserted] = vertex_lookup.try_emplace(key, mesh.get_vertex_count());
+                    if (inserted)
+                    {
+                        mesh.positions.push_back(positions[key.position]);
+                        mesh.normals.push_back(key.normal >= 0 ? normals[key.normal] : stm::vec3f{});
+                        mesh.text_coords.push_back(key.text_coord >= 0 ? text_coords[key.text_coord] : stm::vec2f{});
+                        has_normals |= key.normal >= 0;
+                        has_text_coords |= key.text_coord >= 0;
+                    }
+
+                    face.push_back(it->second);
+                }
+
+                // Fan triangulation, faces are assumed convex
+                for (size_t i = 2; i < face.size(); ++i)
+                {
+                    mesh.indices.push_back(face[0]);
+                    mesh.indices.push_back(face[i - 1]);
+                    mesh.indices.push_back(face[i]);
+                }
+            }
+            else if (keyword == "o" || keyword == "g" || keyword == "usemtl")
+            {
+                begin_submesh();
+            }
+        }
+
+        mesh.submeshes.back().index_count = mesh.get_index_count() - mesh.submeshes.back().index_offset;
+        std::erase_if(mesh.submeshes, [](const Submesh& submesh) { return submesh.index_count == 0; });
+
+        if (mesh.indices.empty())
+        {
+            AQUA_ERROR("Mesh Error: no faces found in " + file_path.string());
+            return std::nullopt;
+        }
+
+        if (!has_normals)
+            mesh.generate_normals();
+        if (!has_text_coords)
+            mesh.text_coords.clear();
+
+        return mesh;
+    }
+}
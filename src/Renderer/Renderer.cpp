@@ -4,8 +4,13 @@
 
 namespace Aqua
 {
-    Renderer::Renderer(Window& window, std::shared_ptr<EventQueue> queue)
-        : handle_{ std::make_unique<Vulkan::Renderer>(window) } , queue_ { queue }
+    Renderer::Renderer(Window& window, std::shared_ptr<EventQueue> queue, const RendererSettings& settings)
+        : handle_{ std::make_unique<Vulkan::Renderer>(window, settings) } , queue_ { queue }
+    {
+    }
+
+    Renderer::Renderer(const RendererSettings& settings)
+        : handle_{ std::make_unique<Vulkan::Renderer>(settings) } , queue_ { nullptr }
     {
     }
     
@@ -23,6 +28,9 @@ namespace Aqua
 
     bool Renderer::handle_events() const
     {
+        if (queue_ == nullptr)
+            return false;
+
         return queue_->handle([this](const Event& event){
             if (event.get_type() == Event::Types::Window_Resized)
             {
@@ -35,6 +43,18 @@ namespace Aqua
 
     void Renderer::render() const { handle_->draw_frame(); }
 
+    void Renderer::set_scene(const SceneDescription& scene) const { handle_->set_scene(scene); }
+
+    std::vector<FrameTiming> Renderer::flush_frame_timings() const { return handle_->flush_frame_timings(); }
+
+    bool Renderer::has_gpu_timings() const noexcept { return handle_->has_gpu_timings(); }
+
+    bool Renderer::has_present_timings() const noexcept { return handle_->has_present_timings(); }
+
+    uint32_t Renderer::get_frames_in_flight() const noexcept { return handle_->get_frames_in_flight(); }
+
+    PresentMode Renderer::get_present_mode() const noexcept { return handle_->get_present_mode(); }
+
     bool Renderer::is_valid() const noexcept
     {
         return handle_->is_valid();
@@ -0,0 +1,166 @@
+#include "Renderer/Vulkan/VulkanBarriers.h"
+#include "Renderer/Vulkan/VulkanDevice.h"
+
+#include <algorithm>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        static constexpr VkAccessFlags2 write_access_mask =
+            VK_ACCESS_2_SHADER_WRITE_BIT |
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_TRANSFER_WRITE_BIT |
+            VK_ACCESS_2_HOST_WRITE_BIT |
+            VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+        ImageState get_layout_state(VkImageLayout layout)
+        {
+            switch (layout)
+            {
+            case VK_IMAGE_LAYOUT_UNDEFINED:
+            case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+                return { layout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                return { layout, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT };
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+                return { layout, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                return { layout, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                return { layout, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT };
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                return { layout, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT };
+            default:
+                return { layout, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT };
+            }
+        }
+
+        BarrierBatcher::~BarrierBatcher()
+        {
+            // The images already track the new states, dropping the barriers would leave them wrong
+            AQUA_ASSERT(barriers_.empty(), "Vulkan Error: image barriers were batched but never flushed");
+        }
+
+        void BarrierBatcher::transition(Image& image, const ImageState& state, bool discard)
+        {
+            transition(image, image.get_full_range(), state, discard);
+        }
+
+        void BarrierBatcher::transition(Image& image, const VkImageSubresourceRange& range, const ImageState& state, bool discard)
+        {
+            const uint32_t base_mip = range.baseMipLevel;
+            const uint32_t end_mip = range.levelCount == VK_REMAINING_MIP_LEVELS ?
+                image.mip_levels_ : base_mip + range.levelCount;
+            const uint32_t base_layer = range.baseArrayLayer;
+            const uint32_t end_layer = range.layerCount == VK_REMAINING_ARRAY_LAYERS ?
+                image.array_layers_ : base_layer + range.layerCount;
+
+            AQUA_ASSERT(end_mip <= image.mip_levels_ && end_layer <= image.array_layers_,
+                "Vulkan Error: image subresource range out of bounds");
+            AQUA_ASSERT(!is_pending(image.image_, { range.aspectMask, base_mip, end_mip - base_mip, base_layer, end_layer - base_layer }),
+                "Vulkan Error: image subresource transitioned twice in one batch");
+
+            const bool reads_only = (state.access & write_access_mask) == 0;
+            const size_t first_barrier = barriers_.size();
+
+            for (uint32_t mip = base_mip; mip < end_mip; ++mip)
+            {
+                auto* states = image.states_.data() + mip * image.array_layers_;
+
+                // Runs of layers in the same state take one barrier
+                for (uint32_t layer = base_layer; layer < end_layer;)
+                {
+                    const ImageState old_state = states[layer];
+                    uint32_t run_end = layer + 1;
+                    while (run_end < end_layer && states[run_end] == old_state)
+                        ++run_end;
+
+                    const uint32_t first_layer = layer;
+                    const uint32_t layer_count = run_end - layer;
+                    layer = run_end;
+
+                    // Reads after reads in the same layout only wait when they add stages or accesses, and a write
+                    // later on has to wait for all of them
+                    ImageState new_state = state;
+                    const bool read_after_read = !discard && reads_only && old_state.layout == state.layout &&
+                        (old_state.access & write_access_mask) == 0 && old_state.access != VK_ACCESS_2_NONE;
+                    if (read_after_read)
+                    {
+                        if ((state.stages & ~old_state.stages) == 0 && (state.access & ~old_state.access) == 0)
+                            continue;
+
+                        new_state.stages |= old_state.stages;
+                        new_state.access |= old_state.access;
+                    }
+
+                    for (uint32_t i = first_layer; i < run_end; ++i)
+                        states[i] = new_state;
+
+                    const VkImageLayout old_layout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : old_state.layout;
+                    const VkAccessFlags2 src_access = old_state.access & write_access_mask;
+
+                    // The same layers of the previous mip level in the same state extend that barrier instead
+                    auto merged = std::find_if(barriers_.begin() + first_barrier, barriers_.end(), [&](const VkImageMemoryBarrier2& barrier) {
+                        return barrier.oldLayout == old_layout &&
+                               barrier.srcStageMask == old_state.stages &&
+                               barrier.srcAccessMask == src_access &&
+                               barrier.subresourceRange.baseArrayLayer == first_layer &&
+                               barrier.subresourceRange.layerCount == layer_count &&
+                               barrier.subresourceRange.baseMipLevel + barrier.subresourceRange.levelCount == mip;
+                    });
+                    if (merged != barriers_.end())
+                    {
+                        ++merged->subresourceRange.levelCount;
+                        continue;
+                    }
+
+                    VkImageMemoryBarrier2 barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                    barrier.srcStageMask = old_state.stages;
+                    barrier.srcAccessMask = src_access;
+                    barrier.dstStageMask = state.stages;
+                    barrier.dstAccessMask = state.access;
+                    barrier.oldLayout = old_layout;
+                    barrier.newLayout = state.layout;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.image = image.image_;
+                    barrier.subresourceRange = { range.aspectMask != 0 ? range.aspectMask : image.aspect_, mip, 1, first_layer, layer_count };
+                    barriers_.push_back(barrier);
+                }
+            }
+        }
+
+        void BarrierBatcher::flush(VkCommandBuffer command_buffer)
+        {
+            if (barriers_.empty())
+                return;
+
+            VkDependencyInfo dependency{};
+            dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency.imageMemoryBarrierCount = static_cast<uint32_t>(barriers_.size());
+            dependency.pImageMemoryBarriers = barriers_.data();
+
+            device_->cmd_pipeline_barrier(command_buffer, dependency);
+            barriers_.clear();
+        }
+
+        bool BarrierBatcher::is_pending(VkImage image, const VkImageSubresourceRange& range) const
+        {
+            return std::any_of(barriers_.begin(), barriers_.end(), [&](const VkImageMemoryBarrier2& barrier) {
+                const auto& pending = barrier.subresourceRange;
+                return barrier.image == image &&
+                       pending.baseMipLevel < range.baseMipLevel + range.levelCount &&
+                       range.baseMipLevel < pending.baseMipLevel + pending.levelCount &&
+                       pending.baseArrayLayer < range.baseArrayLayer + range.layerCount &&
+                       range.baseArrayLayer < pending.baseArrayLayer + pending.layerCount;
+            });
+        }
+    }
+}
@@ -30,17 +30,17 @@ namespace Aqua
             Buffer::copy(device, stage_buffer, *this, buffer_size);
         }
 
-        void VertexBuffer::bind_buffer(VkCommandBuffer command_buffer) const
+        void VertexBuffer::bind_buffer(VkCommandBuffer command_buffer, uint32_t binding) const
         {
             VkBuffer vertex_buffers[] = { buffer_ };
             VkDeviceSize offsets[] = { 0 };
 
-            vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
+            vkCmdBindVertexBuffers(command_buffer, binding, 1, vertex_buffers, offsets);
         }
 
         IndexBuffer::IndexBuffer(const Device& device,
-                                 const std::vector<uint32_t>& indices)
-            : Buffer{device.create_buffer(static_cast<uint32_t>(indices.size()) * sizeof(indices),
+                                 std::span<const uint32_t> indices)
+            : Buffer{device.create_buffer(indices.size() * sizeof(uint32_t),
                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) },
               index_count_{ static_cast<uint32_t>(indices.size()) }
@@ -54,7 +54,7 @@ namespace Aqua
 
             void* data = nullptr;
             vkMapMemory(device_, stage_buffer.get_memory(), 0, buffer_size, 0, &data);
-            std::copy(indices.cbegin(), indices.cend(), static_cast<uint32_t*>(data));
+            std::copy(indices.begin(), indices.end(), static_cast<uint32_t*>(data));
             vkUnmapMemory(device_, stage_buffer.get_memory());
 
             Buffer::copy(device, stage_buffer, *this, buffer_size);
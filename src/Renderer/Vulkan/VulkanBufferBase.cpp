@@ -5,9 +5,25 @@ namespace Aqua
 {
     namespace Vulkan
     {
+        Buffer::Buffer(const Device* owner, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size)
+            : buffer_{ buffer }, memory_{ memory }, device_{ owner->get_device() }, owner_{ owner }, buffer_size_{ size }
+        {
+        }
+
+        Buffer::~Buffer()
+        {
+            if (owner_ == nullptr || (buffer_ == VK_NULL_HANDLE && memory_ == VK_NULL_HANDLE))
+                return;
+
+            owner_->defer_destruction([device = device_, buffer = buffer_, memory = memory_]() {
+                vkFreeMemory(device, memory, nullptr);
+                vkDestroyBuffer(device, buffer, nullptr);
+            });
+        }
+
         bool Buffer::write_data(const uint8_t* src_data, VkDeviceSize size, VkDeviceSize dst_offset) const
         {
-            if (get_buffer_size() > (dst_offset + size))
+            if (dst_offset + size > get_buffer_size())
             {
                 AQUA_ERROR("Vulkan Error: writing data outside of buffer memory");
                 return false;
@@ -35,13 +51,13 @@ namespace Aqua
                           VkDeviceSize src_offset,
                           VkDeviceSize dst_offset)
         {
-            if (src_buffer.get_buffer_size() > (src_offset + size))
+            if (src_offset + size > src_buffer.get_buffer_size())
             {
                 AQUA_ERROR("Vulkan Error: copying memory outside of source buffer");
                 return;
             }
 
-            if (dst_buffer.get_buffer_size() > (dst_offset + size))
+            if (dst_offset + size > dst_buffer.get_buffer_size())
             {
                 AQUA_ERROR("Vulkan Error: copying memory outside of destination buffer");
                 return;
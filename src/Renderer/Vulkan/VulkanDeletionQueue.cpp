@@ -0,0 +1,31 @@
+#include "Renderer/Vulkan/VulkanDeletionQueue.h"
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        void DeletionQueue::push(uint64_t value, std::function<void()> deleter)
+        {
+            AQUA_ASSERT(entries_.empty() || entries_.back().value <= value, "Vulkan Error: deletion queue values out of order");
+            entries_.push_back({ value, std::move(deleter) });
+        }
+
+        void DeletionQueue::flush(uint64_t completed_value)
+        {
+            while (!entries_.empty() && entries_.front().value <= completed_value)
+            {
+                entries_.front().deleter();
+                entries_.pop_front();
+            }
+        }
+
+        void DeletionQueue::flush_all()
+        {
+            while (!entries_.empty())
+            {
+                entries_.front().deleter();
+                entries_.pop_front();
+            }
+        }
+    }
+}
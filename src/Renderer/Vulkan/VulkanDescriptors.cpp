@@ -0,0 +1,282 @@
+#include "Renderer/Vulkan/VulkanDescriptors.h"
+#include "Renderer/Vulkan/VulkanDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        static void hash_combine(size_t& seed, size_t value)
+        {
+            seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+        }
+
+        bool DescriptorLayoutCache::Binding::operator==(const Binding& other) const noexcept
+        {
+            return binding.binding == other.binding.binding &&
+                   binding.descriptorType == other.binding.descriptorType &&
+                   binding.descriptorCount == other.binding.descriptorCount &&
+                   binding.stageFlags == other.binding.stageFlags &&
+                   binding.pImmutableSamplers == other.binding.pImmutableSamplers &&
+                   flags == other.flags;
+        }
+
+        size_t DescriptorLayoutCache::KeyHash::operator()(const Key& key) const noexcept
+        {
+            size_t seed = std::hash<uint32_t>{}(key.flags);
+            for (const auto& entry : key.bindings)
+            {
+                const auto& binding = entry.binding;
+                hash_combine(seed, binding.binding);
+                hash_combine(seed, static_cast<size_t>(binding.descriptorType));
+                hash_combine(seed, binding.descriptorCount);
+                hash_combine(seed, binding.stageFlags);
+                hash_combine(seed, std::hash<const void*>{}(binding.pImmutableSamplers));
+                hash_combine(seed, entry.flags);
+            }
+            return seed;
+        }
+
+        VkDescriptorSetLayout DescriptorLayoutCache::get(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                                         VkDescriptorSetLayoutCreateFlags flags,
+                                                         std::span<const VkDescriptorBindingFlags> binding_flags)
+        {
+            AQUA_ASSERT(binding_flags.empty() || binding_flags.size() == bindings.size(),
+                "Vulkan Error: descriptor binding flags do not match the bindings");
+
+            Key key{};
+            key.flags = flags;
+            key.bindings.reserve(bindings.size());
+            for (size_t i = 0; i < bindings.size(); ++i)
+                key.bindings.push_back({ bindings[i], binding_flags.empty() ? 0 : binding_flags[i] });
+
+            std::sort(key.bindings.begin(), key.bindings.end(),
+                [](const Binding& a, const Binding& b) { return a.binding.binding < b.binding.binding; });
+
+            std::lock_guard lock{ mutex_ };
+            if (auto found = layouts_.find(key); found != layouts_.end())
+                return found->second;
+
+            std::vector<VkDescriptorSetLayoutBinding> sorted_bindings;
+            std::vector<VkDescriptorBindingFlags> sorted_flags;
+            sorted_bindings.reserve(key.bindings.size());
+            sorted_flags.reserve(key.bindings.size());
+            for (const auto& entry : key.bindings)
+            {
+                sorted_bindings.push_back(entry.binding);
+                sorted_flags.push_back(entry.flags);
+            }
+
+            VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info{};
+            flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            flags_info.bindingCount = static_cast<uint32_t>(sorted_flags.size());
+            flags_info.pBindingFlags = sorted_flags.data();
+
+            VkDescriptorSetLayoutCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            info.pNext = binding_flags.empty() ? nullptr : &flags_info;
+            info.flags = flags;
+            info.bindingCount = static_cast<uint32_t>(sorted_bindings.size());
+            info.pBindings = sorted_bindings.data();
+
+            VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+            if (vkCreateDescriptorSetLayout(device_, &info, nullptr, &layout) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to create descriptor set layout");
+                return VK_NULL_HANDLE;
+            }
+
+            layouts_.emplace(std::move(key), layout);
+            return layout;
+        }
+
+        void DescriptorLayoutCache::clear()
+        {
+            std::lock_guard lock{ mutex_ };
+            for (const auto& [key, layout] : layouts_)
+                vkDestroyDescriptorSetLayout(device_, layout, nullptr);
+            layouts_.clear();
+        }
+
+        bool PipelineLayoutCache::Key::operator==(const Key& other) const noexcept
+        {
+            return set_layouts == other.set_layouts &&
+                   std::equal(push_constants.begin(), push_constants.end(), other.push_constants.begin(), other.push_constants.end(),
+                       [](const VkPushConstantRange& a, const VkPushConstantRange& b) {
+                           return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+                       });
+        }
+
+        size_t PipelineLayoutCache::KeyHash::operator()(const Key& key) const noexcept
+        {
+            size_t seed = key.set_layouts.size();
+            for (auto layout : key.set_layouts)
+                hash_combine(seed, std::hash<const void*>{}(reinterpret_cast<const void*>(layout)));
+            for (const auto& range : key.push_constants)
+            {
+                hash_combine(seed, range.stageFlags);
+                hash_combine(seed, range.offset);
+                hash_combine(seed, range.size);
+            }
+            return seed;
+        }
+
+        VkPipelineLayout PipelineLayoutCache::get(std::span<const VkDescriptorSetLayout> set_layouts,
+                                                  std::span<const VkPushConstantRange> push_constants)
+        {
+            Key key{ { set_layouts.begin(), set_layouts.end() }, { push_constants.begin(), push_constants.end() } };
+
+            std::lock_guard lock{ mutex_ };
+            if (auto found = layouts_.find(key); found != layouts_.end())
+                return found->second;
+
+            VkPipelineLayoutCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            info.setLayoutCount = static_cast<uint32_t>(key.set_layouts.size());
+            info.pSetLayouts = key.set_layouts.data();
+            info.pushConstantRangeCount = static_cast<uint32_t>(key.push_constants.size());
+            info.pPushConstantRanges = key.push_constants.data();
+
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            if (vkCreatePipelineLayout(device_, &info, nullptr, &layout) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to create pipeline layout");
+                return VK_NULL_HANDLE;
+            }
+
+            layouts_.emplace(std::move(key), layout);
+            return layout;
+        }
+
+        void PipelineLayoutCache::clear()
+        {
+            std::lock_guard lock{ mutex_ };
+            for (const auto& [key, layout] : layouts_)
+                vkDestroyPipelineLayout(device_, layout, nullptr);
+            layouts_.clear();
+        }
+
+        DescriptorAllocator::DescriptorAllocator(const Device& device, std::span<const PoolRatio> ratios, uint32_t initial_sets)
+            : device_{ &device },
+            ratios_{ ratios.begin(), ratios.end() },
+            sets_per_pool_{ std::clamp(initial_sets, 1u, max_sets_per_pool) }
+        {
+        }
+
+        DescriptorAllocator::~DescriptorAllocator()
+        {
+            if (pool_count() == 0)
+                return;
+
+            auto pools = std::move(full_pools_);
+            pools.insert(pools.end(), ready_pools_.begin(), ready_pools_.end());
+            device_->defer_destruction([logical_device = device_->get_device(), pools = std::move(pools)]() {
+                for (auto pool : pools)
+                    vkDestroyDescriptorPool(logical_device, pool, nullptr);
+            });
+        }
+
+        VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            allocate({ &layout, 1 }, { &set, 1 });
+            return set;
+        }
+
+        bool DescriptorAllocator::allocate(std::span<const VkDescriptorSetLayout> layouts, std::span<VkDescriptorSet> sets)
+        {
+            AQUA_ASSERT(layouts.size() == sets.size(), "Vulkan Error: one descriptor set is allocated per layout");
+            if (layouts.empty())
+                return true;
+
+            const auto count = static_cast<uint32_t>(layouts.size());
+
+            VkDescriptorSetAllocateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            info.descriptorSetCount = count;
+            info.pSetLayouts = layouts.data();
+
+            // Pools that are out of space are retired until reset(), after reset() several small ones may be ready.
+            // Once none are left get_pool creates one that holds at least count sets, only that one failing is final
+            while (true)
+            {
+                const bool new_pool = ready_pools_.empty();
+                info.descriptorPool = get_pool(count);
+                if (info.descriptorPool == VK_NULL_HANDLE)
+                    break;
+
+                auto result = vkAllocateDescriptorSets(device_->get_device(), &info, sets.data());
+                if (result == VK_SUCCESS)
+                    return true;
+
+                if (new_pool || (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL))
+                    break;
+
+                full_pools_.push_back(ready_pools_.back());
+                ready_pools_.pop_back();
+            }
+
+            AQUA_ERROR("Vulkan Error: failed to allocate descriptor sets");
+            std::fill(sets.begin(), sets.end(), VK_NULL_HANDLE);
+            return false;
+        }
+
+        void DescriptorAllocator::reset()
+        {
+            auto logical_device = device_->get_device();
+
+            for (auto pool : ready_pools_)
+                vkResetDescriptorPool(logical_device, pool, 0);
+            for (auto pool : full_pools_)
+            {
+                vkResetDescriptorPool(logical_device, pool, 0);
+                ready_pools_.push_back(pool);
+            }
+            full_pools_.clear();
+        }
+
+        VkDescriptorPool DescriptorAllocator::get_pool(uint32_t set_count)
+        {
+            if (!ready_pools_.empty())
+                return ready_pools_.back();
+
+            // Each new pool is larger than the last, the number of pools stays logarithmic in the sets allocated
+            auto pool = create_pool(std::max(sets_per_pool_, set_count));
+            if (pool == VK_NULL_HANDLE)
+                return VK_NULL_HANDLE;
+
+            sets_per_pool_ = std::min(sets_per_pool_ + sets_per_pool_ / 2, max_sets_per_pool);
+            ready_pools_.push_back(pool);
+            return pool;
+        }
+
+        VkDescriptorPool DescriptorAllocator::create_pool(uint32_t set_count) const
+        {
+            std::vector<VkDescriptorPoolSize> pool_sizes;
+            pool_sizes.reserve(ratios_.size());
+            for (const auto& ratio : ratios_)
+            {
+                const auto count = static_cast<uint32_t>(std::ceil(ratio.per_set * static_cast<float>(set_count)));
+                pool_sizes.push_back({ ratio.type, std::max(count, 1u) });
+            }
+
+            VkDescriptorPoolCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            info.maxSets = set_count;
+            info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+            info.pPoolSizes = pool_sizes.data();
+
+            VkDescriptorPool pool = VK_NULL_HANDLE;
+            if (vkCreateDescriptorPool(device_->get_device(), &info, nullptr, &pool) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to create descriptor pool");
+                return VK_NULL_HANDLE;
+            }
+
+            return pool;
+        }
+    }
+}
@@ -1,27 +1,147 @@
 #include "Renderer/Vulkan/VulkanDevice.h"
 
+#include <cstring>
+
 namespace Aqua
 {
     namespace Vulkan
     {
         std::vector<const char*> Device::device_extensions_ = {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME
+            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+            VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
+        };
+
+        std::vector<const char*> Device::present_wait_extensions_ = {
+            VK_KHR_PRESENT_ID_EXTENSION_NAME,
+            VK_KHR_PRESENT_WAIT_EXTENSION_NAME
         };
 
         Device::Device(VkPhysicalDevice physical_device, VkSurfaceKHR surface)
         {
             physical_device_ = physical_device;
             queue_families_ = find_queue_families(physical_device, surface);
-            device_ = create_logical_device(physical_device, surface);
+            // Only measured, presenting works the same without it
+            const bool present_wait = surface != VK_NULL_HANDLE && check_present_wait_support(physical_device);
+            device_ = create_logical_device(physical_device, surface, present_wait);
+            timeline_ = create_timeline_semaphore(device_);
+            layout_cache_ = std::make_unique<DescriptorLayoutCache>(device_);
+            pipeline_layout_cache_ = std::make_unique<PipelineLayoutCache>(device_);
+
+            if (device_ != VK_NULL_HANDLE)
+                pipeline_barrier2_ = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(vkGetDeviceProcAddr(device_, "vkCmdPipelineBarrier2KHR"));
+
+            if (present_wait && device_ != VK_NULL_HANDLE)
+                wait_for_present_ = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device_, "vkWaitForPresentKHR"));
 
             AQUA_INFO("Created Vulkan Device");
         }
 
         Device::~Device()
         {
+            wait_idle();
+            deletion_queue_.flush_all();
+            pipeline_layout_cache_ = nullptr;
+            layout_cache_ = nullptr;
+
+            vkDestroySemaphore(device_, timeline_, nullptr);
             vkDestroyDevice(device_, nullptr);
         }
 
+        uint64_t Device::submit(VkQueue queue, VkCommandBuffer command_buffer, const SubmitSemaphores& semaphores) const
+        {
+            AQUA_ASSERT(semaphores.wait.size() <= max_submit_semaphores && semaphores.signal.size() < max_submit_semaphores,
+                "Vulkan Error: too many semaphores in one submission");
+            AQUA_ASSERT(semaphores.wait.size() == semaphores.wait_stages.size(), "Vulkan Error: every wait semaphore needs a stage");
+
+            // Binary semaphores ignore their values, only the timeline signal at the end carries one
+            const auto signal_count = static_cast<uint32_t>(semaphores.signal.size() + 1);
+            std::array<VkSemaphore, max_submit_semaphores> signal_semaphores{};
+            std::array<uint64_t, max_submit_semaphores> signal_values{};
+            std::array<uint64_t, max_submit_semaphores> wait_values{};
+            std::copy(semaphores.signal.begin(), semaphores.signal.end(), signal_semaphores.begin());
+            signal_semaphores[signal_count - 1] = timeline_;
+
+            std::lock_guard lock{ submit_mutex_ };
+            const uint64_t value = timeline_value_ + 1;
+            signal_values[signal_count - 1] = value;
+
+            VkTimelineSemaphoreSubmitInfo timeline_info{};
+            timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(semaphores.wait.size());
+            timeline_info.pWaitSemaphoreValues = wait_values.data();
+            timeline_info.signalSemaphoreValueCount = signal_count;
+            timeline_info.pSignalSemaphoreValues = signal_values.data();
+
+            VkSubmitInfo submit_info{};
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.pNext = &timeline_info;
+            submit_info.waitSemaphoreCount = static_cast<uint32_t>(semaphores.wait.size());
+            submit_info.pWaitSemaphores = semaphores.wait.data();
+            submit_info.pWaitDstStageMask = semaphores.wait_stages.data();
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers = &command_buffer;
+            submit_info.signalSemaphoreCount = signal_count;
+            submit_info.pSignalSemaphores = signal_semaphores.data();
+
+            if (vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to submit command");
+                return timeline_value_;
+            }
+
+            timeline_value_ = value;
+            return value;
+        }
+
+        void Device::wait(uint64_t value) const
+        {
+            VkSemaphoreWaitInfo wait_info{};
+            wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.semaphoreCount = 1;
+            wait_info.pSemaphores = &timeline_;
+            wait_info.pValues = &value;
+
+            if (vkWaitSemaphores(device_, &wait_info, UINT64_MAX) != VK_SUCCESS)
+                AQUA_ERROR("Vulkan Error: failed to wait on the device timeline");
+        }
+
+        uint64_t Device::get_completed_value() const
+        {
+            uint64_t value = 0;
+            if (vkGetSemaphoreCounterValue(device_, timeline_, &value) != VK_SUCCESS)
+                AQUA_ERROR("Vulkan Error: failed to read the device timeline");
+
+            return value;
+        }
+
+        VkResult Device::wait_for_present(VkSwapchainKHR swap_chain, uint64_t present_id, uint64_t timeout) const
+        {
+            if (wait_for_present_ == nullptr)
+                return VK_ERROR_EXTENSION_NOT_PRESENT;
+
+            return wait_for_present_(device_, swap_chain, present_id, timeout);
+        }
+
+        uint64_t Device::get_next_submission_value() const
+        {
+            std::lock_guard lock{ submit_mutex_ };
+            return timeline_value_ + 1;
+        }
+
+        void Device::defer_destruction(std::function<void()> deleter) const
+        {
+            std::lock_guard lock{ submit_mutex_ };
+            deletion_queue_.push(timeline_value_ + 1, std::move(deleter));
+        }
+
+        void Device::collect_garbage() const
+        {
+            const uint64_t completed = get_completed_value();
+
+            std::lock_guard lock{ submit_mutex_ };
+            deletion_queue_.flush(completed);
+        }
+
         VkQueue Device::get_graphics_queue() const noexcept
         {
             VkQueue queue = VK_NULL_HANDLE;
@@ -86,9 +206,8 @@ namespace Aqua
 
             vkEndCommandBuffer(command_buffer);
 
-            auto queue = get_graphics_queue();
-            submit_command_buffer(queue, command_buffer);
-            wait_queue_idle(queue);
+            // Waits for this submission only, frames in flight on the same queue keep running
+            wait(submit(get_graphics_queue(), command_buffer));
 
             vkFreeCommandBuffers(device_, command_pool, 1, &command_buffer);
             vkDestroyCommandPool(device_, command_pool, nullptr);
@@ -109,6 +228,25 @@ namespace Aqua
             return create_device_image(*this, info, properties);
         }
 
+        VkDeviceMemory Device::allocate_memory(
+            const VkMemoryRequirements& requirements,
+            VkMemoryPropertyFlags properties) const
+        {
+            VkMemoryAllocateInfo allocate_info{};
+            allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocate_info.allocationSize = requirements.size;
+            allocate_info.memoryTypeIndex = get_memory_type(physical_device_, requirements.memoryTypeBits, properties);
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            if (vkAllocateMemory(device_, &allocate_info, nullptr, &memory) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to allocate device memory");
+                return VK_NULL_HANDLE;
+            }
+
+            return memory;
+        }
+
         Device::QueueFamilyIndices Device::find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface)
         {
             QueueFamilyIndices indices;
@@ -122,7 +260,8 @@ namespace Aqua
             for (const auto& queue_family : queue_families)
             {
                 VkBool32 present_support = false;
-                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+                if (surface != VK_NULL_HANDLE)
+                    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
 
                 if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
                     indices.graphics_family = i;
@@ -134,7 +273,40 @@ namespace Aqua
             return indices;
         }
 
-        VkDevice Device::create_logical_device(VkPhysicalDevice physical_device, VkSurfaceKHR surface)
+        bool Device::check_present_wait_support(VkPhysicalDevice physical_device)
+        {
+            uint32_t extension_count = 0;
+            vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
+
+            std::vector<VkExtensionProperties> extensions(extension_count);
+            vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, extensions.data());
+
+            for (const auto* required : present_wait_extensions_)
+            {
+                const bool found = std::any_of(extensions.begin(), extensions.end(), [required](const VkExtensionProperties& extension) {
+                    return std::strcmp(extension.extensionName, required) == 0;
+                });
+
+                if (!found)
+                    return false;
+            }
+
+            VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+            present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+            VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+            present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            present_id_features.pNext = &present_wait_features;
+
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &present_id_features;
+            vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+            return present_id_features.presentId && present_wait_features.presentWait;
+        }
+
+        VkDevice Device::create_logical_device(VkPhysicalDevice physical_device, VkSurfaceKHR surface, bool present_wait)
         {
             VkDevice device = VK_NULL_HANDLE;
 
@@ -157,9 +329,39 @@ namespace Aqua
             }
 
             VkPhysicalDeviceFeatures features{};
+            // The texture table is indexed per draw
+            features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+            VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+            present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+            present_wait_features.presentWait = VK_TRUE;
+
+            VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+            present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            present_id_features.pNext = &present_wait_features;
+            present_id_features.presentId = VK_TRUE;
+
+            VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_features{};
+            synchronization2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+            synchronization2_features.pNext = present_wait ? &present_id_features : nullptr;
+            synchronization2_features.synchronization2 = VK_TRUE;
+
+            VkPhysicalDeviceVulkan12Features features_12{};
+            features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            features_12.pNext = &synchronization2_features;
+            features_12.timelineSemaphore = VK_TRUE;
+            features_12.runtimeDescriptorArray = VK_TRUE;
+            features_12.descriptorBindingPartiallyBound = VK_TRUE;
+            features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            features_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+            auto extensions = device_extensions_;
+            if (present_wait)
+                extensions.insert(extensions.end(), present_wait_extensions_.begin(), present_wait_extensions_.end());
 
             VkDeviceCreateInfo device_info{};
             device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+            device_info.pNext = &features_12;
             device_info.pEnabledFeatures = &features;
             device_info.pQueueCreateInfos = queue_create_infos.data();
             device_info.queueCreateInfoCount = queue_create_infos.size();
@@ -176,8 +378,8 @@ namespace Aqua
                 device_info.ppEnabledLayerNames = nullptr;
             }
 
-            device_info.ppEnabledExtensionNames = device_extensions_.data();
-            device_info.enabledExtensionCount = device_extensions_.size();
+            device_info.ppEnabledExtensionNames = extensions.data();
+            device_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
             
             if (vkCreateDevice(physical_device, &device_info, nullptr, &device))
                 AQUA_ERROR("Vulkan Error: Failed to create logical device");
@@ -185,6 +387,25 @@ namespace Aqua
             return device;
         }
 
+        VkSemaphore Device::create_timeline_semaphore(VkDevice device)
+        {
+            VkSemaphore semaphore = VK_NULL_HANDLE;
+
+            VkSemaphoreTypeCreateInfo type_info{};
+            type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            type_info.initialValue = 0;
+
+            VkSemaphoreCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            info.pNext = &type_info;
+
+            if (vkCreateSemaphore(device, &info, nullptr, &semaphore) != VK_SUCCESS)
+                AQUA_ERROR("Vulkan Error: failed to create timeline semaphore");
+
+            return semaphore;
+        }
+
         VkCommandPool Device::create_graphics_command_pool(VkDevice device,
                                                             const QueueFamilyIndices& queue_family_indices,
                                                             VkCommandPoolCreateFlags flags)
@@ -296,7 +517,7 @@ namespace Aqua
                 AQUA_ERROR("Vulkan Error: failed to bind memory to buffer");
             }
 
-            return { device.get_device(), buffer , memory, size };
+            return { &device, buffer , memory, size };
         }
 
         Image Device::create_device_image(
@@ -338,7 +559,7 @@ namespace Aqua
                 AQUA_ERROR("Vulkan Error: failed to bind memory to image");
             }
 
-            return { device.get_device(), image , memory, info.format, info.extent };
+            return { &device, image, memory, info };
         }
     }
 }
\ No newline at end of file
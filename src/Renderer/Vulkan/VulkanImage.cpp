@@ -1,112 +1,122 @@
 #include "Renderer/Vulkan/VulkanImage.h"
 #include "Renderer/Vulkan/VulkanDevice.h"
 #include "Renderer/Vulkan/VulkanBuffer.h"
+#include "Renderer/Vulkan/VulkanBarriers.h"
+
+#include <algorithm>
+#include <utility>
 
 namespace Aqua
 {
     namespace Vulkan
     {
-        Image::Image(VkDevice device, VkImage image, VkDeviceMemory memory, VkFormat format, VkExtent3D size)
-            : device_{ device }, image_{ image }, memory_{ memory }, format_{ format }, size_{ size }
+        static VkImageAspectFlags get_format_aspect(VkFormat format)
         {
+            switch (format)
+            {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+            }
+        }
+
+        Image::Image(const Device* owner, VkImage image, VkDeviceMemory memory, const VkImageCreateInfo& info)
+            : image_{ image }, memory_{ memory }, device_{ owner->get_device() }, owner_{ owner },
+              format_{ info.format }, size_{ info.extent }, aspect_{ get_format_aspect(info.format) },
+              mip_levels_{ std::max(info.mipLevels, 1u) }, array_layers_{ std::max(info.arrayLayers, 1u) },
+              states_(mip_levels_ * array_layers_, ImageState{ info.initialLayout })
+        {
+            if (image == VK_NULL_HANDLE)
+                return;
+
             VkImageViewCreateInfo view_info{};
             view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
             view_info.image = image;
-            view_info.format = format;
-            view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            view_info.subresourceRange.baseArrayLayer = 0;
-            view_info.subresourceRange.layerCount = 1;
-            view_info.subresourceRange.baseMipLevel = 0;
-            view_info.subresourceRange.levelCount = 1;
-
-            if (vkCreateImageView(device, &view_info, nullptr, &view_) != VK_SUCCESS)
+            view_info.format = format_;
+            view_info.viewType = array_layers_ > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+            view_info.subresourceRange = get_full_range();
+
+            if (vkCreateImageView(device_, &view_info, nullptr, &view_) != VK_SUCCESS)
                 AQUA_ERROR("Vulkan Error: failed to create image view");
         }
 
         Image::~Image()
         {
-            if (device_ != VK_NULL_HANDLE)
+            release();
+        }
+
+        void Image::release() noexcept
+        {
+            if (owner_ != nullptr && image_ != VK_NULL_HANDLE)
             {
-                vkDestroyImageView(device_, view_, nullptr);
-                vkFreeMemory(device_, memory_, nullptr);
-                vkDestroyImage(device_, image_, nullptr);
+                owner_->defer_destruction([device = device_, view = view_, memory = memory_, image = image_]() {
+                    vkDestroyImageView(device, view, nullptr);
+                    vkFreeMemory(device, memory, nullptr);
+                    vkDestroyImage(device, image, nullptr);
+                });
             }
 
+            view_ = VK_NULL_HANDLE;
             memory_ = VK_NULL_HANDLE;
             image_ = VK_NULL_HANDLE;
         }
 
         Image::Image(Image&& other) noexcept
-            : memory_{ std::exchange(other.memory_, VK_NULL_HANDLE) },
-              image_{ std::exchange(other.image_, VK_NULL_HANDLE) },
-              device_{ std::exchange(other.device_, VK_NULL_HANDLE) },
+            : image_{ std::exchange(other.image_, VK_NULL_HANDLE) },
               view_{ std::exchange(other.view_, VK_NULL_HANDLE) },
-              format_{other.format_}, size_{other.size_}, layout_{other.layout_}
+              memory_{ std::exchange(other.memory_, VK_NULL_HANDLE) },
+              device_{ std::exchange(other.device_, VK_NULL_HANDLE) },
+              owner_{ std::exchange(other.owner_, nullptr) },
+              format_{other.format_}, size_{other.size_}, aspect_{other.aspect_},
+              mip_levels_{other.mip_levels_}, array_layers_{other.array_layers_}, states_{std::move(other.states_)}
         {
         }
             
         Image& Image::operator=(Image&& other) noexcept
         {
+            if (this == &other)
+                return *this;
+
+            release();
+
             memory_ = std::exchange(other.memory_, VK_NULL_HANDLE);
             image_ = std::exchange(other.image_, VK_NULL_HANDLE);
             device_ = std::exchange(other.device_, VK_NULL_HANDLE);
+            owner_ = std::exchange(other.owner_, nullptr);
             view_ = std::exchange(other.view_, VK_NULL_HANDLE);
             format_ = other.format_;
             size_ = other.size_;
-            layout_ = other.layout_;
+            aspect_ = other.aspect_;
+            mip_levels_ = other.mip_levels_;
+            array_layers_ = other.array_layers_;
+            states_ = std::move(other.states_);
 
             return *this;
         }
 
         void Image::transition_image_layout(const Device& device, Image& image, VkImageLayout new_layout)
         {
-            VkImageMemoryBarrier barrier{};
-            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            barrier.oldLayout = image.get_layout();
-            barrier.newLayout = new_layout;
-            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.image = image.get_image();
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            barrier.subresourceRange.baseMipLevel = 0;
-            barrier.subresourceRange.levelCount = 1;
-            barrier.subresourceRange.baseArrayLayer = 0;
-            barrier.subresourceRange.layerCount = 1;
-    
-            VkPipelineStageFlags source_stage{};
-            VkPipelineStageFlags destination_stage{};
-            if (image.get_layout() == VK_IMAGE_LAYOUT_UNDEFINED
-                && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-            {
-                source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-                destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-                
-                barrier.srcAccessMask = 0;
-                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            }
-            else if (image.get_layout() == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-                && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-            {
-                source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-                destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            BarrierBatcher barriers{ device };
+            barriers.transition(image, get_layout_state(new_layout));
 
-                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            }
             device.submit_one_time_commands(
                 [&](VkCommandBuffer command_buffer)
                 {
-                    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0,
-                        0, nullptr, 0, nullptr, 1, &barrier);
+                    barriers.flush(command_buffer);
                 });
-            
-            image.layout_ = new_layout;
         }
 
-        void Image::copy_from_buffer(const Device& device, const Buffer& src, const Image& dst)
+        void Image::record_copy_from_buffer(VkCommandBuffer command_buffer, const Buffer& src, const Image& dst)
         {
-
             VkBufferImageCopy region{};
             region.bufferOffset = 0;
             region.bufferRowLength = 0;
@@ -115,16 +125,21 @@ namespace Aqua
             region.imageExtent = { dst.get_width(), dst.get_height(), dst.get_depth() };
             region.imageOffset = { 0 , 0 , 0 };
             
-            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.aspectMask = dst.get_aspect();
             region.imageSubresource.mipLevel = 0;
-            region.imageSubresource.layerCount = 1;
+            region.imageSubresource.layerCount = dst.get_array_layers();
             region.imageSubresource.baseArrayLayer = 0;
 
+            vkCmdCopyBufferToImage(command_buffer, src.get_buffer(), dst.get_image(),
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+
+        void Image::copy_from_buffer(const Device& device, const Buffer& src, const Image& dst)
+        {
             device.submit_one_time_commands(
                 [&](VkCommandBuffer command_buffer)
                 {
-                    vkCmdCopyBufferToImage(command_buffer, src.get_buffer(), dst.get_image(),
-                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                    record_copy_from_buffer(command_buffer, src, dst);
                 });
         }
     }
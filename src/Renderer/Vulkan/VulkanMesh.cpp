@@ -0,0 +1,113 @@
+#include "Renderer/Vulkan/VulkanMesh.h"
+#include "Renderer/Vulkan/VulkanVertex.h"
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        static_assert(get_format_size(VertexFormat::Float2) == sizeof(Float2));
+        static_assert(get_format_size(VertexFormat::Float3) == sizeof(Float3));
+        static_assert(get_format_size(VertexFormat::Half2) == sizeof(Half2));
+        static_assert(get_format_size(VertexFormat::Snorm16x4) == sizeof(Snorm16x4));
+
+        Mesh::Mesh(const Device& device, const MeshView& mesh)
+            : vertex_count_{ mesh.vertex_count },
+              streams_{ mesh.streams },
+              submeshes_{ mesh.submeshes.begin(), mesh.submeshes.end() },
+              bounds_min_{ mesh.bounds_min },
+              bounds_max_{ mesh.bounds_max }
+        {
+            if (mesh.streams.empty() || mesh.stream_data.size() != mesh.streams.size() || mesh.indices.empty())
+            {
+                AQUA_ERROR("Vulkan Error: cannot create mesh from empty or incomplete mesh data");
+                return;
+            }
+
+            for (size_t i = 0; i < mesh.streams.size(); ++i)
+            {
+                if (mesh.stream_data[i].size() != static_cast<size_t>(mesh.streams[i].stride) * mesh.vertex_count)
+                {
+                    AQUA_ERROR("Vulkan Error: vertex stream size does not match its stride and vertex count");
+                    vertex_buffers_.clear();
+                    return;
+                }
+
+                vertex_buffers_.push_back(std::make_unique<VertexBuffer>(device, mesh.stream_data[i], mesh.vertex_count));
+            }
+
+            index_buffer_ = std::make_unique<IndexBuffer>(device, mesh.indices);
+        }
+
+        std::vector<VkVertexInputBindingDescription> Mesh::get_binding_descriptions(std::span<const VertexStreamDescription> streams)
+        {
+            std::vector<VkVertexInputBindingDescription> descriptions(streams.size());
+            for (size_t i = 0; i < streams.size(); ++i)
+            {
+                descriptions[i].binding = static_cast<uint32_t>(i);
+                descriptions[i].stride = streams[i].stride;
+                descriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            }
+
+            return descriptions;
+        }
+
+        std::vector<VkVertexInputAttributeDescription> Mesh::get_attribute_descriptions(std::span<const VertexStreamDescription> streams)
+        {
+            std::vector<VkVertexInputAttributeDescription> descriptions;
+            for (size_t i = 0; i < streams.size(); ++i)
+            {
+                for (const auto& attribute : streams[i].get_attributes())
+                {
+                    VkVertexInputAttributeDescription description{};
+                    description.binding = static_cast<uint32_t>(i);
+                    description.location = static_cast<uint32_t>(attribute.attribute);
+                    description.format = get_format(attribute.format);
+                    description.offset = attribute.offset;
+                    descriptions.push_back(description);
+                }
+            }
+
+            return descriptions;
+        }
+
+        void Mesh::bind_buffers(VkCommandBuffer command_buffer) const
+        {
+            std::vector<VkBuffer> buffers(vertex_buffers_.size());
+            std::vector<VkDeviceSize> offsets(vertex_buffers_.size(), 0);
+            for (size_t i = 0; i < vertex_buffers_.size(); ++i)
+                buffers[i] = vertex_buffers_[i]->get_buffer();
+
+            vkCmdBindVertexBuffers(command_buffer, 0, static_cast<uint32_t>(buffers.size()), buffers.data(), offsets.data());
+            index_buffer_->bind_buffer(command_buffer);
+        }
+
+        void Mesh::draw(VkCommandBuffer command_buffer) const
+        {
+            vkCmdDrawIndexed(command_buffer, get_index_count(), 1, 0, 0, 0);
+        }
+
+        void Mesh::draw_submesh(VkCommandBuffer command_buffer, size_t submesh) const
+        {
+            if (submesh >= submeshes_.size())
+            {
+                AQUA_ERROR("Vulkan Error: submesh index out of range");
+                return;
+            }
+
+            vkCmdDrawIndexed(command_buffer, submeshes_[submesh].index_count, 1, submeshes_[submesh].index_offset, 0, 0);
+        }
+
+        VkFormat Mesh::get_format(VertexFormat format) noexcept
+        {
+            switch (format)
+            {
+            case VertexFormat::Float2:    return Float2::format;
+            case VertexFormat::Float3:    return Float3::format;
+            case VertexFormat::Half2:     return Half2::format;
+            case VertexFormat::Snorm16x4: return Snorm16x4::format;
+            }
+
+            return VK_FORMAT_UNDEFINED;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "Renderer/Vulkan/VulkanPushConstants.h"
+
+#include <string>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        VkShaderStageFlags get_push_constant_stages(std::span<const VkPushConstantRange> ranges,
+                                                    uint32_t offset,
+                                                    uint32_t size)
+        {
+            const uint32_t end = offset + size;
+
+            VkShaderStageFlags stages = 0;
+            for (const auto& range : ranges)
+            {
+                const uint32_t range_end = range.offset + range.size;
+                if (range_end <= offset || end <= range.offset)
+                    continue;
+
+                if (range.offset > offset || range_end < end)
+                {
+                    AQUA_ERROR("Vulkan Error: push constants [" + std::to_string(offset) + ", " + std::to_string(end) +
+                        ") do not fit the shader block [" + std::to_string(range.offset) + ", " + std::to_string(range_end) + ")");
+                    return 0;
+                }
+
+                if (range.offset != offset || range_end != end)
+                    AQUA_WARN("Vulkan Warning: push constants [" + std::to_string(offset) + ", " + std::to_string(end) +
+                        ") only cover part of the shader block [" + std::to_string(range.offset) + ", " + std::to_string(range_end) + ")");
+
+                stages |= range.stageFlags;
+            }
+
+            if (stages == 0)
+                AQUA_ERROR("Vulkan Error: the shaders declare no push constants at offset " + std::to_string(offset));
+
+            return stages;
+        }
+    }
+}
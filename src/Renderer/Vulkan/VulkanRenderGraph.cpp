@@ -0,0 +1,689 @@
+#include "Renderer/Vulkan/VulkanRenderGraph.h"
+#include "Renderer/Vulkan/VulkanDevice.h"
+
+#include <algorithm>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        namespace
+        {
+            struct AccessInfo
+            {
+                VkImageLayout layout;
+                VkPipelineStageFlags2 stages;
+                VkAccessFlags2 read;
+                VkAccessFlags2 write;
+                VkImageUsageFlags usage;
+            };
+
+            AccessInfo get_access_info(RenderGraph::Access access)
+            {
+                switch (access)
+                {
+                case RenderGraph::Access::ColorAttachment:
+                    return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+                case RenderGraph::Access::SampledFragment:
+                    return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_USAGE_SAMPLED_BIT };
+                case RenderGraph::Access::SampledCompute:
+                    return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_USAGE_SAMPLED_BIT };
+                case RenderGraph::Access::StorageCompute:
+                    return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT };
+                case RenderGraph::Access::TransferSrc:
+                    return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                             VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+                case RenderGraph::Access::TransferDst:
+                    return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                             VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+                }
+
+                return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                         VK_ACCESS_2_MEMORY_READ_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, 0 };
+            }
+
+            // What the next use of an image has to wait for
+            struct ResourceState
+            {
+                VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                VkPipelineStageFlags2 write_stages = VK_PIPELINE_STAGE_2_NONE;
+                VkAccessFlags2 write_access = VK_ACCESS_2_NONE;
+                // Reads since the last write, and what that write has been made visible to
+                VkPipelineStageFlags2 read_stages = VK_PIPELINE_STAGE_2_NONE;
+                VkPipelineStageFlags2 visible_stages = VK_PIPELINE_STAGE_2_NONE;
+                VkAccessFlags2 visible_access = VK_ACCESS_2_NONE;
+            };
+        }
+
+        void RenderGraph::PassBuilder::read(Resource resource, Access access)
+        {
+            graph_.add_use(pass_, { resource, access, true, false });
+        }
+
+        void RenderGraph::PassBuilder::write(Resource resource, Access access)
+        {
+            AQUA_ASSERT(get_access_info(access).write != 0, "Vulkan Error: render graph access cannot write");
+            graph_.add_use(pass_, { resource, access, false, true });
+        }
+
+        void RenderGraph::PassBuilder::color_attachment(Resource resource, std::optional<VkClearColorValue> clear)
+        {
+            graph_.add_use(pass_, { resource, Access::ColorAttachment, !clear.has_value(), true });
+            graph_.passes_[pass_].attachments.push_back({ resource, clear });
+        }
+
+        void RenderGraph::PassBuilder::side_effect()
+        {
+            graph_.passes_[pass_].side_effect = true;
+        }
+
+        RenderGraph::RenderGraph(const Device& device)
+            : device_{ &device }
+        {
+        }
+
+        RenderGraph::~RenderGraph()
+        {
+            std::vector<VkFramebuffer> framebuffers;
+            std::vector<VkRenderPass> render_passes;
+            for (auto& pass : passes_)
+            {
+                for (const auto& [views, framebuffer] : pass.framebuffers)
+                    framebuffers.push_back(framebuffer);
+                if (pass.render_pass != VK_NULL_HANDLE)
+                    render_passes.push_back(pass.render_pass);
+            }
+
+            std::vector<std::pair<VkImage, VkImageView>> images;
+            for (const auto& resource : resources_)
+            {
+                if (!resource.imported && resource.image != VK_NULL_HANDLE)
+                    images.emplace_back(resource.image, resource.view);
+            }
+
+            std::vector<VkDeviceMemory> memory;
+            for (const auto& block : memory_blocks_)
+            {
+                if (block.memory != VK_NULL_HANDLE)
+                    memory.push_back(block.memory);
+            }
+
+            if (framebuffers.empty() && render_passes.empty() && images.empty() && memory.empty())
+                return;
+
+            device_->defer_destruction([logical_device = device_->get_device(),
+                                        framebuffers = std::move(framebuffers),
+                                        render_passes = std::move(render_passes),
+                                        images = std::move(images),
+                                        memory = std::move(memory)]() {
+                for (auto framebuffer : framebuffers)
+                    vkDestroyFramebuffer(logical_device, framebuffer, nullptr);
+                for (auto render_pass : render_passes)
+                    vkDestroyRenderPass(logical_device, render_pass, nullptr);
+                for (auto [image, view] : images)
+                {
+                    vkDestroyImageView(logical_device, view, nullptr);
+                    vkDestroyImage(logical_device, image, nullptr);
+                }
+                for (auto block : memory)
+                    vkFreeMemory(logical_device, block, nullptr);
+            });
+        }
+
+        RenderGraph::Resource RenderGraph::import_image(std::string name, const ImportDesc& desc)
+        {
+            AQUA_ASSERT(!compiled_, "Vulkan Error: render graph is already compiled");
+
+            ResourceData resource{};
+            resource.name = std::move(name);
+            resource.format = desc.format;
+            resource.extent = desc.extent;
+            resource.imported = true;
+            resource.import = desc;
+            resources_.push_back(std::move(resource));
+
+            return static_cast<Resource>(resources_.size() - 1);
+        }
+
+        RenderGraph::Resource RenderGraph::create_image(std::string name, const ImageDesc& desc)
+        {
+            AQUA_ASSERT(!compiled_, "Vulkan Error: render graph is already compiled");
+
+            ResourceData resource{};
+            resource.name = std::move(name);
+            resource.format = desc.format;
+            resource.extent = desc.extent;
+            resource.imported = false;
+            resources_.push_back(std::move(resource));
+
+            return static_cast<Resource>(resources_.size() - 1);
+        }
+
+        RenderGraph::Pass RenderGraph::add_pass(std::string name,
+                                                const std::function<void(PassBuilder&)>& setup,
+                                                std::function<void(VkCommandBuffer)> execute)
+        {
+            AQUA_ASSERT(!compiled_, "Vulkan Error: render graph is already compiled");
+
+            const auto pass = static_cast<Pass>(passes_.size());
+            passes_.emplace_back();
+            passes_.back().name = std::move(name);
+            passes_.back().execute = std::move(execute);
+
+            PassBuilder builder{ *this, pass };
+            setup(builder);
+
+            return pass;
+        }
+
+        void RenderGraph::add_use(Pass pass, const Use& use)
+        {
+            AQUA_ASSERT(use.resource < resources_.size(), "Vulkan Error: unknown render graph resource");
+
+            auto& uses = passes_[pass].uses;
+            auto found = std::find_if(uses.begin(), uses.end(), [&use](const Use& other) { return other.resource == use.resource; });
+            if (found == uses.end())
+            {
+                uses.push_back(use);
+                return;
+            }
+
+            // An image has a single layout during a pass
+            if (get_access_info(found->access).layout != get_access_info(use.access).layout)
+            {
+                AQUA_ERROR("Vulkan Error: render graph pass " + passes_[pass].name + " uses " +
+                    resources_[use.resource].name + " in two layouts");
+                return;
+            }
+
+            found->read |= use.read;
+            found->write |= use.write;
+            if (use.write)
+                found->access = use.access;
+        }
+
+        bool RenderGraph::compile()
+        {
+            AQUA_ASSERT(!compiled_, "Vulkan Error: render graph is already compiled");
+
+            cull_passes();
+            compute_lifetimes();
+
+            if (!allocate_transient_images())
+                return false;
+
+            build_barriers();
+
+            if (!create_render_passes())
+                return false;
+
+            compiled_ = true;
+            return true;
+        }
+
+        void RenderGraph::cull_passes()
+        {
+            // Walking back from the imported images, a pass is kept when a kept pass or the caller reads what it writes
+            std::vector<bool> needed(resources_.size(), false);
+            for (size_t i = 0; i < resources_.size(); ++i)
+                needed[i] = resources_[i].imported;
+
+            for (auto pass = passes_.rbegin(); pass != passes_.rend(); ++pass)
+            {
+                pass->culled = !pass->side_effect && std::none_of(pass->uses.begin(), pass->uses.end(),
+                    [&needed](const Use& use) { return use.write && needed[use.resource]; });
+
+                if (pass->culled)
+                    continue;
+
+                // Whatever earlier passes wrote to an image this pass replaces is never seen
+                for (const auto& use : pass->uses)
+                {
+                    if (use.write && !use.read)
+                        needed[use.resource] = false;
+                }
+                for (const auto& use : pass->uses)
+                {
+                    if (use.read)
+                        needed[use.resource] = true;
+                }
+            }
+
+            kept_passes_.clear();
+            for (Pass pass = 0; pass < passes_.size(); ++pass)
+            {
+                if (!passes_[pass].culled)
+                    kept_passes_.push_back(pass);
+            }
+        }
+
+        void RenderGraph::compute_lifetimes()
+        {
+            for (uint32_t i = 0; i < kept_passes_.size(); ++i)
+            {
+                for (const auto& use : passes_[kept_passes_[i]].uses)
+                {
+                    auto& resource = resources_[use.resource];
+                    if (resource.first_use == invalid_handle)
+                        resource.first_use = i;
+                    resource.last_use = i;
+                    resource.usage |= get_access_info(use.access).usage;
+                }
+            }
+        }
+
+        bool RenderGraph::allocate_transient_images()
+        {
+            auto logical_device = device_->get_device();
+
+            struct Candidate
+            {
+                Resource resource;
+                VkMemoryRequirements requirements;
+            };
+
+            std::vector<Candidate> candidates;
+            for (Resource r = 0; r < resources_.size(); ++r)
+            {
+                auto& resource = resources_[r];
+                if (resource.imported || resource.first_use == invalid_handle)
+                    continue;
+
+                VkImageCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                info.imageType = VK_IMAGE_TYPE_2D;
+                info.format = resource.format;
+                info.extent = { resource.extent.width, resource.extent.height, 1 };
+                info.mipLevels = 1;
+                info.arrayLayers = 1;
+                info.samples = VK_SAMPLE_COUNT_1_BIT;
+                info.tiling = VK_IMAGE_TILING_OPTIMAL;
+                info.usage = resource.usage;
+                info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+                if (vkCreateImage(logical_device, &info, nullptr, &resource.image) != VK_SUCCESS)
+                {
+                    AQUA_ERROR("Vulkan Error: failed to create render graph image " + resource.name);
+                    resource.image = VK_NULL_HANDLE;
+                    return false;
+                }
+
+                Candidate candidate{ r, {} };
+                vkGetImageMemoryRequirements(logical_device, resource.image, &candidate.requirements);
+                candidates.push_back(candidate);
+            }
+
+            // Largest first, each image goes into the first block that is free for its whole lifetime
+            std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                return a.requirements.size > b.requirements.size;
+            });
+
+            for (const auto& candidate : candidates)
+            {
+                auto& resource = resources_[candidate.resource];
+                const auto overlaps = [this, &resource](Resource other) {
+                    return resources_[other].first_use <= resource.last_use && resource.first_use <= resources_[other].last_use;
+                };
+
+                auto block = std::find_if(memory_blocks_.begin(), memory_blocks_.end(), [&](const MemoryBlock& other) {
+                    return (other.memory_type_bits & candidate.requirements.memoryTypeBits) != 0 &&
+                           std::none_of(other.occupants.begin(), other.occupants.end(), overlaps);
+                });
+                if (block == memory_blocks_.end())
+                    block = memory_blocks_.emplace(memory_blocks_.end());
+
+                block->size = std::max(block->size, candidate.requirements.size);
+                block->memory_type_bits &= candidate.requirements.memoryTypeBits;
+                block->occupants.push_back(candidate.resource);
+                resource.memory_block = static_cast<uint32_t>(block - memory_blocks_.begin());
+            }
+
+            for (auto& block : memory_blocks_)
+            {
+                std::sort(block.occupants.begin(), block.occupants.end(), [this](Resource a, Resource b) {
+                    return resources_[a].first_use < resources_[b].first_use;
+                });
+
+                // Every occupant starts at offset 0, so the alignment of each one is met
+                VkMemoryRequirements requirements{};
+                requirements.size = block.size;
+                requirements.memoryTypeBits = block.memory_type_bits;
+
+                block.memory = device_->allocate_memory(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                if (block.memory == VK_NULL_HANDLE)
+                    return false;
+
+                for (auto r : block.occupants)
+                {
+                    auto& resource = resources_[r];
+                    if (vkBindImageMemory(logical_device, resource.image, block.memory, 0) != VK_SUCCESS)
+                    {
+                        AQUA_ERROR("Vulkan Error: failed to bind memory to render graph image " + resource.name);
+                        return false;
+                    }
+
+                    VkImageViewCreateInfo view_info{};
+                    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                    view_info.image = resource.image;
+                    view_info.format = resource.format;
+                    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                    view_info.subresourceRange.baseArrayLayer = 0;
+                    view_info.subresourceRange.layerCount = 1;
+                    view_info.subresourceRange.baseMipLevel = 0;
+                    view_info.subresourceRange.levelCount = 1;
+
+                    if (vkCreateImageView(logical_device, &view_info, nullptr, &resource.view) != VK_SUCCESS)
+                    {
+                        AQUA_ERROR("Vulkan Error: failed to create render graph image view " + resource.name);
+                        resource.view = VK_NULL_HANDLE;
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        void RenderGraph::build_barriers()
+        {
+            std::vector<ResourceState> states(resources_.size());
+            for (size_t i = 0; i < resources_.size(); ++i)
+            {
+                const auto& resource = resources_[i];
+                if (resource.imported)
+                {
+                    states[i].layout = resource.import.initial_layout;
+                    states[i].write_stages = resource.import.initial_stages;
+                    states[i].write_access = resource.import.initial_access;
+                }
+            }
+
+            // A transient image's memory was last used by the occupant before it, the first occupant follows
+            // the last one of the previous frame. Its contents are discarded, only that use has to complete
+            for (const auto& block : memory_blocks_)
+            {
+                for (size_t i = 0; i < block.occupants.size(); ++i)
+                {
+                    const auto previous = block.occupants[(i + block.occupants.size() - 1) % block.occupants.size()];
+                    const auto& last_pass = passes_[kept_passes_[resources_[previous].last_use]];
+                    const auto last_use = std::find_if(last_pass.uses.begin(), last_pass.uses.end(),
+                        [previous](const Use& use) { return use.resource == previous; });
+
+                    const auto info = get_access_info(last_use->access);
+                    auto& state = states[block.occupants[i]];
+                    if (last_use->write)
+                    {
+                        state.write_stages = info.stages;
+                        state.write_access = info.write;
+                    }
+                    else
+                        state.read_stages = info.stages;
+                }
+            }
+
+            const auto add_barrier = [](std::vector<Barrier>& barriers, Resource resource, const ResourceState& state,
+                                        VkImageLayout new_layout, VkPipelineStageFlags2 dst_stages, VkAccessFlags2 dst_access,
+                                        bool discard) {
+                // Reads since the last write already waited on it, a write after them only has to wait for the reads
+                const bool after_reads = state.read_stages != VK_PIPELINE_STAGE_2_NONE;
+                barriers.push_back({
+                    resource,
+                    discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout,
+                    new_layout,
+                    after_reads ? state.read_stages : state.write_stages,
+                    dst_stages,
+                    after_reads ? VK_ACCESS_2_NONE : state.write_access,
+                    dst_access
+                });
+            };
+
+            for (auto pass : kept_passes_)
+            {
+                auto& batch = passes_[pass].barriers;
+                for (const auto& use : passes_[pass].uses)
+                {
+                    const auto info = get_access_info(use.access);
+                    const VkAccessFlags2 access = (use.read ? info.read : VK_ACCESS_2_NONE) | (use.write ? info.write : VK_ACCESS_2_NONE);
+                    auto& state = states[use.resource];
+
+                    if (state.layout != info.layout || use.write)
+                    {
+                        const bool transition = state.layout != info.layout;
+                        if (transition || state.write_stages != 0 || state.read_stages != 0)
+                            add_barrier(batch, use.resource, state, info.layout, info.stages, access, transition && !use.read);
+
+                        // Later uses in other stages chain on this one, which covers the transition
+                        if (use.write)
+                            state = { info.layout, info.stages, info.write, 0, 0, 0 };
+                        else
+                            state = { info.layout, info.stages, 0, info.stages, info.stages, access };
+                    }
+                    else
+                    {
+                        const bool visible = (info.stages & ~state.visible_stages) == 0 && (access & ~state.visible_access) == 0;
+                        if (!visible && state.write_stages != 0)
+                        {
+                            const ResourceState after_write{ state.layout, state.write_stages, state.write_access };
+                            add_barrier(batch, use.resource, after_write, info.layout, info.stages, access, false);
+                            state.visible_stages |= info.stages;
+                            state.visible_access |= access;
+                        }
+                        state.read_stages |= info.stages;
+                    }
+                }
+            }
+
+            for (Resource r = 0; r < resources_.size(); ++r)
+            {
+                const auto& resource = resources_[r];
+                if (resource.imported && resource.import.final_layout != VK_IMAGE_LAYOUT_UNDEFINED &&
+                    resource.import.final_layout != states[r].layout)
+                {
+                    add_barrier(final_barriers_, r, states[r], resource.import.final_layout,
+                        VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, false);
+                }
+            }
+        }
+
+        bool RenderGraph::create_render_passes()
+        {
+            for (auto pass : kept_passes_)
+            {
+                auto& data = passes_[pass];
+                if (data.attachments.empty())
+                    continue;
+
+                // The graph's barriers move the attachments in and out of COLOR_ATTACHMENT_OPTIMAL
+                std::vector<VkAttachmentDescription> attachments;
+                std::vector<VkAttachmentReference> references;
+                for (const auto& attachment : data.attachments)
+                {
+                    const auto& resource = resources_[attachment.resource];
+                    if (resource.extent.width != resources_[data.attachments.front().resource].extent.width ||
+                        resource.extent.height != resources_[data.attachments.front().resource].extent.height)
+                    {
+                        AQUA_ERROR("Vulkan Error: render graph pass " + data.name + " has attachments of different sizes");
+                        return false;
+                    }
+
+                    VkAttachmentDescription description{};
+                    description.format = resource.format;
+                    description.samples = VK_SAMPLE_COUNT_1_BIT;
+                    description.loadOp = attachment.clear.has_value() ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+                    description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+                    description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                    description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                    description.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                    description.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+                    references.push_back({ static_cast<uint32_t>(attachments.size()), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+                    attachments.push_back(description);
+                }
+
+                VkSubpassDescription subpass{};
+                subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+                subpass.colorAttachmentCount = static_cast<uint32_t>(references.size());
+                subpass.pColorAttachments = references.data();
+
+                VkRenderPassCreateInfo render_pass_info{};
+                render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+                render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+                render_pass_info.pAttachments = attachments.data();
+                render_pass_info.subpassCount = 1;
+                render_pass_info.pSubpasses = &subpass;
+
+                if (vkCreateRenderPass(device_->get_device(), &render_pass_info, nullptr, &data.render_pass) != VK_SUCCESS)
+                {
+                    AQUA_ERROR("Vulkan Error: failed to create render pass for render graph pass " + data.name);
+                    data.render_pass = VK_NULL_HANDLE;
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void RenderGraph::bind_image(Resource resource, VkImage image, VkImageView view)
+        {
+            AQUA_ASSERT(resource < resources_.size() && resources_[resource].imported,
+                "Vulkan Error: only imported render graph images can be bound");
+
+            resources_[resource].image = image;
+            resources_[resource].view = view;
+        }
+
+        void RenderGraph::execute(VkCommandBuffer command_buffer)
+        {
+            AQUA_ASSERT(compiled_, "Vulkan Error: render graph has to be compiled before it executes");
+
+            std::vector<VkClearValue> clear_values;
+            for (auto pass : kept_passes_)
+            {
+                auto& data = passes_[pass];
+                record_barriers(command_buffer, data.barriers);
+
+                if (data.render_pass == VK_NULL_HANDLE)
+                {
+                    data.execute(command_buffer);
+                    continue;
+                }
+
+                clear_values.clear();
+                for (const auto& attachment : data.attachments)
+                {
+                    VkClearValue value{};
+                    value.color = attachment.clear.value_or(VkClearColorValue{});
+                    clear_values.push_back(value);
+                }
+
+                VkRenderPassBeginInfo render_pass_info{};
+                render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                render_pass_info.renderPass = data.render_pass;
+                render_pass_info.framebuffer = get_framebuffer(data);
+                render_pass_info.renderArea.offset = { 0, 0 };
+                render_pass_info.renderArea.extent = resources_[data.attachments.front().resource].extent;
+                render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+                render_pass_info.pClearValues = clear_values.data();
+
+                vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+                data.execute(command_buffer);
+                vkCmdEndRenderPass(command_buffer);
+            }
+
+            record_barriers(command_buffer, final_barriers_);
+        }
+
+        VkFramebuffer RenderGraph::get_framebuffer(PassData& pass)
+        {
+            std::vector<VkImageView> views;
+            views.reserve(pass.attachments.size());
+            for (const auto& attachment : pass.attachments)
+                views.push_back(resources_[attachment.resource].view);
+
+            if (auto found = pass.framebuffers.find(views); found != pass.framebuffers.end())
+                return found->second;
+
+            const auto extent = resources_[pass.attachments.front().resource].extent;
+
+            VkFramebufferCreateInfo framebuffer_info{};
+            framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebuffer_info.renderPass = pass.render_pass;
+            framebuffer_info.attachmentCount = static_cast<uint32_t>(views.size());
+            framebuffer_info.pAttachments = views.data();
+            framebuffer_info.width = extent.width;
+            framebuffer_info.height = extent.height;
+            framebuffer_info.layers = 1;
+
+            VkFramebuffer framebuffer = VK_NULL_HANDLE;
+            if (vkCreateFramebuffer(device_->get_device(), &framebuffer_info, nullptr, &framebuffer) != VK_SUCCESS)
+                AQUA_ERROR("Vulkan Error: failed to create framebuffer for render graph pass " + pass.name);
+
+            pass.framebuffers.emplace(std::move(views), framebuffer);
+            return framebuffer;
+        }
+
+        void RenderGraph::record_barriers(VkCommandBuffer command_buffer, const std::vector<Barrier>& batch) const
+        {
+            if (batch.empty())
+                return;
+
+            // Stage masks are per barrier, nothing before or after in the frame is NONE and orders against
+            // the queue's other work through the frame's semaphores
+            std::vector<VkImageMemoryBarrier2> barriers(batch.size());
+            for (size_t i = 0; i < barriers.size(); ++i)
+            {
+                const auto& barrier = batch[i];
+
+                barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barriers[i].oldLayout = barrier.old_layout;
+                barriers[i].newLayout = barrier.new_layout;
+                barriers[i].srcStageMask = barrier.src_stages;
+                barriers[i].dstStageMask = barrier.dst_stages;
+                barriers[i].srcAccessMask = barrier.src_access;
+                barriers[i].dstAccessMask = barrier.dst_access;
+                barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barriers[i].image = resources_[barrier.resource].image;
+                barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                barriers[i].subresourceRange.baseMipLevel = 0;
+                barriers[i].subresourceRange.levelCount = 1;
+                barriers[i].subresourceRange.baseArrayLayer = 0;
+                barriers[i].subresourceRange.layerCount = 1;
+            }
+
+            VkDependencyInfo dependency{};
+            dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+            dependency.pImageMemoryBarriers = barriers.data();
+
+            device_->cmd_pipeline_barrier(command_buffer, dependency);
+        }
+
+        VkRenderPass RenderGraph::get_render_pass(Pass pass) const
+        {
+            AQUA_ASSERT(pass < passes_.size(), "Vulkan Error: unknown render graph pass");
+            return passes_[pass].render_pass;
+        }
+
+        bool RenderGraph::is_culled(Pass pass) const
+        {
+            AQUA_ASSERT(pass < passes_.size(), "Vulkan Error: unknown render graph pass");
+            return passes_[pass].culled;
+        }
+
+        VkDeviceSize RenderGraph::get_transient_memory_size() const noexcept
+        {
+            VkDeviceSize size = 0;
+            for (const auto& block : memory_blocks_)
+                size += block.size;
+            return size;
+        }
+    }
+}
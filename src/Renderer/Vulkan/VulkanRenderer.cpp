@@ -1,10 +1,12 @@
 #include "Renderer/Vulkan/VulkanRenderer.h"
 #include "Renderer/Vulkan/VulkanDebug.h"
+#include "Renderer/Vulkan/VulkanShaderReflection.h"
 
 #include "Window/Window.h"
 #include "Window/WindowInternal.h"
 
 #include "Application/Application.h"
+#include "Assets/AssetArchive.h"
 
 #include "Utils/ShaderCompilation.h"
 
@@ -15,6 +17,10 @@
 
 #include <unordered_set>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <utility>
 
 namespace Aqua
 {
@@ -23,13 +29,108 @@ namespace Aqua
         VkInstance Renderer::instance_ = nullptr;
         std::vector<const char*> Renderer::device_extensions_ = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-            // VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+            VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
             // VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
             // VK_EXT_PRIVATE_DATA_EXTENSION_NAME,
             VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME // Removes weird memory leak
         };
         VkDebugUtilsMessengerEXT Renderer::debug_messenger_ = VK_NULL_HANDLE;
 
+        // Per frame sets hold uniform buffers, samplers come from the texture table
+        static constexpr DescriptorAllocator::PoolRatio frame_descriptor_ratios[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.f }
+        };
+
+        // Renderers created without an application, like the headless benchmark, read from the assets folder
+        static const AssetArchive* get_asset_archive()
+        {
+            const auto* application = Application::get_current();
+            return application ? application->get_asset_archive() : nullptr;
+        }
+
+        // Every scene mesh is packed with these streams, so the pipeline does not change with the scene
+        static constexpr VertexStreamLayout scene_mesh_layout = VertexStreamLayout::Interleaved;
+
+        static std::unique_ptr<Mesh> create_scene_mesh(const Device& device, const std::filesystem::path& mesh_path)
+        {
+            if (!mesh_path.empty())
+            {
+                auto cache = load_mesh(mesh_path, scene_mesh_layout);
+                if (cache.has_value())
+                {
+                    auto mesh = std::make_unique<Mesh>(device, cache->get_view());
+                    if (mesh->is_valid())
+                        return mesh;
+                }
+
+                AQUA_ERROR("Vulkan Error: failed to load scene mesh " + mesh_path.string() + ", drawing quads instead");
+            }
+
+            MeshData quad{};
+            quad.positions = { { -1.f, -1.f, 0.f }, { -1.f, 1.f, 0.f }, { 1.f, 1.f, 0.f }, { 1.f, -1.f, 0.f } };
+            quad.normals.assign(4, { 0.f, 0.f, 1.f });
+            quad.text_coords = { { 1.f, 0.f }, { 0.f, 0.f }, { 0.f, 1.f }, { 1.f, 1.f } };
+            quad.indices = { 0, 1, 2, 2, 3, 0 };
+
+            return std::make_unique<Mesh>(device, PackedMesh{ quad, scene_mesh_layout }.get_view());
+        }
+
+        static VkPresentModeKHR to_vulkan_present_mode(PresentMode mode)
+        {
+            switch (mode)
+            {
+            case PresentMode::FifoRelaxed: return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            case PresentMode::Mailbox: return VK_PRESENT_MODE_MAILBOX_KHR;
+            case PresentMode::Immediate: return VK_PRESENT_MODE_IMMEDIATE_KHR;
+            default: return VK_PRESENT_MODE_FIFO_KHR;
+            }
+        }
+
+        static PresentMode from_vulkan_present_mode(VkPresentModeKHR mode)
+        {
+            switch (mode)
+            {
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return PresentMode::FifoRelaxed;
+            case VK_PRESENT_MODE_MAILBOX_KHR: return PresentMode::Mailbox;
+            case VK_PRESENT_MODE_IMMEDIATE_KHR: return PresentMode::Immediate;
+            default: return PresentMode::Fifo;
+            }
+        }
+
+        // Assets are read from the packed archive when one is present, otherwise from the assets folder
+        static std::vector<uint32_t> load_shader(std::string_view name)
+        {
+            const auto* archive = get_asset_archive();
+            const auto* entry = archive ? archive->find(name) : nullptr;
+
+            if (entry == nullptr)
+                return compile_shader_from_file(Application::get_assets_path() / name);
+
+            if (entry->compression == AssetCompression::None)
+            {
+                auto source = archive->view(*entry);
+                return compile_shader_from_source({ reinterpret_cast<const char*>(source.data()), source.size() }, name);
+            }
+
+            auto source = archive->read(*entry);
+            return compile_shader_from_source({ reinterpret_cast<const char*>(source.data()), source.size() }, name);
+        }
+
+        static std::unique_ptr<Texture> load_texture(const Device& device, std::string_view name)
+        {
+            const auto* archive = get_asset_archive();
+            const auto* entry = archive ? archive->find(name) : nullptr;
+
+            if (entry == nullptr)
+                return std::make_unique<Texture>(device, Application::get_assets_path() / name);
+
+            if (entry->compression == AssetCompression::None)
+                return std::make_unique<Texture>(device, archive->view(*entry));
+
+            auto data = archive->read(*entry);
+            return std::make_unique<Texture>(device, std::span<const uint8_t>(data));
+        }
+
         bool Renderer::Startup()
         {
             VkApplicationInfo app_info{};
@@ -84,19 +185,37 @@ namespace Aqua
             return true;
         }
 
-        Renderer::Renderer(Window& window)
+        Renderer::Renderer(Window& window, const RendererSettings& settings)
+            : Renderer(window.get_internal_handle(), settings)
+        {
+        }
+
+        Renderer::Renderer(const RendererSettings& settings)
+            : Renderer(nullptr, settings)
+        {
+        }
+
+        Renderer::Renderer(GLFWwindow* window, const RendererSettings& settings)
             : surface_{ VK_NULL_HANDLE },
             successful_init_{ true }
         {
-            glfw_window_ = window.get_internal_handle();
+            glfw_window_ = window;
+            headless_ = settings.headless || window == nullptr;
+
+            frames_in_flight_ = std::clamp(settings.frames_in_flight, 1u, max_frames_in_flight);
+            requested_present_mode_ = to_vulkan_present_mode(settings.present_mode);
+            requested_images_ = settings.swap_chain_images;
 
-            surface_ = create_window_surface(glfw_window_);
-            if (surface_ == VK_NULL_HANDLE)
+            if (!headless_)
             {
-                AQUA_CRITICAL("Vulkan Error: failed to create window surface");
-                successful_init_ = false;
+                surface_ = create_window_surface(glfw_window_);
+                if (surface_ == VK_NULL_HANDLE)
+                {
+                    AQUA_CRITICAL("Vulkan Error: failed to create window surface");
+                    successful_init_ = false;
 
-                return;
+                    return;
+                }
             }
 
             auto physical_device = select_physical_device(surface_);
@@ -121,199 +240,119 @@ namespace Aqua
             graphics_queue_ = device_->get_graphics_queue();
             presents_queue_ = device_->get_present_queue();
 
-            std::tie(swap_chain_, image_properties_) =
-                create_swap_chain(*device_, surface_, glfw_window_);
-
-            if (swap_chain_ == VK_NULL_HANDLE)
+            if (headless_)
             {
-                AQUA_CRITICAL("Vulkan Error: failed to create logical device");
-                successful_init_ = false;
+                swap_chain_ = VK_NULL_HANDLE;
+                image_properties_.format = { VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+                image_properties_.extent = { settings.width, settings.height };
+
+                offscreen_images_ = create_offscreen_images(*device_, image_properties_, frames_in_flight_);
             }
+            else
+            {
+                std::tie(swap_chain_, image_properties_) =
+                    create_swap_chain(*device_, surface_, glfw_window_, requested_present_mode_, requested_images_);
 
-            swap_chain_images_ = create_swap_chain_images(*device_, swap_chain_);
-            swap_chain_image_views_ = create_image_views(*device_, swap_chain_images_, image_properties_);
+                if (swap_chain_ == VK_NULL_HANDLE)
+                {
+                    AQUA_CRITICAL("Vulkan Error: failed to create swap chain");
+                    successful_init_ = false;
+                }
 
+                swap_chain_images_ = create_swap_chain_images(*device_, swap_chain_);
+                swap_chain_image_views_ = create_image_views(*device_, swap_chain_images_, image_properties_);
+            }
 
-            main_uniform_buffers.resize(max_frames_in_flight);
-            for (auto& uniform : main_uniform_buffers)
-                uniform = std::make_unique<UniformBuffer>(*device_, 0, UniformBufferObject{});
-           
-            main_texture = std::make_unique<Texture>(*device_, Application::get_assets_path() / "textures/final_kerr.png");
-
-            // descriptor_set_layout_ = create_descriptor_set_layout(logical_device);
-            descriptor_set_layout_ = [logical_device](){
-                VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
-
-                VkDescriptorSetLayoutBinding ubo_binding{};
-                ubo_binding.binding = 0;
-                ubo_binding.descriptorCount = 1;
-                ubo_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                ubo_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-                ubo_binding.pImmutableSamplers = nullptr;
-
-                VkDescriptorSetLayoutBinding sampler_binding{};
-                sampler_binding.binding = 1;
-                sampler_binding.descriptorCount = 1;
-                sampler_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                sampler_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-                sampler_binding.pImmutableSamplers = nullptr;
-
-                std::array<VkDescriptorSetLayoutBinding, 2> bindings{ 
-                    ubo_binding, sampler_binding
+            texture_table_ = std::make_unique<TextureTable>(*device_, texture_table_capacity);
+
+            // Descriptor and pipeline layouts follow the shaders, the texture table set keeps its own update after
+            // bind layout
+            shaders_.vertex = load_shader("shaders/vertex.vert.glsl");
+            shaders_.fragment = load_shader("shaders/vertex.frag.glsl");
+            {
+                const std::array<ShaderReflection, 2> stages{
+                    reflect_shader(shaders_.vertex).value_or(ShaderReflection{}),
+                    reflect_shader(shaders_.fragment).value_or(ShaderReflection{})
                 };
-                VkDescriptorSetLayoutCreateInfo info{};
-                info.bindingCount = bindings.size();
-                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-                info.pBindings = bindings.data();
-
-                if (vkCreateDescriptorSetLayout(logical_device, &info, nullptr, &set_layout) != VK_SUCCESS)
-                    AQUA_ERROR("Vulkan Error: failed to create descriptor set layout");
-
-                return set_layout;
-            }();
-
-            // descriptor_pool_ = create_descriptor_pool(logical_device);
-            descriptor_pool_ = [logical_device](){
-                VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
-                std::array<VkDescriptorPoolSize, 2> pool_sizes{};
-                pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                pool_sizes[0].descriptorCount = static_cast<uint32_t>(max_frames_in_flight);
-                pool_sizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-                pool_sizes[1].descriptorCount = static_cast<uint32_t>(max_frames_in_flight);
-
-                VkDescriptorPoolCreateInfo info{};
-                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-                info.poolSizeCount = pool_sizes.size();
-                info.pPoolSizes = pool_sizes.data();
-                info.maxSets = static_cast<uint32_t>(max_frames_in_flight);
-
-                if (vkCreateDescriptorPool(logical_device, &info, nullptr, &descriptor_pool) != VK_SUCCESS)
-                    AQUA_ERROR("Vulkan Error: failed to create descriptor pool");
-
-                return descriptor_pool;
-            }();
-            descriptor_sets_.resize(max_frames_in_flight);
-            
-            std::vector<VkDescriptorSetLayout> layout(max_frames_in_flight, descriptor_set_layout_);
-            VkDescriptorSetAllocateInfo set_allocate_info{};
-            set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            set_allocate_info.descriptorPool = descriptor_pool_;
-            set_allocate_info.descriptorSetCount = static_cast<uint32_t>(max_frames_in_flight);
-            set_allocate_info.pSetLayouts = layout.data();
 
-            if (vkAllocateDescriptorSets(logical_device, &set_allocate_info, descriptor_sets_.data()) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to allocate descriptor sets");
+                auto program = reflect_program(stages);
+                if (!program.has_value())
+                {
+                    AQUA_CRITICAL("Vulkan Error: failed to reflect the graphics shaders");
+                    successful_init_ = false;
+                    program.emplace();
+                }
 
-            for (size_t i = 0; i < max_frames_in_flight; ++i)
-            {
-                VkDescriptorBufferInfo buffer_info{};
-                buffer_info.buffer = main_uniform_buffers[i]->get_buffer();
-                buffer_info.offset = 0;
-                buffer_info.range = main_uniform_buffers[i]->get_buffer_size();
-
-                VkDescriptorImageInfo image_info{};
-                image_info.imageLayout = main_texture->get_image().get_layout();
-                image_info.imageView = main_texture->get_image().get_view();
-                image_info.sampler = main_texture->get_sampler();
-
-                std::array<VkWriteDescriptorSet, 2> descriptor_writes{};
-                descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptor_writes[0].dstSet = descriptor_sets_[i];
-                descriptor_writes[0].dstBinding = 0;
-                descriptor_writes[0].dstArrayElement = 0;
-                descriptor_writes[0].descriptorCount = 1;
-                descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                descriptor_writes[0].pBufferInfo = &buffer_info;
-                descriptor_writes[0].pImageInfo = nullptr;
-                descriptor_writes[0].pTexelBufferView = nullptr;
-
-                descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptor_writes[1].dstSet = descriptor_sets_[i];
-                descriptor_writes[1].dstBinding = 1;
-                descriptor_writes[1].dstArrayElement = 0;
-                descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                descriptor_writes[1].descriptorCount = 1;
-                descriptor_writes[1].pImageInfo = &image_info;
-
-                vkUpdateDescriptorSets(logical_device, static_cast<uint32_t>(descriptor_writes.size()),
-                    descriptor_writes.data(), 0, nullptr);
+                const FixedSetLayout fixed_sets[] = { { texture_table_set, texture_table_->get_layout() } };
+                auto layout = create_reflected_layout(*device_, *program, fixed_sets);
+
+                pipeline_layout_ = layout.pipeline_layout;
+                descriptor_set_layout_ = layout.set_layouts[scene_set];
+                const auto mesh_streams = get_packed_streams(scene_mesh_layout);
+                shaders_.vertex_bindings = Mesh::get_binding_descriptions(mesh_streams);
+                shaders_.vertex_attributes = match_vertex_inputs(program->vertex_inputs, Mesh::get_attribute_descriptions(mesh_streams));
+
+                draw_constants_ = PushConstants<DrawConstants>{ pipeline_layout_, program->push_constants };
+                if (!draw_constants_.is_valid())
+                {
+                    AQUA_CRITICAL("Vulkan Error: the graphics shaders do not declare the draw push constants");
+                    successful_init_ = false;
+                }
             }
 
-            pipeline_layout_ = create_graphics_pipeline_layout(logical_device);
-            render_pass_ = create_render_pass(logical_device, image_properties_);
-            graphics_pipeline_ = create_graphics_pipeline(logical_device, render_pass_, pipeline_layout_, image_properties_);
-            swap_chain_framebuffers_ = create_framebuffers(*device_, render_pass_, swap_chain_image_views_, image_properties_);
+            // Scene sets are allocated per frame slot, the first draw_frame of each slot writes them
+            frame_descriptor_allocators_.resize(frames_in_flight_);
+            for (auto& allocator : frame_descriptor_allocators_)
+                allocator = std::make_unique<DescriptorAllocator>(*device_, frame_descriptor_ratios);
+            frame_scene_versions_.assign(frames_in_flight_, 0);
+
+            create_scene_resources();
+
+            if (!build_frame_graph())
+            {
+                AQUA_CRITICAL("Vulkan Error: failed to compile the frame graph");
+                successful_init_ = false;
+            }
+            graphics_pipeline_ = create_graphics_pipeline(logical_device, frame_graph_->get_render_pass(scene_pass_),
+                pipeline_layout_, image_properties_, shaders_);
 
             command_pool_ = device_->create_command_pool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
-            // record_command_buffer(command_buffer_, graphics_pipeline_, render_pass_, swap_chain_framebuffers_, 0, image_properties_);
-            command_buffers_.resize(max_frames_in_flight);
-            in_flight_fences_.resize(max_frames_in_flight);
-            image_available_semaphores_.resize(max_frames_in_flight);
-            render_finished_semaphores_.resize(max_frames_in_flight);
+            command_buffers_.resize(frames_in_flight_);
+            frame_values_.assign(frames_in_flight_, 0);
 
             for (auto& command_buffer : command_buffers_)
                 command_buffer = device_->create_command_buffer(command_pool_);
 
-            for (auto& semaphore : image_available_semaphores_)
-                semaphore = create_semaphore(logical_device);
-
-            for (auto& semaphore : render_finished_semaphores_)
-                semaphore = create_semaphore(logical_device);
-
-            for (auto& fence : in_flight_fences_)
-                fence = create_fence(logical_device);
-
-            main_vertex_buffer = std::make_unique<VertexBuffer>(
-                *device_,
-                std::vector<Vertex> {
-                    { {-0.5,-0.5} , {1.0, 0.0, 0.0} , { 1.f, 0.f}},
-                    { {-0.5, 0.5} , {0.0, 1.0, 0.0} , { 0.f, 0.f}},
-                    { { 0.5, 0.5} , {0.0, 0.0, 1.0} , { 0.f, 1.f}}
-                    ,
-                    // { { 0.5, 0.5} , {0.0, 0.0, 1.0} },
-                    { { 0.5,-0.5} , {0.0, 1.0, 0.0} , {1.f, 1.f}}
-                    // ,
-                    // { {-0.5,-0.5} , {1.0, 0.0, 0.0} }
-            
-                    // { {0.5, -0.5} , {1.0, 0.0, 0.0} },
-                    // { {0.5, 0.5} , {0.0, 1.0, 0.0} },
-                    // { {-0.5, 0.5} , {0.0, 1.0, 1.0} }
-                }
-            );
+            if (!headless_)
+            {
+                image_available_semaphores_ = create_semaphores(logical_device, frames_in_flight_);
+                render_finished_semaphores_ = create_semaphores(logical_device, swap_chain_images_.size());
+            }
 
-            main_index_buffer = std::make_unique<IndexBuffer>(
-                *device_,
-                std::vector<uint32_t>{
-                    0, 1, 2, 2, 3, 0
-                }
-            );
+            collect_timings_ = settings.collect_timings;
+            if (collect_timings_)
+                create_timestamp_pool();
         }
 
         Renderer::~Renderer()
         {
             device_->wait_idle();
 
-            main_vertex_buffer = nullptr;
-            main_index_buffer = nullptr;
+            destroy_scene_resources();
+            frame_descriptor_allocators_.clear();
+            texture_table_ = nullptr;
 
             auto logical_device = device_->get_device();
 
+            if (timestamp_pool_ != VK_NULL_HANDLE)
+                vkDestroyQueryPool(logical_device, timestamp_pool_, nullptr);
 
             for (auto semaphore : image_available_semaphores_)
                 vkDestroySemaphore(logical_device, semaphore, nullptr);
 
-            for (auto semaphore : render_finished_semaphores_)
-                vkDestroySemaphore(logical_device, semaphore, nullptr);
-
-            for (auto fence: in_flight_fences_)
-                vkDestroyFence(logical_device, fence, nullptr);
-
             cleanup_swap_chain();
 
-            vkDestroyDescriptorPool(logical_device, descriptor_pool_, nullptr);
-            vkDestroyDescriptorSetLayout(logical_device, descriptor_set_layout_, nullptr);
-
             vkFreeCommandBuffers(logical_device, command_pool_, command_buffers_.size(), command_buffers_.data());
             vkDestroyCommandPool(logical_device, command_pool_, nullptr);
 
@@ -321,8 +360,7 @@ namespace Aqua
             //     vkDestroyImage(logical_device, image, nullptr);
 
             vkDestroyPipeline(logical_device, graphics_pipeline_, nullptr);
-            vkDestroyRenderPass(logical_device, render_pass_, nullptr);
-            vkDestroyPipelineLayout(logical_device, pipeline_layout_, nullptr);
+            frame_graph_ = nullptr;
 
             device_ = nullptr;
 
@@ -331,16 +369,291 @@ namespace Aqua
 
         void Renderer::draw_frame()
         {
-            const auto& window = Application::get().get_window();
+            const auto frame_start = std::chrono::high_resolution_clock::now();
+
+            // The last submission of this frame slot, and everything submitted before it, has completed after this
+            device_->wait(frame_values_[current_frame_]);
+            device_->collect_garbage();
+
+            // Nothing in flight uses this slot's sets anymore, a scene change rewrites them here. Without sets the
+            // frame is dropped rather than recorded with null sets, the next one retries
+            if (frame_scene_versions_[current_frame_] != scene_version_ && !write_frame_descriptor_sets(current_frame_))
+                return;
+
+            if (collect_timings_)
+            {
+                for (auto& pending : pending_timings_)
+                {
+                    if (!pending.gpu_resolved && pending.slot == current_frame_)
+                        resolve_gpu_timing(pending);
+                }
+                resolve_present_timings(0);
+            }
+
+            if (!headless_ && swap_chain_out_of_date_ && !recreate_swap_chain())
+                return;
+
+            uint32_t image_index = current_frame_;
+            if (!headless_)
+            {
+                auto acquire_result = vkAcquireNextImageKHR(device_->get_device(),
+                                                            swap_chain_,
+                                                            UINT64_MAX,
+                                                            image_available_semaphores_[current_frame_],
+                                                            VK_NULL_HANDLE,
+                                                            &image_index);
+
+                // A failed acquire leaves the semaphore unsignaled so it can be reused as is. A pending resize
+                // still draws into the acquired image and recreates after presenting it
+                if (acquire_result == VK_ERROR_OUT_OF_DATE_KHR)
+                {
+                    recreate_swap_chain();
+                    return;
+                }
+                else if (acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR)
+                {
+                    AQUA_ERROR("Vulkan Error: failed to acquire swap chain image");
+                }
+
+                // Acquiring can block on the presentation engine, which is when earlier presents complete
+                if (collect_timings_)
+                    resolve_present_timings(0);
+            }
+
+            // The timeline wait guarantees the previous submission of this frame no longer reads its uniforms
+            update_scene_uniforms();
+
+            vkResetCommandBuffer(command_buffers_[current_frame_], 0);
+            record_command_buffer(command_buffers_[current_frame_], image_index);
+
+            VkSemaphore wait_semaphores[] = { headless_ ? VK_NULL_HANDLE : image_available_semaphores_[current_frame_] };
+            VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            VkSemaphore signal_semaphores[] = { headless_ ? VK_NULL_HANDLE : render_finished_semaphores_[image_index] };
+
+            Device::SubmitSemaphores semaphores{};
+            if (!headless_)
+            {
+                semaphores.wait = wait_semaphores;
+                semaphores.wait_stages = wait_stages;
+                semaphores.signal = signal_semaphores;
+            }
+
+            frame_values_[current_frame_] = device_->submit(graphics_queue_, command_buffers_[current_frame_], semaphores);
+
+            // Ids only have to increase per swap chain, the frame index does across all of them
+            const uint64_t present_id = has_present_timings() ? frame_index_ + 1 : 0;
+            const auto presented_swap_chain = swap_chain_;
+
+            if (!headless_)
+            {
+                VkPresentIdKHR present_id_info{};
+                present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+                present_id_info.swapchainCount = 1;
+                present_id_info.pPresentIds = &present_id;
+
+                VkPresentInfoKHR present_info{};
+                present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                present_info.pNext = present_id != 0 ? &present_id_info : nullptr;
+                present_info.waitSemaphoreCount = 1;
+                present_info.pWaitSemaphores = signal_semaphores;
+                
+                VkSwapchainKHR swap_chains[] = { swap_chain_ };
+                present_info.swapchainCount = 1;
+                present_info.pSwapchains = swap_chains;
+                present_info.pImageIndices = &image_index;
+                present_info.pResults = nullptr;
+
+                auto result = vkQueuePresentKHR(presents_queue_, &present_info);
+                if (framebuffer_resize_ || result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+                {
+                    framebuffer_resize_ = false;
+                    recreate_swap_chain();
+                }
+                else if (result != VK_SUCCESS)
+                    AQUA_ERROR("Vulkan Error: failed to queue presentation of image");
+            }
+
+            if (collect_timings_)
+            {
+                const auto frame_end = std::chrono::high_resolution_clock::now();
+
+                PendingTiming pending{};
+                pending.timing.frame = frame_index_;
+                pending.timing.cpu_ms = std::chrono::duration<double, std::milli>(frame_end - frame_start).count();
+                pending.start = frame_start;
+                pending.slot = current_frame_;
+                pending.present_id = present_id;
+                pending.swap_chain = presented_swap_chain;
+                pending_timings_.push_back(pending);
+
+                collect_resolved_timings();
+            }
+            ++frame_index_;
+            
+            current_frame_ = (current_frame_ + 1) % frames_in_flight_;
+
+            prev_time = curr_time;
+            curr_time = std::chrono::high_resolution_clock::now();
+        }
+
+        void Renderer::set_scene(const SceneDescription& scene)
+        {
+            destroy_scene_resources();
+            scene_ = scene;
+            create_scene_resources();
+        }
+
+        std::vector<FrameTiming> Renderer::flush_frame_timings()
+        {
+            device_->wait_idle();
+
+            for (auto& pending : pending_timings_)
+            {
+                if (!pending.gpu_resolved)
+                    resolve_gpu_timing(pending);
+            }
+
+            // Bounded, a frame that never reaches the screen, such as on a minimized window, stays unmeasured
+            resolve_present_timings(100'000'000);
+            for (auto& pending : pending_timings_)
+                pending.present_id = 0;
+            collect_resolved_timings();
+
+            std::sort(frame_timings_.begin(), frame_timings_.end(),
+                [](const FrameTiming& a, const FrameTiming& b) { return a.frame < b.frame; });
+
+            return std::exchange(frame_timings_, {});
+        }
+
+        void Renderer::create_scene_resources()
+        {
+            auto logical_device = device_->get_device();
+
+            scene_.quad_count = std::max(scene_.quad_count, 1u);
+            scene_.texture_count = std::max(scene_.texture_count, 1u);
+            scene_.uniform_updates = std::max(scene_.uniform_updates, 1u);
+
+            scene_mesh_ = create_scene_mesh(*device_, scene_.mesh);
+
+            // Quads on a square grid covering [-1, 1], a single quad keeps the original 1x1 size. The mesh is
+            // centered and scaled so its largest extent spans half of a cell, as the flat quad always did
+            const auto grid_size = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(scene_.quad_count))));
+            const float cell_size = 2.f / static_cast<float>(grid_size);
+            const float half_extent = 0.25f * cell_size;
+
+            const auto& bounds_min = scene_mesh_->get_bounds_min();
+            const auto& bounds_max = scene_mesh_->get_bounds_max();
+            const stm::vec3f mesh_half_size = 0.5f * (bounds_max - bounds_min);
+            const stm::vec3f to_origin = -0.5f * (bounds_min + bounds_max);
+            const float mesh_extent = std::max({ mesh_half_size.x, mesh_half_size.y, mesh_half_size.z });
+            const float mesh_scale = mesh_extent > 0.f ? half_extent / mesh_extent : 1.f;
+            const auto fit_mesh = stm::matmul(stm::scale<float>(mesh_scale, mesh_scale, mesh_scale),
+                                              stm::translate<float>(to_origin));
+
+            // Transposed like the uniforms, GLSL matrices are column major
+            scene_transforms_.resize(scene_.quad_count);
+            for (uint32_t quad = 0; quad < scene_.quad_count; ++quad)
+            {
+                const float x = -1.f + cell_size * (static_cast<float>(quad % grid_size) + 0.5f);
+                const float y = -1.f + cell_size * (static_cast<float>(quad / grid_size) + 0.5f);
+                scene_transforms_[quad] = stm::matmul(stm::translate<float>(x, y, 0.f), fit_mesh).transpose();
+            }
+
+            if (scene_.texture_count > texture_table_->capacity())
+            {
+                AQUA_WARN("Vulkan Warning: scene texture count exceeds the texture table capacity, clamping it");
+                scene_.texture_count = std::max(texture_table_->capacity(), 1u);
+            }
+
+            // A texture the table rejects is dropped and its quads sample slot 0 instead of an unbound index
+            scene_textures_.resize(scene_.texture_count);
+            scene_texture_indices_.resize(scene_.texture_count);
+            for (uint32_t i = 0; i < scene_.texture_count; ++i)
+            {
+                scene_textures_[i] = load_texture(*device_, "textures/final_kerr.png");
+                scene_texture_indices_[i] = texture_table_->add(*scene_textures_[i]);
+                if (scene_texture_indices_[i] == TextureTable::invalid_index)
+                {
+                    AQUA_ERROR("Vulkan Error: failed to add scene texture to the texture table, using slot 0");
+                    scene_textures_[i] = nullptr;
+                    scene_texture_indices_[i] = 0;
+                }
+            }
+
+            scene_uniform_buffers_.resize(scene_.uniform_updates * frames_in_flight_);
+            for (auto& uniform : scene_uniform_buffers_)
+                uniform = std::make_unique<UniformBuffer>(*device_, 0, UniformBufferObject{});
+
+            sets_per_frame_ = std::min(scene_.quad_count, scene_.uniform_updates);
+            descriptor_sets_.assign(sets_per_frame_ * frames_in_flight_, VK_NULL_HANDLE);
+
+            ++scene_version_;
+        }
+
+        bool Renderer::write_frame_descriptor_sets(uint32_t frame)
+        {
+            auto& allocator = *frame_descriptor_allocators_[frame];
+            allocator.reset();
+
+            const std::span<VkDescriptorSet> frame_sets{ descriptor_sets_.data() + frame * sets_per_frame_, sets_per_frame_ };
+            const std::vector<VkDescriptorSetLayout> layouts(sets_per_frame_, descriptor_set_layout_);
+            if (!allocator.allocate(layouts, frame_sets))
+                return false;
+
+            std::vector<VkDescriptorBufferInfo> buffer_infos(sets_per_frame_);
+            std::vector<VkWriteDescriptorSet> descriptor_writes(sets_per_frame_);
+            for (uint32_t set = 0; set < sets_per_frame_; ++set)
+            {
+                const auto& uniform = scene_uniform_buffers_[frame * scene_.uniform_updates + set];
+
+                auto& buffer_info = buffer_infos[set];
+                buffer_info.buffer = uniform->get_buffer();
+                buffer_info.offset = 0;
+                buffer_info.range = uniform->get_buffer_size();
+
+                auto& write = descriptor_writes[set];
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = frame_sets[set];
+                write.dstBinding = 0;
+                write.dstArrayElement = 0;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                write.pBufferInfo = &buffer_info;
+            }
+
+            vkUpdateDescriptorSets(device_->get_device(), static_cast<uint32_t>(descriptor_writes.size()),
+                descriptor_writes.data(), 0, nullptr);
+
+            frame_scene_versions_[frame] = scene_version_;
+            return true;
+        }
+
+        void Renderer::destroy_scene_resources()
+        {
+            // The sets themselves stay in the frame allocators until each slot is rewritten
+            descriptor_sets_.clear();
+            sets_per_frame_ = 0;
+
+            scene_uniform_buffers_.clear();
+
+            // Frames in flight may still sample the slots, the table only reuses them once those complete
+            for (uint32_t i = 0; i < scene_textures_.size(); ++i)
+                if (scene_textures_[i])
+                    texture_table_->remove(scene_texture_indices_[i]);
+            scene_texture_indices_.clear();
+            scene_textures_.clear();
+            scene_transforms_.clear();
+            scene_mesh_ = nullptr;
+        }
+
+        void Renderer::update_scene_uniforms()
+        {
+            if (scene_.time_step > 0.f)
+                scene_time_ += scene_.time_step;
+            else
+                scene_time_ += std::chrono::duration<float, std::chrono::seconds::period>(curr_time - prev_time).count();
+            scene_time_ = std::fmod(scene_time_, 4.f);
 
-            UniformBufferObject ubo{};
-            auto time = std::chrono::duration<float, std::chrono::seconds::period>(curr_time - prev_time);
-            // AQUA_INFO(std::string("FPS: ") + std::to_string(1.f/time.count()));
-            static float angle = 0.f;
-            angle += time.count() * std::numbers::pi / 2.0;
-            angle = fmod(angle, std::numbers::pi * 2);
-            auto rot = stm::rotate<float>({0.f, 0.f, 1.f}, angle);
-            ubo.model = rot.transpose();
             constexpr auto global_up = stm::vector{ 0.f, 1.f, 0.f };
             constexpr auto look = stm::vector{ 0.f, 0.f, 0.f }; 
             constexpr auto pos = stm::vector{ 2.f, 2.f , 2.f };
@@ -348,123 +661,206 @@ namespace Aqua
             constexpr auto right = stm::cross(dir, global_up).unit();
             constexpr auto up = stm::cross(right, dir).unit();
             constexpr auto view = stm::lookAt<float>(pos, up, right);
+
+            const float aspect = static_cast<float>(image_properties_.extent.width) / static_cast<float>(image_properties_.extent.height);
+
+            UniformBufferObject ubo{};
             ubo.view = view.transpose();
-            ubo.projection = stm::perspective<float>(std::numbers::pi / 2, (float)window.get_width() / (float)window.get_height(), 0.1, 10.).transpose();
+            ubo.projection = stm::perspective<float>(std::numbers::pi / 2, aspect, 0.1, 10.).transpose();
 
-            main_uniform_buffers[current_frame_]->set_uniform_data(ubo);
+            // Quarter turn per second, each uniform buffer offset by an equal share of a turn
+            for (uint32_t i = 0; i < scene_.uniform_updates; ++i)
+            {
+                const float angle = static_cast<float>(scene_time_ * std::numbers::pi / 2.0
+                    + 2.0 * std::numbers::pi * i / scene_.uniform_updates);
+                ubo.model = stm::rotate<float>({ 0.f, 0.f, 1.f }, angle).transpose();
 
-            vkWaitForFences(device_->get_device(), 1, &in_flight_fences_[current_frame_], VK_TRUE, UINT64_MAX);
+                scene_uniform_buffers_[current_frame_ * scene_.uniform_updates + i]->set_uniform_data(ubo);
+            }
+        }
 
-            uint32_t image_index = 0;
-            auto acquire_result = vkAcquireNextImageKHR(device_->get_device(),
-                                                        swap_chain_,
-                                                        UINT64_MAX,
-                                                        image_available_semaphores_[current_frame_],
-                                                        VK_NULL_HANDLE,
-                                                        &image_index);
+        void Renderer::create_timestamp_pool()
+        {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device_->get_physical_device(), &properties);
 
-            if (framebuffer_resize_ || acquire_result == VK_ERROR_OUT_OF_DATE_KHR)
-            {
-                AQUA_INFO("Vulkan Info: Recreated swap chain");
-                framebuffer_resize_ = false;
+            uint32_t queue_family_count = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(device_->get_physical_device(), &queue_family_count, nullptr);
+
+            std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+            vkGetPhysicalDeviceQueueFamilyProperties(device_->get_physical_device(), &queue_family_count, queue_families.data());
 
-                recreate_swap_chain();
+            const uint32_t valid_bits = queue_families[device_->get_queue_families().graphics_family.value()].timestampValidBits;
+
+            if (valid_bits == 0 || properties.limits.timestampPeriod == 0.f)
+            {
+                AQUA_WARN("Vulkan Warning: graphics queue does not support timestamps, only CPU times are recorded");
                 return;
             }
-            else if (acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR)
+
+            timestamp_period_ = properties.limits.timestampPeriod;
+            timestamp_mask_ = valid_bits >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << valid_bits) - 1;
+
+            VkQueryPoolCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            info.queryCount = 2 * frames_in_flight_;
+
+            if (vkCreateQueryPool(device_->get_device(), &info, nullptr, &timestamp_pool_) != VK_SUCCESS)
             {
-                AQUA_ERROR("Vulkan Error: failed to acquire swap chain image");
+                AQUA_ERROR("Vulkan Error: failed to create timestamp query pool");
+                timestamp_pool_ = VK_NULL_HANDLE;
             }
+        }
 
-            vkResetFences(device_->get_device(), 1, &in_flight_fences_[current_frame_]);
+        void Renderer::resolve_gpu_timing(PendingTiming& pending)
+        {
+            pending.gpu_resolved = true;
+            if (timestamp_pool_ == VK_NULL_HANDLE)
+                return;
 
-            vkResetCommandBuffer(command_buffers_[current_frame_], 0);
-            record_command_buffer(command_buffers_[current_frame_],
-                                graphics_pipeline_,
-                                render_pass_,
-                                swap_chain_framebuffers_,
-                                image_index,
-                                image_properties_);
+            std::array<uint64_t, 2> timestamps{};
+            auto result = vkGetQueryPoolResults(device_->get_device(), timestamp_pool_, 2 * pending.slot, 2,
+                sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
 
+            if (result == VK_SUCCESS)
+            {
+                const auto ticks = ((timestamps[1] - timestamps[0]) & timestamp_mask_);
+                pending.timing.gpu_ms = static_cast<double>(ticks) * timestamp_period_ * 1e-6;
+            }
+            else
+                AQUA_ERROR("Vulkan Error: failed to read frame timestamps");
+        }
 
-            VkSubmitInfo submit_info{};
-            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        void Renderer::resolve_present_timings(uint64_t timeout)
+        {
+            for (auto& pending : pending_timings_)
+            {
+                if (pending.present_id == 0)
+                    continue;
 
-            VkSemaphore wait_semaphores[] = { image_available_semaphores_[current_frame_] };
+                // Ids are only meaningful to the swap chain they were presented to, a retired one is not waited on
+                if (pending.swap_chain != swap_chain_)
+                {
+                    pending.present_id = 0;
+                    continue;
+                }
 
-            VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-            submit_info.waitSemaphoreCount = 1;
-            submit_info.pWaitSemaphores = wait_semaphores;
-            submit_info.commandBufferCount = 1;
-            submit_info.pCommandBuffers = &command_buffers_[current_frame_];
-            submit_info.pWaitDstStageMask = wait_stages;
-
-            VkSemaphore signal_semaphores[] = { render_finished_semaphores_[current_frame_] };
-            submit_info.signalSemaphoreCount = 1;
-            submit_info.pSignalSemaphores = signal_semaphores;
-
-            if (vkQueueSubmit(graphics_queue_, 1, &submit_info, in_flight_fences_[current_frame_]) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to submit draw command buffer");
-
-            VkPresentInfoKHR present_info{};
-            present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            present_info.waitSemaphoreCount = 1;
-            present_info.pWaitSemaphores = signal_semaphores;
-            
-            VkSwapchainKHR swap_chains[] = { swap_chain_ };
-            present_info.swapchainCount = 1;
-            present_info.pSwapchains = swap_chains;
-            present_info.pImageIndices = &image_index;
-            present_info.pResults = nullptr;
-
-            auto result = vkQueuePresentKHR(presents_queue_, &present_info);
-            if (framebuffer_resize_ || result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
-            {
-                AQUA_INFO("Vulkan Info: Recreated swap chain");
-                recreate_swap_chain();
+                // Presents complete in order, once one is pending so are all the later ones
+                auto result = device_->wait_for_present(swap_chain_, pending.present_id, timeout);
+                if (result == VK_TIMEOUT)
+                    break;
 
-                framebuffer_resize_ = false;
+                if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+                {
+                    const auto now = std::chrono::high_resolution_clock::now();
+                    pending.timing.present_ms = std::chrono::duration<double, std::milli>(now - pending.start).count();
+                }
+                pending.present_id = 0;
             }
-            else if (result != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to queue presentation of image");
-            
-            current_frame_ = (current_frame_ + 1) % max_frames_in_flight;
+        }
 
-            if (::Aqua::Vulkan::ENABLE_VALIDATION_LAYERS)
-                device_->wait_idle();
+        void Renderer::collect_resolved_timings()
+        {
+            while (!pending_timings_.empty() &&
+                pending_timings_.front().gpu_resolved &&
+                pending_timings_.front().present_id == 0)
+            {
+                frame_timings_.push_back(pending_timings_.front().timing);
+                pending_timings_.pop_front();
+            }
+        }
 
-            prev_time = curr_time;
-            curr_time = std::chrono::high_resolution_clock::now();
+        PresentMode Renderer::get_present_mode() const noexcept
+        {
+            return from_vulkan_present_mode(image_properties_.present_mode);
         }
 
-        void Renderer::recreate_swap_chain()
+        bool Renderer::recreate_swap_chain()
         {
-            device_->wait_idle();
+            auto logical_device = device_->get_device();
 
-            cleanup_swap_chain();
+            // A minimized window has no extent to create images for, the old swap chain is kept until it returns
+            VkSurfaceCapabilitiesKHR capabilities;
+            vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device_->get_physical_device(), surface_, &capabilities);
+            if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0)
+            {
+                swap_chain_out_of_date_ = true;
+                return false;
+            }
+
+            // Passing the old swap chain lets the presentation engine hand its images over without a device wait
+            const auto old_swap_chain = swap_chain_;
+            const auto old_format = image_properties_.format.format;
+            ImageProperties properties;
+            std::tie(swap_chain_, properties) = create_swap_chain(*device_, surface_, glfw_window_,
+                requested_present_mode_, requested_images_, old_swap_chain);
+
+            // The old swap chain is retired even if creation failed
+            retire_swap_chain(old_swap_chain);
+
+            if (swap_chain_ == VK_NULL_HANDLE)
+            {
+                swap_chain_out_of_date_ = true;
+                return false;
+            }
+
+            image_properties_ = properties;
 
-            std::tie(swap_chain_, image_properties_) = create_swap_chain(*device_, surface_, glfw_window_);
             swap_chain_images_ = create_swap_chain_images(*device_, swap_chain_);
             swap_chain_image_views_ = create_image_views(*device_, swap_chain_images_, image_properties_);
-            swap_chain_framebuffers_ = create_framebuffers(*device_, render_pass_, swap_chain_image_views_, image_properties_);
-            
-            for (auto& semaphore : image_available_semaphores_)
-                semaphore = create_semaphore(device_->get_device());
+            render_finished_semaphores_ = create_semaphores(logical_device, swap_chain_images_.size());
+
+            // The graph follows the new extent. Pipelines only need render passes of the same formats, so they
+            // are kept unless the format changed
+            if (!build_frame_graph())
+                AQUA_ERROR("Vulkan Error: failed to compile the frame graph");
+
+            if (image_properties_.format.format != old_format)
+            {
+                device_->defer_destruction([logical_device, pipeline = graphics_pipeline_]() {
+                    vkDestroyPipeline(logical_device, pipeline, nullptr);
+                });
+
+                graphics_pipeline_ = create_graphics_pipeline(logical_device, frame_graph_->get_render_pass(scene_pass_),
+                    pipeline_layout_, image_properties_, shaders_);
+            }
+
+            swap_chain_out_of_date_ = false;
+            AQUA_INFO("Vulkan Info: Recreated swap chain");
+
+            return true;
+        }
+
+        void Renderer::retire_swap_chain(VkSwapchainKHR swap_chain)
+        {
+            device_->defer_destruction([logical_device = device_->get_device(),
+                                        swap_chain,
+                                        views = std::exchange(swap_chain_image_views_, {}),
+                                        semaphores = std::exchange(render_finished_semaphores_, {})]() {
+                for (auto semaphore : semaphores)
+                    vkDestroySemaphore(logical_device, semaphore, nullptr);
+
+                for (auto view : views)
+                    vkDestroyImageView(logical_device, view, nullptr);
+
+                vkDestroySwapchainKHR(logical_device, swap_chain, nullptr);
+            });
+            swap_chain_images_.clear();
         }
         
         void Renderer::cleanup_swap_chain()
         {
             auto logical_device = device_->get_device();
         
-            for (auto semaphore : image_available_semaphores_)
+            for (auto semaphore : render_finished_semaphores_)
                 vkDestroySemaphore(logical_device, semaphore, nullptr);
 
-            for (auto framebuffer : swap_chain_framebuffers_)
-                vkDestroyFramebuffer(logical_device, framebuffer, nullptr);
-
             for (const auto& view : swap_chain_image_views_)
                 vkDestroyImageView(logical_device, view, nullptr);
 
+            offscreen_images_.clear();
+
             vkDestroySwapchainKHR(logical_device, swap_chain_, nullptr);
         }
 
@@ -586,14 +982,19 @@ namespace Aqua
             return available_formats.front();
         }
 
-        VkPresentModeKHR Renderer::select_present_mode(const std::vector<VkPresentModeKHR>& available_modes)
+        VkPresentModeKHR Renderer::select_present_mode(
+            const std::vector<VkPresentModeKHR>& available_modes,
+            VkPresentModeKHR requested_mode)
         {
             for (const auto& mode : available_modes)
             {
-                if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+                if (mode == requested_mode)
                     return mode;
             }
 
+            // The only mode every surface has to support
+            if (requested_mode != VK_PRESENT_MODE_FIFO_KHR)
+                AQUA_WARN("Vulkan Warning: requested present mode is not supported, falling back to FIFO");
             return VK_PRESENT_MODE_FIFO_KHR;
         }
 
@@ -652,11 +1053,34 @@ namespace Aqua
 
             auto queue_families = Device::find_queue_families(device, surface);
 
+            // Frame pacing, uploads and deferred destruction all run on a timeline semaphore, textures are bindless
+            // and image barriers are recorded with vkCmdPipelineBarrier2
+            VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_features{};
+            synchronization2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+            VkPhysicalDeviceVulkan12Features features_12{};
+            features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            features_12.pNext = &synchronization2_features;
+
+            VkPhysicalDeviceFeatures2 features_2{};
+            features_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features_2.pNext = &features_12;
+            vkGetPhysicalDeviceFeatures2(device, &features_2);
+
             auto is_gpu = device_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
-            auto has_features = device_features.geometryShader;
+            auto has_features = device_features.geometryShader &&
+                                device_properties.apiVersion >= VK_API_VERSION_1_2 &&
+                                features_12.timelineSemaphore &&
+                                synchronization2_features.synchronization2 &&
+                                device_features.shaderSampledImageArrayDynamicIndexing &&
+                                TextureTable::is_supported(features_12);
             auto extensions_supported = check_device_extension_support(device);
             auto swap_chain_adequate = false;
 
+            // Headless renderers have no surface to present to
+            if (surface == VK_NULL_HANDLE)
+                return has_features && queue_families.graphics_family.has_value() && extensions_supported && is_gpu;
+
             if (extensions_supported)
             {
                 SwapChainSupportDetails details = get_swap_chain_support(device, surface);
@@ -716,18 +1140,24 @@ namespace Aqua
         std::pair<VkSwapchainKHR, Renderer::ImageProperties> Renderer::create_swap_chain(
             const Device& device,
             VkSurfaceKHR surface,
-            GLFWwindow* window)
+            GLFWwindow* window,
+            VkPresentModeKHR requested_mode,
+            uint32_t requested_images,
+            VkSwapchainKHR old_swap_chain)
         {
             SwapChainSupportDetails swap_chain_support = get_swap_chain_support(device.get_physical_device(), surface);
 
             VkSurfaceFormatKHR surface_format = select_surface_format(swap_chain_support.formats);
-            VkPresentModeKHR present_mode = select_present_mode(swap_chain_support.present_modes);
+            VkPresentModeKHR present_mode = select_present_mode(swap_chain_support.present_modes, requested_mode);
             VkExtent2D extent = select_surface_extent(swap_chain_support.capabilities, window);
-            uint32_t image_count = swap_chain_support.capabilities.minImageCount + 1;
+
+            // Every image past the minimum lets the CPU queue one more frame ahead of the display
+            const auto& capabilities = swap_chain_support.capabilities;
+            uint32_t image_count = requested_images == 0 ? capabilities.minImageCount + 1 :
+                std::max(requested_images, capabilities.minImageCount);
             
-            if (swap_chain_support.capabilities.maxImageCount > 0 &&
-                image_count > swap_chain_support.capabilities.maxImageCount)
-                image_count = swap_chain_support.capabilities.maxImageCount;
+            if (capabilities.maxImageCount > 0 && image_count > capabilities.maxImageCount)
+                image_count = capabilities.maxImageCount;
 
             VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
             VkSwapchainCreateInfoKHR info{};
@@ -761,12 +1191,15 @@ namespace Aqua
             info.presentMode = present_mode;
             info.clipped = VK_TRUE;
             info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-            info.oldSwapchain = VK_NULL_HANDLE;
+            info.oldSwapchain = old_swap_chain;
 
             if (vkCreateSwapchainKHR(device.get_device(), &info, nullptr, &swap_chain) != VK_SUCCESS)
+            {
                 AQUA_ERROR("Vulkan Error: failed to create surface swap chain");
+                swap_chain = VK_NULL_HANDLE;
+            }
 
-            return { swap_chain, { surface_format , extent } };
+            return { swap_chain, { surface_format, extent, present_mode } };
         }
 
         std::vector<VkImage> Renderer::create_swap_chain_images(const Device& device, VkSwapchainKHR swap_chain)
@@ -831,35 +1264,17 @@ namespace Aqua
             return shader_module;
         }
 
-        VkPipelineLayout Renderer::create_graphics_pipeline_layout(VkDevice device)
-        {
-            VkPipelineLayout pipeline_layout;
-
-            VkPipelineLayoutCreateInfo layout_info{};
-            layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-            layout_info.setLayoutCount = 1;
-            layout_info.pSetLayouts = &descriptor_set_layout_;
-            layout_info.pushConstantRangeCount = 0;
-            layout_info.pPushConstantRanges = nullptr;
-
-            if (vkCreatePipelineLayout(device, &layout_info, nullptr, &pipeline_layout) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to create pipeline layout");
-
-            return pipeline_layout;
-        }
-
         VkPipeline Renderer::create_graphics_pipeline(
             VkDevice device,
             VkRenderPass render_pass,
             VkPipelineLayout pipeline_layout,
-            const ImageProperties& image)
+            const ImageProperties& image,
+            const GraphicsShaders& shaders)
         {
             VkPipeline pipeline = VK_NULL_HANDLE;
 
-            auto vert_shader_code = create_shader_module(device, compile_shader_from_file(
-                                                        Application::get_assets_path() / "shaders/vertex.vert.glsl"));
-            auto frag_shader_code = create_shader_module(device, compile_shader_from_file(
-                                                        Application::get_assets_path() / "shaders/vertex.frag.glsl"));
+            auto vert_shader_code = create_shader_module(device, shaders.vertex);
+            auto frag_shader_code = create_shader_module(device, shaders.fragment);
 
             VkPipelineShaderStageCreateInfo vert_info{};
             vert_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -883,7 +1298,13 @@ namespace Aqua
             // vertex_input_info.pVertexAttributeDescriptions = nullptr;
             // vertex_input_info.vertexBindingDescriptionCount = 0;
             // vertex_input_info.pVertexBindingDescriptions = nullptr;
-            auto vertex_input_info = Vertex::create_vertex_input_info();
+            // Only the attributes the vertex shader reads are fetched
+            VkPipelineVertexInputStateCreateInfo vertex_input_info{};
+            vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(shaders.vertex_bindings.size());
+            vertex_input_info.pVertexBindingDescriptions = shaders.vertex_bindings.data();
+            vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(shaders.vertex_attributes.size());
+            vertex_input_info.pVertexAttributeDescriptions = shaders.vertex_attributes.data();
 
             VkPipelineInputAssemblyStateCreateInfo input_assembly{};
             input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -993,91 +1414,56 @@ namespace Aqua
             return pipeline;
         }
 
-        VkRenderPass Renderer::create_render_pass(VkDevice device, const ImageProperties& image)
+        std::vector<std::unique_ptr<Image>> Renderer::create_offscreen_images(
+            const Device& device,
+            const ImageProperties& properties,
+            uint32_t count)
         {
-            VkRenderPass render_pass = VK_NULL_HANDLE;
-
-            VkAttachmentDescription color_attachment{};
-            color_attachment.format = image.format.format;
-            color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-            color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-            color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-            VkAttachmentReference color_attachment_ref{};
-            color_attachment_ref.attachment = 0;
-            color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-            
-            VkSubpassDescription subpass{};
-            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            subpass.colorAttachmentCount = 1;
-            subpass.pColorAttachments = &color_attachment_ref;
-
-            VkSubpassDependency dependency{};
-            dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            dependency.dstSubpass = 0;
-            dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.srcAccessMask = 0;
-            dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-            VkRenderPassCreateInfo render_pass_info{};
-            render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-            render_pass_info.attachmentCount = 1;
-            render_pass_info.pAttachments = &color_attachment;
-            render_pass_info.subpassCount = 1;
-            render_pass_info.pSubpasses = &subpass;
-
-            render_pass_info.dependencyCount = 1;
-            render_pass_info.pDependencies = &dependency;
-
-            if (vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass))
-                AQUA_ERROR("Vulkan Error: failed to create render pass");
-
-            return render_pass;
+            VkImageCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            info.imageType = VK_IMAGE_TYPE_2D;
+            info.format = properties.format.format;
+            info.extent = { properties.extent.width, properties.extent.height, 1 };
+            info.mipLevels = 1;
+            info.arrayLayers = 1;
+            info.samples = VK_SAMPLE_COUNT_1_BIT;
+            info.tiling = VK_IMAGE_TILING_OPTIMAL;
+            info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            std::vector<std::unique_ptr<Image>> images(count);
+            for (auto& image : images)
+                image = std::make_unique<Image>(device.create_image(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+            return images;
         }
 
-        std::vector<VkFramebuffer> Renderer::create_framebuffers(
-                const Device& device,
-                VkRenderPass render_pass,
-                const std::vector<VkImageView>& image_views,
-                const ImageProperties& properties)
+        bool Renderer::build_frame_graph()
         {
-            std::vector<VkFramebuffer> framebuffers(image_views.size(), VK_NULL_HANDLE);
-
-            VkFramebufferCreateInfo framebuffer_info{};
-            framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebuffer_info.renderPass = render_pass;
-            framebuffer_info.width = properties.extent.width;
-            framebuffer_info.height = properties.extent.height;
-            framebuffer_info.layers = 1;
-
-            for (size_t i = 0; i < image_views.size(); ++i)
-            {
-                VkImageView attachments[] = {
-                    image_views[i]
-                };
-
-                framebuffer_info.attachmentCount = 1;
-                framebuffer_info.pAttachments = attachments;
-
-                if (vkCreateFramebuffer(device.get_device(), &framebuffer_info, nullptr, &framebuffers[i]) != VK_SUCCESS)
-                    AQUA_ERROR("Vulkan Error: failed to create framebuffer");
-            }
-
-            return framebuffers;
+            // Frame slots and swap chain images are written in order on one queue, so the previous frame's
+            // attachment writes only have to finish before the layout transition. Swap chain images wait on the
+            // acquire semaphore at that stage
+            RenderGraph::ImportDesc backbuffer{};
+            backbuffer.format = image_properties_.format.format;
+            backbuffer.extent = image_properties_.extent;
+            backbuffer.initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            backbuffer.initial_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            backbuffer.initial_access = VK_ACCESS_2_NONE;
+            backbuffer.final_layout = headless_ ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            frame_graph_ = std::make_unique<RenderGraph>(*device_);
+            backbuffer_ = frame_graph_->import_image("backbuffer", backbuffer);
+            scene_pass_ = frame_graph_->add_pass("scene",
+                [this](RenderGraph::PassBuilder& pass) {
+                    pass.color_attachment(backbuffer_, VkClearColorValue{ { 0.f, 0.f, 0.f, 0.f } });
+                },
+                [this](VkCommandBuffer buffer) { record_scene(buffer); });
+
+            return frame_graph_->compile();
         }
 
-        void Renderer::record_command_buffer(
-            VkCommandBuffer buffer, 
-            VkPipeline graphics_pipeline,
-            VkRenderPass render_pass,
-            const std::vector<VkFramebuffer>& framebuffers,
-            uint32_t image_index,
-            ImageProperties properties)
+        void Renderer::record_command_buffer(VkCommandBuffer buffer, uint32_t image_index) const
         {
             VkCommandBufferBeginInfo begin_info{};
             begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1089,50 +1475,64 @@ namespace Aqua
                 return;
             }
 
-            VkRenderPassBeginInfo render_pass_info{};
-            render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            render_pass_info.framebuffer = framebuffers[image_index];
-            render_pass_info.renderArea.extent = properties.extent;
-            render_pass_info.renderArea.offset = { 0 , 0 };
-            render_pass_info.renderPass = render_pass;
+            if (timestamp_pool_ != VK_NULL_HANDLE)
+            {
+                vkCmdResetQueryPool(buffer, timestamp_pool_, 2 * current_frame_, 2);
+                vkCmdWriteTimestamp(buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_pool_, 2 * current_frame_);
+            }
 
-            VkClearValue clear_color{{{0.f, 0.f, 0.f, 0.f}}};
-            render_pass_info.pClearValues = &clear_color;
-            render_pass_info.clearValueCount = 1;
+            if (headless_)
+                frame_graph_->bind_image(backbuffer_, offscreen_images_[image_index]->get_image(),
+                    offscreen_images_[image_index]->get_view());
+            else
+                frame_graph_->bind_image(backbuffer_, swap_chain_images_[image_index], swap_chain_image_views_[image_index]);
 
-            vkCmdBeginRenderPass(buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-            {
-                vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+            frame_graph_->execute(buffer);
 
-                VkViewport viewport{};
-                viewport.x = 0.f;
-                viewport.y = 0.f;
-                viewport.width = properties.extent.width;
-                viewport.height = properties.extent.height;
-                viewport.minDepth = 0.f;
-                viewport.maxDepth = 1.f;
+            if (timestamp_pool_ != VK_NULL_HANDLE)
+                vkCmdWriteTimestamp(buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_pool_, 2 * current_frame_ + 1);
 
-                VkRect2D scissor{};
-                scissor.offset = { 0 , 0 };
-                scissor.extent = properties.extent;
+            if (vkEndCommandBuffer(buffer) != VK_SUCCESS)
+                AQUA_ERROR("Vulkan Error: failed to record command buffer");
+        }
 
-                vkCmdSetViewport(buffer, 0, 1, &viewport);
-                vkCmdSetScissor(buffer, 0, 1, &scissor);
+        void Renderer::record_scene(VkCommandBuffer buffer) const
+        {
+            vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline_);
 
-                // bind_vertex_buffer(*main_vertex_buffer, buffer);
-                // vkCmdDraw(buffer, main_vertex_buffer->get_vertex_count(), 1, 0, 0);            
+            VkViewport viewport{};
+            viewport.x = 0.f;
+            viewport.y = 0.f;
+            viewport.width = image_properties_.extent.width;
+            viewport.height = image_properties_.extent.height;
+            viewport.minDepth = 0.f;
+            viewport.maxDepth = 1.f;
 
-                main_vertex_buffer->bind_buffer(buffer);
-                main_index_buffer->bind_buffer(buffer);
-                vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, 0, 1,
-                    &descriptor_sets_[current_frame_], 0, nullptr);
+            VkRect2D scissor{};
+            scissor.offset = { 0 , 0 };
+            scissor.extent = image_properties_.extent;
 
-                vkCmdDrawIndexed(buffer, main_index_buffer->get_index_count(), 1, 0, 0, 0);
-            }
-            vkCmdEndRenderPass(buffer);
+            vkCmdSetViewport(buffer, 0, 1, &viewport);
+            vkCmdSetScissor(buffer, 0, 1, &scissor);
 
-            if (vkEndCommandBuffer(buffer) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to record command buffer");
+            scene_mesh_->bind_buffers(buffer);
+
+            const VkDescriptorSet texture_set = texture_table_->get_set();
+            vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, texture_table_set, 1,
+                &texture_set, 0, nullptr);
+
+            // One draw per quad, uniform sets are only rebound when the quad uses a different one. The quad's
+            // transform and texture table index are pushed with the draw
+            const VkDescriptorSet* frame_sets = descriptor_sets_.data() + current_frame_ * sets_per_frame_;
+            for (uint32_t quad = 0; quad < scene_.quad_count; ++quad)
+            {
+                if (quad == 0 || sets_per_frame_ > 1)
+                    vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, scene_set, 1,
+                        &frame_sets[quad % sets_per_frame_], 0, nullptr);
+
+                draw_constants_.push(buffer, { scene_transforms_[quad], scene_texture_indices_[quad % scene_.texture_count] });
+                scene_mesh_->draw(buffer);
+            }
         }
 
         void Renderer::bind_vertex_buffer(const VertexBuffer& vertex_buffer, VkCommandBuffer command_buffer)
@@ -1156,60 +1556,13 @@ namespace Aqua
             return semaphore;
         }
 
-        VkFence Renderer::create_fence(VkDevice device)
-        {
-            VkFence fence = VK_NULL_HANDLE;
-
-            VkFenceCreateInfo info{};
-            info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-            if (vkCreateFence(device, &info, nullptr, &fence) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to create fence");
-
-            return fence;
-        }
-
-        VkDescriptorSetLayout Renderer::create_descriptor_set_layout(VkDevice device)
+        std::vector<VkSemaphore> Renderer::create_semaphores(VkDevice device, size_t count)
         {
-            VkDescriptorSetLayout layout = VK_NULL_HANDLE;
-
-            VkDescriptorSetLayoutBinding ubo_layout_binding{};
-            ubo_layout_binding.binding = 0;
-            ubo_layout_binding.descriptorCount = 1;
-            ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-            ubo_layout_binding.pImmutableSamplers = nullptr;
-
-            VkDescriptorSetLayoutCreateInfo descriptor_info{};
-            descriptor_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            descriptor_info.bindingCount = 1;
-            descriptor_info.pBindings = &ubo_layout_binding;
-
-            if (vkCreateDescriptorSetLayout(device, &descriptor_info, nullptr, &layout) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to create descriptor set");
-
-            return layout;
-        }
-
-        VkDescriptorPool Renderer::create_descriptor_pool(VkDevice device)
-        {
-            VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
-
-            VkDescriptorPoolSize pool_size{};
-            pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            pool_size.descriptorCount = static_cast<uint32_t>(max_frames_in_flight);
-
-            VkDescriptorPoolCreateInfo info{};
-            info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            info.poolSizeCount = 1;
-            info.pPoolSizes = &pool_size;
-            info.maxSets = static_cast<uint32_t>(max_frames_in_flight);
-
-            if (vkCreateDescriptorPool(device, &info, nullptr, &descriptor_pool) != VK_SUCCESS)
-                AQUA_ERROR("Vulkan Error: failed to create descriptor pool");
+            std::vector<VkSemaphore> semaphores(count);
+            for (auto& semaphore : semaphores)
+                semaphore = create_semaphore(device);
 
-            return descriptor_pool;
+            return semaphores;
         }
     }
 }
\ No newline at end of file
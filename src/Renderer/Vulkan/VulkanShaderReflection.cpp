@@ -0,0 +1,633 @@
+#include "Renderer/Vulkan/VulkanShaderReflection.h"
+#include "Renderer/Vulkan/VulkanDevice.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        // The subset of the SPIR-V grammar reflection needs
+        namespace spirv
+        {
+            constexpr uint32_t magic = 0x07230203;
+            constexpr size_t header_words = 5;
+
+            enum Op : uint32_t
+            {
+                OpEntryPoint = 15,
+                OpTypeBool = 20,
+                OpTypeInt = 21,
+                OpTypeFloat = 22,
+                OpTypeVector = 23,
+                OpTypeMatrix = 24,
+                OpTypeImage = 25,
+                OpTypeSampler = 26,
+                OpTypeSampledImage = 27,
+                OpTypeArray = 28,
+                OpTypeRuntimeArray = 29,
+                OpTypeStruct = 30,
+                OpTypePointer = 32,
+                OpConstant = 43,
+                OpSpecConstant = 50,
+                OpVariable = 59,
+                OpDecorate = 71,
+                OpMemberDecorate = 72
+            };
+
+            enum Decoration : uint32_t
+            {
+                Block = 2,
+                BufferBlock = 3,
+                ArrayStride = 6,
+                MatrixStride = 7,
+                BuiltIn = 11,
+                Location = 30,
+                Binding = 33,
+                DescriptorSet = 34,
+                Offset = 35
+            };
+
+            enum StorageClass : uint32_t
+            {
+                UniformConstant = 0,
+                Input = 1,
+                Uniform = 2,
+                PushConstant = 9,
+                StorageBuffer = 12
+            };
+
+            enum ImageDim : uint32_t
+            {
+                DimBuffer = 5,
+                DimSubpassData = 6
+            };
+        }
+
+        namespace
+        {
+            constexpr uint32_t not_set = ~0u;
+
+            struct Id
+            {
+                uint32_t opcode = 0;
+                // Operands after the result id, or after the opcode for instructions without one
+                std::span<const uint32_t> operands;
+
+                uint32_t set = not_set;
+                uint32_t binding = not_set;
+                uint32_t location = not_set;
+                uint32_t array_stride = 0;
+                bool builtin = false;
+                bool buffer_block = false;
+
+                std::vector<uint32_t> member_offsets;
+                std::vector<uint32_t> member_matrix_strides;
+                bool member_builtin = false;
+            };
+
+            class Module
+            {
+            public:
+                explicit Module(std::span<const uint32_t> words) : words_{ words } {}
+
+                bool parse()
+                {
+                    if (words_.size() < spirv::header_words || words_[0] != spirv::magic)
+                        return false;
+
+                    ids_.resize(words_[3]);
+
+                    for (size_t offset = spirv::header_words; offset < words_.size();)
+                    {
+                        const uint32_t word_count = words_[offset] >> 16;
+                        const uint32_t opcode = words_[offset] & 0xffff;
+                        if (word_count == 0 || offset + word_count > words_.size())
+                            return false;
+
+                        if (!parse_instruction(opcode, words_.subspan(offset + 1, word_count - 1)))
+                            return false;
+
+                        offset += word_count;
+                    }
+
+                    return true;
+                }
+
+                const Id& operator[](uint32_t id) const { return ids_[id]; }
+
+                const std::vector<uint32_t>& variables() const noexcept { return variables_; }
+                uint32_t get_execution_model() const noexcept { return execution_model_; }
+                const std::vector<uint32_t>& get_interface() const noexcept { return interface_; }
+
+                // Strips array layers, multiplying their lengths into count (0 once a runtime array is seen)
+                uint32_t strip_arrays(uint32_t type, uint32_t& count) const
+                {
+                    while (ids_[type].opcode == spirv::OpTypeArray || ids_[type].opcode == spirv::OpTypeRuntimeArray)
+                    {
+                        const auto& array = ids_[type];
+                        if (array.opcode == spirv::OpTypeRuntimeArray)
+                            count = 0;
+                        else
+                            count *= get_constant(array.operands[1]);
+                        type = array.operands[0];
+                    }
+                    return type;
+                }
+
+                uint32_t get_constant(uint32_t id) const
+                {
+                    const auto& constant = ids_[id];
+                    if ((constant.opcode != spirv::OpConstant && constant.opcode != spirv::OpSpecConstant) ||
+                        constant.operands.empty())
+                        return 1;
+                    return constant.operands[0];
+                }
+
+                // Bytes spanned by a type inside a block, following its explicit layout decorations
+                uint32_t get_size(uint32_t type, uint32_t matrix_stride = 0) const
+                {
+                    const auto& id = ids_[type];
+                    switch (id.opcode)
+                    {
+                    case spirv::OpTypeBool: return 4;
+                    case spirv::OpTypeInt:
+                    case spirv::OpTypeFloat: return id.operands[0] / 8;
+                    case spirv::OpTypeVector: return id.operands[1] * get_size(id.operands[0]);
+                    case spirv::OpTypeMatrix:
+                    {
+                        const uint32_t column_size = get_size(id.operands[0]);
+                        const uint32_t stride = matrix_stride != 0 ? matrix_stride : column_size;
+                        return (id.operands[1] - 1) * stride + column_size;
+                    }
+                    case spirv::OpTypeArray:
+                    {
+                        const uint32_t length = get_constant(id.operands[1]);
+                        const uint32_t stride = id.array_stride != 0 ? id.array_stride : get_size(id.operands[0], matrix_stride);
+                        return length * stride;
+                    }
+                    case spirv::OpTypeStruct:
+                    {
+                        uint32_t size = 0;
+                        for (size_t member = 0; member < id.operands.size(); ++member)
+                        {
+                            const uint32_t offset = member < id.member_offsets.size() ? id.member_offsets[member] : size;
+                            const uint32_t stride = member < id.member_matrix_strides.size() ? id.member_matrix_strides[member] : 0;
+                            size = std::max(size, offset + get_size(id.operands[member], stride));
+                        }
+                        return size;
+                    }
+                    default: return 0;
+                    }
+                }
+
+            private:
+                std::span<const uint32_t> words_;
+                std::vector<Id> ids_;
+                std::vector<uint32_t> variables_;
+                std::vector<uint32_t> interface_;
+                uint32_t execution_model_ = not_set;
+
+                bool valid_id(uint32_t id) const noexcept { return id < ids_.size(); }
+                // Types and constants are declared before they are used, only pointers may name a later type
+                bool defined_id(uint32_t id) const noexcept { return valid_id(id) && ids_[id].opcode != 0; }
+
+                // Checks the operands reflection reads and every id it follows from them, so a malformed module
+                // fails to parse instead of indexing past the id table or looping through its own types
+                bool valid_operands(uint32_t opcode, std::span<const uint32_t> operands) const
+                {
+                    switch (opcode)
+                    {
+                    case spirv::OpTypeBool:
+                    case spirv::OpTypeSampler:
+                        return true;
+                    case spirv::OpTypeInt:
+                        return operands.size() >= 2;
+                    case spirv::OpTypeFloat:
+                        return operands.size() >= 1;
+                    case spirv::OpTypeVector:
+                    case spirv::OpTypeMatrix:
+                        return operands.size() >= 2 && defined_id(operands[0]);
+                    case spirv::OpTypeImage:
+                        // Sampled type, dim, depth, arrayed, multisampled, sampled
+                        return operands.size() >= 6 && defined_id(operands[0]);
+                    case spirv::OpTypeSampledImage:
+                    case spirv::OpTypeRuntimeArray:
+                        return operands.size() >= 1 && defined_id(operands[0]);
+                    case spirv::OpTypeArray:
+                        return operands.size() >= 2 && defined_id(operands[0]) && defined_id(operands[1]);
+                    case spirv::OpTypeStruct:
+                        return std::all_of(operands.begin(), operands.end(), [this](uint32_t member) { return defined_id(member); });
+                    case spirv::OpTypePointer:
+                        return operands.size() >= 2 && valid_id(operands[1]);
+                    default:
+                        return true;
+                    }
+                }
+
+                static void set_member(std::vector<uint32_t>& values, uint32_t member, uint32_t value)
+                {
+                    if (values.size() <= member)
+                        values.resize(member + 1, 0);
+                    values[member] = value;
+                }
+
+                bool parse_instruction(uint32_t opcode, std::span<const uint32_t> operands)
+                {
+                    switch (opcode)
+                    {
+                    case spirv::OpEntryPoint:
+                    {
+                        // Execution model, function id, literal name, then the interface ids
+                        if (operands.size() < 3 || execution_model_ != not_set)
+                            return true;
+
+                        execution_model_ = operands[0];
+                        size_t word = 2;
+                        while (word < operands.size() && (operands[word] >> 24) != 0)
+                            ++word;
+                        interface_.assign(operands.begin() + std::min(word + 1, operands.size()), operands.end());
+                        return true;
+                    }
+                    case spirv::OpDecorate:
+                    {
+                        if (operands.size() < 2 || !valid_id(operands[0]))
+                            return false;
+
+                        auto& target = ids_[operands[0]];
+                        const uint32_t value = operands.size() > 2 ? operands[2] : 0;
+                        switch (operands[1])
+                        {
+                        case spirv::DescriptorSet: target.set = value; break;
+                        case spirv::Binding: target.binding = value; break;
+                        case spirv::Location: target.location = value; break;
+                        case spirv::ArrayStride: target.array_stride = value; break;
+                        case spirv::BuiltIn: target.builtin = true; break;
+                        case spirv::BufferBlock: target.buffer_block = true; break;
+                        default: break;
+                        }
+                        return true;
+                    }
+                    case spirv::OpMemberDecorate:
+                    {
+                        if (operands.size() < 3 || !valid_id(operands[0]))
+                            return false;
+
+                        auto& target = ids_[operands[0]];
+                        const uint32_t member = operands[1];
+                        const uint32_t value = operands.size() > 3 ? operands[3] : 0;
+                        switch (operands[2])
+                        {
+                        case spirv::Offset: set_member(target.member_offsets, member, value); break;
+                        case spirv::MatrixStride: set_member(target.member_matrix_strides, member, value); break;
+                        case spirv::BuiltIn: target.member_builtin = true; break;
+                        default: break;
+                        }
+                        return true;
+                    }
+                    case spirv::OpTypeBool:
+                    case spirv::OpTypeInt:
+                    case spirv::OpTypeFloat:
+                    case spirv::OpTypeVector:
+                    case spirv::OpTypeMatrix:
+                    case spirv::OpTypeImage:
+                    case spirv::OpTypeSampler:
+                    case spirv::OpTypeSampledImage:
+                    case spirv::OpTypeArray:
+                    case spirv::OpTypeRuntimeArray:
+                    case spirv::OpTypeStruct:
+                    case spirv::OpTypePointer:
+                    {
+                        // Result id first, each id is defined once
+                        if (operands.empty() || !valid_id(operands[0]) || ids_[operands[0]].opcode != 0 ||
+                            !valid_operands(opcode, operands.subspan(1)))
+                            return false;
+
+                        auto& id = ids_[operands[0]];
+                        id.opcode = opcode;
+                        id.operands = operands.subspan(1);
+                        return true;
+                    }
+                    case spirv::OpConstant:
+                    case spirv::OpSpecConstant:
+                    case spirv::OpVariable:
+                    {
+                        // Result type, then result id. Variables also need their storage class
+                        if (operands.size() < 2 || !defined_id(operands[0]) || !valid_id(operands[1]) ||
+                            ids_[operands[1]].opcode != 0 || (opcode == spirv::OpVariable && operands.size() < 3))
+                            return false;
+
+                        auto& id = ids_[operands[1]];
+                        id.opcode = opcode;
+                        id.operands = operands.subspan(2);
+                        if (opcode == spirv::OpVariable)
+                        {
+                            // Keep the pointer type reachable, the storage class is the first operand
+                            id.operands = operands;
+                            variables_.push_back(operands[1]);
+                        }
+                        return true;
+                    }
+                    default:
+                        return true;
+                    }
+                }
+            };
+
+            std::optional<VkShaderStageFlagBits> to_stage(uint32_t execution_model)
+            {
+                switch (execution_model)
+                {
+                case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+                case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+                case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+                case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+                default: return std::nullopt;
+                }
+            }
+
+            VkDescriptorType to_descriptor_type(const Module& module, uint32_t storage_class, uint32_t type)
+            {
+                const auto& id = module[type];
+                switch (storage_class)
+                {
+                case spirv::StorageBuffer:
+                    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                case spirv::Uniform:
+                    // Old style storage buffers are Uniform blocks decorated BufferBlock
+                    return id.buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                case spirv::UniformConstant:
+                    switch (id.opcode)
+                    {
+                    case spirv::OpTypeSampledImage: return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    case spirv::OpTypeSampler: return VK_DESCRIPTOR_TYPE_SAMPLER;
+                    case spirv::OpTypeImage:
+                    {
+                        // Sampled type, dim, depth, arrayed, multisampled, sampled
+                        const uint32_t dim = id.operands[1];
+                        const bool storage = id.operands[5] == 2;
+                        if (dim == spirv::DimBuffer)
+                            return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                        if (dim == spirv::DimSubpassData)
+                            return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                        return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                    }
+                    default: return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+                    }
+                default:
+                    return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+                }
+            }
+
+            VkFormat to_vertex_format(const Module& module, uint32_t type)
+            {
+                const auto* id = &module[type];
+                uint32_t components = 1;
+                if (id->opcode == spirv::OpTypeVector)
+                {
+                    components = id->operands[1];
+                    id = &module[id->operands[0]];
+                }
+
+                if (components < 1 || components > 4)
+                    return VK_FORMAT_UNDEFINED;
+
+                static constexpr VkFormat float_formats[] = {
+                    VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+                };
+                static constexpr VkFormat double_formats[] = {
+                    VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT
+                };
+                static constexpr VkFormat sint_formats[] = {
+                    VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT
+                };
+                static constexpr VkFormat uint_formats[] = {
+                    VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT
+                };
+
+                if (id->opcode == spirv::OpTypeFloat)
+                    return id->operands[0] == 64 ? double_formats[components - 1] : float_formats[components - 1];
+                if (id->opcode == spirv::OpTypeInt)
+                    return id->operands[1] != 0 ? sint_formats[components - 1] : uint_formats[components - 1];
+
+                return VK_FORMAT_UNDEFINED;
+            }
+        }
+
+        std::optional<ShaderReflection> reflect_shader(std::span<const uint32_t> code)
+        {
+            Module module{ code };
+            if (!module.parse())
+            {
+                AQUA_ERROR("Vulkan Error: shader module is not valid SPIR-V");
+                return std::nullopt;
+            }
+
+            auto stage = to_stage(module.get_execution_model());
+            if (!stage.has_value())
+            {
+                AQUA_ERROR("Vulkan Error: shader module has no supported entry point");
+                return std::nullopt;
+            }
+
+            ShaderReflection reflection{};
+            reflection.stage = *stage;
+
+            const auto& interface = module.get_interface();
+            for (uint32_t variable_id : module.variables())
+            {
+                const auto& variable = module[variable_id];
+                const uint32_t storage_class = variable.operands[2];
+                const auto& pointer = module[variable.operands[0]];
+                if (pointer.opcode != spirv::OpTypePointer)
+                    continue;
+
+                uint32_t count = 1;
+                const uint32_t type = module.strip_arrays(pointer.operands[1], count);
+
+                switch (storage_class)
+                {
+                case spirv::UniformConstant:
+                case spirv::Uniform:
+                case spirv::StorageBuffer:
+                {
+                    if (variable.binding == not_set)
+                        continue;
+
+                    ShaderBinding binding{};
+                    binding.set = variable.set == not_set ? 0 : variable.set;
+                    binding.binding = variable.binding;
+                    binding.type = to_descriptor_type(module, storage_class, type);
+                    binding.count = count;
+                    binding.stages = reflection.stage;
+
+                    if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+                    {
+                        AQUA_WARN("Vulkan Warning: skipped a shader binding of an unsupported descriptor type");
+                        continue;
+                    }
+                    reflection.bindings.push_back(binding);
+                    break;
+                }
+                case spirv::PushConstant:
+                {
+                    // GLSL allows one push constant block per stage, ranges start at its first member
+                    const auto& block = module[type];
+                    const uint32_t offset = block.member_offsets.empty() ? 0 :
+                        *std::min_element(block.member_offsets.begin(), block.member_offsets.end());
+                    const uint32_t size = module.get_size(type);
+                    reflection.push_constants = VkPushConstantRange{ static_cast<VkShaderStageFlags>(reflection.stage), offset, size - offset };
+                    break;
+                }
+                case spirv::Input:
+                {
+                    if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || variable.builtin || module[type].member_builtin)
+                        continue;
+                    // SPIR-V 1.4 lists every global in the entry point, earlier versions only the inputs and outputs
+                    if (std::find(interface.begin(), interface.end(), variable_id) == interface.end())
+                        continue;
+
+                    const VkFormat format = to_vertex_format(module, type);
+                    if (variable.location == not_set || format == VK_FORMAT_UNDEFINED || count != 1)
+                    {
+                        AQUA_WARN("Vulkan Warning: skipped a vertex input that is not a scalar or vector");
+                        continue;
+                    }
+                    reflection.vertex_inputs.push_back({ variable.location, format });
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+
+            std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b) {
+                return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+            });
+            std::sort(reflection.vertex_inputs.begin(), reflection.vertex_inputs.end(), [](const ShaderVertexInput& a, const ShaderVertexInput& b) {
+                return a.location < b.location;
+            });
+
+            return reflection;
+        }
+
+        std::optional<ProgramReflection> reflect_program(std::span<const ShaderReflection> stages)
+        {
+            ProgramReflection program{};
+
+            for (const auto& stage : stages)
+            {
+                for (const auto& binding : stage.bindings)
+                {
+                    auto found = std::find_if(program.bindings.begin(), program.bindings.end(), [&binding](const ShaderBinding& other) {
+                        return other.set == binding.set && other.binding == binding.binding;
+                    });
+
+                    if (found == program.bindings.end())
+                    {
+                        program.bindings.push_back(binding);
+                        continue;
+                    }
+
+                    if (found->type != binding.type || found->count != binding.count)
+                    {
+                        AQUA_ERROR("Vulkan Error: shader stages disagree on the type of set " + std::to_string(binding.set) +
+                            " binding " + std::to_string(binding.binding));
+                        return std::nullopt;
+                    }
+                    found->stages |= binding.stages;
+                }
+
+                if (stage.push_constants.has_value())
+                {
+                    const auto& range = *stage.push_constants;
+                    auto found = std::find_if(program.push_constants.begin(), program.push_constants.end(), [&range](const VkPushConstantRange& other) {
+                        return other.offset == range.offset && other.size == range.size;
+                    });
+
+                    if (found != program.push_constants.end())
+                        found->stageFlags |= range.stageFlags;
+                    else
+                        program.push_constants.push_back(range);
+                }
+
+                if (stage.stage == VK_SHADER_STAGE_VERTEX_BIT)
+                    program.vertex_inputs = stage.vertex_inputs;
+            }
+
+            std::sort(program.bindings.begin(), program.bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b) {
+                return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+            });
+            program.set_count = program.bindings.empty() ? 0 : program.bindings.back().set + 1;
+
+            return program;
+        }
+
+        ReflectedLayout create_reflected_layout(const Device& device,
+                                                const ProgramReflection& program,
+                                                std::span<const FixedSetLayout> fixed_sets)
+        {
+            uint32_t set_count = program.set_count;
+            for (const auto& fixed : fixed_sets)
+                set_count = std::max(set_count, fixed.set + 1);
+
+            ReflectedLayout layout{};
+            layout.set_layouts.resize(set_count, VK_NULL_HANDLE);
+
+            for (const auto& fixed : fixed_sets)
+                layout.set_layouts[fixed.set] = fixed.layout;
+
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            auto next = program.bindings.begin();
+            for (uint32_t set = 0; set < set_count; ++set)
+            {
+                bindings.clear();
+                for (; next != program.bindings.end() && next->set == set; ++next)
+                {
+                    VkDescriptorSetLayoutBinding binding{};
+                    binding.binding = next->binding;
+                    binding.descriptorType = next->type;
+                    binding.descriptorCount = next->count;
+                    binding.stageFlags = next->stages;
+                    bindings.push_back(binding);
+
+                    if (next->count == 0 && layout.set_layouts[set] == VK_NULL_HANDLE)
+                        AQUA_WARN("Vulkan Warning: runtime sized descriptor arrays need a fixed set layout");
+                }
+
+                if (layout.set_layouts[set] == VK_NULL_HANDLE)
+                    layout.set_layouts[set] = device.get_layout_cache().get(bindings);
+            }
+
+            layout.pipeline_layout = device.get_pipeline_layout_cache().get(layout.set_layouts, program.push_constants);
+            return layout;
+        }
+
+        std::vector<VkVertexInputAttributeDescription> match_vertex_inputs(
+            std::span<const ShaderVertexInput> inputs,
+            std::span<const VkVertexInputAttributeDescription> available)
+        {
+            std::vector<VkVertexInputAttributeDescription> attributes;
+            attributes.reserve(inputs.size());
+
+            for (const auto& input : inputs)
+            {
+                auto found = std::find_if(available.begin(), available.end(), [&input](const VkVertexInputAttributeDescription& attribute) {
+                    return attribute.location == input.location;
+                });
+
+                if (found == available.end())
+                {
+                    AQUA_WARN("Vulkan Warning: no vertex attribute for shader input location " + std::to_string(input.location));
+                    continue;
+                }
+                attributes.push_back(*found);
+            }
+
+            return attributes;
+        }
+    }
+}
@@ -1,8 +1,12 @@
 #include "Renderer/Vulkan/VulkanTexture.h"
+#include "Renderer/Vulkan/VulkanBarriers.h"
 
 #include <stb/stb_image.h>
 // #include "Renderer/Vulkan/"
 
+#include <string>
+#include <vector>
+
 namespace Aqua
 {
     namespace Vulkan
@@ -10,11 +14,92 @@ namespace Aqua
         Texture::Texture(const Device& device, const std::filesystem::path& filepath)
         {
             int width = 0, height = 0, channels = 0;
-            const uint32_t image_channels = 4;
             
             auto file = filepath.string();
             stbi_uc* image_data = stbi_load(file.c_str(), &width, &height, &channels, image_channels);
-            VkDeviceSize image_size = width * height * image_channels;
+            if (image_data == nullptr)
+            {
+                AQUA_ERROR("Vulkan Error: failed to load texture " + file);
+                return;
+            }
+
+            const uint8_t* layers[] = { image_data };
+            create_texture(device, layers, width, height);
+
+            stbi_image_free(image_data);
+        }
+
+        Texture::Texture(const Device& device, std::span<const uint8_t> encoded_image)
+        {
+            int width = 0, height = 0, channels = 0;
+
+            stbi_uc* image_data = stbi_load_from_memory(encoded_image.data(), static_cast<int>(encoded_image.size()),
+                                                        &width, &height, &channels, image_channels);
+            if (image_data == nullptr)
+            {
+                AQUA_ERROR("Vulkan Error: failed to decode texture from memory");
+                return;
+            }
+
+            const uint8_t* layers[] = { image_data };
+            create_texture(device, layers, width, height);
+
+            stbi_image_free(image_data);
+        }
+
+        Texture::Texture(const Device& device, std::span<const std::filesystem::path> layer_filepaths)
+        {
+            if (layer_filepaths.empty())
+            {
+                AQUA_ERROR("Vulkan Error: texture array has no layers");
+                return;
+            }
+
+            std::vector<const uint8_t*> layers;
+            layers.reserve(layer_filepaths.size());
+
+            int width = 0, height = 0;
+            bool failed = false;
+            for (const auto& filepath : layer_filepaths)
+            {
+                int layer_width = 0, layer_height = 0, channels = 0;
+
+                auto file = filepath.string();
+                stbi_uc* image_data = stbi_load(file.c_str(), &layer_width, &layer_height, &channels, image_channels);
+                if (image_data == nullptr)
+                {
+                    AQUA_ERROR("Vulkan Error: failed to load texture " + file);
+                    failed = true;
+                    break;
+                }
+
+                // Freed with the other layers below, a mismatched layer is never read
+                layers.push_back(image_data);
+                if (layers.size() == 1)
+                {
+                    width = layer_width;
+                    height = layer_height;
+                }
+                else if (layer_width != width || layer_height != height)
+                {
+                    AQUA_ERROR("Vulkan Error: texture array layer " + file + " is " + std::to_string(layer_width) + "x" +
+                        std::to_string(layer_height) + ", the first layer is " + std::to_string(width) + "x" + std::to_string(height));
+                    failed = true;
+                    break;
+                }
+            }
+
+            if (!failed)
+                create_texture(device, layers, width, height);
+
+            for (const auto* image_data : layers)
+                stbi_image_free(const_cast<uint8_t*>(image_data));
+        }
+
+        void Texture::create_texture(const Device& device, std::span<const uint8_t* const> layers, int width, int height)
+        {
+            const VkDeviceSize layer_size = static_cast<VkDeviceSize>(width) * height * image_channels;
+            const VkDeviceSize image_size = layer_size * layers.size();
 
             VkImageCreateInfo info{};
             info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -23,7 +108,7 @@ namespace Aqua
                            .height = static_cast<uint32_t>(height),
                            .depth  = 1};
             info.mipLevels = 1;
-            info.arrayLayers = 1;
+            info.arrayLayers = static_cast<uint32_t>(layers.size());
             info.format = VK_FORMAT_R8G8B8A8_SRGB;
             info.tiling = VK_IMAGE_TILING_OPTIMAL;
             info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -39,17 +124,29 @@ namespace Aqua
                                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                                                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-            if (!stage_buffer.write_data(image_data, image_size))
+            // Layers are tightly packed one after the other, which is what a single copy of all layers reads
+            for (size_t layer = 0; layer < layers.size(); ++layer)
             {
-                AQUA_ERROR("Vulkan Error: failed to store data");
-                return;
+                if (!stage_buffer.write_data(layers[layer], layer_size, layer * layer_size))
+                {
+                    AQUA_ERROR("Vulkan Error: failed to store data");
+                    return;
+                }
             }
 
-            Image::transition_image_layout(device, image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-            Image::copy_from_buffer(device, stage_buffer, image_);
-            Image::transition_image_layout(device, image_, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // Every layer moves through the upload together, one submission and two barriers in total
+            BarrierBatcher barriers{ device };
+            device.submit_one_time_commands(
+                [&](VkCommandBuffer command_buffer)
+                {
+                    barriers.transition(image_, get_layout_state(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL), true);
+                    barriers.flush(command_buffer);
 
-            stbi_image_free(image_data);
+                    Image::record_copy_from_buffer(command_buffer, stage_buffer, image_);
+
+                    barriers.transition(image_, get_layout_state(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+                    barriers.flush(command_buffer);
+                });
 
             VkSamplerCreateInfo sampler_info{};
             sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -77,7 +174,10 @@ namespace Aqua
 
         Texture::~Texture()
         {
-            vkDestroySampler(image_.get_device(), sampler_, nullptr);
+            if (sampler_ != VK_NULL_HANDLE && image_.owner_ != nullptr)
+                image_.owner_->defer_destruction([device = image_.get_device(), sampler = sampler_]() {
+                    vkDestroySampler(device, sampler, nullptr);
+                });
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "Renderer/Vulkan/VulkanTextureTable.h"
+
+#include <algorithm>
+
+namespace Aqua
+{
+    namespace Vulkan
+    {
+        static constexpr VkDescriptorBindingFlags texture_binding_flags =
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+        TextureTable::TextureTable(const Device& device, uint32_t capacity)
+            : device_{ &device }
+        {
+            auto logical_device = device.get_device();
+            capacity_ = std::min(std::max(capacity, 1u), get_max_capacity(device.get_physical_device()));
+
+            VkDescriptorSetLayoutBinding binding{};
+            binding.binding = 0;
+            binding.descriptorCount = capacity_;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+            binding.pImmutableSamplers = nullptr;
+
+            layout_ = device.get_layout_cache().get({ &binding, 1 },
+                VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, { &texture_binding_flags, 1 });
+            if (layout_ == VK_NULL_HANDLE)
+            {
+                capacity_ = 0;
+                return;
+            }
+
+            VkDescriptorPoolSize pool_size{};
+            pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            pool_size.descriptorCount = capacity_;
+
+            VkDescriptorPoolCreateInfo pool_info{};
+            pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            pool_info.poolSizeCount = 1;
+            pool_info.pPoolSizes = &pool_size;
+            pool_info.maxSets = 1;
+
+            if (vkCreateDescriptorPool(logical_device, &pool_info, nullptr, &pool_) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to create texture table pool");
+                pool_ = VK_NULL_HANDLE;
+                capacity_ = 0;
+                return;
+            }
+
+            VkDescriptorSetAllocateInfo set_info{};
+            set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            set_info.descriptorPool = pool_;
+            set_info.descriptorSetCount = 1;
+            set_info.pSetLayouts = &layout_;
+
+            if (vkAllocateDescriptorSets(logical_device, &set_info, &set_) != VK_SUCCESS)
+            {
+                AQUA_ERROR("Vulkan Error: failed to allocate texture table set");
+                set_ = VK_NULL_HANDLE;
+                capacity_ = 0;
+            }
+        }
+
+        TextureTable::~TextureTable()
+        {
+            // Frames in flight may still have the set bound, the layout belongs to the device cache
+            if (pool_ != VK_NULL_HANDLE)
+                device_->defer_destruction([logical_device = device_->get_device(), pool = pool_]() {
+                    vkDestroyDescriptorPool(logical_device, pool, nullptr);
+                });
+        }
+
+        uint32_t TextureTable::add(const Texture& texture)
+        {
+            // A texture that failed to load or upload has no view or sampler to write, even with one layer
+            if (texture.get_image().get_view() == VK_NULL_HANDLE || texture.get_sampler() == VK_NULL_HANDLE)
+            {
+                AQUA_ERROR("Vulkan Error: invalid texture cannot be added to the texture table");
+                return invalid_index;
+            }
+
+            // The table is declared as sampler2D, array textures are bound through their own descriptors
+            if (texture.get_image().get_array_layers() != 1)
+            {
+                AQUA_ERROR("Vulkan Error: texture arrays cannot be added to the texture table");
+                return invalid_index;
+            }
+
+            reclaim_retired_slots();
+
+            uint32_t index = invalid_index;
+            if (!free_slots_.empty())
+            {
+                index = free_slots_.back();
+                free_slots_.pop_back();
+            }
+            else if (next_unused_ < capacity_)
+                index = next_unused_++;
+            else
+            {
+                AQUA_ERROR("Vulkan Error: texture table is full");
+                return invalid_index;
+            }
+
+            VkDescriptorImageInfo image_info{};
+            image_info.imageLayout = texture.get_image().get_layout();
+            image_info.imageView = texture.get_image().get_view();
+            image_info.sampler = texture.get_sampler();
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = set_;
+            write.dstBinding = 0;
+            write.dstArrayElement = index;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo = &image_info;
+
+            vkUpdateDescriptorSets(device_->get_device(), 1, &write, 0, nullptr);
+
+            ++size_;
+            return index;
+        }
+
+        void TextureTable::remove(uint32_t index)
+        {
+            if (index == invalid_index)
+                return;
+
+            AQUA_ASSERT(index < next_unused_, "Vulkan Error: texture table index out of range");
+
+            // Commands recorded but not yet submitted may still read the slot, like deferred destruction
+            // it is only reused once the next submission has completed
+            retired_slots_.push_back({ index, device_->get_next_submission_value() });
+            --size_;
+        }
+
+        void TextureTable::reclaim_retired_slots()
+        {
+            if (retired_slots_.empty())
+                return;
+
+            const auto completed = device_->get_completed_value();
+            while (!retired_slots_.empty() && retired_slots_.front().value <= completed)
+            {
+                free_slots_.push_back(retired_slots_.front().index);
+                retired_slots_.pop_front();
+            }
+        }
+
+        bool TextureTable::is_supported(const VkPhysicalDeviceVulkan12Features& features)
+        {
+            return features.runtimeDescriptorArray &&
+                   features.descriptorBindingPartiallyBound &&
+                   features.descriptorBindingSampledImageUpdateAfterBind &&
+                   features.descriptorBindingUpdateUnusedWhilePending;
+        }
+
+        uint32_t TextureTable::get_max_capacity(VkPhysicalDevice physical_device)
+        {
+            VkPhysicalDeviceVulkan12Properties properties_12{};
+            properties_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+            VkPhysicalDeviceProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties.pNext = &properties_12;
+            vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+            return std::min(properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                            properties_12.maxDescriptorSetUpdateAfterBindSampledImages);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "Utils/MappedFile.h"
+
+#include "Debug/Debug.h"
+
+#include <utility>
+
+#ifdef AQUA_PLATFORM_WINDOWS
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Aqua
+{
+    MappedFile::MappedFile(const std::filesystem::path& file_path)
+    {
+        #ifdef AQUA_PLATFORM_WINDOWS
+            HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                AQUA_ERROR("File Error: cannot open file " + file_path.string());
+                return;
+            }
+
+            LARGE_INTEGER file_size{};
+            if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+            {
+                AQUA_ERROR("File Error: cannot map empty file " + file_path.string());
+                CloseHandle(file);
+                return;
+            }
+
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr)
+            {
+                AQUA_ERROR("File Error: failed to create file mapping for " + file_path.string());
+                CloseHandle(file);
+                return;
+            }
+
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view == nullptr)
+            {
+                AQUA_ERROR("File Error: failed to map view of file " + file_path.string());
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return;
+            }
+
+            file_handle_ = file;
+            mapping_handle_ = mapping;
+            data_ = static_cast<const uint8_t*>(view);
+            size_ = static_cast<size_t>(file_size.QuadPart);
+        #else
+            int file = open(file_path.c_str(), O_RDONLY);
+            if (file < 0)
+            {
+                AQUA_ERROR("File Error: cannot open file " + file_path.string());
+                return;
+            }
+
+            struct stat file_stat{};
+            if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0)
+            {
+                AQUA_ERROR("File Error: cannot map empty file " + file_path.string());
+                close(file);
+                return;
+            }
+
+            void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (view == MAP_FAILED)
+            {
+                AQUA_ERROR("File Error: failed to map file " + file_path.string());
+                close(file);
+                return;
+            }
+
+            file_descriptor_ = file;
+            data_ = static_cast<const uint8_t*>(view);
+            size_ = static_cast<size_t>(file_stat.st_size);
+        #endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_{ std::exchange(other.data_, nullptr) },
+          size_{ std::exchange(other.size_, 0) },
+        #ifdef AQUA_PLATFORM_WINDOWS
+          file_handle_{ std::exchange(other.file_handle_, nullptr) },
+          mapping_handle_{ std::exchange(other.mapping_handle_, nullptr) }
+        #else
+          file_descriptor_{ std::exchange(other.file_descriptor_, -1) }
+        #endif
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            #ifdef AQUA_PLATFORM_WINDOWS
+                file_handle_ = std::exchange(other.file_handle_, nullptr);
+                mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+            #else
+                file_descriptor_ = std::exchange(other.file_descriptor_, -1);
+            #endif
+        }
+
+        return *this;
+    }
+
+    std::span<const uint8_t> MappedFile::get_bytes(size_t offset, size_t size) const noexcept
+    {
+        if (offset > size_ || size > size_ - offset)
+        {
+            AQUA_ERROR("File Error: requested range is outside of the mapped file");
+            return {};
+        }
+
+        return { data_ + offset, size };
+    }
+
+    void MappedFile::unmap() noexcept
+    {
+        #ifdef AQUA_PLATFORM_WINDOWS
+            if (data_ != nullptr)
+                UnmapViewOfFile(data_);
+            if (mapping_handle_ != nullptr)
+                CloseHandle(mapping_handle_);
+            if (file_handle_ != nullptr)
+                CloseHandle(file_handle_);
+
+            mapping_handle_ = nullptr;
+            file_handle_ = nullptr;
+        #else
+            if (data_ != nullptr)
+                munmap(const_cast<uint8_t*>(data_), size_);
+            if (file_descriptor_ >= 0)
+                close(file_descriptor_);
+
+            file_descriptor_ = -1;
+        #endif
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -113,13 +113,18 @@ namespace Aqua
 
         auto source = stream.str();
 
-        auto filename = file_path.filename().string();
+        return compile_shader_from_source(source, file_path.filename().string());
+    }
+
+    std::vector<uint32_t> compile_shader_from_source(std::string_view source, std::string_view name)
+    {
+        auto filename = std::filesystem::path(name).filename().string();
         auto compiler = shaderc_compiler_initialize();
         auto stage = find_shader_stage(filename);
         auto compiler_options = shaderc_compile_options_initialize();
 
         auto result = shaderc_compile_into_spv(compiler,
-                                               source.c_str(),
+                                               source.data(),
                                                source.size(),
                                                stage,
                                                filename.c_str(),
@@ -133,6 +138,7 @@ namespace Aqua
             shaderc_compilation_status::shaderc_compilation_status_success)
         {
             std::string error_message = shaderc_result_get_error_message(result);
+            shaderc_result_release(result);
             AQUA_ERROR("[Shader Compilation Error]: " + error_message);
             return {};
         }
@@ -143,6 +149,8 @@ namespace Aqua
         std::vector<uint32_t> data(reinterpret_cast<const uint32_t*>(byte_code),
                                    reinterpret_cast<const uint32_t*>(byte_code + byte_size));
 
+        shaderc_result_release(result);
+
         AQUA_INFO("[Shader Compilation Info]: " + filename + " shader was compiled successfully");
 
         return data;
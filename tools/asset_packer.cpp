@@ -0,0 +1,43 @@
+#include <chrono>
+#include <iostream>
+
+#include "Assets/AssetArchive.h"
+#include "Debug/Profile.h"
+
+// Packs every file under an assets directory into a single .aqpk archive
+// usage: asset_packer <assets directory> <output archive> [--lz4 | --zstd] [--align <bytes>]
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: asset_packer <assets directory> <output archive> [--lz4 | --zstd] [--align <bytes>]" << std::endl;
+		return 1;
+	}
+
+	Aqua::Profiler::BeginProfile("asset_packer.txt");
+
+	auto compression = Aqua::AssetCompression::None;
+	uint32_t alignment = Aqua::AssetArchiveWriter::default_alignment;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		std::string_view option = argv[i];
+
+		if (option == "--lz4")
+			compression = Aqua::AssetCompression::LZ4;
+		else if (option == "--zstd")
+			compression = Aqua::AssetCompression::Zstd;
+		else if (option == "--align" && i + 1 < argc)
+			alignment = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else
+			std::cout << "Unknown option " << option << std::endl;
+	}
+
+	Aqua::AssetArchiveWriter writer;
+
+	bool result = writer.add_directory(argv[1], compression, alignment) && writer.write(argv[2]);
+
+	Aqua::Profiler::EndProfile();
+
+	return result ? 0 : 1;
+}